@@ -101,6 +101,7 @@ LOCAL_SRC_FILES += \
 	common/mptStringBuffer.cpp \
 	common/mptStringFormat.cpp \
 	common/mptStringParse.cpp \
+	common/mptThreadPool.cpp \
 	common/mptTime.cpp \
 	common/mptUUID.cpp \
 	common/mptWine.cpp \
@@ -117,9 +118,11 @@ LOCAL_SRC_FILES += \
 	soundlib/ContainerPP20.cpp \
 	soundlib/ContainerUMX.cpp \
 	soundlib/ContainerXPK.cpp \
+	soundlib/DeferredSamples.cpp \
 	soundlib/Dither.cpp \
 	soundlib/Dlsbank.cpp \
 	soundlib/Fastmix.cpp \
+	soundlib/GetLengthCheckpoints.cpp \
 	soundlib/InstrumentExtensions.cpp \
 	soundlib/ITCompression.cpp \
 	soundlib/ITTools.cpp \
@@ -185,6 +188,7 @@ LOCAL_SRC_FILES += \
 	soundlib/SampleFormatOpus.cpp \
 	soundlib/SampleFormatVorbis.cpp \
 	soundlib/SampleIO.cpp \
+	soundlib/SamplePool.cpp \
 	soundlib/Sndfile.cpp \
 	soundlib/Snd_flt.cpp \
 	soundlib/Snd_fx.cpp \
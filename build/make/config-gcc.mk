@@ -25,8 +25,10 @@ CFLAGS += $(CFLAGS_STDC)
 
 CPPFLAGS += 
 CXXFLAGS += -fPIC 
+CXXFLAGS += -pthread
 CFLAGS   += -fPIC 
 LDFLAGS  += 
+LDFLAGS  += -pthread
 LDLIBS   += -lm
 ARFLAGS  := rcs
 
@@ -253,6 +253,9 @@
 // Use inline assembly
 #define ENABLE_ASM
 
+// Use compiler intrinsics for runtime-dispatched SIMD code paths
+#define ENABLE_INTRINSICS
+
 // Disable unarchiving support
 //#define NO_ARCHIVE_SUPPORT
 
@@ -314,14 +317,21 @@
 #endif
 // Do not use inline asm in library builds. There is just about no codepath which would use it anyway.
 //#define ENABLE_ASM
+// Intrinsics are portable across compilers and only get used if the CPU supports them.
+#define ENABLE_INTRINSICS
+// Worker threads are only used for opt-in parallel processing.
+// MinGW without a threading model that provides std::thread has to do without.
+#if MPT_PLATFORM_MULTITHREADED && !(MPT_OS_WINDOWS && MPT_COMPILER_GCC)
+#define MPT_ENABLE_THREAD
+#endif
 #if defined(MPT_BUILD_HACK_ARCHIVE_SUPPORT)
 //#define NO_ARCHIVE_SUPPORT
 #else
 #define NO_ARCHIVE_SUPPORT
 #endif
 //#define NO_REVERB
-#define NO_DSP
-#define NO_EQ
+//#define NO_DSP
+//#define NO_EQ
 #define NO_AGC
 #define NO_VST
 //#if !MPT_OS_WINDOWS || MPT_OS_WINDOWS_WINRT || !MPT_COMPILER_MSVC || !defined(LIBOPENMPT_BUILD_FULL)
@@ -483,6 +493,21 @@
 #endif // arch
 #endif // ENABLE_ASM
 
+#if defined(ENABLE_INTRINSICS)
+#if (MPT_COMPILER_MSVC && (defined(_M_IX86) || defined(_M_X64))) || ((MPT_GCC_AT_LEAST(4,9,0) || MPT_CLANG_AT_LEAST(3,8,0)) && (defined(__i386__) || defined(__x86_64__)))
+
+// Generate intrinsics code using SSE2 instructions (only used when the CPU supports it).
+#define ENABLE_INTRINSICS_SSE2
+// Generate intrinsics code using SSE4.1 instructions (only used when the CPU supports it).
+#define ENABLE_INTRINSICS_SSE4_1
+// Generate intrinsics code using AVX2 instructions (only used when the CPU supports it).
+#define ENABLE_INTRINSICS_AVX2
+
+#else // !arch
+#undef ENABLE_INTRINSICS // no supported target architecture
+#endif // arch
+#endif // ENABLE_INTRINSICS
+
 #if defined(MPT_WITH_LAME) && defined(MPT_BUILD_MSVC) && defined(MPT_BUILD_MSVC_STATIC) && defined(MODPLUG_TRACKER) && !MPT_OS_WINDOWS_WINRT
 #define MPT_ENABLE_LAME_DELAYLOAD
 #endif
@@ -548,8 +573,12 @@
 #define MPT_ENABLE_FILEIO // Test suite requires PathString for file loading.
 #endif
 
-#if !MPT_OS_WINDOWS && !defined(MPT_FILEREADER_STD_ISTREAM)
-#define MPT_FILEREADER_STD_ISTREAM // MMAP is only supported on Windows
+#if !MPT_OS_WINDOWS && !MPT_OS_EMSCRIPTEN && !MPT_OS_UNKNOWN
+#define MPT_ENABLE_MMAP // Local files can be mapped into memory via POSIX mmap()
+#endif
+
+#if !MPT_OS_WINDOWS && !defined(MPT_ENABLE_MMAP) && !defined(MPT_FILEREADER_STD_ISTREAM)
+#define MPT_FILEREADER_STD_ISTREAM // MMAP is only supported on Windows and POSIX systems
 #endif
 
 #if defined(MODPLUG_TRACKER) && !defined(MPT_ENABLE_FILEIO)
@@ -564,6 +593,10 @@
 #define MPT_ENABLE_FILEIO // External samples require disk file io
 #endif
 
+#if defined(MPT_ENABLE_FILEIO) && (!defined(MPT_FILEREADER_STD_ISTREAM) || defined(MPT_ENABLE_MMAP))
+#define MPT_FILEIO_MAPPED_INPUTFILE // InputFile maps local files into memory instead of reading them via std::istream
+#endif
+
 #if defined(NO_PLUGINS)
 // Any plugin type requires NO_PLUGINS to not be defined.
 #define NO_VST
@@ -1110,26 +1110,28 @@ template <typename Tbyte> static inline FileReader make_FileReader(mpt::span<Tby
 #if defined(MPT_FILEREADER_CALLBACK_STREAM)
 
 // Initialize file reader object with a CallbackStream.
-static inline FileReader make_FileReader(CallbackStream s, const mpt::PathString *filename = nullptr)
+// If readAhead is set and the stream is not seekable, it is read on a background thread while the file is being parsed.
+static inline FileReader make_FileReader(CallbackStream s, const mpt::PathString *filename = nullptr, bool readAhead = false)
 {
 	return FileReader(
 				FileDataContainerCallbackStreamSeekable::IsSeekable(s) ?
 					std::static_pointer_cast<IFileDataContainer>(std::make_shared<FileDataContainerCallbackStreamSeekable>(s))
 				:
-					std::static_pointer_cast<IFileDataContainer>(std::make_shared<FileDataContainerCallbackStream>(s))
+					std::static_pointer_cast<IFileDataContainer>(std::make_shared<FileDataContainerCallbackStream>(s, readAhead))
 			, filename
 		);
 }
 #endif // MPT_FILEREADER_CALLBACK_STREAM
 	
 // Initialize file reader object with a std::istream.
-static inline FileReader make_FileReader(std::istream *s, const mpt::PathString *filename = nullptr)
+// If readAhead is set and the stream is not seekable, it is read on a background thread while the file is being parsed.
+static inline FileReader make_FileReader(std::istream *s, const mpt::PathString *filename = nullptr, bool readAhead = false)
 {
 	return FileReader(
 				FileDataContainerStdStreamSeekable::IsSeekable(s) ?
 					std::static_pointer_cast<IFileDataContainer>(std::make_shared<FileDataContainerStdStreamSeekable>(s))
 				:
-					std::static_pointer_cast<IFileDataContainer>(std::make_shared<FileDataContainerStdStream>(s))
+					std::static_pointer_cast<IFileDataContainer>(std::make_shared<FileDataContainerStdStream>(s, readAhead))
 			, filename
 		);
 }
@@ -1144,7 +1146,7 @@ static inline FileReader make_FileReader(std::istream *s, const mpt::PathString
 template <typename TInputFile>
 FileReader GetFileReader(TInputFile &file)
 {
-	#if defined(MPT_FILEREADER_STD_ISTREAM)
+	#if !defined(MPT_FILEIO_MAPPED_INPUTFILE)
 		typename TInputFile::ContentsRef tmp = file.Get();
 		if(!tmp.first)
 		{
@@ -15,7 +15,7 @@
 OPENMPT_NAMESPACE_BEGIN
 
 
-#if defined(ENABLE_ASM)
+#if defined(ENABLE_ASM) || defined(ENABLE_INTRINSICS)
 
 
 uint32 RealProcSupport = 0;
@@ -26,10 +26,15 @@ uint8 ProcModel = 0;
 uint8 ProcStepping = 0;
 
 
-#if MPT_COMPILER_MSVC && (defined(ENABLE_X86) || defined(ENABLE_X64))
+#if (MPT_COMPILER_MSVC && (defined(ENABLE_X86) || defined(ENABLE_X64))) || defined(ENABLE_INTRINSICS_SSE4_1)
 
 
+#if MPT_COMPILER_MSVC
 #include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
 
 
 typedef char cpuid_result_string[12];
@@ -60,6 +65,8 @@ struct cpuid_result {
 };
 
 
+#if MPT_COMPILER_MSVC
+
 static cpuid_result cpuid(uint32 function)
 {
 	cpuid_result result;
@@ -72,9 +79,6 @@ static cpuid_result cpuid(uint32 function)
 	return result;
 }
 
-
-#if 0
-
 static cpuid_result cpuidex(uint32 function_a, uint32 function_c)
 {
 	cpuid_result result;
@@ -87,7 +91,47 @@ static cpuid_result cpuidex(uint32 function_a, uint32 function_c)
 	return result;
 }
 
-#endif
+// Returns the OS-enabled extended processor state (XCR0)
+static uint64 xgetbv0()
+{
+	return _xgetbv(0);
+}
+
+#else // !MPT_COMPILER_MSVC
+
+static cpuid_result cpuid(uint32 function)
+{
+	cpuid_result result;
+	unsigned int a = 0, b = 0, c = 0, d = 0;
+	__cpuid(function, a, b, c, d);
+	result.a = a;
+	result.b = b;
+	result.c = c;
+	result.d = d;
+	return result;
+}
+
+static cpuid_result cpuidex(uint32 function_a, uint32 function_c)
+{
+	cpuid_result result;
+	unsigned int a = 0, b = 0, c = 0, d = 0;
+	__cpuid_count(function_a, function_c, a, b, c, d);
+	result.a = a;
+	result.b = b;
+	result.c = c;
+	result.d = d;
+	return result;
+}
+
+// Returns the OS-enabled extended processor state (XCR0)
+static uint64 xgetbv0()
+{
+	uint32 lo = 0, hi = 0;
+	__asm__ __volatile__ ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+	return (static_cast<uint64>(hi) << 32) | lo;
+}
+
+#endif // MPT_COMPILER_MSVC
 
 
 void InitProcSupport()
@@ -157,6 +201,16 @@ void InitProcSupport()
 			if(StandardFeatureFlags.c & (1<< 9)) ProcSupport |= PROCSUPPORT_SSSE3;
 			if(StandardFeatureFlags.c & (1<<19)) ProcSupport |= PROCSUPPORT_SSE4_1;
 			if(StandardFeatureFlags.c & (1<<20)) ProcSupport |= PROCSUPPORT_SSE4_2;
+			// AVX requires the OS to save the YMM registers on context switches (OSXSAVE, XCR0 bits 1 and 2)
+			if((StandardFeatureFlags.c & (1<<27)) && (StandardFeatureFlags.c & (1<<28)) && ((xgetbv0() & 0x06) == 0x06))
+			{
+				ProcSupport |= PROCSUPPORT_AVX;
+				if(VendorString.a >= 0x00000007u)
+				{
+					cpuid_result ExtendedFeatures = cpuidex(0x00000007u, 0x00000000u);
+					if(ExtendedFeatures.b & (1<< 5)) ProcSupport |= PROCSUPPORT_AVX2;
+				}
+			}
 		}
 
 		// 3DNow! manual recommends to just execute 0x80000000u.
@@ -263,7 +317,7 @@ void InitProcSupport()
 }
 
 
-#else // !( MPT_COMPILER_MSVC && ENABLE_X86 )
+#else // !( MPT_COMPILER_MSVC && ENABLE_X86 ) && !ENABLE_INTRINSICS_SSE4_1
 
 
 void InitProcSupport()
@@ -272,9 +326,25 @@ void InitProcSupport()
 }
 
 
-#endif // MPT_COMPILER_MSVC && ENABLE_X86
+#endif // MPT_COMPILER_MSVC && ENABLE_X86 || ENABLE_INTRINSICS_SSE4_1
+
+
+#if !defined(MODPLUG_TRACKER)
+
+// The library has no central startup code that could call InitProcSupport,
+// so the processor features are detected when the library is loaded.
+struct ProcSupportInitializer
+{
+	ProcSupportInitializer()
+	{
+		InitProcSupport();
+	}
+};
+static ProcSupportInitializer g_ProcSupportInitializer;
+
+#endif // !MODPLUG_TRACKER
 
-#endif // ENABLE_ASM
+#endif // ENABLE_ASM || ENABLE_INTRINSICS
 
 
 #ifdef MODPLUG_TRACKER
@@ -344,7 +414,7 @@ int GetMinimumAVXVersion()
 #endif
 
 
-#if !defined(MODPLUG_TRACKER) && !defined(ENABLE_ASM)
+#if !defined(MODPLUG_TRACKER) && !defined(ENABLE_ASM) && !defined(ENABLE_INTRINSICS)
 
 MPT_MSVC_WORKAROUND_LNK4221(mptCPU)
 
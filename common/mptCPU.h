@@ -14,7 +14,7 @@
 OPENMPT_NAMESPACE_BEGIN
 
 
-#ifdef ENABLE_ASM
+#if defined(ENABLE_ASM) || defined(ENABLE_INTRINSICS)
 
 #define PROCSUPPORT_TSC          0x00002 // Processor supports RDTSC instruction (i586)
 #define PROCSUPPORT_CMOV         0x00004 // Processor supports conditional move instructions (i686)
@@ -28,6 +28,8 @@ OPENMPT_NAMESPACE_BEGIN
 #define PROCSUPPORT_SSSE3        0x00800 // Processor supports SSSE3 instructions
 #define PROCSUPPORT_SSE4_1       0x01000 // Processor supports SSE4.1 instructions
 #define PROCSUPPORT_SSE4_2       0x02000 // Processor supports SSE4.2 instructions
+#define PROCSUPPORT_AVX          0x10000 // Processor and OS support AVX instructions
+#define PROCSUPPORT_AVX2         0x20000 // Processor and OS support AVX2 instructions
 
 static const uint32 PROCSUPPORT_i586     = 0u                                                        ;
 static const uint32 PROCSUPPORT_i686     = 0u | PROCSUPPORT_CMOV                                     ;
@@ -56,7 +58,21 @@ static inline uint32 GetRealProcSupport()
 	return RealProcSupport;
 }
 
-#endif // ENABLE_ASM
+#endif // ENABLE_ASM || ENABLE_INTRINSICS
+
+
+// Function attributes that allow the compiler to generate code for a specific instruction set extension
+// inside an individual function, so that it can be selected at runtime via GetProcSupport().
+// MSVC always allows using all intrinsics and does not need this.
+#if defined(ENABLE_INTRINSICS) && (MPT_COMPILER_GCC || MPT_COMPILER_CLANG)
+#define MPT_TARGET_SSE2   __attribute__((target("sse2")))
+#define MPT_TARGET_SSE4_1 __attribute__((target("sse4.1")))
+#define MPT_TARGET_AVX2   __attribute__((target("avx2")))
+#else
+#define MPT_TARGET_SSE2
+#define MPT_TARGET_SSE4_1
+#define MPT_TARGET_AVX2
+#endif
 
 
 #ifdef MODPLUG_TRACKER
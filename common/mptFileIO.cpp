@@ -18,6 +18,16 @@
 #endif // MPT_OS_WINDOWS
 #endif // MODPLUG_TRACKER
 
+#if defined(MPT_ENABLE_MMAP)
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif // MPT_ENABLE_MMAP
+
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -286,6 +296,139 @@ const mpt::byte *CMappedFile::Lock()
 
 
 
+#endif // MPT_ENABLE_FILEIO
+
+
+
+#if defined(MPT_ENABLE_MMAP)
+
+CMappedFile::~CMappedFile()
+{
+	Close();
+}
+
+
+bool CMappedFile::Open(const mpt::PathString &filename)
+{
+	Close();
+	int flags = O_RDONLY;
+#if defined(O_CLOEXEC)
+	flags |= O_CLOEXEC;
+#endif
+	do
+	{
+		m_fd = open(filename.AsNative().c_str(), flags);
+	} while(m_fd == -1 && errno == EINTR);
+	if(m_fd == -1)
+	{
+		return false;
+	}
+	struct stat st;
+	if(fstat(m_fd, &st) != 0 || S_ISDIR(st.st_mode))
+	{
+		close(m_fd);
+		m_fd = -1;
+		return false;
+	}
+	m_FileName = filename;
+	return true;
+}
+
+
+void CMappedFile::Close()
+{
+	m_FileName = mpt::PathString();
+	if(m_pData)
+	{
+		if(m_isMapped)
+		{
+			munmap(m_pData, m_dataLength);
+		} else
+		{
+			free(m_pData);
+		}
+		m_pData = nullptr;
+	}
+	m_dataLength = 0;
+	m_isMapped = false;
+	if(m_fd != -1)
+	{
+		close(m_fd);
+		m_fd = -1;
+	}
+}
+
+
+size_t CMappedFile::GetLength()
+{
+	if(m_pData)
+	{
+		return m_dataLength;
+	}
+	struct stat st;
+	if(m_fd == -1 || fstat(m_fd, &st) != 0 || st.st_size <= 0)
+	{
+		return 0;
+	}
+	return mpt::saturate_cast<size_t>(static_cast<uint64>(st.st_size));
+}
+
+
+const mpt::byte *CMappedFile::Lock()
+{
+	if(m_pData)
+	{
+		return mpt::void_cast<const mpt::byte*>(m_pData);
+	}
+	size_t length = GetLength();
+	if(!length) return nullptr;
+
+	// Try memory-mapping first. Pages are only read from disk once they are accessed.
+	void *lpStream = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, m_fd, 0);
+	if(lpStream != MAP_FAILED)
+	{
+		m_pData = lpStream;
+		m_dataLength = length;
+		m_isMapped = true;
+		return mpt::void_cast<const mpt::byte*>(lpStream);
+	}
+
+	// Fallback for files that cannot be mapped (e.g. on some special or network file systems)
+	if((lpStream = malloc(length)) == nullptr) return nullptr;
+	size_t bytesRead = 0;
+	while(bytesRead < length)
+	{
+		ssize_t chunkRead = pread(m_fd, mpt::void_cast<mpt::byte*>(lpStream) + bytesRead, length - bytesRead, bytesRead);
+		if(chunkRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if(chunkRead < 0)
+		{
+			free(lpStream);
+			return nullptr;
+		}
+		if(chunkRead == 0)
+		{
+			// File has been truncated in the meantime
+			break;
+		}
+		bytesRead += static_cast<size_t>(chunkRead);
+	}
+	m_pData = lpStream;
+	m_dataLength = bytesRead;
+	m_isMapped = false;
+	return mpt::void_cast<const mpt::byte*>(lpStream);
+}
+
+#endif // MPT_ENABLE_MMAP
+
+
+
+#if defined(MPT_ENABLE_FILEIO)
+
+
+
 InputFile::InputFile()
 {
 	return;
@@ -294,7 +437,7 @@ InputFile::InputFile()
 InputFile::InputFile(const mpt::PathString &filename)
 	: m_Filename(filename)
 {
-#if defined(MPT_FILEREADER_STD_ISTREAM)
+#if !defined(MPT_FILEIO_MAPPED_INPUTFILE)
 	m_File.open(m_Filename, std::ios::binary | std::ios::in);
 #else
 	m_File.Open(m_Filename);
@@ -310,7 +453,7 @@ InputFile::~InputFile()
 bool InputFile::Open(const mpt::PathString &filename)
 {
 	m_Filename = filename;
-#if defined(MPT_FILEREADER_STD_ISTREAM)
+#if !defined(MPT_FILEIO_MAPPED_INPUTFILE)
 	m_File.open(m_Filename, std::ios::binary | std::ios::in);
 	return m_File.good();
 #else
@@ -321,14 +464,14 @@ bool InputFile::Open(const mpt::PathString &filename)
 
 bool InputFile::IsValid() const
 {
-#if defined(MPT_FILEREADER_STD_ISTREAM)
+#if !defined(MPT_FILEIO_MAPPED_INPUTFILE)
 	return m_File.good();
 #else
 	return m_File.IsOpen();
 #endif
 }
 
-#if defined(MPT_FILEREADER_STD_ISTREAM)
+#if !defined(MPT_FILEIO_MAPPED_INPUTFILE)
 
 InputFile::ContentsRef InputFile::Get()
 {
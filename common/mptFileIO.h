@@ -9,7 +9,7 @@
 
 #pragma once
 
-#if defined(MPT_ENABLE_FILEIO)
+#if defined(MPT_ENABLE_FILEIO) || defined(MPT_ENABLE_MMAP)
 
 #include "../common/mptString.h"
 #include "../common/mptPathString.h"
@@ -21,7 +21,7 @@
 #include <streambuf>
 #include <utility>
 
-#endif // MPT_ENABLE_FILEIO
+#endif // MPT_ENABLE_FILEIO || MPT_ENABLE_MMAP
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -236,40 +236,66 @@ public:
 
 
 
-#ifdef MODPLUG_TRACKER
-#if MPT_OS_WINDOWS
+#endif // MPT_ENABLE_FILEIO
+
+
+
+#if (defined(MODPLUG_TRACKER) && MPT_OS_WINDOWS) || defined(MPT_ENABLE_MMAP)
+// Read-only view of the complete contents of a file.
+// The file is mapped into memory if possible, so that only the parts that are actually accessed are read from disk.
+// If mapping fails, the whole file is read into memory instead.
 class CMappedFile
 {
 protected:
+#if MPT_OS_WINDOWS
 	HANDLE m_hFile;
 	HANDLE m_hFMap;
+#else // !MPT_OS_WINDOWS
+	int m_fd;
+	size_t m_dataLength;	// Size of the mapped or allocated data
+	bool m_isMapped;
+#endif // MPT_OS_WINDOWS
 	void *m_pData;
 	mpt::PathString m_FileName;
 
 public:
+#if MPT_OS_WINDOWS
 	CMappedFile() : m_hFile(nullptr), m_hFMap(nullptr), m_pData(nullptr) { }
+#else // !MPT_OS_WINDOWS
+	CMappedFile() : m_fd(-1), m_dataLength(0), m_isMapped(false), m_pData(nullptr) { }
+#endif // MPT_OS_WINDOWS
 	~CMappedFile();
 
+	CMappedFile(const CMappedFile &) = delete;
+	CMappedFile & operator = (const CMappedFile &) = delete;
+
 public:
 	bool Open(const mpt::PathString &filename);
+#if MPT_OS_WINDOWS
 	bool IsOpen() const { return m_hFile != NULL && m_hFile != INVALID_HANDLE_VALUE; }
+#else // !MPT_OS_WINDOWS
+	bool IsOpen() const { return m_fd != -1; }
+#endif // MPT_OS_WINDOWS
 	const mpt::PathString * GetpFilename() const { return &m_FileName; }
 	void Close();
 	size_t GetLength();
 	const mpt::byte *Lock();
 };
-#endif // MPT_OS_WINDOWS
-#endif // MODPLUG_TRACKER
+#endif // (MODPLUG_TRACKER && MPT_OS_WINDOWS) || MPT_ENABLE_MMAP
+
+
+
+#if defined(MPT_ENABLE_FILEIO)
 
 
 class InputFile
 {
 private:
 	mpt::PathString m_Filename;
-	#ifdef MPT_FILEREADER_STD_ISTREAM
-		mpt::ifstream m_File;
-	#else
+	#if defined(MPT_FILEIO_MAPPED_INPUTFILE)
 		CMappedFile m_File;
+	#else
+		mpt::ifstream m_File;
 	#endif
 public:
 	InputFile();
@@ -277,7 +303,7 @@ public:
 	~InputFile();
 	bool Open(const mpt::PathString &filename);
 	bool IsValid() const;
-#if defined(MPT_FILEREADER_STD_ISTREAM)
+#if !defined(MPT_FILEIO_MAPPED_INPUTFILE)
 	typedef std::pair<std::istream*, const mpt::PathString*> ContentsRef;
 #else
 	struct Data
@@ -420,76 +420,175 @@ IFileDataContainer::off_t FileDataContainerStdStreamSeekable::InternalRead(mpt::
 }
 
 
+#if defined(MPT_ENABLE_THREAD)
+#define MPT_UNSEEKABLE_LOCK_CACHE() std::unique_lock<std::mutex> cacheLock(mutex)
+#else
+#define MPT_UNSEEKABLE_LOCK_CACHE() MPT_DO { } MPT_WHILE_0
+#endif
+
 FileDataContainerUnseekable::FileDataContainerUnseekable()
 	: cachesize(0), streamFullyCached(false)
+#if defined(MPT_ENABLE_THREAD)
+	, stopReadAhead(false)
+#endif // MPT_ENABLE_THREAD
 {
 	return;
 }
 
-void FileDataContainerUnseekable::EnsureCacheBuffer(std::size_t requiredbuffersize) const
+void FileDataContainerUnseekable::StartReadAhead()
+{
+#if defined(MPT_ENABLE_THREAD)
+	readAheadThread = std::thread(&FileDataContainerUnseekable::ReadAheadThread, this);
+#endif // MPT_ENABLE_THREAD
+}
+
+void FileDataContainerUnseekable::StopReadAhead()
 {
-	if(cache.size() >= cachesize + requiredbuffersize)
+#if defined(MPT_ENABLE_THREAD)
+	if(!readAheadThread.joinable())
 	{
 		return;
 	}
-	if(cache.size() == 0)
 	{
-		cache.resize(Util::AlignUp<std::size_t>(cachesize + requiredbuffersize, BUFFER_SIZE));
-	} else if(Util::ExponentialGrow(cache.size()) < cachesize + requiredbuffersize)
+		MPT_UNSEEKABLE_LOCK_CACHE();
+		stopReadAhead = true;
+	}
+	// A read that is already in progress cannot be interrupted, so this blocks until the stream returns.
+	readAheadThread.join();
+#endif // MPT_ENABLE_THREAD
+}
+
+bool FileDataContainerUnseekable::IsReadingAhead() const
+{
+#if defined(MPT_ENABLE_THREAD)
+	return readAheadThread.joinable();
+#else
+	return false;
+#endif // MPT_ENABLE_THREAD
+}
+
+#if defined(MPT_ENABLE_THREAD)
+void FileDataContainerUnseekable::ReadAheadThread()
+{
+	while(true)
 	{
-		cache.resize(Util::AlignUp<std::size_t>(cachesize + requiredbuffersize, BUFFER_SIZE));
-	} else
+		{
+			MPT_UNSEEKABLE_LOCK_CACHE();
+			if(stopReadAhead || streamFullyCached)
+			{
+				break;
+			}
+		}
+		try
+		{
+			AppendFromStream(QUANTUM_SIZE);
+		} catch(...)
+		{
+			// Treat read errors like the end of the stream, so that waiting readers can continue.
+			{
+				MPT_UNSEEKABLE_LOCK_CACHE();
+				streamFullyCached = true;
+			}
+			dataAvailable.notify_all();
+			break;
+		}
+	}
+}
+#endif // MPT_ENABLE_THREAD
+
+// Only the thread that reads the stream (the read-ahead thread if there is one) may call this.
+void FileDataContainerUnseekable::AppendFromStream(std::size_t count) const
+{
+	while(count > 0)
 	{
-		cache.resize(Util::ExponentialGrow(cache.size()));
+		const std::size_t segmentPos = cachesize % SEGMENT_SIZE;
+		if(cachesize == segments.size() * SEGMENT_SIZE)
+		{
+			std::unique_ptr<mpt::byte[]> segment(new mpt::byte[SEGMENT_SIZE]);
+			MPT_UNSEEKABLE_LOCK_CACHE();
+			segments.push_back(std::move(segment));
+		}
+		const std::size_t chunkSize = std::min(count, SEGMENT_SIZE - segmentPos);
+		// Readers never look beyond cachesize, so the segment can be filled without holding the lock.
+		const std::size_t readcount = InternalRead(segments[cachesize / SEGMENT_SIZE].get() + segmentPos, chunkSize);
+		const bool eof = InternalEof() || readcount == 0;
+		{
+			MPT_UNSEEKABLE_LOCK_CACHE();
+			cachesize += readcount;
+			streamFullyCached = eof;
+		}
+#if defined(MPT_ENABLE_THREAD)
+		dataAvailable.notify_all();
+#endif // MPT_ENABLE_THREAD
+		if(eof)
+		{
+			return;
+		}
+		count -= readcount;
 	}
 }
 
 void FileDataContainerUnseekable::CacheStream() const
 {
-	if(streamFullyCached)
+#if defined(MPT_ENABLE_THREAD)
+	if(IsReadingAhead())
 	{
+		MPT_UNSEEKABLE_LOCK_CACHE();
+		dataAvailable.wait(cacheLock, [this]() { return streamFullyCached; });
 		return;
 	}
-	while(!InternalEof())
+#endif // MPT_ENABLE_THREAD
+	while(!streamFullyCached)
 	{
-		EnsureCacheBuffer(BUFFER_SIZE);
-		std::size_t readcount = InternalRead(&cache[cachesize], BUFFER_SIZE);
-		cachesize += readcount;
+		AppendFromStream(SEGMENT_SIZE);
 	}
-	streamFullyCached = true;
 }
 
 void FileDataContainerUnseekable::CacheStreamUpTo(off_t pos, off_t length) const
 {
-	if(streamFullyCached)
-	{
-		return;
-	}
 	if(length > std::numeric_limits<off_t>::max() - pos)
 	{
 		length = std::numeric_limits<off_t>::max() - pos;
 	}
-	std::size_t target = mpt::saturate_cast<std::size_t>(pos + length);
-	if(target <= cachesize)
+	const std::size_t target = mpt::saturate_cast<std::size_t>(pos + length);
+#if defined(MPT_ENABLE_THREAD)
+	if(IsReadingAhead())
 	{
+		MPT_UNSEEKABLE_LOCK_CACHE();
+		dataAvailable.wait(cacheLock, [this, target]() { return cachesize >= target || streamFullyCached; });
 		return;
 	}
-	std::size_t alignedpos = Util::AlignUp<std::size_t>(target, QUANTUM_SIZE);
-	std::size_t needcount = alignedpos - cachesize;
-	EnsureCacheBuffer(needcount);
-	std::size_t readcount = InternalRead(&cache[cachesize], alignedpos - cachesize);
-	cachesize += readcount;
-	if(!InternalEof())
+#endif // MPT_ENABLE_THREAD
+	if(streamFullyCached || target <= cachesize)
 	{
-		// can read further
 		return;
 	}
-	streamFullyCached = true;
+	std::size_t alignedpos = target;
+	if(target <= std::numeric_limits<std::size_t>::max() - QUANTUM_SIZE)
+	{
+		alignedpos = Util::AlignUp<std::size_t>(target, QUANTUM_SIZE);
+	}
+	AppendFromStream(alignedpos - cachesize);
 }
 
+// The cache lock must be held if another thread may be reading the stream.
 void FileDataContainerUnseekable::ReadCached(mpt::byte *dst, IFileDataContainer::off_t pos, IFileDataContainer::off_t count) const
 {
-	std::copy(cache.begin() + pos, cache.begin() + pos + count, dst);
+	if(segments.empty())
+	{
+		std::copy(contiguous.begin() + pos, contiguous.begin() + pos + count, dst);
+		return;
+	}
+	while(count > 0)
+	{
+		const std::size_t segmentPos = pos % SEGMENT_SIZE;
+		const std::size_t chunkSize = std::min<std::size_t>(count, SEGMENT_SIZE - segmentPos);
+		const mpt::byte *src = segments[pos / SEGMENT_SIZE].get() + segmentPos;
+		std::copy(src, src + chunkSize, dst);
+		dst += chunkSize;
+		pos += chunkSize;
+		count -= chunkSize;
+	}
 }
 
 bool FileDataContainerUnseekable::IsValid() const
@@ -504,24 +603,36 @@ bool FileDataContainerUnseekable::HasFastGetLength() const
 
 bool FileDataContainerUnseekable::HasPinnedView() const
 {
-	return true; // we have the cache which is required for seeking anyway
+	MPT_UNSEEKABLE_LOCK_CACHE();
+	return streamFullyCached && segments.empty();
 }
 
 const mpt::byte *FileDataContainerUnseekable::GetRawData() const
 {
 	CacheStream();
-	return cache.data();
+	MPT_UNSEEKABLE_LOCK_CACHE();
+	if(!segments.empty())
+	{
+		// Only happens once, the segments are released right away in order to not keep the file in memory twice.
+		std::vector<mpt::byte> data(cachesize);
+		ReadCached(data.data(), 0, cachesize);
+		contiguous.swap(data);
+		segments.clear();
+	}
+	return contiguous.data();
 }
 
 IFileDataContainer::off_t FileDataContainerUnseekable::GetLength() const
 {
 	CacheStream();
+	MPT_UNSEEKABLE_LOCK_CACHE();
 	return cachesize;
 }
 
 IFileDataContainer::off_t FileDataContainerUnseekable::Read(mpt::byte *dst, IFileDataContainer::off_t pos, IFileDataContainer::off_t count) const
 {
 	CacheStreamUpTo(pos, count);
+	MPT_UNSEEKABLE_LOCK_CACHE();
 	if(pos >= IFileDataContainer::off_t(cachesize))
 	{
 		return 0;
@@ -534,6 +645,7 @@ IFileDataContainer::off_t FileDataContainerUnseekable::Read(mpt::byte *dst, IFil
 bool FileDataContainerUnseekable::CanRead(IFileDataContainer::off_t pos, IFileDataContainer::off_t length) const
 {
 	CacheStreamUpTo(pos, length);
+	MPT_UNSEEKABLE_LOCK_CACHE();
 	if((pos == IFileDataContainer::off_t(cachesize)) && (length == 0))
 	{
 		return true;
@@ -548,6 +660,7 @@ bool FileDataContainerUnseekable::CanRead(IFileDataContainer::off_t pos, IFileDa
 IFileDataContainer::off_t FileDataContainerUnseekable::GetReadableLength(IFileDataContainer::off_t pos, IFileDataContainer::off_t length) const
 {
 	CacheStreamUpTo(pos, length);
+	MPT_UNSEEKABLE_LOCK_CACHE();
 	if(pos >= cachesize)
 	{
 		return 0;
@@ -555,12 +668,22 @@ IFileDataContainer::off_t FileDataContainerUnseekable::GetReadableLength(IFileDa
 	return std::min<IFileDataContainer::off_t>(cachesize - pos, length);
 }
 
+#undef MPT_UNSEEKABLE_LOCK_CACHE
 
 
-FileDataContainerStdStream::FileDataContainerStdStream(std::istream *s)
+
+FileDataContainerStdStream::FileDataContainerStdStream(std::istream *s, bool readAhead)
 	: stream(s)
 {
-	return;
+	if(readAhead)
+	{
+		StartReadAhead();
+	}
+}
+
+FileDataContainerStdStream::~FileDataContainerStdStream()
+{
+	StopReadAhead();
 }
 
 bool FileDataContainerStdStream::InternalEof() const
@@ -697,12 +820,20 @@ IFileDataContainer::off_t FileDataContainerCallbackStreamSeekable::InternalRead(
 
 
 
-FileDataContainerCallbackStream::FileDataContainerCallbackStream(CallbackStream s)
+FileDataContainerCallbackStream::FileDataContainerCallbackStream(CallbackStream s, bool readAhead)
 	: FileDataContainerUnseekable()
 	, stream(s)
 	, eof_reached(false)
 {
-	return;
+	if(readAhead)
+	{
+		StartReadAhead();
+	}
+}
+
+FileDataContainerCallbackStream::~FileDataContainerCallbackStream()
+{
+	StopReadAhead();
 }
 
 bool FileDataContainerCallbackStream::InternalEof() const
@@ -19,7 +19,14 @@
 #include <array>
 #include <iosfwd>
 #include <limits>
+#include <memory>
+#include <vector>
 #include <cstring>
+#if defined(MPT_FILEREADER_STD_ISTREAM) && defined(MPT_ENABLE_THREAD)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -861,24 +868,47 @@ private:
 };
 
 
+// Caches everything that has been read from the stream, so that loaders can seek in it.
+// The cache is a list of fixed-size segments, so growing it never copies data that has already been read.
+// A contiguous copy is only created if a pinned view of the whole file is requested (GetRawData).
+// With read-ahead enabled, a background thread reads the stream while loaders parse what is already there,
+// which overlaps I/O and parsing for slow sources like pipes. The stream is then only accessed from that thread.
+// Derived classes that enable read-ahead must call StopReadAhead() in their destructor.
 class FileDataContainerUnseekable : public IFileDataContainer {
 
 private:
 
-	mutable std::vector<mpt::byte> cache;
+	mutable std::vector<std::unique_ptr<mpt::byte[]>> segments;
+	mutable std::vector<mpt::byte> contiguous;
 	mutable std::size_t cachesize;
 	mutable bool streamFullyCached;
 
+#if defined(MPT_ENABLE_THREAD)
+	mutable std::mutex mutex;	// Protects all members above while the read-ahead thread is running
+	mutable std::condition_variable dataAvailable;
+	std::thread readAheadThread;
+	bool stopReadAhead;
+#endif // MPT_ENABLE_THREAD
+
 protected:
 
 	FileDataContainerUnseekable();
 
+	// Start reading the whole stream on a background thread.
+	// Must be called at the end of the derived class constructor, without thread support it does nothing.
+	void StartReadAhead();
+	void StopReadAhead();
+
 private:
 
 	static const std::size_t QUANTUM_SIZE = mpt::IO::BUFFERSIZE_SMALL;
-	static const std::size_t BUFFER_SIZE = mpt::IO::BUFFERSIZE_NORMAL;
+	static const std::size_t SEGMENT_SIZE = mpt::IO::BUFFERSIZE_NORMAL;
 
-	void EnsureCacheBuffer(std::size_t requiredbuffersize) const;
+	bool IsReadingAhead() const;
+#if defined(MPT_ENABLE_THREAD)
+	void ReadAheadThread();
+#endif // MPT_ENABLE_THREAD
+	void AppendFromStream(std::size_t count) const;
 	void CacheStream() const;
 	void CacheStreamUpTo(off_t pos, off_t length) const;
 
@@ -913,7 +943,8 @@ private:
 
 public:
 
-	FileDataContainerStdStream(std::istream *s);
+	FileDataContainerStdStream(std::istream *s, bool readAhead = false);
+	~FileDataContainerStdStream();
 
 private:
 
@@ -957,7 +988,8 @@ private:
 	CallbackStream stream;
 	mutable bool eof_reached;
 public:
-	FileDataContainerCallbackStream(CallbackStream s);
+	FileDataContainerCallbackStream(CallbackStream s, bool readAhead = false);
+	~FileDataContainerCallbackStream();
 private:
 	bool InternalEof() const override;
 	off_t InternalRead(mpt::byte *dst, off_t count) const override;
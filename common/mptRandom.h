@@ -280,6 +280,24 @@ public:
 		state = s;
 		return result;
 	}
+public:
+	// Raw state access and parameters for code that computes several consecutive results at once.
+	static MPT_CONSTEXPR11_FUN state_type multiplier()
+	{
+		return a;
+	}
+	static MPT_CONSTEXPR11_FUN state_type increment()
+	{
+		return c;
+	}
+	inline state_type get_state() const
+	{
+		return state;
+	}
+	inline void set_state(state_type s)
+	{
+		state = s;
+	}
 };
 
 #if MPT_COMPILER_MSVC
@@ -0,0 +1,206 @@
+/*
+ * mptThreadPool.cpp
+ * -----------------
+ * Purpose: Simple pool of worker threads for splitting work into independent items.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "mptThreadPool.h"
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace mpt
+{
+
+
+#if defined(MPT_ENABLE_THREAD)
+
+
+std::size_t thread_pool::hardware_concurrency()
+{
+	return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+
+thread_pool::thread_pool(std::size_t numThreads)
+	: m_nextItem(0)
+{
+	if(numThreads == 0)
+	{
+		numThreads = hardware_concurrency();
+	}
+	m_threads.reserve(numThreads - 1);
+	for(std::size_t i = 1; i < numThreads; i++)
+	{
+		m_threads.emplace_back(&thread_pool::WorkerThread, this);
+	}
+}
+
+
+thread_pool::~thread_pool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	m_wakeCondition.notify_all();
+	for(auto &thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+
+std::size_t thread_pool::size() const
+{
+	return m_threads.size() + 1;
+}
+
+
+bool thread_pool::IsWorkerThread() const
+{
+	const std::thread::id self = std::this_thread::get_id();
+	for(const auto &thread : m_threads)
+	{
+		if(thread.get_id() == self)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+void thread_pool::ProcessItems(const std::function<void(std::size_t)> &func, std::size_t count)
+{
+	std::size_t item;
+	while((item = m_nextItem.fetch_add(1)) < count)
+	{
+		try
+		{
+			func(item);
+		} catch(...)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if(!m_exception)
+			{
+				m_exception = std::current_exception();
+			}
+		}
+	}
+}
+
+
+void thread_pool::WorkerThread()
+{
+	uint64 generation = 0;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(true)
+	{
+		m_wakeCondition.wait(lock, [&] { return m_shutdown || m_generation != generation; });
+		if(m_shutdown)
+		{
+			return;
+		}
+		generation = m_generation;
+		const std::function<void(std::size_t)> &func = *m_func;
+		const std::size_t count = m_count;
+		lock.unlock();
+		ProcessItems(func, count);
+		lock.lock();
+		if(--m_busyWorkers == 0)
+		{
+			m_doneCondition.notify_one();
+		}
+	}
+}
+
+
+void thread_pool::parallel_for(std::size_t count, const std::function<void(std::size_t)> &func)
+{
+	if(m_threads.empty() || count <= 1 || IsWorkerThread())
+	{
+		for(std::size_t i = 0; i < count; i++)
+		{
+			func(i);
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> submitLock(m_submitMutex);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_func = &func;
+		m_count = count;
+		m_nextItem = 0;
+		m_exception = nullptr;
+		m_busyWorkers = m_threads.size();
+		m_generation++;
+	}
+	m_wakeCondition.notify_all();
+
+	ProcessItems(func, count);
+
+	std::exception_ptr exception;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_doneCondition.wait(lock, [&] { return m_busyWorkers == 0; });
+		m_func = nullptr;
+		std::swap(exception, m_exception);
+	}
+	if(exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+
+#else // !MPT_ENABLE_THREAD
+
+
+std::size_t thread_pool::hardware_concurrency()
+{
+	return 1;
+}
+
+
+thread_pool::thread_pool(std::size_t /* numThreads */ )
+{
+	return;
+}
+
+
+thread_pool::~thread_pool()
+{
+	return;
+}
+
+
+std::size_t thread_pool::size() const
+{
+	return 1;
+}
+
+
+void thread_pool::parallel_for(std::size_t count, const std::function<void(std::size_t)> &func)
+{
+	for(std::size_t i = 0; i < count; i++)
+	{
+		func(i);
+	}
+}
+
+
+#endif // MPT_ENABLE_THREAD
+
+
+} // namespace mpt
+
+
+OPENMPT_NAMESPACE_END
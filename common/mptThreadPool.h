@@ -0,0 +1,80 @@
+/*
+ * mptThreadPool.h
+ * ---------------
+ * Purpose: Simple pool of worker threads for splitting work into independent items.
+ * Notes  : The calling thread always participates in the work, so a pool of size 1 has no worker threads at all.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include <functional>
+
+#if defined(MPT_ENABLE_THREAD)
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif // MPT_ENABLE_THREAD
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace mpt
+{
+
+
+class thread_pool
+{
+public:
+
+	// Number of threads (including the calling thread) that can actually run in parallel on this system.
+	static std::size_t hardware_concurrency();
+
+	// Creates a pool that processes work items on numThreads threads, including the calling thread.
+	// numThreads = 0 uses hardware_concurrency(). Without thread support, the pool always has size 1.
+	explicit thread_pool(std::size_t numThreads);
+	~thread_pool();
+
+	thread_pool(const thread_pool &) = delete;
+	thread_pool & operator = (const thread_pool &) = delete;
+
+	// Number of threads that process work items, including the calling thread.
+	std::size_t size() const;
+
+	// Calls func(i) for all i in [0, count) and returns once all calls have finished.
+	// The order in which items are processed is unspecified, so func must not depend on it.
+	// If any call throws, the first caught exception is rethrown after all items have been processed.
+	// Calls from inside a work item of the same pool are processed serially on the calling thread.
+	void parallel_for(std::size_t count, const std::function<void(std::size_t)> &func);
+
+#if defined(MPT_ENABLE_THREAD)
+private:
+	void WorkerThread();
+	void ProcessItems(const std::function<void(std::size_t)> &func, std::size_t count);
+	bool IsWorkerThread() const;
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_submitMutex;	// Serializes concurrent parallel_for calls
+	std::mutex m_mutex;			// Protects all members below
+	std::condition_variable m_wakeCondition;
+	std::condition_variable m_doneCondition;
+	const std::function<void(std::size_t)> *m_func = nullptr;
+	std::size_t m_count = 0;
+	std::atomic<std::size_t> m_nextItem;
+	std::size_t m_busyWorkers = 0;
+	uint64 m_generation = 0;
+	std::exception_ptr m_exception;
+	bool m_shutdown = false;
+#endif // MPT_ENABLE_THREAD
+};
+
+
+} // namespace mpt
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,608 @@
+/*
+ * benchmark.cpp
+ * -------------
+ * Purpose: Timing of libopenmpt module loading, seeking and rendering
+ * Notes  : Only uses the public libopenmpt API, so the same source can be built against older libopenmpt versions for before/after comparisons.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+/*
+ * Usage: libopenmpt_benchmark [--runs N] [--ctl KEY=VALUE] [--chunk-frames N] SCENARIO|SOMEMODULE ...
+ * Scenarios are modules that are generated in memory:
+ *   orders  IT module with 4000 orders (row visitor setup in GetLength)
+ *   voices  IT module with 64 continuously playing channels (mixer)
+ *   it215   IT module with 4M samples of IT 2.15 compressed sample data (sample decompression)
+ *   mo3     MO3 module with 16 MiB of compressed music data (MO3 decompression)
+ *   plugins IT module with 32 channels routed through 8 DMO plugins (per-chunk plugin overhead)
+ * --ctl sets an initial ctl for all following modules (e.g. --ctl render.eq.enabled=1). It can be given several times.
+ * --chunk-frames N is the same as --ctl render.chunk_frames=N, the maximum number of frames that are mixed at once.
+ * Each phase is run N times (default 5), and the best and median times are printed.
+ * Returns 0 on success, 1 if a module could not be loaded, 2 on error.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <libopenmpt/libopenmpt.hpp>
+
+namespace {
+
+typedef std::vector<std::uint8_t> bytes;
+
+void put8( bytes & data, std::uint8_t value ) {
+	data.push_back( value );
+}
+
+void put16( bytes & data, std::uint16_t value ) {
+	put8( data, static_cast<std::uint8_t>( value ) );
+	put8( data, static_cast<std::uint8_t>( value >> 8 ) );
+}
+
+void put32( bytes & data, std::uint32_t value ) {
+	put16( data, static_cast<std::uint16_t>( value ) );
+	put16( data, static_cast<std::uint16_t>( value >> 16 ) );
+}
+
+void patch32( bytes & data, std::size_t offset, std::uint32_t value ) {
+	for ( int i = 0; i < 4; ++i ) {
+		data[offset + i] = static_cast<std::uint8_t>( value >> ( i * 8 ) );
+	}
+}
+
+// Minimal IT writer for sample mode modules without instruments.
+class it_builder {
+public:
+	struct sample {
+		std::uint8_t flags; // ITSample::ITSampleFlags
+		std::uint8_t cvt;
+		std::uint32_t length;
+		std::uint32_t loop_start;
+		std::uint32_t loop_end;
+		bytes data; // Raw or compressed sample data as it is stored in the file
+	};
+	struct pattern {
+		std::uint16_t rows;
+		bytes packed; // IT pattern packing, one 0 byte per row end
+	};
+	int channels;
+	std::vector<std::uint8_t> orders;
+	std::vector<sample> samples;
+	std::vector<pattern> patterns;
+	bytes extensions; // Chunks between the pointer tables and the sample headers, e.g. plugin data
+
+	explicit it_builder( int channels_ ) : channels( channels_ ) { }
+
+	bytes build() const {
+		bytes file;
+		file.insert( file.end(), { 'I', 'M', 'P', 'M' } );
+		file.resize( 32, 0 ); // song name and highlights
+		put16( file, static_cast<std::uint16_t>( orders.size() ) );
+		put16( file, 0 );
+		put16( file, static_cast<std::uint16_t>( samples.size() ) );
+		put16( file, static_cast<std::uint16_t>( patterns.size() ) );
+		put16( file, 0x0214 ); // cwtv
+		put16( file, 0x0214 ); // cmwt
+		put16( file, 0x09 ); // stereo, linear slides
+		put16( file, 0 );
+		put8( file, 128 ); // global volume
+		put8( file, 48 ); // mix volume
+		put8( file, 6 ); // speed
+		put8( file, 125 ); // tempo
+		put8( file, 128 ); // separation
+		put8( file, 0 );
+		put16( file, 0 );
+		put32( file, 0 );
+		put32( file, 0 );
+		for ( int chn = 0; chn < 64; ++chn ) {
+			put8( file, chn < channels ? ( chn % 2 ? 48 : 16 ) : 0xA0 );
+		}
+		for ( int chn = 0; chn < 64; ++chn ) {
+			put8( file, 64 );
+		}
+		file.insert( file.end(), orders.begin(), orders.end() );
+		const std::size_t sample_offsets = file.size();
+		file.resize( file.size() + 4 * samples.size() );
+		const std::size_t pattern_offsets = file.size();
+		file.resize( file.size() + 4 * patterns.size() );
+		file.insert( file.end(), extensions.begin(), extensions.end() );
+		for ( std::size_t i = 0; i < samples.size(); ++i ) {
+			const sample & smp = samples[i];
+			patch32( file, sample_offsets + 4 * i, static_cast<std::uint32_t>( file.size() ) );
+			const std::size_t header = file.size();
+			file.insert( file.end(), { 'I', 'M', 'P', 'S' } );
+			file.resize( file.size() + 13, 0 );
+			put8( file, 64 ); // global volume
+			put8( file, smp.flags );
+			put8( file, 64 ); // volume
+			file.resize( file.size() + 26, 0 );
+			put8( file, smp.cvt );
+			put8( file, 32 ); // panning
+			put32( file, smp.length );
+			put32( file, smp.loop_start );
+			put32( file, smp.loop_end );
+			put32( file, 8363 );
+			put32( file, 0 );
+			put32( file, 0 );
+			put32( file, 0 ); // sample pointer, patched below
+			put32( file, 0 ); // auto-vibrato
+			patch32( file, header + 72, static_cast<std::uint32_t>( file.size() ) );
+			file.insert( file.end(), smp.data.begin(), smp.data.end() );
+		}
+		for ( std::size_t i = 0; i < patterns.size(); ++i ) {
+			const pattern & pat = patterns[i];
+			patch32( file, pattern_offsets + 4 * i, static_cast<std::uint32_t>( file.size() ) );
+			put16( file, static_cast<std::uint16_t>( pat.packed.size() ) );
+			put16( file, pat.rows );
+			put32( file, 0 );
+			file.insert( file.end(), pat.packed.begin(), pat.packed.end() );
+		}
+		return file;
+	}
+};
+
+it_builder::sample make_loop_sample( bool sixteen_bit ) {
+	// One period of a sawtooth wave, looped
+	const std::uint32_t length = 256;
+	it_builder::sample smp = { static_cast<std::uint8_t>( 0x01 | 0x10 | ( sixteen_bit ? 0x02 : 0x00 ) ), 0x01, length, 0, length, bytes() };
+	for ( std::uint32_t i = 0; i < length; ++i ) {
+		const int value = static_cast<int>( i ) - 128;
+		if ( sixteen_bit ) {
+			put16( smp.data, static_cast<std::uint16_t>( value * 256 ) );
+		} else {
+			put8( smp.data, static_cast<std::uint8_t>( value ) );
+		}
+	}
+	return smp;
+}
+
+bytes generate_orders() {
+	// Many orders, so that setting up the visited rows of all orders is a noticeable part of every seek
+	it_builder it( 4 );
+	it.samples.push_back( make_loop_sample( false ) );
+	it_builder::pattern pat = { 64, bytes() };
+	for ( int row = 0; row < 64; ++row ) {
+		if ( row % 16 == 0 ) {
+			put8( pat.packed, 0x81 ); // channel 1, mask follows
+			put8( pat.packed, 0x03 ); // note and instrument
+			put8( pat.packed, static_cast<std::uint8_t>( 48 + row / 16 ) );
+			put8( pat.packed, 1 );
+		}
+		put8( pat.packed, 0 );
+	}
+	it.patterns.push_back( pat );
+	it.orders.assign( 4000, 0 );
+	it.orders.push_back( 0xFF );
+	return it.build();
+}
+
+bytes generate_voices() {
+	// All channels play a looped 8-bit or 16-bit sample all the time, with a new note on every channel every 8 rows
+	const int channels = 64;
+	it_builder it( channels );
+	it.samples.push_back( make_loop_sample( false ) );
+	it.samples.push_back( make_loop_sample( true ) );
+	it_builder::pattern pat = { 64, bytes() };
+	for ( int row = 0; row < 64; ++row ) {
+		for ( int chn = 0; chn < channels; ++chn ) {
+			if ( ( row + chn ) % 8 == 0 ) {
+				put8( pat.packed, static_cast<std::uint8_t>( 0x80 | ( chn + 1 ) ) );
+				put8( pat.packed, 0x03 );
+				put8( pat.packed, static_cast<std::uint8_t>( 36 + ( chn * 7 + row ) % 48 ) );
+				put8( pat.packed, static_cast<std::uint8_t>( 1 + chn % 2 ) );
+			}
+		}
+		put8( pat.packed, 0 );
+	}
+	it.patterns.push_back( pat );
+	it.orders.push_back( 0 );
+	it.orders.push_back( 0xFF );
+	return it.build();
+}
+
+// Appends IT 2.15 compressed sample data. Every value is written with the smallest bit width that can hold it.
+void compress_it215( bytes & data, const std::vector<int> & samples, bool sixteen_bit ) {
+	const int bits = sixteen_bit ? 16 : 8;
+	const int def_width = bits + 1, fetch_a = sixteen_bit ? 4 : 3, lower_b = sixteen_bit ? -8 : -4;
+	const std::size_t block_length = sixteen_bit ? 0x4000 : 0x8000;
+	const auto wrap = [bits]( int value ) {
+		const int half = 1 << ( bits - 1 );
+		return ( ( value + half ) & ( ( 1 << bits ) - 1 ) ) - half;
+	};
+	const auto fits = [=]( int value, int width ) {
+		const int top = 1 << ( width - 1 );
+		if ( width <= 6 ) {
+			return value > -top && value < top;
+		}
+		return value >= -top - lower_b && value < top + lower_b;
+	};
+	for ( std::size_t start = 0; start < samples.size(); start += block_length ) {
+		bytes block;
+		std::uint32_t bit_buf = 0;
+		int bit_num = 0;
+		const auto write_bits = [&]( std::uint32_t value, int num_bits ) {
+			bit_buf |= value << bit_num;
+			bit_num += num_bits;
+			while ( bit_num >= 8 ) {
+				block.push_back( static_cast<std::uint8_t>( bit_buf ) );
+				bit_buf >>= 8;
+				bit_num -= 8;
+			}
+		};
+		int width = def_width, previous = 0, previous_delta = 0;
+		for ( std::size_t i = start; i < std::min( start + block_length, samples.size() ); ++i ) {
+			const int delta = wrap( samples[i] - previous );
+			const int value = wrap( delta - previous_delta );
+			previous = samples[i];
+			previous_delta = delta;
+			int new_width = 1;
+			while ( new_width < def_width && !fits( value, new_width ) ) {
+				new_width++;
+			}
+			if ( new_width != width ) {
+				const std::uint32_t code = new_width < width ? new_width - 1 : new_width - 2;
+				if ( width <= 6 ) {
+					write_bits( 1u << ( width - 1 ), width );
+					write_bits( code, fetch_a );
+				} else if ( width < def_width ) {
+					write_bits( ( 1u << ( width - 1 ) ) + lower_b + code, width );
+				} else {
+					write_bits( ( 1u << ( width - 1 ) ) + new_width - 1, width );
+				}
+				width = new_width;
+			}
+			write_bits( static_cast<std::uint32_t>( value ) & ( ( 1u << std::min( width, bits ) ) - 1 ), width );
+		}
+		write_bits( 0, 7 );
+		put16( data, static_cast<std::uint16_t>( block.size() ) );
+		data.insert( data.end(), block.begin(), block.end() );
+	}
+}
+
+bytes generate_it215() {
+	// Two tones and some noise, so that the bit width changes frequently
+	std::mt19937 rng( 1 );
+	it_builder it( 4 );
+	for ( int sixteen_bit = 0; sixteen_bit < 2; ++sixteen_bit ) {
+		const std::uint32_t length = 2 * 1024 * 1024;
+		const double amplitude = sixteen_bit ? 12000.0 : 45.0;
+		const int noise = sixteen_bit ? 64 : 4;
+		std::vector<int> samples( length );
+		for ( std::uint32_t i = 0; i < length; ++i ) {
+			samples[i] = static_cast<int>( amplitude * ( std::sin( i * 0.01 ) + 0.5 * std::sin( i * 0.0731 ) ) ) + static_cast<int>( rng() % ( 2 * noise + 1 ) ) - noise;
+		}
+		it_builder::sample smp = { static_cast<std::uint8_t>( 0x01 | 0x08 | ( sixteen_bit ? 0x02 : 0x00 ) ), 0x01 | 0x04, length, 0, 0, bytes() };
+		compress_it215( smp.data, samples, sixteen_bit != 0 );
+		it.samples.push_back( smp );
+	}
+	it_builder::pattern pat = { 64, bytes( 64, 0 ) };
+	it.patterns.push_back( pat );
+	it.orders.push_back( 0 );
+	it.orders.push_back( 0xFF );
+	return it.build();
+}
+
+// Writes an MO3 LZ stream: literals for the parts of the music data that have to be valid,
+// and a random mix of literals and short, long, overlapping and repeated matches for the bulk data.
+class mo3_stream_writer {
+private:
+	std::size_t ctrl_pos = 0;
+	int ctrl_bits_left = 0;
+	std::uint32_t previous_distance = 0;
+	void write_ctrl_bit( std::uint32_t bit ) {
+		if ( !ctrl_bits_left ) {
+			ctrl_pos = stream.size();
+			stream.push_back( 0 );
+			ctrl_bits_left = 8;
+		}
+		ctrl_bits_left--;
+		stream[ctrl_pos] |= static_cast<std::uint8_t>( bit << ctrl_bits_left );
+	}
+	void write_ctrl_value( std::uint32_t value ) {
+		int num_bits = 0;
+		while ( ( value >> ( num_bits + 1 ) ) != 0 ) {
+			num_bits++;
+		}
+		while ( num_bits-- > 0 ) {
+			write_ctrl_bit( ( value >> num_bits ) & 1 );
+			write_ctrl_bit( num_bits > 0 ? 1 : 0 );
+		}
+	}
+	void write_length( std::uint32_t length ) {
+		if ( length <= 3 ) {
+			write_ctrl_bit( length >> 1 );
+			write_ctrl_bit( length & 1 );
+		} else {
+			write_ctrl_bit( 0 );
+			write_ctrl_bit( 0 );
+			write_ctrl_value( length - 2 );
+		}
+	}
+public:
+	bytes stream;
+	bytes output;
+	void literal( std::uint8_t value ) {
+		if ( !output.empty() ) {
+			write_ctrl_bit( 0 );
+		}
+		stream.push_back( value );
+		output.push_back( value );
+	}
+	void literals( const bytes & values ) {
+		for ( auto value : values ) {
+			literal( value );
+		}
+	}
+	void random_data( std::mt19937 & rng, std::uint32_t size ) {
+		const std::size_t end = output.size() + size;
+		while ( output.size() < end ) {
+			const std::uint32_t remain = static_cast<std::uint32_t>( end - output.size() );
+			const std::uint32_t choice = rng() % 8;
+			if ( choice < 3 || remain < 4 ) {
+				literal( static_cast<std::uint8_t>( rng() ) );
+				continue;
+			}
+			std::uint32_t distance;
+			if ( choice == 3 && previous_distance ) {
+				distance = previous_distance;
+			} else if ( choice < 6 ) {
+				distance = 1 + rng() % std::min<std::uint32_t>( static_cast<std::uint32_t>( output.size() ), 16 );
+			} else {
+				distance = 1 + rng() % std::min<std::uint32_t>( static_cast<std::uint32_t>( output.size() ), 65536 );
+			}
+			const std::uint32_t length_adjust = ( distance == previous_distance ) ? 0 : ( 1 + ( distance > 1280 ? 1 : 0 ) + ( distance > 32000 ? 1 : 0 ) );
+			const std::uint32_t length = std::min<std::uint32_t>( length_adjust + 1 + rng() % ( ( choice & 1 ) ? 300 : 12 ), remain );
+			write_ctrl_bit( 1 );
+			if ( distance == previous_distance ) {
+				write_ctrl_value( 2 );
+			} else {
+				const std::uint32_t code = distance - 1;
+				write_ctrl_value( ( code >> 8 ) + 3 );
+				stream.push_back( static_cast<std::uint8_t>( code & 0xFF ) );
+				previous_distance = distance;
+			}
+			write_length( length - length_adjust );
+			for ( std::uint32_t i = 0; i < length; ++i ) {
+				output.push_back( output[output.size() - distance] );
+			}
+		}
+	}
+};
+
+bytes generate_mo3() {
+	// An IT-based MO3 without samples, whose music data is mostly one big unused track
+	const std::uint32_t track_size = 16 * 1024 * 1024;
+	std::mt19937 rng( 1 );
+	bytes music;
+	put8( music, 0 ); // song name
+	put8( music, 0 ); // song message
+	put8( music, 4 ); // channels
+	put16( music, 1 ); // orders
+	put16( music, 0 ); // restart position
+	put16( music, 1 ); // patterns
+	put16( music, 1 ); // tracks
+	put16( music, 0 ); // instruments
+	put16( music, 0 ); // samples
+	put8( music, 6 ); // speed
+	put8( music, 125 ); // tempo
+	put32( music, 0x100 | 0x20000 ); // isIT, unknown
+	put8( music, 128 ); // global volume
+	put8( music, 128 ); // pan separation
+	put8( music, 0 ); // sample volume
+	music.resize( music.size() + 64, 64 ); // channel volume
+	music.resize( music.size() + 64, 128 ); // channel panning
+	music.resize( music.size() + 16 + 256, 0 ); // macros
+	put8( music, 0 ); // order list
+	for ( int chn = 0; chn < 4; ++chn ) {
+		put16( music, 0xFFFF ); // no track
+	}
+	put16( music, 64 ); // pattern length
+	put32( music, track_size );
+	mo3_stream_writer writer;
+	writer.literals( music );
+	writer.random_data( rng, track_size );
+	bytes file = { 'M', 'O', '3', 5 };
+	put32( file, static_cast<std::uint32_t>( writer.output.size() ) );
+	put32( file, static_cast<std::uint32_t>( writer.stream.size() ) );
+	file.insert( file.end(), writer.stream.begin(), writer.stream.end() );
+	return file;
+}
+
+// Appends an OpenMPT plugin chunk for a built-in DMO plugin to IT extension data.
+// output is the 0-based slot of the plugin that receives the output, or -1 for the master mix.
+void put_dmo_plugin( bytes & data, int slot, std::uint32_t id, int output ) {
+	const char code[4] = { 'F', 'X', static_cast<char>( '0' + slot / 10 ), static_cast<char>( '0' + slot % 10 ) };
+	data.insert( data.end(), code, code + 4 );
+	put32( data, 128 + 8 );
+	put32( data, 0x44584D4F ); // 'DXMO'
+	put32( data, id );
+	put8( data, 0 ); // routing flags
+	put8( data, 0 ); // mix mode
+	put8( data, 10 ); // gain
+	put8( data, 0 );
+	put32( data, output >= 0 ? 0x80 + output : 0 );
+	data.resize( data.size() + 16 + 32 + 64, 0 ); // reserved, name, library name
+	put32( data, 0 ); // no plugin data, so the plugin uses its default parameters
+	put32( data, 0 ); // no extra data
+}
+
+bytes generate_plugins() {
+	// 32 channels spread over 8 cheap DMO plugins, so that the fixed cost of plugin processing in every mix chunk matters
+	const int channels = 32;
+	it_builder it( channels );
+	it.samples.push_back( make_loop_sample( false ) );
+	it_builder::pattern pat = { 64, bytes() };
+	for ( int row = 0; row < 64; ++row ) {
+		for ( int chn = 0; chn < channels; ++chn ) {
+			if ( ( row + chn ) % 4 == 0 ) {
+				put8( pat.packed, static_cast<std::uint8_t>( 0x80 | ( chn + 1 ) ) );
+				put8( pat.packed, 0x03 );
+				put8( pat.packed, static_cast<std::uint8_t>( 36 + ( chn * 5 + row ) % 48 ) );
+				put8( pat.packed, 1 );
+			}
+		}
+		put8( pat.packed, 0 );
+	}
+	it.patterns.push_back( pat );
+	it.orders.push_back( 0 );
+	it.orders.push_back( 0xFF );
+	const std::uint32_t plugins[] = {
+		0xEFE6629C, // Chorus -> Echo
+		0xEF3E932C, // Echo
+		0xEFCA3D92, // Flanger
+		0xEF114C90, // Distortion
+		0xDAFD8210, // Gargle -> ParamEq
+		0x120CED89, // ParamEq
+		0xEF011F79, // Compressor
+		0x120CED89, // ParamEq
+	};
+	for ( int slot = 0; slot < 8; ++slot ) {
+		put_dmo_plugin( it.extensions, slot, plugins[slot], ( slot == 0 || slot == 4 ) ? slot + 1 : -1 );
+	}
+	// Channel plugins are 1-based, 0 = no plugin
+	it.extensions.insert( it.extensions.end(), { 'C', 'H', 'F', 'X' } );
+	put32( it.extensions, channels * 4 );
+	for ( int chn = 0; chn < channels; ++chn ) {
+		put32( it.extensions, chn % 8 + 1 );
+	}
+	return it.build();
+}
+
+typedef std::chrono::steady_clock clock_type;
+
+double seconds_since( clock_type::time_point start ) {
+	return std::chrono::duration<double>( clock_type::now() - start ).count();
+}
+
+struct timings {
+	std::vector<double> values;
+	void print( const char * phase, const char * unit, double scale ) {
+		std::sort( values.begin(), values.end() );
+		std::cout << "  " << phase << ": best " << values.front() * scale << " " << unit << ", median " << values[values.size() / 2] * scale << " " << unit << std::endl;
+	}
+};
+
+void benchmark( const std::string & name, const bytes & data, int runs, const std::map< std::string, std::string > & ctls ) {
+	std::cout << name << " (" << data.size() << " bytes)" << std::endl;
+	std::ostringstream log;
+
+	// Loading includes the song length calculation of all subsongs
+	const int loads = 4;
+	timings load;
+	for ( int run = 0; run < runs; ++run ) {
+		const clock_type::time_point start = clock_type::now();
+		for ( int i = 0; i < loads; ++i ) {
+			openmpt::module mod( data, log, ctls );
+		}
+		load.values.push_back( seconds_since( start ) / loads );
+	}
+	load.print( "load", "ms", 1000.0 );
+
+	openmpt::module mod( data, log, ctls );
+	const double duration = mod.get_duration_seconds();
+
+	// Seek targets are spread over the first minute, so that the setup of each seek is not hidden behind scanning a long song
+	const int seeks = 500;
+	const double seek_range = std::min( duration, 60.0 );
+	timings seek;
+	for ( int run = 0; run < runs; ++run ) {
+		const clock_type::time_point start = clock_type::now();
+		for ( int i = 0; i < seeks; ++i ) {
+			mod.set_position_seconds( seek_range * ( ( i * 37 ) % seeks ) / seeks );
+		}
+		seek.values.push_back( seconds_since( start ) / seeks );
+	}
+	seek.print( "seek", "us", 1000000.0 );
+
+	// Rendering is reported as a multiple of real time
+	const std::int32_t samplerate = 48000;
+	const double render_seconds = std::min( duration, 30.0 );
+	std::vector<float> buffer( 1024 * 2 );
+	timings render;
+	for ( int run = 0; run < runs; ++run ) {
+		mod.set_position_seconds( 0.0 );
+		std::size_t frames = static_cast<std::size_t>( render_seconds * samplerate );
+		const clock_type::time_point start = clock_type::now();
+		while ( frames > 0 ) {
+			const std::size_t count = mod.read_interleaved_stereo( samplerate, std::min<std::size_t>( frames, 1024 ), buffer.data() );
+			if ( count == 0 ) {
+				break;
+			}
+			frames -= count;
+		}
+		const double elapsed = seconds_since( start );
+		render.values.push_back( elapsed > 0.0 ? elapsed / render_seconds : 0.0 );
+	}
+	// Print the speed, so invert the best and median times
+	std::sort( render.values.begin(), render.values.end() );
+	std::cout << "  render: best " << 1.0 / render.values.front() << "x, median " << 1.0 / render.values[render.values.size() / 2] << "x real time" << std::endl;
+}
+
+} // namespace
+
+int main( int argc, char * argv[] ) {
+	int runs = 5;
+	std::map< std::string, std::string > ctls;
+	int result = 0;
+	try {
+		for ( int i = 1; i < argc; ++i ) {
+			const std::string arg = argv[i];
+			if ( arg == "--runs" && i + 1 < argc ) {
+				runs = std::max( 1, std::atoi( argv[++i] ) );
+				continue;
+			}
+			if ( arg == "--chunk-frames" && i + 1 < argc ) {
+				ctls["render.chunk_frames"] = argv[++i];
+				continue;
+			}
+			if ( arg == "--ctl" && i + 1 < argc ) {
+				const std::string ctl = argv[++i];
+				const std::size_t equals = ctl.find( '=' );
+				if ( equals == std::string::npos ) {
+					throw std::invalid_argument( "--ctl expects KEY=VALUE" );
+				}
+				ctls[ctl.substr( 0, equals )] = ctl.substr( equals + 1 );
+				continue;
+			}
+			bytes data;
+			if ( arg == "orders" ) {
+				data = generate_orders();
+			} else if ( arg == "voices" ) {
+				data = generate_voices();
+			} else if ( arg == "it215" ) {
+				data = generate_it215();
+			} else if ( arg == "mo3" ) {
+				data = generate_mo3();
+			} else if ( arg == "plugins" ) {
+				data = generate_plugins();
+			} else {
+				std::ifstream file( arg, std::ios::binary );
+				data.assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+			}
+			try {
+				benchmark( arg, data, runs, ctls );
+			} catch ( const openmpt::exception & e ) {
+				std::cerr << arg << ": " << e.what() << std::endl;
+				result = 1;
+			}
+		}
+	} catch ( const std::exception & e ) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 2;
+	}
+	std::cout << "libopenmpt " << openmpt::string::get( "library_version" ) << std::endl;
+	return result;
+}
@@ -0,0 +1,5 @@
+#!/usr/bin/env bash
+cd "${0%/*}"
+cd ../..
+make bin/libopenmpt.so EXAMPLES=0 TEST=0 OPENMPT123=0 || exit 1
+${CXX:-c++} -std=c++11 -O2 -I. contrib/benchmark/benchmark.cpp -Lbin -lopenmpt -Wl,-rpath,'$ORIGIN' -o bin/libopenmpt_benchmark
@@ -0,0 +1,174 @@
+/*
+ * libopenmpt_example_c_info.c
+ * ---------------------------
+ * Purpose: libopenmpt C API module information example and benchmark
+ * Notes  : Compares openmpt_read_module_info() with loading the complete module.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+/*
+ * Usage: libopenmpt_example_c_info [--full] SOMEMODULE ...
+ * Prints basic information about all modules and the number of processed files per second.
+ * With --full, every module is loaded completely with openmpt_module_create2() instead.
+ * Returns 0 on success for all files.
+ * Returns 1 on failure for 1 or more files.
+ * Returns 2 on error.
+ */
+
+#include <memory.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libopenmpt/libopenmpt.h>
+#include <libopenmpt/libopenmpt_stream_callbacks_file.h>
+
+static void libopenmpt_example_logfunc( const char * message, void * userdata ) {
+	(void)userdata;
+
+	if ( message ) {
+		fprintf( stderr, "%s\n", message );
+	}
+}
+
+#if ( defined( _WIN32 ) || defined( WIN32 ) ) && ( defined( _UNICODE ) || defined( UNICODE ) )
+static int info_file( const wchar_t * filename, int full ) {
+#else
+static int info_file( const char * filename, int full ) {
+#endif
+
+	int result = 0;
+	int mod_err = OPENMPT_ERROR_OK;
+	FILE * file = NULL;
+	openmpt_module_info * info = NULL;
+	openmpt_module * mod = NULL;
+	const char * type = NULL;
+	const char * title = NULL;
+
+#if ( defined( _WIN32 ) || defined( WIN32 ) ) && ( defined( _UNICODE ) || defined( UNICODE ) )
+	file = _wfopen( filename, L"rb" );
+#else
+	file = fopen( filename, "rb" );
+#endif
+	if ( !file ) {
+		fprintf( stderr, "Error: %s\n", "fopen() failed." );
+		goto fail;
+	}
+
+	if ( full ) {
+		mod = openmpt_module_create2( openmpt_stream_get_file_callbacks(), file, &libopenmpt_example_logfunc, NULL, &openmpt_error_func_default, NULL, &mod_err, NULL, NULL );
+		if ( !mod ) {
+			result = 1;
+			goto cleanup;
+		}
+		type = openmpt_module_get_metadata( mod, "type" );
+		title = openmpt_module_get_metadata( mod, "title" );
+#if ( defined( _WIN32 ) || defined( WIN32 ) ) && ( defined( _UNICODE ) || defined( UNICODE ) )
+		fprintf( stdout, "%-4s %3d channels %3d samples  %s - %ls\n", type ? type : "", (int)openmpt_module_get_num_channels( mod ), (int)openmpt_module_get_num_samples( mod ), title ? title : "", filename );
+#else
+		fprintf( stdout, "%-4s %3d channels %3d samples  %s - %s\n", type ? type : "", (int)openmpt_module_get_num_channels( mod ), (int)openmpt_module_get_num_samples( mod ), title ? title : "", filename );
+#endif
+	} else {
+		info = openmpt_read_module_info( openmpt_stream_get_file_callbacks(), file, &libopenmpt_example_logfunc, NULL, &openmpt_error_func_default, NULL, &mod_err, NULL );
+		if ( !info ) {
+			result = 1;
+			goto cleanup;
+		}
+#if ( defined( _WIN32 ) || defined( WIN32 ) ) && ( defined( _UNICODE ) || defined( UNICODE ) )
+		fprintf( stdout, "%-4s %3d channels %3d samples  %s - %ls\n", info->type, (int)info->num_channels, (int)info->num_samples, info->title, filename );
+#else
+		fprintf( stdout, "%-4s %3d channels %3d samples  %s - %s\n", info->type, (int)info->num_channels, (int)info->num_samples, info->title, filename );
+#endif
+	}
+
+	goto cleanup;
+
+fail:
+
+	result = 2;
+
+cleanup:
+
+	if ( title ) {
+		openmpt_free_string( title );
+		title = NULL;
+	}
+	if ( type ) {
+		openmpt_free_string( type );
+		type = NULL;
+	}
+	if ( mod ) {
+		openmpt_module_destroy( mod );
+		mod = NULL;
+	}
+	if ( info ) {
+		openmpt_module_info_destroy( info );
+		info = NULL;
+	}
+	if ( file ) {
+		fclose( file );
+		file = 0;
+	}
+
+	return result;
+}
+
+#if ( defined( _WIN32 ) || defined( WIN32 ) ) && ( defined( _UNICODE ) || defined( UNICODE ) )
+int wmain( int argc, wchar_t * argv[] ) {
+#else
+int main( int argc, char * argv[] ) {
+#endif
+
+	int global_result = 0;
+	int full = 0;
+	int first = 1;
+	int num_files = 0;
+	clock_t start = 0;
+	double seconds = 0.0;
+
+	if ( argc > 1 ) {
+#if ( defined( _WIN32 ) || defined( WIN32 ) ) && ( defined( _UNICODE ) || defined( UNICODE ) )
+		if ( wcscmp( argv[1], L"--full" ) == 0 ) {
+#else
+		if ( strcmp( argv[1], "--full" ) == 0 ) {
+#endif
+			full = 1;
+			first = 2;
+		}
+	}
+
+	if ( argc <= first ) {
+		fprintf( stderr, "Error: %s\n", "Wrong invocation. Use 'libopenmpt_example_c_info [--full] SOMEMODULE ...'." );
+		goto fail;
+	}
+
+	start = clock();
+	for ( int i = first; i < argc; ++i ) {
+		int result = info_file( argv[i], full );
+		if ( result > global_result ) {
+			global_result = result;
+		}
+		num_files++;
+	}
+	seconds = (double)( clock() - start ) / CLOCKS_PER_SEC;
+
+	fprintf( stderr, "%d files in %.3f seconds of CPU time", num_files, seconds );
+	if ( seconds > 0.0 ) {
+		fprintf( stderr, " (%.1f files/second)", num_files / seconds );
+	}
+	fprintf( stderr, "\n" );
+
+	goto cleanup;
+
+fail:
+
+	global_result = 2;
+
+cleanup:
+
+	return global_result;
+
+}
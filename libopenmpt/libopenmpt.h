@@ -54,8 +54,11 @@
  *
  * \section libopenmpt_c_fileio File I/O
  *
- * libopenmpt can use 3 different strategies for file I/O.
+ * libopenmpt can use 4 different strategies for file I/O.
  *
+ * - openmpt_module_create_from_file() will open the file itself. On POSIX
+ * systems, the file is mapped into memory, which avoids copying the file data
+ * and only reads the parts of the file from disk that are actually needed.
  * - openmpt_module_create_from_memory2() will load the module from the provided
  * memory buffer, which will require loading all data upfront by the library
  * caller.
@@ -71,6 +74,7 @@
  *
  * | create function                                 | speed  | memory consumption |
  * | ----------------------------------------------: | :----: | :----------------: |
+ * | openmpt_module_create_from_file()               | <p style="background-color:green" >fast  </p> | <p style="background-color:green" >low   </p> |
  * | openmpt_module_create_from_memory2()            | <p style="background-color:green" >fast  </p> | <p style="background-color:yellow">medium</p> | 
  * | openmpt_module_create2() with seekable stream   | <p style="background-color:red"   >slow  </p> | <p style="background-color:green" >low   </p> |
  * | openmpt_module_create2() with unseekable stream | <p style="background-color:yellow">medium</p> | <p style="background-color:red"   >high  </p> |
@@ -651,6 +655,67 @@ LIBOPENMPT_API int openmpt_probe_file_header_without_filesize( uint64_t flags, c
  */
 LIBOPENMPT_API int openmpt_probe_file_header_from_stream( uint64_t flags, openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message );
 
+/*! \brief Basic information about a module, see openmpt_read_module_info()
+ *
+ * All strings are UTF-8 encoded and never NULL. The string fields correspond to the keys of openmpt_module_get_metadata().
+ * \since 0.4.0
+ */
+typedef struct openmpt_module_info {
+	/*! Module format extension (e.g. it) */
+	const char * type;
+	/*! Tracker name associated with the module format (e.g. Impulse Tracker) */
+	const char * type_long;
+	/*! Container format the module file is embedded in, if any (e.g. umx) */
+	const char * container;
+	/*! Full container name if the module is embedded in a container (e.g. Unreal Music) */
+	const char * container_long;
+	/*! Tracker that was (most likely) used to save the module file, if known */
+	const char * tracker;
+	/*! Author of the module */
+	const char * artist;
+	/*! Module title */
+	const char * title;
+	/*! Date the module was last saved, in ISO-8601 format */
+	const char * date;
+	/*! Song message. Unlike the "message" metadata key, it is empty if the module has no song message. */
+	const char * message;
+	/*! Number of channels, see openmpt_module_get_num_channels() */
+	int32_t num_channels;
+	/*! Number of instruments, see openmpt_module_get_num_instruments() */
+	int32_t num_instruments;
+	/*! Number of samples, see openmpt_module_get_num_samples() */
+	int32_t num_samples;
+	/*! Array of num_instruments instrument names, see openmpt_module_get_instrument_name() */
+	const char * const * instrument_names;
+	/*! Array of num_samples sample names, see openmpt_module_get_sample_name() */
+	const char * const * sample_names;
+} openmpt_module_info;
+
+/*! \brief Read basic information about a module without loading it completely
+ *
+ * Only the module header, names and the song message are read. Pattern data, sample data and plugins are skipped and the song length is not computed, which makes this a lot faster than constructing an openmpt_module, e.g. for indexing large module collections.
+ * \param stream_callbacks Input stream callback operations.
+ * \param stream Input stream to read the module from.
+ * \param logfunc Logging function where warning and errors are written. May be NULL.
+ * \param loguser Logging function user context. Used to pass any user-defined data associated with this module to the logging function.
+ * \param errfunc Error function to define error behaviour. May be NULL.
+ * \param erruser Error function user context. Used to pass any user-defined data associated with this module to the logging function.
+ * \param error Pointer to an integer where an error may get stored. May be NULL.
+ * \param error_message Pointer to a string pointer where an error message may get stored. May be NULL.
+ * \return Information about the module, which has to be freed with openmpt_module_info_destroy(), or NULL on failure.
+ * \sa \ref libopenmpt_c_fileio
+ * \sa openmpt_stream_callbacks
+ * \since 0.4.0
+ */
+LIBOPENMPT_API openmpt_module_info * openmpt_read_module_info( openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message );
+
+/*! \brief Free module information
+ *
+ * \param info Information returned by openmpt_read_module_info(). May be NULL.
+ * \since 0.4.0
+ */
+LIBOPENMPT_API void openmpt_module_info_destroy( openmpt_module_info * info );
+
 
 /*! \brief Opaque type representing a libopenmpt module
  */
@@ -727,6 +792,23 @@ LIBOPENMPT_API LIBOPENMPT_DEPRECATED openmpt_module * openmpt_module_create_from
  */
 LIBOPENMPT_API openmpt_module * openmpt_module_create_from_memory2( const void * filedata, size_t filesize, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message, const openmpt_module_initial_ctl * ctls );
 
+/*! \brief Construct an openmpt_module from a file
+ *
+ * \param filename Path of the file to load the module from, in the native encoding of the operating system.
+ * \param logfunc Logging function where warning and errors are written. The logging function may be called throughout the lifetime of openmpt_module. May be NULL.
+ * \param loguser User-defined data associated with this module. This value will be passed to the logging callback function (logfunc)
+ * \param errfunc Error function to define error behaviour. May be NULL.
+ * \param erruser Error function user context. Used to pass any user-defined data associated with this module to the logging function.
+ * \param error Pointer to an integer where an error may get stored. May be NULL.
+ * \param error_message Pointer to a string pointer where an error message may get stored. May be NULL.
+ * \param ctls A map of initial ctl values. See openmpt_module_get_ctls()
+ * \return A pointer to the constructed openmpt_module, or NULL on failure.
+ * \remarks Where supported, the file is mapped into memory instead of being read. The file is closed again after an openmpt_module has been constructed, unless "load.lazy_samples" or "load.pin_samples" is enabled. In that case the file stays mapped until the openmpt_module is destroyed, and it must not be modified in the meantime.
+ * \sa \ref libopenmpt_c_fileio
+ * \since 0.4.0
+ */
+LIBOPENMPT_API openmpt_module * openmpt_module_create_from_file( const char * filename, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message, const openmpt_module_initial_ctl * ctls );
+
 /*! \brief Unload a previously created openmpt_module from memory.
  *
  * \param mod The module to unload.
@@ -1395,7 +1477,14 @@ LIBOPENMPT_API const char * openmpt_module_highlight_pattern_row_channel( openmp
  *          - load.skip_patterns: Set to "1" to avoid loading patterns into memory
  *          - load.skip_plugins: Set to "1" to avoid loading plugins
  *          - load.skip_subsongs_init: Set to "1" to avoid pre-initializing sub-songs. Skipping results in faster module loading but slower seeking.
+ *          - load.threads: Number of threads used for loading. "1" (the default) does everything on the calling thread, "0" uses one thread per CPU core. Currently, sample data of IT, MPTM, XM and MO3 files is decoded in parallel, and the sub-songs of modules with multiple sequences are pre-initialized in parallel.
+ *          - load.lazy_samples: "0" (the default) decodes all sample data while loading. "1" only decodes the sample data on a background thread when a sample is played for the first time. Notes of that sample stay silent until its data has been decoded. "2" additionally decodes all other samples on the same thread after loading, so that they are usually ready before they are played. Lazy decoding keeps a copy of the module file in memory (or the memory mapping when loading from a file). Currently supported for IT, MPTM and XM files.
+ *          - load.share_samples: Set to "1" to share the decoded sample data with other modules that are loaded from the same file data with this option enabled, instead of keeping a separate copy in each module. Shared sample data is copied when it is modified. Ignored when "load.lazy_samples" is enabled.
+ *          - load.read_ahead: Set to "1" to read unseekable input streams on a background thread while the module is being parsed, which overlaps slow I/O (e.g. pipes or network streams) with loading. The stream read callback is then called from that thread. Has no effect on seekable streams and memory buffers.
+ *          - load.pin_samples: Set to "1" to let uncompressed sample data (plain PCM in native byte order, currently in IT and MPTM files) reference the module file data instead of keeping a second copy of it. When loading from a memory buffer, the buffer must stay valid and unmodified until the module is destroyed. Otherwise, libopenmpt keeps the file mapping or its own copy of the file data.
  *          - seek.sync_samples: Set to "1" to sync sample playback when using openmpt_module_set_position_seconds or openmpt_module_set_position_order_row.
+ *          - seek.checkpoint_interval: Interval in seconds at which the playback state is remembered while scanning the module, so that seeking can resume from the closest remembered state instead of the song start. "0" disables checkpoints. Default: "10". Checkpoints are not used if seek.sync_samples is enabled.
+ *          - seek.checkpoint_memory: Maximum amount of memory in bytes used for seek checkpoints. If more checkpoints are needed, their interval is increased. Default: "4194304".
  *          - subsong: The current subsong. Setting it has identical semantics as openmpt_module_select_subsong(), getting it returns the currently selected subsong.
  *          - play.at_end: Chooses the behaviour when the end of song is reached:
  *                         - "fadeout": Fades the module out for a short while. Subsequent reads after the fadeout will return 0 rendered frames.
@@ -1404,6 +1493,17 @@ LIBOPENMPT_API const char * openmpt_module_highlight_pattern_row_channel( openmp
  *          - play.tempo_factor: Set a floating point tempo factor. "1.0" is the default tempo.
  *          - play.pitch_factor: Set a floating point pitch factor. "1.0" is the default pitch.
  *          - render.resampler.emulate_amiga: Set to "1" to enable the Amiga resampler for Amiga modules. This emulates the sound characteristics of the Paula chip and overrides the selected interpolation filter. Non-Amiga module formats are not affected by this setting.
+ *          - render.chunk_frames: Set the maximum number of frames that are rendered in one internal mixing chunk. The default is 512, valid values are 1 to 65536. Bigger values reduce the per-chunk overhead when rendering offline, smaller values reduce latency of parameter changes. Modules with plugins are always mixed in chunks of at most 512 frames.
+ *          - render.mix_threads: Number of threads that mix voices in parallel. "1" (the default) mixes everything on the thread calling read, "0" uses one thread per CPU core, at most 32 threads are used. The output is identical to single-threaded mixing. Parallel mixing only pays off for modules with many simultaneously playing voices.
+ *          - render.plugin_threads: Number of threads that process independent plugin chains in parallel. "1" (the default) processes all plugins on the thread calling read, "0" uses one thread per CPU core, at most 32 threads are used. The output is identical to processing the plugins one after another. Parallel processing only pays off for modules with several plugins that are not routed into each other, e.g. separate effect chains for different instruments.
+ *          - render.float_master_mix: Set to "1" to process the master mix (plugins, global volume, stereo separation) in floating point and hand it to the float versions of openmpt_module_read without any intermediate fixed point conversion. Voices are always mixed in fixed point. Has no effect on the 16 bit versions of openmpt_module_read. Default: "0".
+ *          - render.eq.enabled: Set to "1" to enable the 6-band equalizer. Default: "0". The effect processes the fixed point mix, so render.float_master_mix has no effect while it is enabled.
+ *          - render.eq.gains: Comma-separated list of up to 6 band gains in dB, valid values are -12 to 12. Missing bands are flat. Default: "0,0,0,0,0,0".
+ *          - render.eq.frequencies: Comma-separated list of up to 6 band center frequencies in Hz, valid values are 0 to 20000. A frequency of 0 disables the band. Default: "125,300,600,1250,4000,8000".
+ *          - render.megabass.enabled: Set to "1" to enable bass expansion (which also removes DC offset). Default: "0". The effect processes the fixed point mix, so render.float_master_mix has no effect while it is enabled.
+ *          - render.megabass.depth: Bass expansion depth, valid values are 0 (quiet) to 100 (loud). Default: "40".
+ *          - render.megabass.range: Bass expansion range, valid values are 0 (highest cutoff) to 100 (lowest cutoff). Default: "60".
+ *          - render.silent_frames_skipped: Number of frames for which all mixing and effect processing was skipped because nothing was playing and no effect tail was left. Only meant for measuring, setting it to "0" resets the counter.
  *          - dither: Set the dither algorithm that is used for the 16 bit versions of openmpt_module_read. Supported values are:
  *                    - 0: No dithering.
  *                    - 1: Default mode. Chosen by OpenMPT code, might change.
@@ -1429,6 +1529,71 @@ LIBOPENMPT_API const char * openmpt_module_ctl_get( openmpt_module * mod, const
  */
 LIBOPENMPT_API int openmpt_module_ctl_set( openmpt_module * mod, const char * ctl, const char * value );
 
+/*! \brief Batch job begin function
+ *
+ * Called once for each job of openmpt_render_batch() after the module has been loaded and before rendering starts.
+ * \param user User context of the job.
+ * \param mod The loaded module. It can be used to select a subsong, set the repeat count or render parameters, or to query metadata. It must not be destroyed or used after rendering has finished.
+ * \sa openmpt_batch_job
+ * \since 0.4.0
+ */
+typedef void (*openmpt_batch_begin_func)( void * user, openmpt_module * mod );
+
+/*! \brief Batch job write function
+ *
+ * Called for each block of audio rendered by a job of openmpt_render_batch().
+ * \param user User context of the job.
+ * \param interleaved Interleaved float sample data with the number of channels that was passed to openmpt_render_batch().
+ * \param frames Number of sample frames in interleaved.
+ * \return 1 to continue rendering, 0 to finish the job early.
+ * \sa openmpt_batch_job
+ * \since 0.4.0
+ */
+typedef int (*openmpt_batch_write_func)( void * user, const float * interleaved, size_t frames );
+
+/*! \brief A single module rendering job for openmpt_render_batch()
+ *
+ * The input fields must be set by the caller. The result fields are filled in by openmpt_render_batch().
+ * \since 0.4.0
+ */
+typedef struct openmpt_batch_job {
+	/*! Stream callbacks of the module data. Every job needs its own stream. */
+	openmpt_stream_callbacks stream_callbacks;
+	/*! Stream handle of the module data */
+	void * stream;
+	/*! Initial ctls, see openmpt_module_create2(). Can be NULL. */
+	const openmpt_module_initial_ctl * ctls;
+	/*! Called before rendering starts. Can be NULL. */
+	openmpt_batch_begin_func begin_func;
+	/*! Receives the rendered audio. Must not be NULL. */
+	openmpt_batch_write_func write_func;
+	/*! User context that is passed to begin_func and write_func */
+	void * user;
+	/*! Result: OPENMPT_ERROR_OK if the module was loaded and rendered without errors, otherwise the error code */
+	int error;
+	/*! Result: Number of sample frames that were passed to write_func */
+	int64_t frames;
+	/*! Result: Wall-clock time in seconds that was spent loading the module */
+	double load_seconds;
+	/*! Result: Wall-clock time in seconds that was spent rendering the module, including the time spent in write_func */
+	double render_seconds;
+} openmpt_batch_job;
+
+/*! \brief Render a list of modules concurrently
+ *
+ * Loads and renders every job on a pool of worker threads. Jobs are handed out to the threads as they become idle, so one long module does not hold up the remaining jobs.
+ * The callbacks of a job are called on the thread that renders the job. Different jobs are rendered concurrently, so callbacks that share state between jobs must be thread-safe.
+ * \param jobs The modules to render. The result fields of each job are filled in when the function returns.
+ * \param count Number of jobs.
+ * \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+ * \param channels Number of interleaved output channels: 1, 2 or 4.
+ * \param num_threads Number of threads to use, including the calling thread. 0 uses one thread per CPU core.
+ * \return 1 if all jobs succeeded, 0 if any job failed or the parameters are invalid.
+ * \remarks Every job renders until the end of the song (or the selected subsong) is reached, or until its write function returns 0. Set the repeat count in the begin function if the song should be repeated, but do not set it to -1 unless the write function stops the job on its own.
+ * \since 0.4.0
+ */
+LIBOPENMPT_API int openmpt_render_batch( openmpt_batch_job * jobs, size_t count, int32_t samplerate, int32_t channels, int32_t num_threads );
+
 /* remember to add new functions to both C and C++ interfaces and to increase OPENMPT_API_VERSION_MINOR */
 
 #ifdef __cplusplus
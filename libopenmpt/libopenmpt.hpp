@@ -45,8 +45,12 @@
  *
  * \section libopenmpt_cpp_fileio File I/O
  *
- * libopenmpt can use 3 different strategies for file I/O.
+ * libopenmpt can use 4 different strategies for file I/O.
  *
+ * - openmpt::module::module() with a file name as parameter will open the file
+ * itself. On POSIX systems, the file is mapped into memory, which avoids
+ * copying the file data and only reads the parts of the file from disk that
+ * are actually needed.
  * - openmpt::module::module() with any kind of memory buffer as parameter will
  * load the module from the provided memory buffer, which will require loading
  * all data upfront by the library
@@ -63,6 +67,7 @@
  *
  * | constructor       | speed  | memory consumption |
  * | ----------------: | :----: | :----------------: |
+ * | file name         | <p style="background-color:green" >fast  </p> | <p style="background-color:green" >low   </p> |
  * | memory buffer     | <p style="background-color:green" >fast  </p> | <p style="background-color:yellow">medium</p> | 
  * | seekable stream   | <p style="background-color:red"   >slow  </p> | <p style="background-color:green" >low   </p> |
  * | unseekable stream | <p style="background-color:yellow">medium</p> | <p style="background-color:red"   >high  </p> |
@@ -330,6 +335,54 @@ LIBOPENMPT_CXX_API int probe_file_header( std::uint64_t flags, const std::uint8_
 */
 LIBOPENMPT_CXX_API int probe_file_header( std::uint64_t flags, std::istream & stream );
 
+//! Basic information about a module, see openmpt::read_module_info()
+/*!
+  All strings are UTF-8 encoded. The string fields correspond to the keys of openmpt::module::get_metadata().
+  \since 0.4.0
+*/
+struct LIBOPENMPT_CXX_API module_info {
+	//! Module format extension (e.g. it)
+	std::string type;
+	//! Tracker name associated with the module format (e.g. Impulse Tracker)
+	std::string type_long;
+	//! Container format the module file is embedded in, if any (e.g. umx)
+	std::string container;
+	//! Full container name if the module is embedded in a container (e.g. Unreal Music)
+	std::string container_long;
+	//! Tracker that was (most likely) used to save the module file, if known
+	std::string tracker;
+	//! Author of the module
+	std::string artist;
+	//! Module title
+	std::string title;
+	//! Date the module was last saved, in ISO-8601 format
+	std::string date;
+	//! Song message. Unlike the "message" metadata key, it is empty if the module has no song message.
+	std::string message;
+	//! Number of channels, see openmpt::module::get_num_channels()
+	std::int32_t num_channels;
+	//! Number of instruments, see openmpt::module::get_num_instruments()
+	std::int32_t num_instruments;
+	//! Number of samples, see openmpt::module::get_num_samples()
+	std::int32_t num_samples;
+	//! Instrument names, see openmpt::module::get_instrument_names()
+	std::vector<std::string> instrument_names;
+	//! Sample names, see openmpt::module::get_sample_names()
+	std::vector<std::string> sample_names;
+	module_info();
+}; // struct module_info
+
+//! Read basic information about a module without loading it completely
+/*!
+  Only the module header, names and the song message are read. Pattern data, sample data and plugins are skipped and the song length is not computed, which makes this a lot faster than constructing an openmpt::module, e.g. for indexing large module collections.
+  \param stream Input stream from which the module is read.
+  \param log Log where any warnings or errors are printed to.
+  \return Information about the module.
+  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+  \since 0.4.0
+*/
+LIBOPENMPT_CXX_API module_info read_module_info( std::istream & stream, std::ostream & log = std::clog );
+
 class module_impl;
 
 class module_ext;
@@ -485,6 +538,16 @@ public:
 	  \sa \ref libopenmpt_cpp_fileio
 	*/
 	module( const void * data, std::size_t size, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
+	/*!
+	  \param filename Path of the file to load the module from, in the native encoding of the operating system.
+	  \param log Log where any warnings or errors are printed to. The lifetime of the reference has to be as long as the lifetime of the module instance.
+	  \param ctls A map of initial ctl values, see openmpt::module::get_ctls.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+	  \remarks Where supported, the file is mapped into memory instead of being read. The file is closed again after an openmpt::module has been constructed, unless "load.lazy_samples" or "load.pin_samples" is enabled. In that case the file stays mapped until the openmpt::module is destroyed, and it must not be modified in the meantime.
+	  \sa \ref libopenmpt_cpp_fileio
+	  \since 0.4.0
+	*/
+	module( const std::string & filename, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
 	virtual ~module();
 public:
 
@@ -964,7 +1027,14 @@ public:
 	           - load.skip_patterns: Set to "1" to avoid loading patterns into memory
 	           - load.skip_plugins: Set to "1" to avoid loading plugins
 	           - load.skip_subsongs_init: Set to "1" to avoid pre-initializing sub-songs. Skipping results in faster module loading but slower seeking.
+	           - load.threads: Number of threads used for loading. "1" (the default) does everything on the calling thread, "0" uses one thread per CPU core. Currently, sample data of IT, MPTM, XM and MO3 files is decoded in parallel, and the sub-songs of modules with multiple sequences are pre-initialized in parallel.
+	           - load.lazy_samples: "0" (the default) decodes all sample data while loading. "1" only decodes the sample data on a background thread when a sample is played for the first time. Notes of that sample stay silent until its data has been decoded. "2" additionally decodes all other samples on the same thread after loading, so that they are usually ready before they are played. Lazy decoding keeps a copy of the module file in memory (or the memory mapping when loading from a file). Currently supported for IT, MPTM and XM files.
+	           - load.share_samples: Set to "1" to share the decoded sample data with other modules that are loaded from the same file data with this option enabled, instead of keeping a separate copy in each module. Shared sample data is copied when it is modified. Ignored when "load.lazy_samples" is enabled.
+	           - load.read_ahead: Set to "1" to read unseekable input streams on a background thread while the module is being parsed, which overlaps slow I/O (e.g. pipes or network streams) with loading. The stream read callback is then called from that thread. Has no effect on seekable streams and memory buffers.
+	           - load.pin_samples: Set to "1" to let uncompressed sample data (plain PCM in native byte order, currently in IT and MPTM files) reference the module file data instead of keeping a second copy of it. When loading from a memory buffer, the buffer must stay valid and unmodified until the module is destroyed. Otherwise, libopenmpt keeps the file mapping or its own copy of the file data.
 	           - seek.sync_samples: Set to "1" to sync sample playback when using openmpt::module::set_position_seconds or openmpt::module::set_position_order_row.
+	           - seek.checkpoint_interval: Interval in seconds at which the playback state is remembered while scanning the module, so that seeking can resume from the closest remembered state instead of the song start. "0" disables checkpoints. Default: "10". Checkpoints are not used if seek.sync_samples is enabled.
+	           - seek.checkpoint_memory: Maximum amount of memory in bytes used for seek checkpoints. If more checkpoints are needed, their interval is increased. Default: "4194304".
 	           - subsong: The current subsong. Setting it has identical semantics as openmpt::module::select_subsong(), getting it returns the currently selected subsong.
 	           - play.at_end: Chooses the behaviour when the end of song is reached:
 	                          - "fadeout": Fades the module out for a short while. Subsequent reads after the fadeout will return 0 rendered frames.
@@ -973,6 +1043,17 @@ public:
 	           - play.tempo_factor: Set a floating point tempo factor. "1.0" is the default tempo.
 	           - play.pitch_factor: Set a floating point pitch factor. "1.0" is the default pitch.
 	           - render.resampler.emulate_amiga: Set to "1" to enable the Amiga resampler for Amiga modules. This emulates the sound characteristics of the Paula chip and overrides the selected interpolation filter. Non-Amiga module formats are not affected by this setting. 
+	           - render.chunk_frames: Set the maximum number of frames that are rendered in one internal mixing chunk. The default is 512, valid values are 1 to 65536. Bigger values reduce the per-chunk overhead when rendering offline, smaller values reduce latency of parameter changes. Modules with plugins are always mixed in chunks of at most 512 frames. 
+	           - render.mix_threads: Number of threads that mix voices in parallel. "1" (the default) mixes everything on the thread calling read, "0" uses one thread per CPU core, at most 32 threads are used. The output is identical to single-threaded mixing. Parallel mixing only pays off for modules with many simultaneously playing voices.
+	           - render.plugin_threads: Number of threads that process independent plugin chains in parallel. "1" (the default) processes all plugins on the thread calling read, "0" uses one thread per CPU core, at most 32 threads are used. The output is identical to processing the plugins one after another. Parallel processing only pays off for modules with several plugins that are not routed into each other, e.g. separate effect chains for different instruments.
+	           - render.float_master_mix: Set to "1" to process the master mix (plugins, global volume, stereo separation) in floating point and hand it to the float versions of openmpt::module::read without any intermediate fixed point conversion. Voices are always mixed in fixed point. Has no effect on the 16 bit versions of openmpt::module::read. Default: "0".
+	           - render.eq.enabled: Set to "1" to enable the 6-band equalizer. Default: "0". The effect processes the fixed point mix, so render.float_master_mix has no effect while it is enabled.
+	           - render.eq.gains: Comma-separated list of up to 6 band gains in dB, valid values are -12 to 12. Missing bands are flat. Default: "0,0,0,0,0,0".
+	           - render.eq.frequencies: Comma-separated list of up to 6 band center frequencies in Hz, valid values are 0 to 20000. A frequency of 0 disables the band. Default: "125,300,600,1250,4000,8000".
+	           - render.megabass.enabled: Set to "1" to enable bass expansion (which also removes DC offset). Default: "0". The effect processes the fixed point mix, so render.float_master_mix has no effect while it is enabled.
+	           - render.megabass.depth: Bass expansion depth, valid values are 0 (quiet) to 100 (loud). Default: "40".
+	           - render.megabass.range: Bass expansion range, valid values are 0 (highest cutoff) to 100 (lowest cutoff). Default: "60".
+	           - render.silent_frames_skipped: Number of frames for which all mixing and effect processing was skipped because nothing was playing and no effect tail was left. Only meant for measuring, setting it to "0" resets the counter.
 	           - dither: Set the dither algorithm that is used for the 16 bit versions of openmpt::module::read. Supported values are:
 	                     - 0: No dithering.
 	                     - 1: Default mode. Chosen by OpenMPT code, might change.
@@ -1003,6 +1084,75 @@ public:
 
 }; // class module
 
+//! Receives the output of a job rendered by openmpt::render_batch()
+/*!
+  All member functions of a sink are called on the thread that renders the corresponding job. Different jobs are rendered concurrently, so sinks that are shared between jobs must be thread-safe.
+  \since 0.4.0
+*/
+class LIBOPENMPT_CXX_API batch_sink {
+public:
+	virtual ~batch_sink();
+	//! Called once after the module has been loaded and before rendering starts
+	/*!
+	  \param mod The loaded module. It can be used to select a subsong, set the repeat count or render parameters, or to query metadata. The module must not be accessed after rendering has finished.
+	  \remarks The default implementation does nothing.
+	*/
+	virtual void begin( module & mod );
+	//! Called for each block of rendered audio
+	/*!
+	  \param interleaved Interleaved float sample data with the number of channels that was passed to openmpt::render_batch().
+	  \param frames Number of sample frames in interleaved.
+	  \return true to continue rendering, false to finish the job early.
+	*/
+	virtual bool write( const float * interleaved, std::size_t frames ) = 0;
+}; // class batch_sink
+
+//! A single module rendering job for openmpt::render_batch()
+/*!
+  \since 0.4.0
+*/
+struct LIBOPENMPT_CXX_API batch_job {
+	//! Module data. Every job needs its own stream.
+	std::istream * stream;
+	//! Receives the rendered audio
+	batch_sink * sink;
+	//! Initial ctls, see openmpt::module::module()
+	std::map< std::string, std::string > ctls;
+	batch_job( std::istream & stream, batch_sink & sink, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
+}; // struct batch_job
+
+//! Result of a single openmpt::render_batch() job
+/*!
+  \since 0.4.0
+*/
+struct LIBOPENMPT_CXX_API batch_result {
+	//! true if the module was loaded and rendered without errors
+	bool success;
+	//! Error message if success is false
+	std::string error;
+	//! Number of sample frames that were passed to the sink
+	std::int64_t frames;
+	//! Wall-clock time in seconds that was spent loading the module
+	double load_seconds;
+	//! Wall-clock time in seconds that was spent rendering the module, including the time spent in the sink
+	double render_seconds;
+	batch_result();
+}; // struct batch_result
+
+//! Render a list of modules concurrently
+/*!
+  Loads and renders every job on a pool of worker threads. Jobs are handed out to the threads as they become idle, so one long module does not hold up the remaining jobs.
+  \param jobs The modules to render. The streams and sinks must stay valid until the function returns.
+  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+  \param channels Number of interleaved output channels: 1, 2 or 4.
+  \param num_threads Number of threads to use, including the calling thread. 0 uses one thread per CPU core.
+  \return One result per job, in the same order as jobs. Errors in individual jobs are reported there and do not affect other jobs.
+  \throws openmpt::exception Throws an exception derived from openmpt::exception if channels or num_threads is not valid.
+  \remarks Every job renders until the end of the song (or the selected subsong) is reached, or until its sink returns false. Set the repeat count in openmpt::batch_sink::begin() if the song should be repeated, but do not set it to -1 unless the sink stops the job on its own.
+  \since 0.4.0
+*/
+LIBOPENMPT_CXX_API std::vector<batch_result> render_batch( const std::vector<batch_job> & jobs, std::int32_t samplerate, std::int32_t channels, std::int32_t num_threads = 0 );
+
 } // namespace openmpt
 
 /*!
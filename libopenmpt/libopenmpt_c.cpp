@@ -16,9 +16,11 @@
 #include "libopenmpt_impl.hpp"
 #include "libopenmpt_ext_impl.hpp"
 
+#include <chrono>
 #include <limits>
 #include <new>
 #include <stdexcept>
+#include <vector>
 
 #include <cmath>
 #include <cstdio>
@@ -277,6 +279,58 @@ void check_pointer( T * p ) {
 
 } // namespace interface
 
+static std::size_t read_interleaved( openmpt::module_impl & impl, std::int32_t samplerate, std::int32_t channels, std::size_t count, float * interleaved ) {
+	switch ( channels ) {
+		case 1:
+			return impl.read( samplerate, count, interleaved );
+		case 2:
+			return impl.read_interleaved_stereo( samplerate, count, interleaved );
+		case 4:
+			return impl.read_interleaved_quad( samplerate, count, interleaved );
+	}
+	return 0;
+}
+
+static void render_batch_job( openmpt_batch_job & job, std::int32_t samplerate, std::int32_t channels ) {
+	static const std::size_t block_frames = 4096;
+	typedef std::chrono::steady_clock clock;
+	const clock::time_point load_start = clock::now();
+	// loader messages are available from openmpt_module_get_metadata( mod, "warnings" )
+	openmpt_module * mod = openmpt_module_create2( job.stream_callbacks, job.stream, openmpt_log_func_silent, NULL, NULL, NULL, &job.error, NULL, job.ctls );
+	if ( !mod ) {
+		return;
+	}
+	try {
+		const clock::time_point render_start = clock::now();
+		job.load_seconds = std::chrono::duration<double>( render_start - load_start ).count();
+		if ( job.begin_func ) {
+			job.begin_func( job.user, mod );
+		}
+		std::vector<float> buffer( block_frames * channels );
+		while ( true ) {
+			std::size_t count = read_interleaved( *mod->impl, samplerate, channels, block_frames, buffer.data() );
+			if ( count == 0 ) {
+				break;
+			}
+			job.frames += count;
+			if ( !job.write_func( job.user, buffer.data(), count ) ) {
+				break;
+			}
+		}
+		job.render_seconds = std::chrono::duration<double>( clock::now() - render_start ).count();
+	} catch ( ... ) {
+		job.error = error_from_exception( NULL );
+	}
+	openmpt_module_destroy( mod );
+}
+
+// openmpt_module_info only points into the strings owned by this struct
+struct module_info_holder : public openmpt_module_info {
+	module_info data;
+	std::vector<const char *> instrument_name_ptrs;
+	std::vector<const char *> sample_name_ptrs;
+};
+
 } // namespace openmpt
 
 extern "C" {
@@ -510,6 +564,46 @@ int openmpt_probe_file_header_from_stream( uint64_t flags, openmpt_stream_callba
 	return OPENMPT_PROBE_FILE_HEADER_RESULT_ERROR;
 }
 
+openmpt_module_info * openmpt_read_module_info( openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message ) {
+	try {
+		openmpt::callback_stream_wrapper istream = { stream, stream_callbacks.read, stream_callbacks.seek, stream_callbacks.tell };
+		std::unique_ptr<openmpt::module_info_holder> info = openmpt::helper::make_unique<openmpt::module_info_holder>();
+		info->data = openmpt::module_impl::read_module_info( istream, openmpt::helper::make_unique<openmpt::logfunc_logger>( logfunc ? logfunc : openmpt_log_func_default, loguser ) );
+		info->type = info->data.type.c_str();
+		info->type_long = info->data.type_long.c_str();
+		info->container = info->data.container.c_str();
+		info->container_long = info->data.container_long.c_str();
+		info->tracker = info->data.tracker.c_str();
+		info->artist = info->data.artist.c_str();
+		info->title = info->data.title.c_str();
+		info->date = info->data.date.c_str();
+		info->message = info->data.message.c_str();
+		info->num_channels = info->data.num_channels;
+		info->num_instruments = info->data.num_instruments;
+		info->num_samples = info->data.num_samples;
+		for ( const auto & name : info->data.instrument_names ) {
+			info->instrument_name_ptrs.push_back( name.c_str() );
+		}
+		for ( const auto & name : info->data.sample_names ) {
+			info->sample_name_ptrs.push_back( name.c_str() );
+		}
+		info->instrument_names = info->instrument_name_ptrs.data();
+		info->sample_names = info->sample_name_ptrs.data();
+		return info.release();
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, logfunc, loguser, errfunc, erruser, error, error_message );
+	}
+	return NULL;
+}
+
+void openmpt_module_info_destroy( openmpt_module_info * info ) {
+	try {
+		delete static_cast<openmpt::module_info_holder *>( info );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__ );
+	}
+}
+
 openmpt_module * openmpt_module_create( openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * user, const openmpt_module_initial_ctl * ctls ) {
 	return openmpt_module_create2( stream_callbacks, stream, logfunc, user, NULL, NULL, NULL, NULL, ctls );
 }
@@ -607,6 +701,52 @@ openmpt_module * openmpt_module_create_from_memory2( const void * filedata, size
 	return NULL;
 }
 
+openmpt_module * openmpt_module_create_from_file( const char * filename, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message, const openmpt_module_initial_ctl * ctls ) {
+	try {
+		openmpt::interface::check_pointer( filename );
+		openmpt_module * mod = (openmpt_module*)std::calloc( 1, sizeof( openmpt_module ) );
+		if ( !mod ) {
+			throw std::bad_alloc();
+		}
+		std::memset( mod, 0, sizeof( openmpt_module ) );
+		mod->logfunc = logfunc ? logfunc : openmpt_log_func_default;
+		mod->loguser = loguser;
+		mod->errfunc = errfunc ? errfunc : NULL;
+		mod->erruser = erruser;
+		mod->error = OPENMPT_ERROR_OK;
+		mod->error_message = NULL;
+		mod->impl = 0;
+		try {
+			std::map< std::string, std::string > ctls_map;
+			if ( ctls ) {
+				for ( const openmpt_module_initial_ctl * it = ctls; it->ctl; ++it ) {
+					if ( it->value ) {
+						ctls_map[ it->ctl ] = it->value;
+					} else {
+						ctls_map.erase( it->ctl );
+					}
+				}
+			}
+			openmpt::file_path_wrapper file = { filename };
+			mod->impl = new openmpt::module_impl( file, openmpt::helper::make_unique<openmpt::logfunc_logger>( mod->logfunc, mod->loguser ), ctls_map );
+			return mod;
+		} catch ( ... ) {
+			openmpt::report_exception( __FUNCTION__, mod, error, error_message );
+		}
+		delete mod->impl;
+		mod->impl = 0;
+		if ( mod->error_message ) {
+			openmpt_free_string( mod->error_message );
+			mod->error_message = NULL;
+		}
+		std::free( (void*)mod );
+		mod = NULL;
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, 0, error, error_message );
+	}
+	return NULL;
+}
+
 void openmpt_module_destroy( openmpt_module * mod ) {
 	try {
 		openmpt::interface::check_soundfile( mod );
@@ -1292,6 +1432,36 @@ int openmpt_module_ctl_set( openmpt_module * mod, const char * ctl, const char *
 	return 0;
 }
 
+int openmpt_render_batch( openmpt_batch_job * jobs, size_t count, int32_t samplerate, int32_t channels, int32_t num_threads ) {
+	try {
+		if ( count > 0 ) {
+			openmpt::interface::check_pointer( jobs );
+		}
+		if ( channels != 1 && channels != 2 && channels != 4 ) {
+			throw openmpt::exception("invalid number of channels");
+		}
+		for ( std::size_t i = 0; i < count; ++i ) {
+			openmpt::interface::check_pointer( jobs[i].write_func );
+			jobs[i].error = OPENMPT_ERROR_OK;
+			jobs[i].frames = 0;
+			jobs[i].load_seconds = 0.0;
+			jobs[i].render_seconds = 0.0;
+		}
+		openmpt::module_impl::run_batch( count, num_threads, [&]( std::size_t i ) {
+			openmpt::render_batch_job( jobs[i], samplerate, channels );
+		} );
+		for ( std::size_t i = 0; i < count; ++i ) {
+			if ( jobs[i].error != OPENMPT_ERROR_OK ) {
+				return 0;
+			}
+		}
+		return 1;
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__ );
+	}
+	return 0;
+}
+
 
 openmpt_module_ext * openmpt_module_ext_create( openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message, const openmpt_module_initial_ctl * ctls ) {
 	try {
@@ -17,6 +17,8 @@
 #include "libopenmpt_ext_impl.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <sstream>
 #include <stdexcept>
 
 #include <cstdlib>
@@ -147,6 +149,18 @@ int probe_file_header( std::uint64_t flags, std::istream & stream ) {
 	return openmpt::module_impl::probe_file_header( flags, stream );
 }
 
+module_info::module_info()
+	: num_channels(0)
+	, num_instruments(0)
+	, num_samples(0)
+{
+	return;
+}
+
+module_info read_module_info( std::istream & stream, std::ostream & log ) {
+	return openmpt::module_impl::read_module_info( stream, openmpt::helper::make_unique<std_ostream_log>( log ) );
+}
+
 #if defined(_MSC_VER)
 #pragma warning(push)
 #pragma warning(disable:4702) // unreachable code
@@ -205,6 +219,11 @@ module::module( const void * data, std::size_t size, std::ostream & log, const s
 	impl = new module_impl( data, size, openmpt::helper::make_unique<std_ostream_log>( log ), ctls );
 }
 
+module::module( const std::string & filename, std::ostream & log, const std::map< std::string, std::string > & ctls ) : impl(0) {
+	file_path_wrapper file = { filename.c_str() };
+	impl = new module_impl( file, openmpt::helper::make_unique<std_ostream_log>( log ), ctls );
+}
+
 module::~module() {
 	delete impl;
 	impl = 0;
@@ -392,6 +411,90 @@ void module::ctl_set( const std::string & ctl, const std::string & value ) {
 	impl->ctl_set( ctl, value );
 }
 
+batch_sink::~batch_sink() {
+	return;
+}
+
+void batch_sink::begin( module & /* mod */ ) {
+	return;
+}
+
+batch_job::batch_job( std::istream & stream_, batch_sink & sink_, const std::map< std::string, std::string > & ctls_ )
+	: stream(&stream_)
+	, sink(&sink_)
+	, ctls(ctls_)
+{
+	return;
+}
+
+batch_result::batch_result()
+	: success(false)
+	, frames(0)
+	, load_seconds(0.0)
+	, render_seconds(0.0)
+{
+	return;
+}
+
+static std::size_t read_interleaved( module & mod, std::int32_t samplerate, std::int32_t channels, std::size_t count, float * interleaved ) {
+	switch ( channels ) {
+		case 1:
+			return mod.read( samplerate, count, interleaved );
+		case 2:
+			return mod.read_interleaved_stereo( samplerate, count, interleaved );
+		case 4:
+			return mod.read_interleaved_quad( samplerate, count, interleaved );
+	}
+	return 0;
+}
+
+static void render_batch_job( const batch_job & job, batch_result & result, std::int32_t samplerate, std::int32_t channels ) {
+	static const std::size_t block_frames = 4096;
+	typedef std::chrono::steady_clock clock;
+	const clock::time_point load_start = clock::now();
+	try {
+		// loader messages are available from get_metadata( "warnings" )
+		std::ostringstream log;
+		module mod( *job.stream, log, job.ctls );
+		const clock::time_point render_start = clock::now();
+		result.load_seconds = std::chrono::duration<double>( render_start - load_start ).count();
+		job.sink->begin( mod );
+		std::vector<float> buffer( block_frames * channels );
+		while ( true ) {
+			std::size_t count = read_interleaved( mod, samplerate, channels, block_frames, buffer.data() );
+			if ( count == 0 ) {
+				break;
+			}
+			result.frames += count;
+			if ( !job.sink->write( buffer.data(), count ) ) {
+				break;
+			}
+		}
+		result.render_seconds = std::chrono::duration<double>( clock::now() - render_start ).count();
+		result.success = true;
+	} catch ( const std::exception & e ) {
+		result.error = e.what() ? e.what() : "";
+	} catch ( ... ) {
+		result.error = "unknown error";
+	}
+}
+
+std::vector<batch_result> render_batch( const std::vector<batch_job> & jobs, std::int32_t samplerate, std::int32_t channels, std::int32_t num_threads ) {
+	if ( channels != 1 && channels != 2 && channels != 4 ) {
+		throw openmpt::exception("invalid number of channels");
+	}
+	for ( const auto & job : jobs ) {
+		if ( !job.stream || !job.sink ) {
+			throw openmpt::exception("null pointer");
+		}
+	}
+	std::vector<batch_result> results( jobs.size() );
+	openmpt::module_impl::run_batch( jobs.size(), num_threads, [&]( std::size_t i ) {
+		render_batch_job( jobs[i], results[i], samplerate, channels );
+	} );
+	return results;
+}
+
 module_ext::module_ext( std::istream & stream, std::ostream & log, const std::map< std::string, std::string > & ctls ) : ext_impl(0) {
 	ext_impl = new module_ext_impl( stream, openmpt::helper::make_unique<std_ostream_log>( log ), ctls );
 	set_impl( ext_impl );
@@ -15,6 +15,7 @@
 #include "libopenmpt_impl.hpp"
 
 #include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <istream>
 #include <iterator>
@@ -28,8 +29,10 @@
 #include "common/version.h"
 #include "common/misc_util.h"
 #include "common/FileReader.h"
+#include "common/mptFileIO.h"
 #include "common/Logging.h"
 #include "common/mptMutex.h"
+#include "common/mptThreadPool.h"
 #include "soundlib/Sndfile.h"
 #include "soundlib/mod_specifications.h"
 #include "soundlib/AudioReadTarget.h"
@@ -416,14 +419,55 @@ void module_impl::apply_libopenmpt_defaults() {
 	set_render_param( module::RENDER_STEREOSEPARATION_PERCENT, 100 );
 	m_sndFile->Order.SetSequence( 0 );
 }
+void module_impl::apply_eq_settings() {
+	float gains[MAX_EQ_BANDS];
+	float frequencies[MAX_EQ_BANDS];
+	for ( std::size_t band = 0; band < MAX_EQ_BANDS; ++band ) {
+		gains[band] = static_cast<float>( std::pow( 10.0, m_ctl_render_eq_gains[band] / 20.0 ) );
+		frequencies[band] = static_cast<float>( m_ctl_render_eq_frequencies[band] );
+	}
+	m_sndFile->SetEQGains( gains, MAX_EQ_BANDS, frequencies );
+}
+void module_impl::set_dsp_effect( std::uint32_t effect, bool enable ) {
+	std::uint32_t mask = m_sndFile->m_MixerSettings.DSPMask;
+	if ( enable ) {
+		mask |= effect;
+	} else {
+		mask &= ~effect;
+	}
+	if ( mask != m_sndFile->m_MixerSettings.DSPMask ) {
+		m_sndFile->SetDspEffects( mask );
+	}
+}
+static std::vector<double> parse_eq_band_values( const std::string & value, double min_value, double max_value, double default_value, const char * error ) {
+	std::vector<double> values = mpt::String::Split<double>( value );
+	if ( values.size() > MAX_EQ_BANDS ) {
+		throw openmpt::exception( error );
+	}
+	for ( const auto & v : values ) {
+		if ( !( v >= min_value && v <= max_value ) ) {
+			throw openmpt::exception( error );
+		}
+	}
+	values.resize( MAX_EQ_BANDS, default_value );
+	return values;
+}
 module_impl::subsongs_type module_impl::get_subsongs() const {
 	std::vector<subsong_data> subsongs;
 	if ( m_sndFile->Order.GetNumSequences() == 0 ) {
 		throw openmpt::exception("module contains no songs");
 	}
-	for ( SEQUENCEINDEX seq = 0; seq < m_sndFile->Order.GetNumSequences(); ++seq ) {
-		const std::vector<GetLengthType> lengths = m_sndFile->GetLength( eNoAdjust, GetLengthTarget( true ).StartPos( seq, 0, 0 ) );
-		for ( const auto & l : lengths ) {
+	// Sequences are independent of each other, so they can be scanned in parallel.
+	// Subsongs within a sequence have to be found one after another, as each scan continues with the rows that the previous ones did not visit.
+	const SEQUENCEINDEX num_sequences = m_sndFile->Order.GetNumSequences();
+	std::vector<std::vector<GetLengthType>> lengths( num_sequences );
+	std::size_t threads = ( m_ctl_load_threads == 0 ) ? mpt::thread_pool::hardware_concurrency() : static_cast<std::size_t>( m_ctl_load_threads );
+	mpt::thread_pool pool( std::min<std::size_t>( threads, num_sequences ) );
+	pool.parallel_for( num_sequences, [&]( std::size_t seq ) {
+		lengths[seq] = m_sndFile->GetLength( eNoAdjust, GetLengthTarget( true ).StartPos( static_cast<SEQUENCEINDEX>( seq ), 0, 0 ) );
+	} );
+	for ( SEQUENCEINDEX seq = 0; seq < num_sequences; ++seq ) {
+		for ( const auto & l : lengths[seq] ) {
 			subsongs.push_back( subsong_data( l.duration, l.startRow, l.startOrder, seq ) );
 		}
 	}
@@ -450,7 +494,18 @@ void module_impl::ctor( const std::map< std::string, std::string > & ctls ) {
 	m_ctl_load_skip_patterns = false;
 	m_ctl_load_skip_plugins = false;
 	m_ctl_load_skip_subsongs_init = false;
+	m_ctl_load_threads = 1;
+	m_ctl_load_lazy_samples = 0;
+	m_ctl_load_share_samples = false;
+	m_ctl_load_read_ahead = false;
+	m_ctl_load_pin_samples = false;
 	m_ctl_seek_sync_samples = false;
+	m_ctl_render_eq_gains = std::vector<double>( MAX_EQ_BANDS, 0.0 );
+	m_ctl_render_eq_frequencies = { 125.0, 300.0, 600.0, 1250.0, 4000.0, 8000.0 };
+	m_ctl_render_megabass_depth = 40;
+	m_ctl_render_megabass_range = 60;
+	apply_eq_settings();
+	m_sndFile->SetLengthCheckpoints( 10.0, 4 * 1024 * 1024 );
 	// init member variables that correspond to ctls
 	for ( const auto & ctl : ctls ) {
 		ctl_set( ctl.first, ctl.second, false );
@@ -470,9 +525,27 @@ void module_impl::load( const FileReader & file, const std::map< std::string, st
 		if ( m_ctl_load_skip_plugins ) {
 			load_flags &= ~(CSoundFile::loadPluginData | CSoundFile::loadPluginInstance);
 		}
-		if ( !m_sndFile->Create( file, static_cast<CSoundFile::ModLoadingFlags>( load_flags ) ) ) {
+		FileReader file_to_load = file;
+		if ( m_ctl_load_lazy_samples != 0 && !m_ctl_load_skip_samples ) {
+			load_flags |= CSoundFile::deferSampleData;
+		}
+		if ( ( m_ctl_load_lazy_samples != 0 || m_ctl_load_pin_samples ) && !m_ctl_load_skip_samples ) {
+			if ( !m_file_data ) {
+				// Deferred samples are decoded and pinned samples are read after loading has finished, so we need our own copy of the file data.
+				auto data = std::make_shared<std::vector<mpt::byte> >( file.GetRawDataAsByteVector() );
+				file_to_load = make_FileReader( mpt::as_span( *data ) );
+				m_file_data = data;
+			}
+		}
+		m_sndFile->SetLoadThreads( static_cast<std::size_t>( m_ctl_load_threads ) );
+		m_sndFile->SetSampleSharing( m_ctl_load_share_samples );
+		m_sndFile->SetSamplePinning( m_ctl_load_pin_samples );
+		if ( !m_sndFile->Create( file_to_load, static_cast<CSoundFile::ModLoadingFlags>( load_flags ) ) ) {
 			throw openmpt::exception("error loading file");
 		}
+		if ( m_ctl_load_lazy_samples != 0 ) {
+			m_sndFile->StartDeferredSampleDecoding( m_ctl_load_lazy_samples == 2 );
+		}
 		if ( !m_ctl_load_skip_subsongs_init ) {
 			init_subsongs( m_subsongs );
 		}
@@ -661,6 +734,49 @@ double module_impl::could_open_probability( callback_stream_wrapper stream, doub
 double module_impl::could_open_probability( std::istream & stream, double effort, std::unique_ptr<log_interface> log ) {
 	return could_open_probability( make_FileReader( &stream ), effort, std::move(log) );
 }
+module_info module_impl::read_module_info( const OpenMPT::FileReader & file, std::unique_ptr<log_interface> log ) {
+	std::unique_ptr<CSoundFile> sndFile = mpt::make_unique<CSoundFile>();
+	std::unique_ptr<log_forwarder> logForwarder = mpt::make_unique<log_forwarder>( *log );
+	sndFile->SetCustomLog( logForwarder.get() );
+	// Names and the song message are read, but no pattern, sample or plugin data, and unlike module_impl::load, no subsongs are initialized.
+	if ( !sndFile->Create( file, CSoundFile::loadMetadata ) ) {
+		throw openmpt::exception("error loading file");
+	}
+	const mpt::Charset charset = sndFile->GetCharsetInternal();
+	module_info info;
+	info.type = mpt::ToCharset( mpt::CharsetUTF8, CSoundFile::ModTypeToString( sndFile->GetType() ) );
+	info.type_long = mpt::ToCharset( mpt::CharsetUTF8, !sndFile->m_moduleFormat.empty() ? sndFile->m_moduleFormat : CSoundFile::ModTypeToTracker( sndFile->GetType() ) );
+	info.container = mpt::ToCharset( mpt::CharsetUTF8, CSoundFile::ModContainerTypeToString( sndFile->GetContainerType() ) );
+	info.container_long = mpt::ToCharset( mpt::CharsetUTF8, CSoundFile::ModContainerTypeToTracker( sndFile->GetContainerType() ) );
+	info.tracker = mpt::ToCharset( mpt::CharsetUTF8, sndFile->m_madeWithTracker );
+	info.artist = mpt::ToCharset( mpt::CharsetUTF8, sndFile->m_songArtist );
+	info.title = mpt::ToCharset( mpt::CharsetUTF8, charset, sndFile->GetTitle() );
+	if ( !sndFile->GetFileHistory().empty() ) {
+		info.date = mpt::ToCharset( mpt::CharsetUTF8, sndFile->GetFileHistory().back().AsISO8601() );
+	}
+	info.message = mpt::ToCharset( mpt::CharsetUTF8, charset, sndFile->m_songMessage.GetFormatted( SongMessage::leLF ) );
+	info.num_channels = sndFile->GetNumChannels();
+	info.num_instruments = sndFile->GetNumInstruments();
+	info.num_samples = sndFile->GetNumSamples();
+	for ( INSTRUMENTINDEX i = 1; i <= sndFile->GetNumInstruments(); ++i ) {
+		info.instrument_names.push_back( mpt::ToCharset( mpt::CharsetUTF8, charset, sndFile->GetInstrumentName( i ) ) );
+	}
+	for ( SAMPLEINDEX i = 1; i <= sndFile->GetNumSamples(); ++i ) {
+		info.sample_names.push_back( mpt::ToCharset( mpt::CharsetUTF8, charset, sndFile->GetSampleName( i ) ) );
+	}
+	return info;
+}
+module_info module_impl::read_module_info( callback_stream_wrapper stream, std::unique_ptr<log_interface> log ) {
+	CallbackStream fstream;
+	fstream.stream = stream.stream;
+	fstream.read = stream.read;
+	fstream.seek = stream.seek;
+	fstream.tell = stream.tell;
+	return read_module_info( make_FileReader( fstream ), std::move(log) );
+}
+module_info module_impl::read_module_info( std::istream & stream, std::unique_ptr<log_interface> log ) {
+	return read_module_info( make_FileReader( &stream ), std::move(log) );
+}
 
 std::size_t module_impl::probe_file_header_get_recommended_size() {
 	return CSoundFile::ProbeRecommendedSize;
@@ -819,6 +935,18 @@ int module_impl::probe_file_header( std::uint64_t flags, callback_stream_wrapper
 	}
 	return result;
 }
+void module_impl::run_batch( std::size_t count, std::int32_t num_threads, const std::function<void( std::size_t )> & job ) {
+	if ( num_threads < 0 ) {
+		throw openmpt::exception("invalid number of threads");
+	}
+	if ( count == 0 ) {
+		return;
+	}
+	// Idle threads pick up the next unprocessed job, so short and long jobs balance out automatically.
+	std::size_t threads = ( num_threads == 0 ) ? mpt::thread_pool::hardware_concurrency() : static_cast<std::size_t>( num_threads );
+	mpt::thread_pool pool( std::min( threads, count ) );
+	pool.parallel_for( count, job );
+}
 module_impl::module_impl( callback_stream_wrapper stream, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
 	CallbackStream fstream;
@@ -826,39 +954,76 @@ module_impl::module_impl( callback_stream_wrapper stream, std::unique_ptr<log_in
 	fstream.read = stream.read;
 	fstream.seek = stream.seek;
 	fstream.tell = stream.tell;
-	load( make_FileReader( fstream ), ctls );
+	load( make_FileReader( fstream, nullptr, m_ctl_load_read_ahead ), ctls );
 	apply_libopenmpt_defaults();
 }
-module_impl::module_impl( std::istream & stream, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
+module_impl::module_impl( file_path_wrapper file, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
+#if defined(MPT_ENABLE_MMAP)
+	{
+		// Loading from the mapped file does not copy the file data, and only the parts of the file that are actually used get read from disk.
+		// All module data is copied by the loaders, so the mapping is not needed anymore once the module has been loaded,
+		// unless sample data is decoded lazily or pinned, in which case the mapping is kept instead of copying the file.
+		auto mapping = std::make_shared<CMappedFile>();
+		const mpt::byte * data = mapping->Open( mpt::PathString::FromNative( file.filename ) ) ? mapping->Lock() : nullptr;
+		if ( data ) {
+			if ( m_ctl_load_lazy_samples != 0 || m_ctl_load_pin_samples ) {
+				m_file_data = mapping;
+			}
+			load( make_FileReader( mpt::as_span( data, mapping->GetLength() ) ), ctls );
+			apply_libopenmpt_defaults();
+			return;
+		}
+	}
+#endif // MPT_ENABLE_MMAP
+	std::ifstream stream( file.filename, std::ios::binary );
+	if ( !stream ) {
+		throw openmpt::exception( "error opening file" );
+	}
 	load( make_FileReader( &stream ), ctls );
 	apply_libopenmpt_defaults();
 }
+module_impl::module_impl( std::istream & stream, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
+	ctor( ctls );
+	load( make_FileReader( &stream, nullptr, m_ctl_load_read_ahead ), ctls );
+	apply_libopenmpt_defaults();
+}
 module_impl::module_impl( const std::vector<std::uint8_t> & data, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
+	reference_caller_data( data.data() );
 	load( make_FileReader( mpt::as_span( data ) ), ctls );
 	apply_libopenmpt_defaults();
 }
 module_impl::module_impl( const std::vector<char> & data, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
+	reference_caller_data( data.data() );
 	load( make_FileReader( mpt::byte_cast< mpt::span< const mpt::byte > >( mpt::as_span( data ) ) ), ctls );
 	apply_libopenmpt_defaults();
 }
 module_impl::module_impl( const std::uint8_t * data, std::size_t size, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
+	reference_caller_data( data );
 	load( make_FileReader( mpt::as_span( data, size ) ), ctls );
 	apply_libopenmpt_defaults();
 }
 module_impl::module_impl( const char * data, std::size_t size, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
+	reference_caller_data( data );
 	load( make_FileReader( mpt::byte_cast< mpt::span< const mpt::byte > >( mpt::as_span( data, size ) ) ), ctls );
 	apply_libopenmpt_defaults();
 }
 module_impl::module_impl( const void * data, std::size_t size, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
+	reference_caller_data( data );
 	load( make_FileReader( mpt::as_span( mpt::void_cast< const mpt::byte * >( data ), size ) ), ctls );
 	apply_libopenmpt_defaults();
 }
+void module_impl::reference_caller_data( const void * data ) {
+	if ( m_ctl_load_pin_samples ) {
+		// The caller guarantees that the data outlives the module, so pinned samples can reference it without copying it first.
+		m_file_data = std::shared_ptr<const void>( data, []( const void * ) { } );
+	}
+}
 module_impl::~module_impl() {
 	m_sndFile->Destroy();
 }
@@ -1507,12 +1672,30 @@ std::vector<std::string> module_impl::get_ctls() const {
 		"load.skip_patterns",
 		"load.skip_plugins",
 		"load.skip_subsongs_init",
+		"load.threads",
+		"load.lazy_samples",
+		"load.share_samples",
+		"load.read_ahead",
+		"load.pin_samples",
 		"seek.sync_samples",
+		"seek.checkpoint_interval",
+		"seek.checkpoint_memory",
 		"subsong",
 		"play.tempo_factor",
 		"play.pitch_factor",
 		"play.at_end",
 		"render.resampler.emulate_amiga",
+		"render.chunk_frames",
+		"render.mix_threads",
+		"render.plugin_threads",
+		"render.float_master_mix",
+		"render.eq.enabled",
+		"render.eq.gains",
+		"render.eq.frequencies",
+		"render.megabass.enabled",
+		"render.megabass.depth",
+		"render.megabass.range",
+		"render.silent_frames_skipped",
 		"dither",
 	};
 }
@@ -1538,8 +1721,22 @@ std::string module_impl::ctl_get( std::string ctl, bool throw_if_unknown ) const
 		return mpt::fmt::val( m_ctl_load_skip_plugins );
 	} else if ( ctl == "load.skip_subsongs_init" ) {
 		return mpt::fmt::val( m_ctl_load_skip_subsongs_init );
+	} else if ( ctl == "load.threads" ) {
+		return mpt::fmt::val( m_ctl_load_threads );
+	} else if ( ctl == "load.lazy_samples" ) {
+		return mpt::fmt::val( m_ctl_load_lazy_samples );
+	} else if ( ctl == "load.share_samples" ) {
+		return mpt::fmt::val( m_ctl_load_share_samples );
+	} else if ( ctl == "load.read_ahead" ) {
+		return mpt::fmt::val( m_ctl_load_read_ahead );
+	} else if ( ctl == "load.pin_samples" ) {
+		return mpt::fmt::val( m_ctl_load_pin_samples );
 	} else if ( ctl == "seek.sync_samples" ) {
 		return mpt::fmt::val( m_ctl_seek_sync_samples );
+	} else if ( ctl == "seek.checkpoint_interval" ) {
+		return mpt::fmt::val( m_sndFile->GetLengthCheckpointInterval() );
+	} else if ( ctl == "seek.checkpoint_memory" ) {
+		return mpt::fmt::val( m_sndFile->GetLengthCheckpointMaxMemory() );
 	} else if ( ctl == "subsong" ) {
 		return mpt::fmt::val( get_selected_subsong() );
 	} else if ( ctl == "play.at_end" ) {
@@ -1566,6 +1763,28 @@ std::string module_impl::ctl_get( std::string ctl, bool throw_if_unknown ) const
 		return mpt::fmt::val( m_sndFile->m_nFreqFactor / 65536.0 );
 	} else if ( ctl == "render.resampler.emulate_amiga" ) {
 		return mpt::fmt::val( m_sndFile->m_Resampler.m_Settings.emulateAmiga );
+	} else if ( ctl == "render.chunk_frames" ) {
+		return mpt::fmt::val( m_sndFile->m_MixerSettings.MixChunkSize );
+	} else if ( ctl == "render.mix_threads" ) {
+		return mpt::fmt::val( m_sndFile->m_MixerSettings.NumMixThreads );
+	} else if ( ctl == "render.plugin_threads" ) {
+		return mpt::fmt::val( m_sndFile->m_MixerSettings.NumPluginThreads );
+	} else if ( ctl == "render.float_master_mix" ) {
+		return mpt::fmt::val( m_sndFile->m_MixerSettings.FloatMasterMix );
+	} else if ( ctl == "render.eq.enabled" ) {
+		return mpt::fmt::val( ( m_sndFile->m_MixerSettings.DSPMask & SNDDSP_EQ ) != 0 );
+	} else if ( ctl == "render.eq.gains" ) {
+		return mpt::String::Combine( m_ctl_render_eq_gains, std::string(",") );
+	} else if ( ctl == "render.eq.frequencies" ) {
+		return mpt::String::Combine( m_ctl_render_eq_frequencies, std::string(",") );
+	} else if ( ctl == "render.megabass.enabled" ) {
+		return mpt::fmt::val( ( m_sndFile->m_MixerSettings.DSPMask & SNDDSP_MEGABASS ) != 0 );
+	} else if ( ctl == "render.megabass.depth" ) {
+		return mpt::fmt::val( m_ctl_render_megabass_depth );
+	} else if ( ctl == "render.megabass.range" ) {
+		return mpt::fmt::val( m_ctl_render_megabass_range );
+	} else if ( ctl == "render.silent_frames_skipped" ) {
+		return mpt::fmt::val( m_sndFile->GetSilentFramesSkipped() );
 	} else if ( ctl == "dither" ) {
 		return mpt::fmt::val( static_cast<int>( m_Dither->GetMode() ) );
 	} else {
@@ -1598,8 +1817,38 @@ void module_impl::ctl_set( std::string ctl, const std::string & value, bool thro
 		m_ctl_load_skip_plugins = ConvertStrTo<bool>( value );
 	} else if ( ctl == "load.skip_subsongs_init" ) {
 		m_ctl_load_skip_subsongs_init = ConvertStrTo<bool>( value );
+	} else if ( ctl == "load.threads" ) {
+		std::int32_t threads = ConvertStrTo<std::int32_t>( value );
+		if ( threads < 0 ) {
+			throw openmpt::exception("invalid number of load threads");
+		}
+		m_ctl_load_threads = threads;
+	} else if ( ctl == "load.lazy_samples" ) {
+		std::int32_t mode = ConvertStrTo<std::int32_t>( value );
+		if ( mode < 0 || mode > 2 ) {
+			throw openmpt::exception("invalid lazy samples mode");
+		}
+		m_ctl_load_lazy_samples = mode;
+	} else if ( ctl == "load.share_samples" ) {
+		m_ctl_load_share_samples = ConvertStrTo<bool>( value );
+	} else if ( ctl == "load.read_ahead" ) {
+		m_ctl_load_read_ahead = ConvertStrTo<bool>( value );
+	} else if ( ctl == "load.pin_samples" ) {
+		m_ctl_load_pin_samples = ConvertStrTo<bool>( value );
 	} else if ( ctl == "seek.sync_samples" ) {
 		m_ctl_seek_sync_samples = ConvertStrTo<bool>( value );
+	} else if ( ctl == "seek.checkpoint_interval" ) {
+		double interval = ConvertStrTo<double>( value );
+		if ( !( interval >= 0.0 ) || interval > 3600.0 ) {
+			throw openmpt::exception("invalid checkpoint interval");
+		}
+		m_sndFile->SetLengthCheckpoints( interval, m_sndFile->GetLengthCheckpointMaxMemory() );
+	} else if ( ctl == "seek.checkpoint_memory" ) {
+		std::int64_t bytes = ConvertStrTo<std::int64_t>( value );
+		if ( bytes < 0 || static_cast<std::uint64_t>( bytes ) > std::numeric_limits<std::size_t>::max() ) {
+			throw openmpt::exception("invalid checkpoint memory size");
+		}
+		m_sndFile->SetLengthCheckpoints( m_sndFile->GetLengthCheckpointInterval(), static_cast<std::size_t>( bytes ) );
 	} else if ( ctl == "subsong" ) {
 		select_subsong( ConvertStrTo<int32>( value ) );
 	} else if ( ctl == "play.at_end" ) {
@@ -1638,6 +1887,70 @@ void module_impl::ctl_set( std::string ctl, const std::string & value, bool thro
 		if ( newsettings != m_sndFile->m_Resampler.m_Settings ) {
 			m_sndFile->SetResamplerSettings( newsettings );
 		}
+	} else if ( ctl == "render.chunk_frames" ) {
+		std::int32_t frames = ConvertStrTo<std::int32_t>( value );
+		if ( frames <= 0 || frames > static_cast<std::int32_t>( MixerSettings::MaxMixChunkSize ) ) {
+			throw openmpt::exception("invalid chunk size");
+		}
+		if ( static_cast<std::uint32_t>( frames ) != m_sndFile->m_MixerSettings.MixChunkSize ) {
+			MixerSettings newsettings = m_sndFile->m_MixerSettings;
+			newsettings.MixChunkSize = frames;
+			m_sndFile->SetMixerSettings( newsettings );
+		}
+	} else if ( ctl == "render.mix_threads" ) {
+		std::int32_t threads = ConvertStrTo<std::int32_t>( value );
+		if ( threads < 0 || threads > static_cast<std::int32_t>( MixerSettings::MaxMixThreads ) ) {
+			throw openmpt::exception("invalid number of mix threads");
+		}
+		if ( static_cast<std::uint32_t>( threads ) != m_sndFile->m_MixerSettings.NumMixThreads ) {
+			MixerSettings newsettings = m_sndFile->m_MixerSettings;
+			newsettings.NumMixThreads = threads;
+			m_sndFile->SetMixerSettings( newsettings );
+		}
+	} else if ( ctl == "render.plugin_threads" ) {
+		std::int32_t threads = ConvertStrTo<std::int32_t>( value );
+		if ( threads < 0 || threads > static_cast<std::int32_t>( MixerSettings::MaxMixThreads ) ) {
+			throw openmpt::exception("invalid number of plugin threads");
+		}
+		if ( static_cast<std::uint32_t>( threads ) != m_sndFile->m_MixerSettings.NumPluginThreads ) {
+			MixerSettings newsettings = m_sndFile->m_MixerSettings;
+			newsettings.NumPluginThreads = threads;
+			m_sndFile->SetMixerSettings( newsettings );
+		}
+	} else if ( ctl == "render.float_master_mix" ) {
+		bool float_master_mix = ConvertStrTo<bool>( value );
+		if ( float_master_mix != m_sndFile->m_MixerSettings.FloatMasterMix ) {
+			MixerSettings newsettings = m_sndFile->m_MixerSettings;
+			newsettings.FloatMasterMix = float_master_mix;
+			m_sndFile->SetMixerSettings( newsettings );
+		}
+	} else if ( ctl == "render.eq.enabled" ) {
+		set_dsp_effect( SNDDSP_EQ, ConvertStrTo<bool>( value ) );
+	} else if ( ctl == "render.eq.gains" ) {
+		m_ctl_render_eq_gains = parse_eq_band_values( value, -12.0, 12.0, 0.0, "invalid EQ gains" );
+		apply_eq_settings();
+	} else if ( ctl == "render.eq.frequencies" ) {
+		m_ctl_render_eq_frequencies = parse_eq_band_values( value, 0.0, 20000.0, 0.0, "invalid EQ frequencies" );
+		apply_eq_settings();
+	} else if ( ctl == "render.megabass.enabled" ) {
+		set_dsp_effect( SNDDSP_MEGABASS, ConvertStrTo<bool>( value ) );
+	} else if ( ctl == "render.megabass.depth" || ctl == "render.megabass.range" ) {
+		std::int32_t amount = ConvertStrTo<std::int32_t>( value );
+		if ( amount < 0 || amount > 100 ) {
+			throw openmpt::exception("invalid megabass setting");
+		}
+		if ( ctl == "render.megabass.depth" ) {
+			m_ctl_render_megabass_depth = amount;
+		} else {
+			m_ctl_render_megabass_range = amount;
+		}
+		m_sndFile->m_MegaBass.SetXBassParameters( m_ctl_render_megabass_depth, m_ctl_render_megabass_range );
+		m_sndFile->InitPlayer( false );
+	} else if ( ctl == "render.silent_frames_skipped" ) {
+		if ( ConvertStrTo<std::uint64_t>( value ) != 0 ) {
+			throw openmpt::exception("render.silent_frames_skipped can only be reset to 0");
+		}
+		m_sndFile->ResetSilentFramesSkipped();
 	} else if ( ctl == "dither" ) {
 		int dither = ConvertStrTo<int>( value );
 		if ( dither < 0 || dither >= NumDitherModes ) {
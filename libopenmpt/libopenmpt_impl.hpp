@@ -13,6 +13,7 @@
 #include "libopenmpt_internal.h"
 #include "libopenmpt.hpp"
 
+#include <functional>
 #include <iosfwd>
 #include <memory>
 
@@ -70,6 +71,10 @@ struct callback_stream_wrapper {
 	std::int64_t (*tell)( void * stream );
 }; // struct callback_stream_wrapper
 
+struct file_path_wrapper {
+	const char * filename;
+}; // struct file_path_wrapper
+
 class module_impl {
 protected:
 	struct subsong_data {
@@ -94,6 +99,7 @@ protected:
 	std::unique_ptr<log_forwarder> m_LogForwarder;
 	std::int32_t m_current_subsong;
 	double m_currentPositionSeconds;
+	std::shared_ptr<const void> m_file_data;
 	std::unique_ptr<OpenMPT::CSoundFile> m_sndFile;
 	bool m_loaded;
 	bool m_mixer_initialized;
@@ -105,7 +111,16 @@ protected:
 	bool m_ctl_load_skip_patterns;
 	bool m_ctl_load_skip_plugins;
 	bool m_ctl_load_skip_subsongs_init;
+	std::int32_t m_ctl_load_threads;
+	std::int32_t m_ctl_load_lazy_samples;
+	bool m_ctl_load_share_samples;
+	bool m_ctl_load_read_ahead;
+	bool m_ctl_load_pin_samples;
 	bool m_ctl_seek_sync_samples;
+	std::vector<double> m_ctl_render_eq_gains;
+	std::vector<double> m_ctl_render_eq_frequencies;
+	std::int32_t m_ctl_render_megabass_depth;
+	std::int32_t m_ctl_render_megabass_range;
 	std::vector<std::string> m_loaderMessages;
 public:
 	void PushToCSoundFileLog( const std::string & text ) const;
@@ -114,11 +129,14 @@ protected:
 	std::string mod_string_to_utf8( const std::string & encoded ) const;
 	void apply_mixer_settings( std::int32_t samplerate, int channels );
 	void apply_libopenmpt_defaults();
+	void apply_eq_settings();
+	void set_dsp_effect( std::uint32_t effect, bool enable );
 	subsongs_type get_subsongs() const;
 	void init_subsongs( subsongs_type & subsongs ) const;
 	bool has_subsongs_inited() const;
 	void ctor( const std::map< std::string, std::string > & ctls );
 	void load( const OpenMPT::FileReader & file, const std::map< std::string, std::string > & ctls );
+	void reference_caller_data( const void * data );
 	bool is_loaded() const;
 	std::size_t read_wrapper( std::size_t count, std::int16_t * left, std::int16_t * right, std::int16_t * rear_left, std::int16_t * rear_right );
 	std::size_t read_wrapper( std::size_t count, float * left, float * right, float * rear_left, float * rear_right );
@@ -127,12 +145,15 @@ protected:
 	std::pair< std::string, std::string > format_and_highlight_pattern_row_channel_command( std::int32_t p, std::int32_t r, std::int32_t c, int command ) const;
 	std::pair< std::string, std::string > format_and_highlight_pattern_row_channel( std::int32_t p, std::int32_t r, std::int32_t c, std::size_t width, bool pad ) const;
 	static double could_open_probability( const OpenMPT::FileReader & file, double effort, std::unique_ptr<log_interface> log );
+	static module_info read_module_info( const OpenMPT::FileReader & file, std::unique_ptr<log_interface> log );
 public:
 	static std::vector<std::string> get_supported_extensions();
 	static bool is_extension_supported( const char * extension );
 	static bool is_extension_supported( const std::string & extension );
 	static double could_open_probability( callback_stream_wrapper stream, double effort, std::unique_ptr<log_interface> log );
 	static double could_open_probability( std::istream & stream, double effort, std::unique_ptr<log_interface> log );
+	static module_info read_module_info( callback_stream_wrapper stream, std::unique_ptr<log_interface> log );
+	static module_info read_module_info( std::istream & stream, std::unique_ptr<log_interface> log );
 	static std::size_t probe_file_header_get_recommended_size();
 	static int probe_file_header( std::uint64_t flags, const std::uint8_t * data, std::size_t size, std::uint64_t filesize );
 	static int probe_file_header( std::uint64_t flags, const void * data, std::size_t size, std::uint64_t filesize );
@@ -140,7 +161,9 @@ public:
 	static int probe_file_header( std::uint64_t flags, const void * data, std::size_t size );
 	static int probe_file_header( std::uint64_t flags, std::istream & stream );
 	static int probe_file_header( std::uint64_t flags, callback_stream_wrapper stream );
+	static void run_batch( std::size_t count, std::int32_t num_threads, const std::function<void( std::size_t )> & job );
 	module_impl( callback_stream_wrapper stream, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
+	module_impl( file_path_wrapper file, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 	module_impl( std::istream & stream, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 	module_impl( const std::vector<std::uint8_t> & data, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 	module_impl( const std::vector<char> & data, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
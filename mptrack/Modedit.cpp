@@ -329,6 +329,7 @@ SAMPLEINDEX CModDoc::ReArrangeSamples(const std::vector<SAMPLEINDEX> &newOrder)
 	for(SAMPLEINDEX i = newNumSamples + 1; i <= oldNumSamples; i++)
 	{
 		m_SndFile.GetSample(i).pData.pSample = nullptr;
+		m_SndFile.GetSample(i).pLookahead = nullptr;
 		m_SndFile.GetSample(i).nLength = 0;
 		strcpy(m_SndFile.m_szNames[i], "");
 	}
@@ -363,6 +364,7 @@ SAMPLEINDEX CModDoc::ReArrangeSamples(const std::vector<SAMPLEINDEX> &newOrder)
 			// Invalid sample reference.
 			target.Initialize(m_SndFile.GetType());
 			target.pData.pSample = nullptr;
+			target.pLookahead = nullptr;
 			strcpy(m_SndFile.m_szNames[i + 1], "");
 			m_SndFile.ResetSamplePath(i + 1);
 		}
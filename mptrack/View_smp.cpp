@@ -2255,6 +2255,7 @@ void CViewSample::DoPaste(PasteMode pasteMode)
 		if(pasteMode != kReplace)
 		{
 			sndFile.GetSample(m_nSample).pData.pSample = nullptr;	// prevent old sample from being deleted.
+			sndFile.GetSample(m_nSample).pLookahead = nullptr;
 		}
 
 		FileReader file(data);
@@ -90,6 +90,7 @@ namespace MidiExport
 			if(tempoTrack == nullptr) return;
 
 			m_pMixStruct->pMixPlugin = this;
+			m_SndFile.InvalidateActivePlugins();
 		}
 
 		void WritePitchWheelDepth()
@@ -395,6 +396,7 @@ namespace MidiExport
 				MidiTrack &midiInstr = *(new MidiTrack(m_plugFactory, m_sndFile, &mixPlugin, &tempoTrack, m_wasInstrumentMode ? oldInstr->name : m_sndFile.GetSampleName(i), oldInstr, overlappingInstruments));
 				ModInstrument &instr = midiInstr;
 				mixPlugin.pMixPlugin = &midiInstr;
+				m_sndFile.InvalidateActivePlugins();
 				
 				m_sndFile.Instruments[i] = &instr;
 				m_tracks.push_back(&midiInstr);
@@ -40,6 +40,7 @@ static const char * const license =
 #include "openmpt123_config.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <deque>
 #include <fstream>
 #include <iomanip>
@@ -47,6 +48,7 @@ static const char * const license =
 #include <iterator>
 #include <limits>
 #include <map>
+#include <memory>
 #include <random>
 #include <set>
 #include <sstream>
@@ -275,6 +277,7 @@ static std::ostream & operator << ( std::ostream & s, const commandlineflags & f
 	s << "Standard output: " << flags.use_stdout << std::endl;
 	s << "Output filename: " << flags.output_filename << std::endl;
 	s << "Force overwrite output file: " << flags.force_overwrite << std::endl;
+	s << "Jobs: " << flags.jobs << std::endl;
 	s << "Ctls: " << ctls_to_string( flags.ctls ) << std::endl;
 	s << std::endl;
 	s << "Files: " << std::endl;
@@ -650,6 +653,7 @@ static void show_help( textout & log, bool with_info = true, bool longhelp = fal
 		log << "     --output-type t        Use output format t when writing to a individual PCM files (only applies to --render mode) [default: " << commandlineflags().output_extension << "]" << std::endl;
 		log << " -o, --output f             Write PCM output to file f instead of streaming to audio device (only applies to --ui and --batch modes) [default: " << commandlineflags().output_filename << "]" << std::endl;
 		log << "     --force                Force overwriting of output file [default: " << commandlineflags().force_overwrite << "]" << std::endl;
+		log << " -j, --jobs n               Render n files concurrently, 0 means one per CPU core (only applies to --render mode) [default: " << commandlineflags().jobs << "]" << std::endl;
 		log << std::endl;
 		log << "     --                     Interpret further arguments as filenames" << std::endl;
 		log << std::endl;
@@ -1717,8 +1721,14 @@ static void render_file( commandlineflags & flags, const std::string & filename,
 			throw exception( "file open error" );
 		}
 
+		std::map<std::string, std::string> ctls = flags.ctls;
+		if ( use_stdin && ctls.find( "load.read_ahead" ) == ctls.end() ) {
+			// pipes are slow, parse what has already arrived while reading the rest
+			ctls[ "load.read_ahead" ] = "1";
+		}
+
 		{
-			openmpt::module mod( data_stream, silentlog, flags.ctls );
+			openmpt::module mod( data_stream, silentlog, ctls );
 			mod.select_subsong( flags.subsong );
 			silentlog.str( std::string() ); // clear, loader messages get stored to get_metadata( "warnings" ) by libopenmpt internally
 			render_mod_file( flags, filename, filesize, mod, log, audio_stream );
@@ -1828,6 +1838,148 @@ static void render_files( commandlineflags & flags, textout & log, write_buffers
 	}
 }
 
+static std::unique_ptr<std::istream> open_input_file( const std::string & filename ) {
+#if defined(WIN32) && defined(UNICODE) && !defined(_MSC_VER)
+	// Only MSVC has std::ifstream::ifstream(std::wstring).
+	// Fake it for other compilers using _wfopen().
+	std::string data;
+	FILE * f = _wfopen( utf8_to_wstring( filename ).c_str(), L"rb" );
+	if ( !f ) {
+		std::unique_ptr<std::istream> result( new std::istringstream() );
+		result->setstate( std::ios::failbit );
+		return result;
+	}
+	while ( !feof( f ) ) {
+		static const std::size_t BUFFER_SIZE = 4096;
+		char buffer[BUFFER_SIZE];
+		size_t data_read = fread( buffer, 1, BUFFER_SIZE, f );
+		std::copy( buffer, buffer + data_read, std::back_inserter( data ) );
+	}
+	fclose( f );
+	f = NULL;
+	return std::unique_ptr<std::istream>( new std::istringstream( data ) );
+#elif defined(_MSC_VER) && defined(UNICODE)
+	return std::unique_ptr<std::istream>( new std::ifstream( utf8_to_wstring( filename ), std::ios::binary ) );
+#else
+	return std::unique_ptr<std::istream>( new std::ifstream( filename, std::ios::binary ) );
+#endif
+}
+
+// Writes one module rendered by openmpt::render_batch to its own output file.
+class batch_file_sink : public openmpt::batch_sink {
+private:
+	commandlineflags flags;
+	std::string output_filename;
+	std::ostringstream log;
+	std::unique_ptr<file_audio_stream_raii> audio_stream;
+	openmpt::module * mod;
+	std::vector< std::vector<float> > float_buffers;
+	std::vector< std::vector<std::int16_t> > int16_buffers;
+public:
+	batch_file_sink( const commandlineflags & flags_, const std::string & output_filename_ )
+		: flags(flags_)
+		, output_filename(output_filename_)
+		, mod(nullptr)
+		, float_buffers(flags_.channels)
+		, int16_buffers(flags_.channels)
+	{
+		return;
+	}
+	void begin( openmpt::module & mod_ ) override {
+		mod = &mod_;
+		mod->select_subsong( flags.subsong );
+		mod->set_repeat_count( flags.repeatcount );
+		apply_mod_settings( flags, *mod );
+		audio_stream.reset( new file_audio_stream_raii( flags, output_filename, log ) );
+		audio_stream->write_metadata( get_metadata( *mod ) );
+		if ( flags.seek_target > 0.0 ) {
+			mod->set_position_seconds( flags.seek_target );
+		}
+	}
+	bool write( const float * interleaved, std::size_t frames ) override {
+		if ( flags.use_float ) {
+			write_planar( float_buffers, interleaved, frames );
+		} else {
+			write_planar( int16_buffers, interleaved, frames );
+		}
+		return !( flags.end_time > 0 && mod->get_position_seconds() >= flags.end_time );
+	}
+	// Finishes the output file
+	void close() {
+		audio_stream.reset();
+	}
+private:
+	template < typename Tsample >
+	void write_planar( std::vector< std::vector<Tsample> > & planar, const float * interleaved, std::size_t frames ) {
+		std::vector<Tsample*> buffers( flags.channels );
+		for ( int channel = 0; channel < flags.channels; ++channel ) {
+			planar[channel].resize( frames );
+			for ( std::size_t frame = 0; frame < frames; ++frame ) {
+				planar[channel][frame] = convert_sample_to<Tsample>( interleaved[frame * flags.channels + channel] );
+			}
+			buffers[channel] = planar[channel].data();
+		}
+		audio_stream->write( buffers, frames );
+	}
+};
+
+static void render_files_concurrently( commandlineflags & flags, textout & log ) {
+	// Render the files in groups, so that we do not run out of file handles for huge file lists.
+	const std::size_t group_size = 64 * static_cast<std::size_t>( flags.jobs > 0 ? flags.jobs : 1 );
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	double total_audio_seconds = 0.0;
+	for ( std::size_t group_start = 0; group_start < flags.filenames.size(); group_start += group_size ) {
+		const std::size_t group_end = std::min( group_start + group_size, flags.filenames.size() );
+		std::vector< std::unique_ptr<std::istream> > streams;
+		std::vector< std::unique_ptr<batch_file_sink> > sinks;
+		std::vector<openmpt::batch_job> jobs;
+		std::vector<std::size_t> job_files;
+		for ( std::size_t i = group_start; i < group_end; ++i ) {
+			const std::string & filename = flags.filenames[i];
+			std::unique_ptr<std::istream> stream = open_input_file( filename );
+			if ( stream->fail() ) {
+				log << "error rendering '" << filename << "': file open error" << std::endl;
+				continue;
+			}
+			sinks.emplace_back( new batch_file_sink( flags, filename + std::string(".") + flags.output_extension ) );
+			jobs.push_back( openmpt::batch_job( *stream, *sinks.back(), flags.ctls ) );
+			streams.push_back( std::move( stream ) );
+			job_files.push_back( i );
+		}
+		log.writeout();
+		const std::vector<openmpt::batch_result> results = openmpt::render_batch( jobs, flags.samplerate, flags.channels, flags.jobs );
+		for ( std::size_t job = 0; job < results.size(); ++job ) {
+			const std::string & filename = flags.filenames[ job_files[job] ];
+			const openmpt::batch_result & result = results[job];
+			try {
+				sinks[job]->close();
+			} catch ( std::exception & e ) {
+				log << "error rendering '" << filename << "': " << e.what() << std::endl;
+				continue;
+			}
+			if ( !result.success ) {
+				log << "error rendering '" << filename << "': " << result.error << std::endl;
+				continue;
+			}
+			const double audio_seconds = static_cast<double>( result.frames ) / flags.samplerate;
+			total_audio_seconds += audio_seconds;
+			if ( !flags.quiet ) {
+				log << get_filename( filename ) << ": " << seconds_to_string( audio_seconds ) << " rendered in " << std::fixed << std::setprecision(2) << result.render_seconds << "s";
+				if ( result.render_seconds > 0.0 ) {
+					log << " (" << std::setprecision(1) << audio_seconds / result.render_seconds << "x realtime)";
+				}
+				log << std::endl;
+			}
+		}
+		log.writeout();
+	}
+	const double total_seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+	if ( !flags.quiet && total_audio_seconds > 0.0 ) {
+		log << "Total: " << seconds_to_string( total_audio_seconds ) << " rendered in " << std::fixed << std::setprecision(2) << total_seconds << "s (" << std::setprecision(1) << total_audio_seconds / total_seconds << "x realtime)" << std::endl;
+		log.writeout();
+	}
+}
+
 
 static bool parse_playlist( commandlineflags & flags, std::string filename, std::ostream & log ) {
 	log.flush();
@@ -2008,6 +2160,10 @@ static commandlineflags parse_openmpt123( const std::vector<std::string> & args,
 				flags.mode = ModeBatch;
 			} else if ( arg == "--render" ) {
 				flags.mode = ModeRender;
+			} else if ( ( arg == "-j" || arg == "--jobs" ) && nextarg != "" ) {
+				std::istringstream istr( nextarg );
+				istr >> flags.jobs;
+				++i;
 			} else if ( arg == "--terminal-width" && nextarg != "" ) {
 				std::istringstream istr( nextarg );
 				istr >> flags.terminal_width;
@@ -2453,6 +2609,10 @@ static int main( int argc, char * argv [] ) {
 				}
 			} break;
 			case ModeRender: {
+				if ( flags.jobs != 1 ) {
+					render_files_concurrently( flags, log );
+					break;
+				}
 				for ( const auto & filename : flags.filenames ) {
 					flags.apply_default_buffer_sizes();
 					file_audio_stream_raii file_audio_stream( flags, filename + std::string(".") + flags.output_extension, log );
@@ -302,6 +302,7 @@ struct commandlineflags {
 	std::string output_filename;
 	std::string output_extension;
 	bool force_overwrite;
+	std::int32_t jobs;
 	bool paused;
 	std::string warnings;
 	void apply_default_buffer_sizes() {
@@ -406,6 +407,7 @@ struct commandlineflags {
 		playlist_index = 0;
 		output_extension = "auto";
 		force_overwrite = false;
+		jobs = 1;
 		paused = false;
 	}
 	void check_and_sanitize() {
@@ -494,6 +496,9 @@ struct commandlineflags {
 		if ( mode == ModeRender && !output_filename.empty() ) {
 			throw args_error_exception();
 		}
+		if ( jobs < 0 || ( mode != ModeRender && jobs != 1 ) ) {
+			throw args_error_exception();
+		}
 		if ( mode != ModeRender && !output_filename.empty() ) {
 			output_extension = get_extension( output_filename );
 		}
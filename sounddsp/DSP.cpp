@@ -23,12 +23,6 @@ OPENMPT_NAMESPACE_BEGIN
 #define DEFAULT_XBASS_DEPTH		6	// 1+(3>>(x-4)) (+6dB)
 
 
-////////////////////////////////////////////////////////////////////
-// DSP Effects internal state
-
-static void X86_StereoDCRemoval(int *, uint32 count, int32 &nDCRFlt_Y1l, int32 &nDCRFlt_X1l, int32 &nDCRFlt_Y1r, int32 &nDCRFlt_X1r);
-static void X86_MonoDCRemoval(int *, uint32 count, int32 &nDCRFlt_Y1l, int32 &nDCRFlt_X1l);
-
 ///////////////////////////////////////////////////////////////////////////////////
 //
 // Biquad setup
@@ -135,7 +129,7 @@ CMegaBass::CMegaBass()
 }
 
 
-void CSurround::Initialize(bool bReset, DWORD MixingFreq)
+void CSurround::Initialize(bool bReset, uint32 MixingFreq)
 {
 	MPT_UNREFERENCED_PARAMETER(bReset);
 	if (!m_Settings.m_nProLogicDelay) m_Settings.m_nProLogicDelay = 20;
@@ -164,7 +158,7 @@ void CSurround::Initialize(bool bReset, DWORD MixingFreq)
 }
 
 
-void CMegaBass::Initialize(bool bReset, DWORD MixingFreq)
+void CMegaBass::Initialize(bool bReset, uint32 MixingFreq)
 {
 	// Bass Expansion Reset
 	{
@@ -273,118 +267,95 @@ void CSurround::Process(int * MixSoundBuffer, int * MixRearBuffer, int count, ui
 }
 
 
-void CMegaBass::Process(int * MixSoundBuffer, int * MixRearBuffer, int count, uint32 nChannels)
+//////////////////////////////////////////////////////////////////////////
+//
+// DC Removal
+//
+
+#define DCR_AMOUNT		9
+
+static MPT_FORCEINLINE int DCRemoval(int in, int &y1, int &x1)
 {
+	int diff = x1 - in;
+	x1 = in;
+	int out = diff / (1 << (DCR_AMOUNT + 1)) - diff + y1;
+	y1 = out - out / (1 << DCR_AMOUNT);
+	return out;
+}
 
-	if(nChannels >= 2)
+
+// DC removal and bass expansion are done in a single pass over the mix buffer.
+// The bass filter is one recursive chain on the downmixed signal, so there is nothing to gain from vectorizing it.
+void CMegaBass::Process(int * MixSoundBuffer, int * MixRearBuffer, int count, uint32 nChannels)
+{
+	int x1 = nXBassFlt_X1;
+	int y1 = nXBassFlt_Y1;
+	int dcY1lf = nDCRFlt_Y1lf, dcX1lf = nDCRFlt_X1lf;
+	int dcY1rf = nDCRFlt_Y1rf, dcX1rf = nDCRFlt_X1rf;
+	int dcY1lb = nDCRFlt_Y1lb, dcX1lb = nDCRFlt_X1lb;
+	int dcY1rb = nDCRFlt_Y1rb, dcX1rb = nDCRFlt_X1rb;
+	const int b0 = nXBassFlt_B0, b1 = nXBassFlt_B1, a1 = nXBassFlt_A1;
+
+	if(nChannels > 2)
 	{
-		X86_StereoDCRemoval(MixSoundBuffer, count, nDCRFlt_Y1lf, nDCRFlt_X1lf, nDCRFlt_Y1rf, nDCRFlt_X1rf);
-		if(nChannels > 2) X86_StereoDCRemoval(MixSoundBuffer, count, nDCRFlt_Y1lb, nDCRFlt_X1lb, nDCRFlt_Y1rb, nDCRFlt_X1rb);
 		int *px = MixSoundBuffer;
 		int *py = MixRearBuffer;
-		int x1 = nXBassFlt_X1;
-		int y1 = nXBassFlt_Y1;
-		if(nChannels > 2) for (int x=count; x; x--)
+		for (int x=count; x; x--)
 		{
-			int x_m = (px[0]+px[1]+py[0]+py[1]+0x100)>>9;
+			const int lf = DCRemoval(px[0], dcY1lf, dcX1lf);
+			const int rf = DCRemoval(px[1], dcY1rf, dcX1rf);
+			const int lb = DCRemoval(py[0], dcY1lb, dcX1lb);
+			const int rb = DCRemoval(py[1], dcY1rb, dcX1rb);
+			int x_m = (lf+rf+lb+rb+0x100)>>9;
 
-			y1 = (nXBassFlt_B0 * x_m + nXBassFlt_B1 * x1 + nXBassFlt_A1 * y1) >> (10-8);
+			y1 = (b0 * x_m + b1 * x1 + a1 * y1) >> (10-8);
 			x1 = x_m;
-			px[0] += y1;
-			px[1] += y1;
-			py[0] += y1;
-			py[1] += y1;
+			px[0] = lf + y1;
+			px[1] = rf + y1;
+			py[0] = lb + y1;
+			py[1] = rb + y1;
 			y1 = (y1+0x80) >> 8;
 			px += 2;
 			py += 2;
-		} else for (int x=count; x; x--)
+		}
+	} else if(nChannels == 2)
+	{
+		int *px = MixSoundBuffer;
+		for (int x=count; x; x--)
 		{
-			int x_m = (px[0]+px[1]+0x100)>>9;
+			const int lf = DCRemoval(px[0], dcY1lf, dcX1lf);
+			const int rf = DCRemoval(px[1], dcY1rf, dcX1rf);
+			int x_m = (lf+rf+0x100)>>9;
 
-			y1 = (nXBassFlt_B0 * x_m + nXBassFlt_B1 * x1 + nXBassFlt_A1 * y1) >> (10-8);
+			y1 = (b0 * x_m + b1 * x1 + a1 * y1) >> (10-8);
 			x1 = x_m;
-			px[0] += y1;
-			px[1] += y1;
+			px[0] = lf + y1;
+			px[1] = rf + y1;
 			y1 = (y1+0x80) >> 8;
 			px += 2;
 		}
-		nXBassFlt_X1 = x1;
-		nXBassFlt_Y1 = y1;
 	} else
 	{
-		X86_MonoDCRemoval(MixSoundBuffer, count, nDCRFlt_Y1lf, nDCRFlt_X1lf);
 		int *px = MixSoundBuffer;
-		int x1 = nXBassFlt_X1;
-		int y1 = nXBassFlt_Y1;
 		for (int x=count; x; x--)
 		{
-			int x_m = (px[0]+0x80)>>8;
+			const int m = DCRemoval(px[0], dcY1lf, dcX1lf);
+			int x_m = (m+0x80)>>8;
 
-			y1 = (nXBassFlt_B0 * x_m + nXBassFlt_B1 * x1 + nXBassFlt_A1 * y1) >> (10-8);
+			y1 = (b0 * x_m + b1 * x1 + a1 * y1) >> (10-8);
 			x1 = x_m;
-			px[0] += y1;
+			px[0] = m + y1;
 			y1 = (y1+0x40) >> 8;
 			px++;
 		}
-		nXBassFlt_X1 = x1;
-		nXBassFlt_Y1 = y1;
-	}
-
-}
-
-
-
-//////////////////////////////////////////////////////////////////////////
-//
-// DC Removal
-//
-
-#define DCR_AMOUNT		9
-
-static void X86_StereoDCRemoval(int *pBuffer, uint32 nSamples, int32 &nDCRFlt_Y1l, int32 &nDCRFlt_X1l, int32 &nDCRFlt_Y1r, int32 &nDCRFlt_X1r)
-{
-	int y1l = nDCRFlt_Y1l, x1l = nDCRFlt_X1l;
-	int y1r = nDCRFlt_Y1r, x1r = nDCRFlt_X1r;
-
-	while(nSamples--)
-	{
-		int inL = pBuffer[0];
-		int inR = pBuffer[1];
-		int diffL = x1l - inL;
-		int diffR = x1r - inR;
-		x1l = inL;
-		x1r = inR;
-		int outL = diffL / (1 << (DCR_AMOUNT + 1)) - diffL + y1l;
-		int outR = diffR / (1 << (DCR_AMOUNT + 1)) - diffR + y1r;
-		pBuffer[0] = outL;
-		pBuffer[1] = outR;
-		pBuffer += 2;
-		y1l = outL - outL / (1 << DCR_AMOUNT);
-		y1r = outR - outR / (1 << DCR_AMOUNT);
-	}
-
-	nDCRFlt_Y1l = y1l;
-	nDCRFlt_X1l = x1l;
-	nDCRFlt_Y1r = y1r;
-	nDCRFlt_X1r = x1r;
-}
-
-
-static void X86_MonoDCRemoval(int *pBuffer, uint32 nSamples, int32 &nDCRFlt_Y1l, int32 &nDCRFlt_X1l)
-{
-	int y1l = nDCRFlt_Y1l, x1l = nDCRFlt_X1l;
-	while(nSamples--)
-	{
-		int inM = pBuffer[0];
-		int diff = x1l - inM;
-		x1l = inM;
-		pBuffer[0] = inM = diff / (1 << (DCR_AMOUNT + 1)) - diff + y1l;
-		pBuffer++;
-		y1l = inM - inM / (1 << DCR_AMOUNT);
 	}
 
-	nDCRFlt_Y1l = y1l;
-	nDCRFlt_X1l = x1l;
+	nXBassFlt_X1 = x1;
+	nXBassFlt_Y1 = y1;
+	nDCRFlt_Y1lf = dcY1lf; nDCRFlt_X1lf = dcX1lf;
+	nDCRFlt_Y1rf = dcY1rf; nDCRFlt_X1rf = dcX1rf;
+	nDCRFlt_Y1lb = dcY1lb; nDCRFlt_X1lb = dcX1lb;
+	nDCRFlt_Y1rb = dcY1rb; nDCRFlt_X1rb = dcX1rb;
 }
 
 
@@ -72,7 +72,7 @@ public:
 	bool SetXBassParameters(uint32 nDepth, uint32 nRange);
 	// [Surround level 0(quiet)-100(heavy)] [delay in ms, usually 5-40ms]
 	void SetSurroundParameters(uint32 nDepth, uint32 nDelay);
-	void Initialize(bool bReset, DWORD MixingFreq);
+	void Initialize(bool bReset, uint32 MixingFreq);
 	void Process(int * MixSoundBuffer, int * MixRearBuffer, int count, uint32 nChannels);
 private:
 	void ProcessStereoSurround(int * MixSoundBuffer, int count);
@@ -109,7 +109,7 @@ public:
 	void SetSettings(const CMegaBassSettings &settings) { m_Settings = settings; }
 	// [XBass level 0(quiet)-100(loud)], [cutoff in Hz 10-100]
 	void SetXBassParameters(uint32 nDepth, uint32 nRange);
-	void Initialize(bool bReset, DWORD MixingFreq);
+	void Initialize(bool bReset, uint32 MixingFreq);
 	void Process(int * MixSoundBuffer, int * MixRearBuffer, int count, uint32 nChannels);
 };
 
@@ -10,10 +10,14 @@
 
 
 #include "stdafx.h"
-#include "../soundlib/MixerLoops.h"
 #include "../sounddsp/EQ.h"
 
-#include <cstddef>
+#include <algorithm>
+#include <cmath>
+
+#if defined(ENABLE_INTRINSICS_SSE2)
+#include <immintrin.h>
+#endif
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -27,7 +31,7 @@ OPENMPT_NAMESPACE_BEGIN
 
 
 
-static const UINT gEqLinearToDB[33] =
+static const uint32 gEqLinearToDB[33] =
 {
 	16, 19, 22, 25, 28, 31, 34, 37,
 	40, 43, 46, 49, 52, 55, 58, 61,
@@ -52,361 +56,175 @@ static const EQBANDSTRUCT gEQDefaults[MAX_EQ_BANDS*2] =
 	{0,0,0,0,0, 0,0,0,0, 1, 10000, false},
 };
 
-#ifdef ENABLE_X86
-
-#if MPT_COMPILER_MSVC
-#pragma warning(push)
-#pragma warning(disable:4100)
-#endif // MPT_COMPILER_MSVC
+// Identity filter for channels on which a band is not active, so that all channels can run through the same cascade of bands
+static const EQBANDSTRUCT gEQIdentity = {1,0,0,0,0, 0,0,0,0, 1, 0, false};
 
-#define PBS_A0	DWORD PTR [eax + EQBANDSTRUCT.a0]
-#define PBS_A1	DWORD PTR [eax + EQBANDSTRUCT.a1]
-#define PBS_A2	DWORD PTR [eax + EQBANDSTRUCT.a2]
-#define PBS_B1	DWORD PTR [eax + EQBANDSTRUCT.b1]
-#define PBS_B2	DWORD PTR [eax + EQBANDSTRUCT.b2]
-#define PBS_X1	DWORD PTR [eax + EQBANDSTRUCT.x1]
-#define PBS_X2	DWORD PTR [eax + EQBANDSTRUCT.x2]
-#define PBS_Y1	DWORD PTR [eax + EQBANDSTRUCT.y1]
-#define PBS_Y2	DWORD PTR [eax + EQBANDSTRUCT.y2]
 
-static void EQFilter(EQBANDSTRUCT *pbs, float32 *pbuffer, UINT nCount)
+static bool IsEQBandActive(const EQBANDSTRUCT &band)
 {
-	_asm {
-	mov eax, pbs		// eax = pbs
-	mov edx, nCount		// edx = nCount
-	mov ecx, pbuffer	// ecx = pbuffer
-	fld		PBS_Y2		// ST(3)=y2
-	fld		PBS_Y1		// ST(2)=y1
-	fld		PBS_X2		// ST(1)=x2
-	fld		PBS_X1		// ST(0)=x1
-EQ_Loop:
-	fld		DWORD PTR [ecx]		// ST(0):x ST(1):x1 ST(2):x2 ST(3):y1 ST(4):y2
-	fld		PBS_A0				// ST(0):a0 ST(1):x ST(2):x1 ST(3):x2 ST(4):y1 ST(5):y2
-	fmul	ST(0), ST(1)		// ST(0):a0*x
-	fld		PBS_A1				// ST(0):a1 ST(1):a0*x ST(2):x ST(3):x1 ST(4):x2 ST(5):y1 ST(6):y2
-	fmul	ST(0), ST(3)		// ST(0):a1*x1
-	add		ecx, 4
-
-	faddp	ST(1), ST(0)
-	fld		PBS_A2
-	fmul	ST(0), ST(4)
-	faddp	ST(1), ST(0)
-	fld		PBS_B1
-	fmul	ST(0), ST(5)
-	faddp	ST(1), ST(0)
-	fld		PBS_B2
-	fmul	ST(0), ST(6)
-	sub     edx, 1
-	faddp	ST(1), ST(0)
-	fst		DWORD PTR [ecx-4]		// *pbuffer = a0*x+a1*x1+a2*x2+b1*y1+b2*y2
-	// Here, ST(0)=y ST(1)=x ST(2)=x1 ST(3)=x2 ST(4)=y1 ST(5)=y2
-	fxch	ST(4)	// y1=y
-	fstp	ST(5)	// y2=y1
-	// Here, ST(0)=x ST(1)=x1 ST(2)=x2 ST(3)=y1 ST(4)=y2
-	fxch	ST(1)	// x1=x
-	fstp	ST(2)	// x2=x1
-	jnz		EQ_Loop
-	// Store x1,y1,x2,y2 and pop FPU stack
-	fstp	PBS_X1
-	fstp	PBS_X2
-	fstp	PBS_Y1
-	fstp	PBS_Y2
-	}
+	return band.bEnable && band.Gain != 1.0f;
 }
 
 
-#ifdef ENABLE_X86_AMD
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filter processing
+//
+// All channels are processed together, one channel per lane (front left, front right, rear left, rear right).
+// Every frame is converted from the fixed point mix, sent through all active bands and converted back,
+// so no intermediate floating point buffer is needed and the chunk size is not limited.
+// The filters run directly on the fixed point scale, which only differs from a normalized signal by a power of two.
+// The scalar and SSE2 versions perform the same operations in the same order (unless the compiler reorders them).
 
-static void AMD_StereoEQ(EQBANDSTRUCT *pbl, EQBANDSTRUCT *pbr, float32 *pbuffer, UINT nCount)
+// Coefficients and state of one band for all channels
+struct EQBandLanes
 {
-	float tmp[16];
-
-	_asm {
-	mov eax, pbl
-	mov edx, pbr
-	mov ebx, pbuffer
-	mov ecx, nCount
-	lea edi, [tmp+8]
-	and edi, 0xfffffff8
-	movd mm7, [eax+EQBANDSTRUCT.a0]
-	movd mm0, [edx+EQBANDSTRUCT.a0]
-	movd mm6, [eax+EQBANDSTRUCT.a1]
-	movd mm1, [edx+EQBANDSTRUCT.a1]
-	punpckldq mm7, mm0
-	punpckldq mm6, mm1
-	movq [edi], mm7						// [edi] = a0
-	movq [edi+8], mm6					// [edi+8] = a1
-	movd mm5, [eax+EQBANDSTRUCT.a2]
-	movd mm0, [edx+EQBANDSTRUCT.a2]
-	movd mm4, [eax+EQBANDSTRUCT.b1]
-	movd mm1, [edx+EQBANDSTRUCT.b1]
-	movd mm3, [eax+EQBANDSTRUCT.b2]
-	movd mm2, [edx+EQBANDSTRUCT.b2]
-	punpckldq mm5, mm0
-	punpckldq mm4, mm1
-	punpckldq mm3, mm2
-	movq [edi+16], mm5					// [edi+16] = a2
-	movq [edi+24], mm4					// [edi+24] = b1
-	movq [edi+32], mm3					// [edi+32] = b2
-	movd mm4, [eax+EQBANDSTRUCT.x1]
-	movd mm0, [edx+EQBANDSTRUCT.x1]
-	movd mm5, [eax+EQBANDSTRUCT.x2]
-	movd mm1, [edx+EQBANDSTRUCT.x2]
-	punpckldq mm4, mm0					// mm4 = x1
-	punpckldq mm5, mm1					// mm5 = x2
-	movd mm6, [eax+EQBANDSTRUCT.y1]
-	movd mm2, [edx+EQBANDSTRUCT.y1]
-	movd mm7, [eax+EQBANDSTRUCT.y2]
-	movd mm3, [edx+EQBANDSTRUCT.y2]
-	punpckldq mm6, mm2					// mm6 = y1
-	punpckldq mm7, mm3					// mm7 = y2
-mainloop:
-	movq mm0, [ebx]
-	movq mm3, [edi+8]
-	add ebx, 8
-	movq mm1, [edi+16]
-	pfmul mm3, mm4						// x1 * a1
-	movq mm2, [edi+32]
-	pfmul mm1, mm5						// x2 * a2
-	movq mm5, mm4						// x2 = x1
-	pfmul mm2, mm7						// y2 * b2
-	movq mm7, mm6						// y2 = y1
-	pfmul mm6, [edi+24]					// y1 * b1
-	movq mm4, mm0						// x1 = x
-	pfmul mm0, [edi]					// x * a0
-	pfadd mm6, mm1						// x2*a2 + y1*b1
-	pfadd mm6, mm2						// x2*a2 + y1*b1 + y2*b2
-	pfadd mm6, mm3						// x1*a1 + x2*a2 + y1*b1 + y2*b2
-	pfadd mm6, mm0						// x*a0 + x1*a1 + x2*a2 + y1*b1 + y2*b2
-	dec ecx
-	movq [ebx-8], mm6
-	jnz mainloop
-	movd [eax+EQBANDSTRUCT.x1], mm4
-	punpckhdq mm4, mm4
-	movd [eax+EQBANDSTRUCT.x2], mm5
-	punpckhdq mm5, mm5
-	movd [eax+EQBANDSTRUCT.y1], mm6
-	punpckhdq mm6, mm6
-	movd [eax+EQBANDSTRUCT.y2], mm7
-	punpckhdq mm7, mm7
-	movd [edx+EQBANDSTRUCT.x1], mm4
-	movd [edx+EQBANDSTRUCT.x2], mm5
-	movd [edx+EQBANDSTRUCT.y1], mm6
-	movd [edx+EQBANDSTRUCT.y2], mm7
-	emms
-	}
-}
-
-#endif // ENABLE_X86_AMD
-
-
-#ifdef ENABLE_SSE
-
-static void SSE_StereoEQ(EQBANDSTRUCT *pbl, EQBANDSTRUCT *pbr, float32 *pbuffer, UINT nCount)
-{
-	static const float gk1 = 1.0f;
-	_asm {
-	mov eax, pbl
-	mov edx, pbr
-	mov ebx, pbuffer
-	mov ecx, nCount
-	movss xmm0, [eax+EQBANDSTRUCT.Gain]
-	movss xmm1, gk1
-	comiss xmm0, xmm1
-	jne doeq
-	movss xmm0, [edx+EQBANDSTRUCT.Gain]
-	comiss xmm0, xmm1
-	je done
-doeq:
-	test ecx, ecx
-	jz done
-	movss xmm6, [eax+EQBANDSTRUCT.a1]
-	movss xmm7, [eax+EQBANDSTRUCT.a2]
-	movss xmm4, [eax+EQBANDSTRUCT.x1]
-	movss xmm5, [eax+EQBANDSTRUCT.x2]
-	movlhps xmm6, xmm7		// xmm6 = [  0 | a2 |  0 | a1 ]
-	movlhps xmm4, xmm5		// xmm4 = [  0 | x2 |  0 | x1 ]
-	movss xmm2, [edx+EQBANDSTRUCT.a1]
-	movss xmm3, [edx+EQBANDSTRUCT.a2]
-	movss xmm0, [edx+EQBANDSTRUCT.x1]
-	movss xmm1, [edx+EQBANDSTRUCT.x2]
-	movlhps xmm2, xmm3		// xmm2 = [ 0 | a'2 | 0 | a'1 ]
-	movlhps xmm0, xmm1		// xmm0 = [ 0 | x'2 | 0 | x'1 ]
-	shufps xmm6, xmm2, 0x88	// xmm6 = [ a'2 | a'1 | a2 | a1 ]
-	shufps xmm4, xmm0, 0x88 // xmm4 = [ x'2 | x'1 | x2 | x1 ]
-	shufps xmm6, xmm6, 0xD8	// xmm6 = [ a'2 | a2 | a'1 | a1 ]
-	shufps xmm4, xmm4, 0xD8	// xmm4 = [ x'2 | x2 | x'1 | x1 ]
-	movss xmm7, [eax+EQBANDSTRUCT.b1]
-	movss xmm0, [eax+EQBANDSTRUCT.b2]
-	movss xmm2, [edx+EQBANDSTRUCT.b1]
-	movss xmm1, [edx+EQBANDSTRUCT.b2]
-	movlhps xmm7, xmm0		// xmm7 = [ 0 |  b2 | 0 |  b1 ]
-	movlhps xmm2, xmm1		// xmm2 = [  0 | b'2 |  0 | b'1 ]
-	shufps xmm7, xmm2, 0x88	// xmm7 = [ b'2 | b'1 | b2 | b1 ]
-	shufps xmm7, xmm7, 0xD8 // xmm7 = [ b'2 | b2 | b'1 | b1 ]
-	movss xmm5, [eax+EQBANDSTRUCT.y1]
-	movss xmm1, [eax+EQBANDSTRUCT.y2]
-	movss xmm3, [edx+EQBANDSTRUCT.y1]
-	movss xmm0, [edx+EQBANDSTRUCT.y2]
-	movlhps xmm5, xmm1		// xmm5 = [  0 |  y2 |  0 |  y1 ]
-	movlhps xmm3, xmm0		// xmm3 = [  0 | y'2 |  0 | y'1 ]
-	shufps xmm5, xmm3, 0x88 // xmm5 = [ y'2 | y'1 | y2 | y1 ]
-	shufps xmm5, xmm5, 0xD8 // xmm5 = [ y'2 |  y2 | y'1 |  y1 ]
-	movss xmm3, [eax+EQBANDSTRUCT.a0]
-	movss xmm2, [edx+EQBANDSTRUCT.a0]
-	shufps xmm3, xmm2, 0x88
-	shufps xmm3, xmm3, 0xD8	// xmm3 = [  0 |  0 | a'0 | a0 ]
-mainloop:
-	movlps xmm0, qword ptr [ebx]
-	add ebx, 8
-	movaps xmm1, xmm5		// xmm1 = [ y2r | y2l | y1r | y1l ]
-	mulps xmm1, xmm7		// xmm1 = [b2r*y2r|b2l*y2l|b1r*y1r|b1l*y1l]
-	movaps xmm2, xmm4		// xmm2 = [ x2r | x2l | x1r | x1l ]
-	mulps xmm2, xmm6		// xmm6 = [a2r*x2r|a2l*x2l|a1r*x1r|a1l*x1l]
-	shufps xmm4, xmm0, 0x44 // xmm4 = [  xr |  xl | x1r | x1l ]
-	mulps xmm0, xmm3		// xmm0 = [   0 |   0 |a0r*xr|a0l*xl]
-	shufps xmm4, xmm4, 0x4E // xmm4 = [ x1r | x1l |  xr |  xl ]
-	addps xmm1, xmm2		// xmm1 = [b2r*y2r+a2r*x2r|b2l*y2l+a2l*x2l|b1r*y1r+a1r*x1r|b1l*y1l+a1l*x1l]
-	addps xmm1, xmm0		// xmm1 = [b2r*y2r+a2r*x2r|b2l*y2l+a2l*x2l|b1r*y1r+a1r*x1r+a0r*xr|b1l*y1l+a1l*x1l+a0l*xl]
-	sub ecx, 1
-	movhlps xmm0, xmm1
-	addps xmm0, xmm1		// xmm0 = [  ? |  ? | yr(n) | yl(n) ]
-	movlps [ebx-8], xmm0
-	shufps xmm0, xmm5, 0x44
-	movaps xmm5, xmm0
-	jnz mainloop
-	movhlps xmm0, xmm4
-	movhlps xmm1, xmm5
-	movss [eax+EQBANDSTRUCT.x1], xmm4
-	movss [eax+EQBANDSTRUCT.x2], xmm0
-	movss [eax+EQBANDSTRUCT.y1], xmm5
-	movss [eax+EQBANDSTRUCT.y2], xmm1
-	shufps xmm4, xmm4, 0x01
-	shufps xmm0, xmm0, 0x01
-	shufps xmm5, xmm5, 0x01
-	shufps xmm1, xmm1, 0x01
-	movss [edx+EQBANDSTRUCT.x1], xmm4
-	movss [edx+EQBANDSTRUCT.x2], xmm0
-	movss [edx+EQBANDSTRUCT.y1], xmm5
-	movss [edx+EQBANDSTRUCT.y2], xmm1
-done:;
-	}
-}
+	float32 a0[4], a1[4], a2[4], b1[4], b2[4];
+	float32 x1[4], x2[4], y1[4], y2[4];
+};
 
-#endif // ENABLE_SSE
+// Saturation limits for the conversion back to the fixed point mix (2^31 - 128 is the largest float below 2^31)
+static const float32 EQMixMin = -2147483648.0f;
+static const float32 EQMixMax = 2147483520.0f;
 
-#if MPT_COMPILER_MSVC
-#pragma warning(pop)
-#endif // MPT_COMPILER_MSVC
 
-#else
-
-static void EQFilter(EQBANDSTRUCT *pbs, float32 *pbuffer, UINT nCount)
+template<uint32 channels>
+static void EQProcess(EQBandLanes *bands, uint32 numBands, int *frontBuffer, int *rearBuffer, uint32 nCount)
 {
-	for (UINT i=0; i<nCount; i++)
+	const uint32 frontChannels = (channels == 1) ? 1 : 2;
+	for(uint32 i = 0; i < nCount; i++)
 	{
-		float32 x = pbuffer[i];
-		float32 y = pbs->a1 * pbs->x1 + pbs->a2 * pbs->x2 + pbs->a0 * x + pbs->b1 * pbs->y1 + pbs->b2 * pbs->y2;
-		pbs->x2 = pbs->x1;
-		pbs->y2 = pbs->y1;
-		pbs->x1 = x;
-		pbuffer[i] = y;
-		pbs->y1 = y;
+		float32 x[channels];
+		for(uint32 c = 0; c < channels; c++)
+		{
+			x[c] = static_cast<float32>((c < 2) ? frontBuffer[i * frontChannels + c] : rearBuffer[i * 2 + c - 2]);
+		}
+		for(uint32 b = 0; b < numBands; b++)
+		{
+			EQBandLanes &band = bands[b];
+			for(uint32 c = 0; c < channels; c++)
+			{
+				const float32 y = band.a1[c] * band.x1[c] + band.a2[c] * band.x2[c] + band.b2[c] * band.y2[c] + band.a0[c] * x[c] + band.b1[c] * band.y1[c];
+				band.x2[c] = band.x1[c];
+				band.x1[c] = x[c];
+				band.y2[c] = band.y1[c];
+				band.y1[c] = y;
+				x[c] = y;
+			}
+		}
+		for(uint32 c = 0; c < channels; c++)
+		{
+			const int out = static_cast<int>(std::min(std::max(x[c], EQMixMin), EQMixMax));
+			if(c < 2)
+				frontBuffer[i * frontChannels + c] = out;
+			else
+				rearBuffer[i * 2 + c - 2] = out;
+		}
 	}
 }
 
-#endif
 
+#ifdef ENABLE_INTRINSICS_SSE2
 
-void CEQ::ProcessMono(int *pbuffer, float *MixFloatBuffer, UINT nCount)
+template<uint32 channels>
+static MPT_TARGET_SSE2 void EQProcessSSE2(EQBandLanes *bands, uint32 numBands, int *frontBuffer, int *rearBuffer, uint32 nCount)
 {
-	MonoMixToFloat(pbuffer, MixFloatBuffer, nCount, 1.0f/MIXING_SCALEF);
-	for (UINT b=0; b<MAX_EQ_BANDS; b++)
+	__m128 a0[MAX_EQ_BANDS], a1[MAX_EQ_BANDS], a2[MAX_EQ_BANDS], b1[MAX_EQ_BANDS], b2[MAX_EQ_BANDS];
+	__m128 x1[MAX_EQ_BANDS], x2[MAX_EQ_BANDS], y1[MAX_EQ_BANDS], y2[MAX_EQ_BANDS];
+	for(uint32 b = 0; b < numBands; b++)
 	{
-		if ((gEQ[b].bEnable) && (gEQ[b].Gain != 1.0f)) EQFilter(&gEQ[b], MixFloatBuffer, nCount);
+		a0[b] = _mm_loadu_ps(bands[b].a0);
+		a1[b] = _mm_loadu_ps(bands[b].a1);
+		a2[b] = _mm_loadu_ps(bands[b].a2);
+		b1[b] = _mm_loadu_ps(bands[b].b1);
+		b2[b] = _mm_loadu_ps(bands[b].b2);
+		x1[b] = _mm_loadu_ps(bands[b].x1);
+		x2[b] = _mm_loadu_ps(bands[b].x2);
+		y1[b] = _mm_loadu_ps(bands[b].y1);
+		y2[b] = _mm_loadu_ps(bands[b].y2);
 	}
-	FloatToMonoMix(MixFloatBuffer, pbuffer, nCount, MIXING_SCALEF);
-}
+	const __m128 mixMin = _mm_set1_ps(EQMixMin), mixMax = _mm_set1_ps(EQMixMax);
 
+	// Decaying filter tails would otherwise produce denormals
+	const unsigned int csr = _mm_getcsr();
+	_mm_setcsr(csr | 0x8000);	// Flush to zero
 
-void CEQ::ProcessStereo(int *pbuffer, float *MixFloatBuffer, UINT nCount)
-{
-
-#ifdef ENABLE_SSE
-
-	if(GetProcSupport() & PROCSUPPORT_SSE)
+	for(uint32 i = 0; i < nCount; i++)
 	{
-		int sse_state, sse_eqstate;
-		MonoMixToFloat(pbuffer, MixFloatBuffer, nCount*2, 1.0f/MIXING_SCALEF);
-
-		_asm stmxcsr sse_state;
-		sse_eqstate = sse_state | 0xFF80; // set flush-to-zero, denormals-are-zero, round-to-zero, mask all exception, leave flags alone
-		_asm ldmxcsr sse_eqstate;
-		for (UINT b=0; b<MAX_EQ_BANDS; b++)
+		__m128i in;
+		MPT_CONSTANT_IF(channels == 1)
+			in = _mm_cvtsi32_si128(frontBuffer[i]);
+		else MPT_CONSTANT_IF(channels == 2)
+			in = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(frontBuffer + i * 2));
+		else
+			in = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(frontBuffer + i * 2)), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(rearBuffer + i * 2)));
+
+		__m128 x = _mm_cvtepi32_ps(in);
+		for(uint32 b = 0; b < numBands; b++)
 		{
-			if ((gEQ[b].bEnable) || (gEQ[b+MAX_EQ_BANDS].bEnable))
-				SSE_StereoEQ(&gEQ[b], &gEQ[b+MAX_EQ_BANDS], MixFloatBuffer, nCount);
+			__m128 y = _mm_mul_ps(a1[b], x1[b]);
+			y = _mm_add_ps(y, _mm_mul_ps(a2[b], x2[b]));
+			y = _mm_add_ps(y, _mm_mul_ps(b2[b], y2[b]));
+			y = _mm_add_ps(y, _mm_mul_ps(a0[b], x));
+			y = _mm_add_ps(y, _mm_mul_ps(b1[b], y1[b]));
+			x2[b] = x1[b];
+			x1[b] = x;
+			y2[b] = y1[b];
+			y1[b] = y;
+			x = y;
 		}
-		_asm ldmxcsr sse_state;
 
-		FloatToMonoMix(MixFloatBuffer, pbuffer, nCount*2, MIXING_SCALEF);
-
-	} else
-
-#endif // ENABLE_SSE
-
-#ifdef ENABLE_X86_AMD
-
-	if(GetProcSupport() & PROCSUPPORT_AMD_3DNOW)
-	{ 
-		MonoMixToFloat(pbuffer, MixFloatBuffer, nCount*2, 1.0f/MIXING_SCALEF);
-
-		for (UINT b=0; b<MAX_EQ_BANDS; b++)
+		const __m128i out = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(x, mixMin), mixMax));
+		MPT_CONSTANT_IF(channels == 1)
+		{
+			frontBuffer[i] = _mm_cvtsi128_si32(out);
+		} else
 		{
-			if (((gEQ[b].bEnable) && (gEQ[b].Gain != 1.0f))
-			 || ((gEQ[b+MAX_EQ_BANDS].bEnable) && (gEQ[b+MAX_EQ_BANDS].Gain != 1.0f)))
-				AMD_StereoEQ(&gEQ[b], &gEQ[b+MAX_EQ_BANDS], MixFloatBuffer, nCount);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(frontBuffer + i * 2), out);
+			MPT_CONSTANT_IF(channels == 4)
+				_mm_storel_epi64(reinterpret_cast<__m128i *>(rearBuffer + i * 2), _mm_unpackhi_epi64(out, out));
 		}
+	}
 
-		FloatToMonoMix(MixFloatBuffer, pbuffer, nCount*2, MIXING_SCALEF);
-		
-	} else
-#endif // ENABLE_X86_AMD
+	_mm_setcsr(csr);
 
-	{	
+	for(uint32 b = 0; b < numBands; b++)
+	{
+		_mm_storeu_ps(bands[b].x1, x1[b]);
+		_mm_storeu_ps(bands[b].x2, x2[b]);
+		_mm_storeu_ps(bands[b].y1, y1[b]);
+		_mm_storeu_ps(bands[b].y2, y2[b]);
+	}
+}
 
-		StereoMixToFloat(pbuffer, MixFloatBuffer, MixFloatBuffer+MIXBUFFERSIZE, nCount, 1.0f/MIXING_SCALEF);
-		
-		for (UINT bl=0; bl<MAX_EQ_BANDS; bl++)
-		{
-			if ((gEQ[bl].bEnable) && (gEQ[bl].Gain != 1.0f)) EQFilter(&gEQ[bl], MixFloatBuffer, nCount);
-		}
-		for (UINT br=MAX_EQ_BANDS; br<MAX_EQ_BANDS*2; br++)
-		{
-			if ((gEQ[br].bEnable) && (gEQ[br].Gain != 1.0f)) EQFilter(&gEQ[br], MixFloatBuffer+MIXBUFFERSIZE, nCount);
-		}
+#endif // ENABLE_INTRINSICS_SSE2
 
-		FloatToStereoMix(MixFloatBuffer, MixFloatBuffer+MIXBUFFERSIZE, pbuffer, nCount, MIXING_SCALEF);
 
+template<uint32 channels>
+static void EQProcessChannels(EQBandLanes *bands, uint32 numBands, int *frontBuffer, int *rearBuffer, uint32 nCount)
+{
+#ifdef ENABLE_INTRINSICS_SSE2
+	if(GetProcSupport() & PROCSUPPORT_SSE2)
+	{
+		EQProcessSSE2<channels>(bands, numBands, frontBuffer, rearBuffer, nCount);
+		return;
 	}
+#endif // ENABLE_INTRINSICS_SSE2
+	EQProcess<channels>(bands, numBands, frontBuffer, rearBuffer, nCount);
 }
 
 
 CEQ::CEQ()
 {
-	#if defined(ENABLE_SSE) || defined(ENABLE_X86_AMD)
-		MPT_ASSERT_ALWAYS(((uintptr_t)&(gEQ[0])) % 4 == 0);
-		MPT_ASSERT_ALWAYS(((uintptr_t)&(gEQ[1])) % 4 == 0);
-	#endif // ENABLE_SSE || ENABLE_X86_AMD
 	memcpy(gEQ, gEQDefaults, sizeof(gEQ));
 }
 
 
-void CEQ::Initialize(bool bReset, DWORD MixingFreq)
+void CEQ::Initialize(bool bReset, uint32 MixingFreq)
 {
 	float32 fMixingFreq = (float32)MixingFreq;
 	// Gain = 0.5 (-6dB) .. 2 (+6dB)
-	for (UINT band=0; band<MAX_EQ_BANDS*2; band++) if (gEQ[band].bEnable)
+	for (uint32 band=0; band<MAX_EQ_BANDS*2; band++) if (gEQ[band].bEnable)
 	{
 		float32 k, k2, r, f;
 		float32 v0, v1;
@@ -482,18 +300,30 @@ void CEQ::Initialize(bool bReset, DWORD MixingFreq)
 	}
 }
 
+void CEQ::SetEQGains(const uint32 *pGains, uint32 nGains, const uint32 *pFreqs, bool bReset, uint32 MixingFreq)
+{
+	float32 gains[MAX_EQ_BANDS] = {}, freqs[MAX_EQ_BANDS] = {};
+	nGains = std::min(nGains, uint32(MAX_EQ_BANDS));
+	for (uint32 i=0; i<nGains; i++)
+	{
+		uint32 n = pGains[i];
+		if (n > 32) n = 32;
+		gains[i] = ((float32)gEqLinearToDB[n]) / 64.0f;
+		freqs[i] = pFreqs ? (float32)(int)pFreqs[i] : 0.0f;
+	}
+	SetEQGains(gains, nGains, freqs, bReset, MixingFreq);
+}
+
 
-void CEQ::SetEQGains(const UINT *pGains, UINT nGains, const UINT *pFreqs, bool bReset, DWORD MixingFreq)
+void CEQ::SetEQGains(const float32 *pGains, uint32 nGains, const float32 *pFreqs, bool bReset, uint32 MixingFreq)
 {
-	for (UINT i=0; i<MAX_EQ_BANDS; i++)
+	for (uint32 i=0; i<MAX_EQ_BANDS; i++)
 	{
 		float32 g, f = 0;
 		if (i < nGains)
 		{
-			UINT n = pGains[i];
-			if (n > 32) n = 32;
-			g = ((float32)gEqLinearToDB[n]) / 64.0f;
-			if (pFreqs) f = (float32)(int)pFreqs[i];
+			g = mpt::clamp(pGains[i], 0.25f, 4.0f);
+			if (pFreqs) f = pFreqs[i];
 		} else
 		{
 			g = 1;
@@ -516,30 +346,91 @@ void CEQ::SetEQGains(const UINT *pGains, UINT nGains, const UINT *pFreqs, bool b
 }
 
 
-void CQuadEQ::Initialize(bool bReset, DWORD MixingFreq)
+void CQuadEQ::Initialize(bool bReset, uint32 MixingFreq)
 {
 	front.Initialize(bReset, MixingFreq);
 	rear.Initialize(bReset, MixingFreq);
 }
 
-void CQuadEQ::SetEQGains(const UINT *pGains, UINT nGains, const UINT *pFreqs, bool bReset, DWORD MixingFreq)
+void CQuadEQ::SetEQGains(const uint32 *pGains, uint32 nGains, const uint32 *pFreqs, bool bReset, uint32 MixingFreq)
 {
 	front.SetEQGains(pGains, nGains, pFreqs, bReset, MixingFreq);
 	rear.SetEQGains(pGains, nGains, pFreqs, bReset, MixingFreq);
 }
 
-void CQuadEQ::Process(int *frontBuffer, int *rearBuffer, UINT nCount, UINT nChannels)
+void CQuadEQ::SetEQGains(const float32 *pGains, uint32 nGains, const float32 *pFreqs, bool bReset, uint32 MixingFreq)
 {
-	if(nChannels == 1)
+	front.SetEQGains(pGains, nGains, pFreqs, bReset, MixingFreq);
+	rear.SetEQGains(pGains, nGains, pFreqs, bReset, MixingFreq);
+}
+
+void CQuadEQ::Process(int *frontBuffer, int *rearBuffer, uint32 nCount, uint32 nChannels)
+{
+	if(nChannels != 1 && nChannels != 2 && nChannels != 4)
+	{
+		return;
+	}
+	EQBANDSTRUCT * const channelBands[4] = { front.gEQ, front.gEQ + MAX_EQ_BANDS, rear.gEQ, rear.gEQ + MAX_EQ_BANDS };
+
+	// Gather all bands that are active on any channel
+	EQBandLanes bands[MAX_EQ_BANDS];
+	uint32 bandIndex[MAX_EQ_BANDS];
+	uint32 numBands = 0;
+	for(uint32 b = 0; b < MAX_EQ_BANDS; b++)
+	{
+		bool active = false;
+		for(uint32 c = 0; c < nChannels; c++)
+		{
+			active = active || IsEQBandActive(channelBands[c][b]);
+		}
+		if(!active)
+		{
+			continue;
+		}
+		EQBandLanes &lanes = bands[numBands];
+		for(uint32 c = 0; c < 4; c++)
+		{
+			const EQBANDSTRUCT &band = (c < nChannels && IsEQBandActive(channelBands[c][b])) ? channelBands[c][b] : gEQIdentity;
+			lanes.a0[c] = band.a0;
+			lanes.a1[c] = band.a1;
+			lanes.a2[c] = band.a2;
+			lanes.b1[c] = band.b1;
+			lanes.b2[c] = band.b2;
+			lanes.x1[c] = band.x1;
+			lanes.x2[c] = band.x2;
+			lanes.y1[c] = band.y1;
+			lanes.y2[c] = band.y2;
+		}
+		bandIndex[numBands++] = b;
+	}
+	if(!numBands)
 	{
-		front.ProcessMono(frontBuffer, EQTempFloatBuffer, nCount);
-	} else if(nChannels == 2)
+		return;
+	}
+
+	switch(nChannels)
 	{
-		front.ProcessStereo(frontBuffer, EQTempFloatBuffer, nCount);
-	} else if(nChannels == 4)
+	case 1: EQProcessChannels<1>(bands, numBands, frontBuffer, rearBuffer, nCount); break;
+	case 2: EQProcessChannels<2>(bands, numBands, frontBuffer, rearBuffer, nCount); break;
+	case 4: EQProcessChannels<4>(bands, numBands, frontBuffer, rearBuffer, nCount); break;
+	}
+
+	for(uint32 i = 0; i < numBands; i++)
 	{
-		front.ProcessStereo(frontBuffer, EQTempFloatBuffer, nCount);
-		rear.ProcessStereo(rearBuffer, EQTempFloatBuffer, nCount);
+		const EQBandLanes &lanes = bands[i];
+		for(uint32 c = 0; c < nChannels; c++)
+		{
+			EQBANDSTRUCT &band = channelBands[c][bandIndex[i]];
+			if(!IsEQBandActive(band))
+			{
+				continue;
+			}
+			// Cut off decaying tails, so that they cannot turn into denormals in the next chunk
+			band.x1 = lanes.x1[c];
+			band.x2 = lanes.x2[c];
+			band.y1 = (std::abs(lanes.y1[c]) < EQ_ZERO) ? 0.0f : lanes.y1[c];
+			band.y2 = (std::abs(lanes.y2[c]) < EQ_ZERO) ? 0.0f : lanes.y2[c];
+		}
 	}
 }
 
@@ -11,7 +11,6 @@
 
 #pragma once
 
-#include "../soundlib/Mixer.h"	// For MIXBUFFERSIZE
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -35,30 +34,34 @@ typedef struct _EQBANDSTRUCT
 	bool bEnable;
 } EQBANDSTRUCT;
 
+// Filter bands of a left and right channel (gEQ[0 .. MAX_EQ_BANDS-1] and gEQ[MAX_EQ_BANDS .. 2*MAX_EQ_BANDS-1])
 class CEQ
 {
+	friend class CQuadEQ;
 private:
 	EQBANDSTRUCT gEQ[MAX_EQ_BANDS*2];
 public:
 	CEQ();
 public:
-	void Initialize(bool bReset, DWORD MixingFreq);
-	void ProcessStereo(int *pbuffer, float *MixFloatBuffer, UINT nCount);
-	void ProcessMono(int *pbuffer, float *MixFloatBuffer, UINT nCount);
-	void SetEQGains(const UINT *pGains, UINT nGains, const UINT *pFreqs, bool bReset, DWORD MixingFreq);
+	void Initialize(bool bReset, uint32 MixingFreq);
+	// Gains are 0 (-12dB) .. 16 (0dB) .. 32 (+12dB)
+	void SetEQGains(const uint32 *pGains, uint32 nGains, const uint32 *pFreqs, bool bReset, uint32 MixingFreq);
+	// Linear gains 0.25 (-12dB) .. 4 (+12dB), center frequencies in Hz
+	void SetEQGains(const float32 *pGains, uint32 nGains, const float32 *pFreqs, bool bReset, uint32 MixingFreq);
 };
 
 
+// Front and rear EQ. All channels are filtered in one pass over the fixed point mix, without an intermediate floating point buffer.
 class CQuadEQ
 {
 private:
 	CEQ front;
 	CEQ rear;
-	float EQTempFloatBuffer[MIXBUFFERSIZE * 2];
 public:
-	void Initialize(bool bReset, DWORD MixingFreq);
-	void Process(int *frontBuffer, int *rearBuffer, UINT nCount, UINT nChannels);
-	void SetEQGains(const UINT *pGains, UINT nGains, const UINT *pFreqs, bool bReset, DWORD MixingFreq);
+	void Initialize(bool bReset, uint32 MixingFreq);
+	void Process(int *frontBuffer, int *rearBuffer, uint32 nCount, uint32 nChannels);
+	void SetEQGains(const uint32 *pGains, uint32 nGains, const uint32 *pFreqs, bool bReset, uint32 MixingFreq);
+	void SetEQGains(const float32 *pGains, uint32 nGains, const float32 *pFreqs, bool bReset, uint32 MixingFreq);
 };
 
 
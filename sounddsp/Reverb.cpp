@@ -59,7 +59,7 @@ static MPT_FORCEINLINE void Store64SSE(LR16 *dst, __m128i src) { return _mm_stor
 CReverb::CReverb()
 {
 	// Shared reverb state
-	InitMixBuffer(MixReverbBuffer, static_cast<uint32>(mpt::size(MixReverbBuffer)));
+	AllocateMixBuffer(MIXBUFFERSIZE);
 
 	// Reverb mix buffers
 	MemsetZero(g_RefDelay);
@@ -417,6 +417,13 @@ mixsample_t *CReverb::GetReverbSendBuffer(uint32 nSamples)
 }
 
 
+void CReverb::AllocateMixBuffer(std::size_t chunkSize)
+{
+	MixReverbBuffer.Resize(chunkSize * 2);
+	gnReverbSend = 0; // buffer contents are gone
+}
+
+
 // Reverb
 void CReverb::Process(mixsample_t *MixSoundBuffer, uint32 nSamples)
 {
@@ -449,41 +456,49 @@ void CReverb::Process(mixsample_t *MixSoundBuffer, uint32 nSamples)
 	if (lDryVol < 8) lDryVol = 8;
 	if (lDryVol > 16) lDryVol = 16;
 	lDryVol = 16 - (((16-lDryVol) * lMaxRvbGain) >> 15);
-	ReverbDryMix(MixSoundBuffer, MixReverbBuffer, lDryVol, nSamples);
-	// Downsample 2x + 1st stage of lowpass filter
-	nIn = ReverbProcessPreFiltering1x(MixReverbBuffer, nSamples);
-	nOut = nIn;
-	// Main reverb processing: split into small chunks (needed for short reverb delays)
-	// Reverb Input + Low-Pass stage #2 + Pre-diffusion
-	if (nIn > 0) ProcessPreDelay(&g_RefDelay, MixReverbBuffer, nIn);
-	// Process Reverb Reflections and Late Reverberation
-	int32 *pRvbOut = MixReverbBuffer;
-	uint32 nRvbSamples = nOut, nCount = 0;
-	while (nRvbSamples > 0)
+	// The pre-delay line must not be filled faster than the reflections consume it,
+	// so bigger mix chunks are processed in blocks of at most MIXBUFFERSIZE frames.
+	for(uint32 blockOffset = 0; blockOffset < nSamples; blockOffset += MIXBUFFERSIZE)
 	{
-		uint32 nPosRef = g_RefDelay.nRefOutPos & SNDMIX_REVERB_DELAY_MASK;
-		uint32 nPosRvb = (nPosRef - g_LateReverb.nReverbDelay) & SNDMIX_REVERB_DELAY_MASK;
-		uint32 nmax1 = (SNDMIX_REVERB_DELAY_MASK+1) - nPosRef;
-		uint32 nmax2 = (SNDMIX_REVERB_DELAY_MASK+1) - nPosRvb;
-		nmax1 = (nmax1 < nmax2) ? nmax1 : nmax2;
-		uint32 n = nRvbSamples;
-		if (n > nmax1) n = nmax1;
-		if (n > 64) n = 64;
-		// Reflections output + late reverb delay
-		ProcessReflections(&g_RefDelay, &g_RefDelay.RefOut[nPosRef], pRvbOut, n);
-		// Late Reverberation
-		ProcessLateReverb(&g_LateReverb, &g_RefDelay.RefOut[nPosRvb], pRvbOut, n);
-		// Update delay positions
-		g_RefDelay.nRefOutPos = (g_RefDelay.nRefOutPos + n) & SNDMIX_REVERB_DELAY_MASK;
-		g_RefDelay.nDelayPos = (g_RefDelay.nDelayPos + n) & SNDMIX_REFLECTIONS_DELAY_MASK;
-		nCount += n*2;
-		pRvbOut += n*2;
-		nRvbSamples -= n;
+		const uint32 blockSamples = std::min(nSamples - blockOffset, uint32(MIXBUFFERSIZE));
+		int32 *pDry = MixSoundBuffer + blockOffset * 2;
+		int32 *pWet = MixReverbBuffer + blockOffset * 2;
+		ReverbDryMix(pDry, pWet, lDryVol, blockSamples);
+		// Downsample 2x + 1st stage of lowpass filter
+		nIn = ReverbProcessPreFiltering1x(pWet, blockSamples);
+		nOut = nIn;
+		// Main reverb processing: split into small chunks (needed for short reverb delays)
+		// Reverb Input + Low-Pass stage #2 + Pre-diffusion
+		if (nIn > 0) ProcessPreDelay(&g_RefDelay, pWet, nIn);
+		// Process Reverb Reflections and Late Reverberation
+		int32 *pRvbOut = pWet;
+		uint32 nRvbSamples = nOut, nCount = 0;
+		while (nRvbSamples > 0)
+		{
+			uint32 nPosRef = g_RefDelay.nRefOutPos & SNDMIX_REVERB_DELAY_MASK;
+			uint32 nPosRvb = (nPosRef - g_LateReverb.nReverbDelay) & SNDMIX_REVERB_DELAY_MASK;
+			uint32 nmax1 = (SNDMIX_REVERB_DELAY_MASK+1) - nPosRef;
+			uint32 nmax2 = (SNDMIX_REVERB_DELAY_MASK+1) - nPosRvb;
+			nmax1 = (nmax1 < nmax2) ? nmax1 : nmax2;
+			uint32 n = nRvbSamples;
+			if (n > nmax1) n = nmax1;
+			if (n > 64) n = 64;
+			// Reflections output + late reverb delay
+			ProcessReflections(&g_RefDelay, &g_RefDelay.RefOut[nPosRef], pRvbOut, n);
+			// Late Reverberation
+			ProcessLateReverb(&g_LateReverb, &g_RefDelay.RefOut[nPosRvb], pRvbOut, n);
+			// Update delay positions
+			g_RefDelay.nRefOutPos = (g_RefDelay.nRefOutPos + n) & SNDMIX_REVERB_DELAY_MASK;
+			g_RefDelay.nDelayPos = (g_RefDelay.nDelayPos + n) & SNDMIX_REFLECTIONS_DELAY_MASK;
+			nCount += n*2;
+			pRvbOut += n*2;
+			nRvbSamples -= n;
+		}
+		// Adjust nDelayPos, in case nIn != nOut
+		g_RefDelay.nDelayPos = (g_RefDelay.nDelayPos - nOut + nIn) & SNDMIX_REFLECTIONS_DELAY_MASK;
+		// Upsample 2x
+		ReverbProcessPostFiltering1x(pWet, pDry, blockSamples);
 	}
-	// Adjust nDelayPos, in case nIn != nOut
-	g_RefDelay.nDelayPos = (g_RefDelay.nDelayPos - nOut + nIn) & SNDMIX_REFLECTIONS_DELAY_MASK;
-	// Upsample 2x
-	ReverbProcessPostFiltering1x(MixReverbBuffer, MixSoundBuffer, nSamples);
 	// Automatically shut down if needed
 	if(gnReverbSend) gnReverbSamples = gnReverbDecaySamples; // reset decay counter
 	else if(gnReverbSamples > nSamples) gnReverbSamples -= nSamples; // decay
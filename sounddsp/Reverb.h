@@ -13,6 +13,7 @@
 #ifndef NO_REVERB
 
 #include "../soundlib/Mixer.h"	// For MIXBUFFERSIZE
+#include "../soundlib/MixBuffer.h"
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -140,7 +141,7 @@ public:
 
 	// Shared reverb state
 private:
-	mixsample_t MixReverbBuffer[MIXBUFFERSIZE * 2];
+	AlignedMixBuffer<mixsample_t> MixReverbBuffer;
 public:
 	mixsample_t gnRvbROfsVol = 0, gnRvbLOfsVol = 0;
 
@@ -175,9 +176,13 @@ public:
 
 	// can be called multiple times or never (if no data is sent to reverb)
 	mixsample_t *GetReverbSendBuffer(uint32 nSamples);
+	// Allocate the reverb send buffer for the given mix chunk size
+	void AllocateMixBuffer(std::size_t chunkSize);
 
 	// call once after all data has been sent.
 	void Process(mixsample_t *MixSoundBuffer, uint32 nSamples);
+	// Returns false if there is no reverb input and the reverb tail has decayed completely
+	bool IsActive() const { return gnReverbSend || gnReverbSamples; }
 
 private:
 	void Shutdown();
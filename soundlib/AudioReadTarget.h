@@ -20,6 +20,71 @@
 OPENMPT_NAMESPACE_BEGIN
 
 
+// Copy the floating point master mix to the output buffer(s).
+// Only floating point targets accept the float mix, so the generic version is never called.
+template<bool clipOutput, typename Tsample>
+void CopyFloatMix(Tsample * /*outputBuffer*/, Tsample * const * /*outputBuffers*/, std::size_t /*offset*/, const float * /*mixBuffer*/, std::size_t /*channels*/, std::size_t /*countChunk*/)
+{
+	MPT_ASSERT_NOTREACHED();
+}
+
+template<bool clipOutput>
+MPT_FORCEINLINE float ClipFloatMix(float sample)
+{
+	MPT_CONSTANT_IF(clipOutput)
+	{
+		if(sample < -1.0f) sample = -1.0f;
+		if(sample > 1.0f) sample = 1.0f;
+	}
+	return sample;
+}
+
+template<bool clipOutput>
+void CopyFloatMix(float *outputBuffer, float * const *outputBuffers, std::size_t offset, const float *mixBuffer, std::size_t channels, std::size_t countChunk)
+{
+	if(outputBuffer)
+	{
+		float *out = outputBuffer + (channels * offset);
+		for(std::size_t i = 0; i < channels * countChunk; ++i)
+		{
+			out[i] = ClipFloatMix<clipOutput>(mixBuffer[i]);
+		}
+	}
+	if(outputBuffers)
+	{
+		for(std::size_t channel = 0; channel < channels; ++channel)
+		{
+			float *out = outputBuffers[channel] + offset;
+			for(std::size_t frame = 0; frame < countChunk; ++frame)
+			{
+				out[frame] = ClipFloatMix<clipOutput>(mixBuffer[frame * channels + channel]);
+			}
+		}
+	}
+}
+
+
+// Convert the fixed point master mix to the output buffer(s) using SIMD instructions.
+// Returns false if there is no optimized version for this sample format, in which case the generic conversion functions have to be used.
+template<bool clipOutput, typename Tsample>
+bool ConvertFixedPointMixSIMD(Tsample * /*outputBuffer*/, Tsample * const * /*outputBuffers*/, std::size_t /*offset*/, const int32 * /*mixBuffer*/, std::size_t /*channels*/, std::size_t /*countChunk*/)
+{
+	return false;
+}
+
+template<bool clipOutput>
+bool ConvertFixedPointMixSIMD(int16 *outputBuffer, int16 * const *outputBuffers, std::size_t offset, const int32 *mixBuffer, std::size_t channels, std::size_t countChunk)
+{
+	return ConvertMixToInt16SIMD(outputBuffer, outputBuffers, offset, mixBuffer, channels, countChunk);
+}
+
+template<bool clipOutput>
+bool ConvertFixedPointMixSIMD(float *outputBuffer, float * const *outputBuffers, std::size_t offset, const int32 *mixBuffer, std::size_t channels, std::size_t countChunk)
+{
+	return ConvertMixToFloatSIMD(outputBuffer, outputBuffers, offset, mixBuffer, channels, countChunk, clipOutput);
+}
+
+
 template<typename Tsample, bool clipOutput = false>
 class AudioReadTargetBuffer
 	: public IAudioReadTarget
@@ -52,6 +117,12 @@ public:
 			dither.Process(MixSoundBuffer, countChunk, channels, sampleFormat.GetBitsPerSample());
 		}
 
+		if(ConvertFixedPointMixSIMD<clipOutput>(outputBuffer, outputBuffers, countRendered, MixSoundBuffer, channels, countChunk))
+		{
+			countRendered += countChunk;
+			return;
+		}
+
 		if(outputBuffer)
 		{
 			ConvertInterleavedFixedPointToInterleaved<MIXING_FRACTIONAL_BITS, clipOutput>(outputBuffer + (channels * countRendered), MixSoundBuffer, channels, countChunk);
@@ -68,6 +139,16 @@ public:
 
 		countRendered += countChunk;
 	}
+	bool AcceptsFloatMix() const override
+	{
+		return SampleFormat(SampleFormatTraits<Tsample>::sampleFormat).IsFloat();
+	}
+	void FloatDataCallback(float *MixFloatBuffer, std::size_t channels, std::size_t countChunk) override
+	{
+		// Floating point output does not need any dithering, so just copy (and optionally clip) the mix
+		CopyFloatMix<clipOutput>(outputBuffer, outputBuffers, countRendered, MixFloatBuffer, channels, countChunk);
+		countRendered += countChunk;
+	}
 };
 
 
@@ -269,6 +350,14 @@ public:
 		ApplyGainAfterConversionIfAppropriate<Tsample>(Tbase::outputBuffer, Tbase::outputBuffers, countRendered_, channels, countChunk, gainFactor);
 
 	}
+	void FloatDataCallback(float *MixFloatBuffer, std::size_t channels, std::size_t countChunk) override
+	{
+		const std::size_t countRendered_ = Tbase::GetRenderedCount();
+
+		Tbase::FloatDataCallback(MixFloatBuffer, channels, countChunk);
+
+		ApplyGainAfterConversionIfAppropriate<Tsample>(Tbase::outputBuffer, Tbase::outputBuffers, countRendered_, channels, countChunk, gainFactor);
+	}
 };
 
 
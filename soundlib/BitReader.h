@@ -5,6 +5,7 @@
  * Notes  : The current implementation can only read bit widths up to 32 bits, and it always
  *          reads bits starting from the least significant bit, as this is all that is
  *          required by the class users at the moment.
+ *          The bit buffer is refilled a 64-bit word at a time where possible.
  * Authors: OpenMPT Devs
  * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
  */
@@ -25,7 +26,7 @@ class BitReader : private FileReader
 {
 protected:
 	off_t m_bufPos = 0, m_bufSize = 0;
-	uint32 bitBuf = 0; // Current bit buffer
+	uint64 bitBuf = 0; // Current bit buffer. Bits above m_bitNum are either zero or already contain the next bits from the buffer.
 	int m_bitNum = 0;  // Currently available number of bits
 	mpt::byte buffer[mpt::IO::BUFFERSIZE_TINY];
 
@@ -52,6 +53,33 @@ public:
 
 	uint32 ReadBits(int numBits)
 	{
+		if(m_bitNum < numBits)
+		{
+			Refill(numBits);
+		}
+
+		uint32 v = static_cast<uint32>(bitBuf & ((uint64(1) << numBits) - 1));
+		bitBuf >>= numBits;
+		m_bitNum -= numBits;
+		return v;
+	}
+
+protected:
+
+	void Refill(int numBits)
+	{
+		if(m_bufSize - m_bufPos >= sizeof(uint64le))
+		{
+			// Fetch as many whole bytes as fit into the bit buffer at once.
+			// The bits of the following byte that do not fully fit are also stored, which is harmless as the next refill will write the same bits again.
+			uint64le word;
+			std::memcpy(&word, buffer + m_bufPos, sizeof(word));
+			bitBuf |= static_cast<uint64>(word) << m_bitNum;
+			const int numBytes = (63 - m_bitNum) / 8;
+			m_bufPos += numBytes;
+			m_bitNum += numBytes * 8;
+			return;
+		}
 		while(m_bitNum < numBits)
 		{
 			// Fetch more bits
@@ -64,14 +92,9 @@ public:
 					throw eof();
 				}
 			}
-			bitBuf |= (static_cast<uint32>(buffer[m_bufPos++]) << m_bitNum);
+			bitBuf |= (static_cast<uint64>(buffer[m_bufPos++]) << m_bitNum);
 			m_bitNum += 8;
 		}
-
-		uint32 v = bitBuf & ((1 << numBits) - 1);
-		bitBuf >>= numBits;
-		m_bitNum -= numBits;
-		return v;
 	}
 };
 
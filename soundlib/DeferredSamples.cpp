@@ -0,0 +1,334 @@
+/*
+ * DeferredSamples.cpp
+ * -------------------
+ * Purpose: Sample data that is only decoded when the sample is played for the first time.
+ * Notes  : Loaders that support it only prepare the sample header and remember the sample data's location and encoding.
+ *          The data is decoded on a background thread, either when the sample is used by a note for the first time, or earlier
+ *          if the thread is asked to decode all samples. Notes of a sample stay silent until its data has been published.
+ *          A thread that decodes a sample does so into its own buffer, and the first one to finish publishes it, so the
+ *          playback thread never has to wait for the background thread.
+ *          Only the playback thread ever modifies the ModSample, so the mixer can read it without synchronization.
+ *          The same mechanism is used to decode all sample data on several threads at the end of CSoundFile::Create,
+ *          and to let uncompressed samples reference the file data instead of decoding them (see CSoundFile::SetSamplePinning).
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "DeferredSamples.h"
+#include "Sndfile.h"
+#include "../common/mptThreadPool.h"
+#include <algorithm>
+#if defined(MPT_ENABLE_THREAD)
+#include <chrono>
+#endif // MPT_ENABLE_THREAD
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+DeferredSamples::~DeferredSamples()
+{
+	Clear();
+}
+
+
+void DeferredSamples::Add(SAMPLEINDEX smp, const SampleIO &sampleIO, const FileReader &file)
+{
+	if(smp >= m_entries.size())
+	{
+		m_entries.resize(smp + 1);
+	}
+	m_entries[smp] = mpt::make_unique<Entry>();
+	m_entries[smp]->file = file;
+	m_entries[smp]->sampleIO = sampleIO;
+}
+
+
+void *DeferredSamples::Decode(const Entry &entry, const ModSample &header, CSoundFile &sndFile)
+{
+	ModSample sample = header;
+	sample.pData.pSample = nullptr;
+	FileReader file = entry.file;
+	entry.sampleIO.ReadSample(sample, file);
+	// The header has already been prepared with the same length limits
+	MPT_ASSERT(!sample.HasSampleData() || sample.nLength == header.nLength);
+	sample.PrecomputeLoops(sndFile, false);
+	return sample.samplev();
+}
+
+
+void *DeferredSamples::Publish(Entry &entry, void *data)
+{
+	void *expected = nullptr;
+	if(data == nullptr)
+	{
+		return entry.data.load(std::memory_order_acquire);
+	}
+	if(!entry.data.compare_exchange_strong(expected, data, std::memory_order_acq_rel))
+	{
+		// The other thread was faster
+		ModSample::FreeSample(data);
+		return expected;
+	}
+	return data;
+}
+
+
+void DeferredSamples::HandOver(SAMPLEINDEX smp, void *data, CSoundFile &sndFile)
+{
+	ModSample &sample = sndFile.GetSample(smp);
+	m_entries[smp]->resolved = true;
+	if(data != nullptr)
+	{
+		sample.pData.pSample = data;
+	} else
+	{
+		// Out of memory
+		sample.nLength = 0;
+	}
+}
+
+
+void DeferredSamples::Resolve(SAMPLEINDEX smp, CSoundFile &sndFile)
+{
+	if(!IsPending(smp))
+	{
+		return;
+	}
+	Entry &entry = *m_entries[smp];
+	void *data = entry.data.load(std::memory_order_acquire);
+	if(data == nullptr)
+	{
+		entry.claimed.store(true, std::memory_order_relaxed);
+		data = Publish(entry, Decode(entry, sndFile.GetSample(smp), sndFile));
+	}
+	HandOver(smp, data, sndFile);
+}
+
+
+bool DeferredSamples::Request(SAMPLEINDEX smp, CSoundFile &sndFile)
+{
+	if(!IsPending(smp))
+	{
+		return true;
+	}
+#if defined(MPT_ENABLE_THREAD)
+	Entry &entry = *m_entries[smp];
+	void *data = entry.data.load(std::memory_order_acquire);
+	if(data == nullptr && entry.failed.load(std::memory_order_acquire))
+	{
+		HandOver(smp, nullptr, sndFile);
+		return true;
+	} else if(data != nullptr)
+	{
+		HandOver(smp, data, sndFile);
+		return true;
+	}
+	if(!entry.requested.exchange(true, std::memory_order_relaxed))
+	{
+		if(!m_thread.joinable())
+		{
+			// Nobody started the background thread when loading the module
+			StartBackgroundDecoding(sndFile, false);
+		}
+		m_hasRequests.store(true, std::memory_order_release);
+		// The mutex is not locked here, so that the playback thread never has to wait for the background thread.
+		// A notification that is missed because of that only delays the request until the background thread wakes up by itself.
+		m_wakeCondition.notify_one();
+	}
+	return false;
+#else
+	Resolve(smp, sndFile);
+	return true;
+#endif // MPT_ENABLE_THREAD
+}
+
+
+bool DeferredSamples::Pin(SAMPLEINDEX smp, CSoundFile &sndFile)
+{
+	if(!IsPending(smp) || !m_entries[smp]->sampleIO.IsNativePCM())
+	{
+		return false;
+	}
+	Entry &entry = *m_entries[smp];
+	ModSample &sample = sndFile.GetSample(smp);
+	if(sample.nLength < ModSample::GetMinPinnedLength() || !entry.file.CanRead(sample.GetSampleSizeInBytes()))
+	{
+		// Truncated samples are padded with silence when decoding them
+		return false;
+	}
+	// For stream-backed files, this caches the complete file, so the data pointer stays valid as long as the file is alive.
+	const mpt::byte *data = entry.file.GetRawData();
+	if(sample.GetElementarySampleSize() > 1 && (reinterpret_cast<uintptr_t>(data) % sample.GetElementarySampleSize()) != 0)
+	{
+		return false;
+	}
+	if(!sample.PinSampleData(data))
+	{
+		return false;
+	}
+	sample.PrecomputeLoops(sndFile, false);
+	if(!m_pinnedFile.IsValid())
+	{
+		m_pinnedFile = entry.file;
+	}
+	m_entries[smp] = nullptr;
+	return true;
+}
+
+
+void DeferredSamples::DecodeAll(CSoundFile &sndFile, std::size_t numThreads)
+{
+	std::vector<SAMPLEINDEX> pending;
+	for(SAMPLEINDEX smp = 0; smp < m_entries.size(); smp++)
+	{
+		if(IsPending(smp))
+		{
+			pending.push_back(smp);
+		}
+	}
+	if(pending.empty())
+	{
+		return;
+	}
+	// Start with the longest samples so that the threads finish at roughly the same time
+	std::stable_sort(pending.begin(), pending.end(), [&sndFile](SAMPLEINDEX a, SAMPLEINDEX b)
+	{
+		return sndFile.GetSample(a).GetSampleSizeInBytes() > sndFile.GetSample(b).GetSampleSizeInBytes();
+	});
+	if(numThreads == 0)
+	{
+		numThreads = mpt::thread_pool::hardware_concurrency();
+	}
+	mpt::thread_pool pool(std::min(numThreads, pending.size()));
+	pool.parallel_for(pending.size(), [&](std::size_t i)
+	{
+		Entry &entry = *m_entries[pending[i]];
+		entry.claimed.store(true, std::memory_order_relaxed);
+		Publish(entry, Decode(entry, sndFile.GetSample(pending[i]), sndFile));
+	});
+	for(SAMPLEINDEX smp : pending)
+	{
+		Resolve(smp, sndFile);
+		m_entries[smp] = nullptr;
+	}
+}
+
+
+void DeferredSamples::StartBackgroundDecoding(CSoundFile &sndFile, bool decodeAll)
+{
+#if defined(MPT_ENABLE_THREAD)
+	if(m_thread.joinable())
+	{
+		return;
+	}
+	m_decodeAll = decodeAll;
+	// Take a copy of all sample headers now, as the playback thread may modify the samples while the background thread is running.
+	for(SAMPLEINDEX smp = 0; smp < m_entries.size(); smp++)
+	{
+		if(IsPending(smp))
+		{
+			m_entries[smp]->header = sndFile.GetSample(smp);
+			m_entries[smp]->header.pData.pSample = nullptr;
+		}
+	}
+	m_stopThread = false;
+	m_hasRequests = false;
+	m_thread = std::thread([this, &sndFile]() { DecodeInBackground(sndFile); });
+#else
+	MPT_UNREFERENCED_PARAMETER(sndFile);
+	MPT_UNREFERENCED_PARAMETER(decodeAll);
+#endif // MPT_ENABLE_THREAD
+}
+
+
+void DeferredSamples::DecodeInBackground(CSoundFile &sndFile)
+{
+#if defined(MPT_ENABLE_THREAD)
+	std::size_t nextEntry = 0;	// Next sample to decode if all samples are decoded
+	while(!m_stopThread)
+	{
+		if(m_hasRequests.exchange(false, std::memory_order_acquire))
+		{
+			// Samples that are waiting to be played come first
+			for(auto &entry : m_entries)
+			{
+				if(m_stopThread)
+				{
+					break;
+				}
+				if(entry != nullptr && entry->requested.load(std::memory_order_relaxed) && !entry->claimed.exchange(true, std::memory_order_relaxed))
+				{
+					DecodeEntryInBackground(*entry, sndFile);
+				}
+			}
+			continue;
+		}
+		if(m_decodeAll && nextEntry < m_entries.size())
+		{
+			Entry *entry = m_entries[nextEntry++].get();
+			if(entry != nullptr && !entry->claimed.exchange(true, std::memory_order_relaxed))
+			{
+				DecodeEntryInBackground(*entry, sndFile);
+			}
+			continue;
+		}
+		if(std::all_of(m_entries.begin(), m_entries.end(), [](const std::unique_ptr<Entry> &entry) { return entry == nullptr || entry->claimed.load(std::memory_order_relaxed); }))
+		{
+			// Nothing left that could be requested
+			break;
+		}
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+		m_wakeCondition.wait_for(lock, std::chrono::milliseconds(10), [this]() { return m_stopThread || m_hasRequests; });
+	}
+#else
+	MPT_UNREFERENCED_PARAMETER(sndFile);
+#endif // MPT_ENABLE_THREAD
+}
+
+
+void DeferredSamples::DecodeEntryInBackground(Entry &entry, CSoundFile &sndFile)
+{
+	void *data = nullptr;
+	try
+	{
+		data = Publish(entry, Decode(entry, entry.header, sndFile));
+	} catch(...)
+	{
+		// Out of memory
+	}
+	if(data == nullptr)
+	{
+		// The playback thread would wait forever otherwise
+		entry.failed.store(true, std::memory_order_release);
+	}
+}
+
+
+void DeferredSamples::Clear()
+{
+#if defined(MPT_ENABLE_THREAD)
+	if(m_thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_wakeMutex);
+			m_stopThread = true;
+		}
+		m_wakeCondition.notify_one();
+		m_thread.join();
+	}
+#endif // MPT_ENABLE_THREAD
+	for(auto &entry : m_entries)
+	{
+		if(entry != nullptr && !entry->resolved)
+		{
+			ModSample::FreeSample(entry->data.load(std::memory_order_acquire));
+		}
+	}
+	m_entries.clear();
+	m_pinnedFile = FileReader();
+}
+
+
+OPENMPT_NAMESPACE_END
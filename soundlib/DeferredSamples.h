@@ -0,0 +1,111 @@
+/*
+ * DeferredSamples.h
+ * -----------------
+ * Purpose: Sample data that is only decoded when the sample is played for the first time.
+ * Notes  : See implementation file.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#if defined(MPT_ENABLE_THREAD)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif // MPT_ENABLE_THREAD
+#include "Snd_defs.h"
+#include "ModSample.h"
+#include "SampleIO.h"
+#include "../common/FileReader.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+class CSoundFile;
+
+
+class DeferredSamples
+{
+public:
+	DeferredSamples() = default;
+	~DeferredSamples();
+
+	DeferredSamples(const DeferredSamples &) = delete;
+	DeferredSamples & operator = (const DeferredSamples &) = delete;
+
+	// Remember where to decode the data of a sample from. The sample header must have been prepared with SampleIO::PrepareSample.
+	// The data referenced by file must stay valid until the sample has been decoded or Clear() has been called.
+	// For background decoding, file must be backed by memory, as stream-backed readers cannot be read from several threads.
+	void Add(SAMPLEINDEX smp, const SampleIO &sampleIO, const FileReader &file);
+
+	// Returns true if the sample data has been deferred and has not been handed to the sample yet.
+	bool IsPending(SAMPLEINDEX smp) const
+	{
+		return smp < m_entries.size() && m_entries[smp] != nullptr && !m_entries[smp]->resolved;
+	}
+
+	// Hand the decoded data to the sample, decoding it on the calling thread if the background thread has not finished it yet.
+	// This never waits for the background thread, but decoding may take long, so the playback routines use Request() instead.
+	// Must only be called from the thread that plays the module.
+	void Resolve(SAMPLEINDEX smp, CSoundFile &sndFile);
+
+	// Hand the decoded data to the sample if the background thread has finished it. Otherwise, let the background thread decode
+	// this sample next, starting the thread if necessary, and return false. The sample data is never decoded on the calling thread,
+	// unless there is no thread support. Returns true if the sample is not pending anymore.
+	// Must only be called from the thread that plays the module.
+	bool Request(SAMPLEINDEX smp, CSoundFile &sndFile);
+
+	// Let a pending sample reference the file data directly instead of decoding it, if it is stored as plain PCM in native byte order (see CSoundFile::SetSamplePinning).
+	// The file that the sample data is read from is kept alive until Clear() is called. Returns true if the sample data has been pinned.
+	// Must not be called while background decoding is running.
+	bool Pin(SAMPLEINDEX smp, CSoundFile &sndFile);
+
+	// Decode all pending samples using numThreads threads (0 = one per CPU core) and hand the data to the samples.
+	// Must be called from the thread that plays the module, and the sample headers must not be modified while it is running.
+	void DecodeAll(CSoundFile &sndFile, std::size_t numThreads);
+
+	// Start a background thread that decodes the samples passed to Request(), and all other pending samples as well if decodeAll is true.
+	void StartBackgroundDecoding(CSoundFile &sndFile, bool decodeAll);
+
+	// Stop background decoding, forget all pending samples and release the file that pinned sample data is read from.
+	// Must only be called once pinned samples are not played anymore.
+	void Clear();
+
+protected:
+	struct Entry
+	{
+		FileReader file;
+		SampleIO sampleIO;
+		ModSample header;						// Copy of the sample header for the background thread
+		std::atomic<void *> data{nullptr};		// Decoded sample data, published by the thread that finished decoding first
+		std::atomic<bool> claimed{false};		// Set once a thread has started decoding the sample
+		std::atomic<bool> requested{false};		// Set by the playback thread if the background thread should decode the sample next
+		std::atomic<bool> failed{false};		// Set by the background thread if the sample could not be decoded
+		bool resolved = false;					// Decoded data has been handed to the sample (only accessed by the playback thread)
+	};
+
+	static void *Decode(const Entry &entry, const ModSample &header, CSoundFile &sndFile);
+	static void *Publish(Entry &entry, void *data);
+	void HandOver(SAMPLEINDEX smp, void *data, CSoundFile &sndFile);
+	void DecodeInBackground(CSoundFile &sndFile);
+	void DecodeEntryInBackground(Entry &entry, CSoundFile &sndFile);
+
+	std::vector<std::unique_ptr<Entry>> m_entries;	// Indexed by sample index
+	FileReader m_pinnedFile;						// Keeps stream-backed file data alive for pinned samples
+#if defined(MPT_ENABLE_THREAD)
+	std::thread m_thread;
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeCondition;	// Wakes up the background thread when there are new requests or it should stop
+	std::atomic<bool> m_hasRequests{false};
+	std::atomic<bool> m_stopThread{false};
+	bool m_decodeAll = false;
+#endif // MPT_ENABLE_THREAD
+};
+
+
+OPENMPT_NAMESPACE_END
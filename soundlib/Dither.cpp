@@ -15,6 +15,10 @@
 
 #include "../common/misc_util.h"
 
+#if defined(ENABLE_INTRINSICS_SSE2) || defined(ENABLE_INTRINSICS_AVX2)
+#include <immintrin.h>
+#endif
+
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -136,6 +140,113 @@ static void Dither_ModPlug(int *pBuffer, std::size_t count, std::size_t channels
 }
 
 
+// Noise generation for Dither_Simple.
+// Values are consecutive results of the fast PRNG (an LCG), masked to the requested number of bits, i.e. identical to calling mpt::random<unsigned int>(prng, bits).
+// The SIMD versions compute the states of several consecutive PRNG steps in parallel, using the LCG jump-ahead property: state[n + k] = A(k) * state[n] + C(k).
+
+STATIC_ASSERT((std::is_same<mpt::fast_prng, mpt::rng::lcg_msvc>::value)); // 32-bit state, 15 result bits starting at bit 16
+
+static const int DitherNoiseMaxBits = 15; // Noise values that can be generated from a single PRNG result
+
+// Parameters for advancing the PRNG state by steps at once
+static MPT_FORCEINLINE void LCGJumpAhead(uint32 steps, uint32 &mul, uint32 &add)
+{
+	mul = 1;
+	add = 0;
+	for(uint32 i = 0; i < steps; i++)
+	{
+		mul *= mpt::fast_prng::multiplier();
+		add = add * mpt::fast_prng::multiplier() + mpt::fast_prng::increment();
+	}
+}
+
+#if defined(ENABLE_INTRINSICS_SSE2)
+
+// Lower 32 bits of the product of each 32-bit element
+static MPT_TARGET_SSE2 MPT_FORCEINLINE __m128i MulLo32SSE2(__m128i a, __m128i b)
+{
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static MPT_TARGET_SSE2 std::size_t Dither_NoiseSSE2(uint32 *noise, std::size_t count, int bits, uint32 &state)
+{
+	uint32 lane[4], mul, add;
+	for(uint32 i = 0; i < 4; i++)
+	{
+		LCGJumpAhead(i, mul, add);
+		lane[i] = state * mul + add;
+	}
+	LCGJumpAhead(4, mul, add);
+	__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lane));
+	const __m128i vMul = _mm_set1_epi32(static_cast<int32>(mul)), vAdd = _mm_set1_epi32(static_cast<int32>(add));
+	const __m128i mask = _mm_set1_epi32((1 << bits) - 1);
+	const std::size_t numVectors = count / 4;
+	for(std::size_t i = 0; i < numVectors; i++)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(noise + i * 4), _mm_and_si128(_mm_srli_epi32(s, 16), mask));
+		s = _mm_add_epi32(MulLo32SSE2(s, vMul), vAdd);
+	}
+	state = static_cast<uint32>(_mm_cvtsi128_si32(s));
+	return numVectors * 4;
+}
+
+#endif // ENABLE_INTRINSICS_SSE2
+
+#if defined(ENABLE_INTRINSICS_AVX2)
+
+static MPT_TARGET_AVX2 std::size_t Dither_NoiseAVX2(uint32 *noise, std::size_t count, int bits, uint32 &state)
+{
+	uint32 lane[8], mul, add;
+	for(uint32 i = 0; i < 8; i++)
+	{
+		LCGJumpAhead(i, mul, add);
+		lane[i] = state * mul + add;
+	}
+	LCGJumpAhead(8, mul, add);
+	__m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lane));
+	const __m256i vMul = _mm256_set1_epi32(static_cast<int32>(mul)), vAdd = _mm256_set1_epi32(static_cast<int32>(add));
+	const __m256i mask = _mm256_set1_epi32((1 << bits) - 1);
+	const std::size_t numVectors = count / 8;
+	for(std::size_t i = 0; i < numVectors; i++)
+	{
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(noise + i * 8), _mm256_and_si256(_mm256_srli_epi32(s, 16), mask));
+		s = _mm256_add_epi32(_mm256_mullo_epi32(s, vMul), vAdd);
+	}
+	state = static_cast<uint32>(_mm_cvtsi128_si32(_mm256_castsi256_si128(s)));
+	return numVectors * 8;
+}
+
+#endif // ENABLE_INTRINSICS_AVX2
+
+static void Dither_Noise(uint32 *noise, std::size_t count, int bits, mpt::fast_prng &prng)
+{
+	MPT_ASSERT(bits <= DitherNoiseMaxBits);
+	std::size_t done = 0;
+#if defined(ENABLE_INTRINSICS_SSE2) || defined(ENABLE_INTRINSICS_AVX2)
+	uint32 state = prng.get_state();
+#if defined(ENABLE_INTRINSICS_AVX2)
+	if(GetProcSupport() & PROCSUPPORT_AVX2)
+	{
+		done = Dither_NoiseAVX2(noise, count, bits, state);
+	} else
+#endif // ENABLE_INTRINSICS_AVX2
+#if defined(ENABLE_INTRINSICS_SSE2)
+	if(GetProcSupport() & PROCSUPPORT_SSE2)
+	{
+		done = Dither_NoiseSSE2(noise, count, bits, state);
+	}
+#endif // ENABLE_INTRINSICS_SSE2
+	prng.set_state(state);
+#endif // ENABLE_INTRINSICS_SSE2 || ENABLE_INTRINSICS_AVX2
+	for(std::size_t i = done; i < count; i++)
+	{
+		noise[i] = mpt::random<unsigned int>(prng, bits);
+	}
+}
+
+
 template<int targetbits, int channels, int ditherdepth = 1, bool triangular = false, bool shaped = true>
 struct Dither_SimpleTemplate
 {
@@ -153,6 +264,37 @@ MPT_NOINLINE void operator () (int *mixbuffer, std::size_t count, DitherSimpleSt
 	const int noise_bits = rshift + (ditherdepth - 1);
 	const int noise_bias = (1<<(noise_bits-1));
 	DitherSimpleState s = state;
+	MPT_CONSTANT_IF(!triangular && noise_bits <= DitherNoiseMaxBits)
+	{
+		// Generate the noise for a block of samples at once, then apply the noise shaping, which has to be done one frame at a time
+		const std::size_t blockFrames = 256 / channels;
+		uint32 noiseBuffer[blockFrames * channels];
+		while(count > 0)
+		{
+			const std::size_t frames = std::min(count, blockFrames);
+			Dither_Noise(noiseBuffer, frames * channels, noise_bits, prng);
+			const uint32 *unoise = noiseBuffer;
+			for(std::size_t i = 0; i < frames; ++i)
+			{
+				for(std::size_t channel = 0; channel < channels; ++channel)
+				{
+					int noise = static_cast<int>(*unoise++) - noise_bias; // un-bias
+					int val = *mixbuffer;
+					MPT_CONSTANT_IF(shaped)
+					{
+						val += (s.error[channel] >> 1);
+					}
+					int rounded = (val + noise + round_offset) & round_mask;
+					s.error[channel] = val - rounded;
+					*mixbuffer = rounded;
+					mixbuffer++;
+				}
+			}
+			count -= frames;
+		}
+		state = s;
+		return;
+	}
 	for(std::size_t i = 0; i < count; ++i)
 	{
 		for(std::size_t channel = 0; channel < channels; ++channel)
@@ -22,7 +22,9 @@
 #include "MixFuncTable.h"
 #include <cfloat>	// For FLT_EPSILON
 #include "plugins/PlugInterface.h"
+#include "../common/mptThreadPool.h"
 #include <algorithm>
+#include <array>
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -34,8 +36,12 @@ struct MixLoopState
 {
 	const int8 * samplePointer;
 	const int8 * lookaheadPointer;
+	const int8 * startLookaheadPointer;	// Only for pinned sample data
+	const int8 * endLookaheadPointer;	// Ditto
 	SmpLength lookaheadStart;
+	int32 positionBase;	// Sample position that corresponds to the start of chn.pCurrentSample, as set up by GetSampleCount
 	uint32 maxSamples;
+	bool pinned;
 
 	MixLoopState(const ModChannel &chn)
 	{
@@ -55,6 +61,16 @@ struct MixLoopState
 	{
 		samplePointer = static_cast<const int8 *>(chn.pCurrentSample);
 		lookaheadPointer = nullptr;
+		startLookaheadPointer = endLookaheadPointer = nullptr;
+		positionBase = 0;
+		// Pinned sample data has no lookahead area around it, the lookahead is stored in a separate buffer instead.
+		// As this buffer is not adjacent to the sample data, the sample position has to be rebased when reading from it.
+		pinned = chn.pModSample != nullptr && chn.pModSample->IsPinned() && samplePointer == chn.pModSample->samplev();
+		if(pinned)
+		{
+			startLookaheadPointer = reinterpret_cast<const int8 *>(chn.pModSample->GetPinnedLookahead(ModSample::lookaheadSampleStart));
+			endLookaheadPointer = reinterpret_cast<const int8 *>(chn.pModSample->GetPinnedLookahead(ModSample::lookaheadSampleEnd));
+		}
 		if(chn.nLoopEnd < InterpolationMaxLookahead)
 			lookaheadStart = chn.nLoopStart;
 		else
@@ -68,12 +84,19 @@ struct MixLoopState
 			// Do not enable wraparound magic if we're previewing a custom loop!
 			if(inSustainLoop || chn.nLoopEnd == chn.pModSample->nLoopEnd)
 			{
-				SmpLength lookaheadOffset = 3 * InterpolationMaxLookahead + chn.pModSample->nLength - chn.nLoopEnd;
-				if(inSustainLoop)
+				if(pinned)
+				{
+					// The wrap-around buffer starts at 2x InterpolationMaxLookahead before the loop end (see GetSampleCount)
+					lookaheadPointer = reinterpret_cast<const int8 *>(chn.pModSample->GetPinnedLookahead(inSustainLoop ? ModSample::lookaheadSustainLoop : ModSample::lookaheadLoop));
+				} else
 				{
-					lookaheadOffset += 4 * InterpolationMaxLookahead;
+					SmpLength lookaheadOffset = 3 * InterpolationMaxLookahead + chn.pModSample->nLength - chn.nLoopEnd;
+					if(inSustainLoop)
+					{
+						lookaheadOffset += 4 * InterpolationMaxLookahead;
+					}
+					lookaheadPointer = samplePointer + lookaheadOffset * chn.pModSample->GetBytesPerSample();
 				}
-				lookaheadPointer = samplePointer + lookaheadOffset * chn.pModSample->GetBytesPerSample();
 			}
 		}
 	}
@@ -85,7 +108,7 @@ struct MixLoopState
 	}
 
 	// Check how many samples can be rendered without encountering loop or sample end, and also update loop position / direction
-	MPT_FORCEINLINE uint32 GetSampleCount(ModChannel &chn, uint32 nSamples, bool ITPingPongMode) const
+	MPT_FORCEINLINE uint32 GetSampleCount(ModChannel &chn, uint32 nSamples, bool ITPingPongMode)
 	{
 		int32 nLoopStart = chn.dwFlags[CHN_LOOP] ? chn.nLoopStart : 0;
 		SamplePosition nInc = chn.increment;
@@ -94,6 +117,7 @@ struct MixLoopState
 
 		// Part 1: Making sure the play position is valid, and if necessary, invert the play direction in case we reached a loop boundary of a ping-pong loop.
 		chn.pCurrentSample = samplePointer;
+		positionBase = 0;
 
 		// Under zero ?
 		if (chn.position.GetInt() < nLoopStart)
@@ -219,12 +243,21 @@ struct MixLoopState
 				}
 #endif
 				chn.pCurrentSample = lookaheadPointer;
+				if(pinned)
+					positionBase = static_cast<int32>(chn.nLoopEnd - 2 * InterpolationMaxLookahead);
 				checkDest = false;
 			} else if(chn.dwFlags[CHN_WRAPPED_LOOP] && isAtLoopStart)
 			{
 				// We just restarted the loop, so interpolate correctly after wrapping around
 				nSmpCount = DistanceToBufferLength(nPos, SamplePosition(nLoopStart + InterpolationMaxLookahead, 0), nInv);
-				chn.pCurrentSample = lookaheadPointer + (chn.nLoopEnd - nLoopStart) * chn.pModSample->GetBytesPerSample();
+				if(pinned)
+				{
+					chn.pCurrentSample = lookaheadPointer;
+					positionBase = nLoopStart - static_cast<int32>(2 * InterpolationMaxLookahead);
+				} else
+				{
+					chn.pCurrentSample = lookaheadPointer + (chn.nLoopEnd - nLoopStart) * chn.pModSample->GetBytesPerSample();
+				}
 				checkDest = false;
 			} else if(nInc.IsPositive() && static_cast<SmpLength>(nPosDest) >= lookaheadStart && nSmpCount > 1)
 			{
@@ -252,6 +285,31 @@ struct MixLoopState
 			}
 		}
 
+		if(pinned && chn.pCurrentSample == samplePointer)
+		{
+			// Only the sampling points that are at least InterpolationMaxLookahead away from the sample start and end can be read from the sample data itself.
+			const SmpLength sampleLength = chn.pModSample->nLength;
+			if(nPosInt < InterpolationMaxLookahead)
+			{
+				chn.pCurrentSample = startLookaheadPointer;
+				positionBase = -static_cast<int32>(InterpolationMaxLookahead);
+				if(nInc.IsPositive())
+					LimitMax(nSmpCount, DistanceToBufferLength(nPos, SamplePosition(InterpolationMaxLookahead, 0), nInv));
+			} else if(nPosInt >= sampleLength - InterpolationMaxLookahead)
+			{
+				chn.pCurrentSample = endLookaheadPointer;
+				positionBase = static_cast<int32>(sampleLength - 2 * InterpolationMaxLookahead);
+				if(nInc.IsNegative())
+					LimitMax(nSmpCount, DistanceToBufferLength(SamplePosition(sampleLength - InterpolationMaxLookahead, 0), nPos, nInv));
+			} else if(nInc.IsPositive())
+			{
+				LimitMax(nSmpCount, DistanceToBufferLength(nPos, SamplePosition(sampleLength - InterpolationMaxLookahead, 0), nInv));
+			} else
+			{
+				LimitMax(nSmpCount, DistanceToBufferLength(SamplePosition(InterpolationMaxLookahead, 0), nPos, nInv));
+			}
+		}
+
 		Limit(nSmpCount, 1u, nSamples);
 
 #ifdef MPT_BUILD_DEBUG
@@ -271,11 +329,161 @@ struct MixLoopState
 };
 
 
+// Index into the mix function table for the voice's resampling mode, sample format and filter (without the ramping flag)
+static uint32 GetMixFunctionIndex(const ModChannel &chn)
+{
+	uint32 functionNdx = MixFuncTable::ResamplingModeToMixFlags(static_cast<ResamplingMode>(chn.resamplingMode));
+	if(chn.dwFlags[CHN_16BIT]) functionNdx |= MixFuncTable::ndx16Bit;
+	if(chn.dwFlags[CHN_STEREO]) functionNdx |= MixFuncTable::ndxStereo;
+#ifndef NO_FILTER
+	if(chn.dwFlags[CHN_FILTER]) functionNdx |= MixFuncTable::ndxFilter;
+#endif
+	return functionNdx;
+}
+
+
+// Mix a single voice into pbuffer (count stereo frames). The voice's DC offset on note end is added to ofsR / ofsL.
+// functionNdx is updated if the voice switches to a sample with a different format while mixing.
+// This only modifies the voice itself and the given buffer, so voices with different target buffers can be mixed concurrently.
+// Returns true if the voice was actually mixed (i.e. it is not silent and was not skipped).
+bool CSoundFile::MixChannel(ModChannel &chn, const MixFuncInterface *mixFunctions, uint32 &functionNdx, mixsample_t *pbuffer, mixsample_t &ofsR, mixsample_t &ofsL, int count, bool tooManyChannels) const
+{
+	const bool ITPingPongMode = m_playBehaviour[kITPingPongMode];
+	MixLoopState mixLoopState(chn);
+
+	////////////////////////////////////////////////////
+	bool mixed = false;
+	int nsamples = count;
+	// Keep mixing this sample until the buffer is filled.
+	do
+	{
+		uint32 nrampsamples = nsamples;
+		int32 nSmpCount;
+		if(chn.nRampLength > 0)
+		{
+			if (nrampsamples > chn.nRampLength) nrampsamples = chn.nRampLength;
+		}
+
+		if((nSmpCount = mixLoopState.GetSampleCount(chn, nrampsamples, ITPingPongMode)) <= 0)
+		{
+			// Stopping the channel
+			chn.pCurrentSample = nullptr;
+			chn.nLength = 0;
+			chn.position.Set(0);
+			chn.nRampLength = 0;
+			EndChannelOfs(chn, pbuffer, nsamples);
+			ofsR += chn.nROfs;
+			ofsL += chn.nLOfs;
+			chn.nROfs = chn.nLOfs = 0;
+			chn.dwFlags.reset(CHN_PINGPONGFLAG);
+			break;
+		}
+
+		// Should we mix this channel ?
+		if(tooManyChannels												// Too many channels
+			|| (!chn.nRampLength && !(chn.leftVol | chn.rightVol)))		// Channel is completely silent
+		{
+			chn.position += chn.increment * nSmpCount;
+			chn.nROfs = chn.nLOfs = 0;
+			pbuffer += nSmpCount * 2;
+			mixed = false;
+		}
+#ifdef MODPLUG_TRACKER
+		else if(m_SamplePlayLengths != nullptr)
+		{
+			// Detecting the longest play time for each sample for optimization
+			chn.position += chn.increment * nSmpCount;
+			size_t smp = std::distance<const ModSample *>(Samples, chn.pModSample);
+			if(smp < m_SamplePlayLengths->size())
+			{
+				m_SamplePlayLengths->at(smp) = std::max(m_SamplePlayLengths->at(smp), chn.position.GetUInt());
+			}
+		}
+#endif
+		else
+		{
+			// Do mixing
+			mixsample_t *pbufmax = pbuffer + (nSmpCount * 2);
+			chn.nROfs = -*(pbufmax - 2);
+			chn.nLOfs = -*(pbufmax - 1);
+
+#ifdef MPT_BUILD_DEBUG
+			SamplePosition targetpos = chn.position + chn.increment * nSmpCount;
+#endif
+			const SamplePosition positionBase(mixLoopState.positionBase, 0);
+			chn.position -= positionBase;
+			mixFunctions[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
+			chn.position += positionBase;
+#ifdef MPT_BUILD_DEBUG
+			MPT_ASSERT(chn.position.GetUInt() == targetpos.GetUInt());
+#endif
+
+			chn.nROfs += *(pbufmax - 2);
+			chn.nLOfs += *(pbufmax - 1);
+			pbuffer = pbufmax;
+			mixed = true;
+		}
+
+		nsamples -= nSmpCount;
+		if (chn.nRampLength)
+		{
+			if (chn.nRampLength <= static_cast<uint32>(nSmpCount))
+			{
+				// Ramping is done
+				chn.nRampLength = 0;
+				chn.leftVol = chn.newLeftVol;
+				chn.rightVol = chn.newRightVol;
+				chn.rightRamp = chn.leftRamp = 0;
+				if(chn.dwFlags[CHN_NOTEFADE] && !chn.nFadeOutVol)
+				{
+					chn.nLength = 0;
+					chn.pCurrentSample = nullptr;
+				}
+			} else
+			{
+				chn.nRampLength -= nSmpCount;
+			}
+		}
+
+		if(chn.position.GetUInt() >= chn.nLoopEnd && chn.dwFlags[CHN_LOOP])
+		{
+			if(m_playBehaviour[kMODSampleSwap] && chn.nNewIns && chn.nNewIns <= GetNumSamples() && chn.pModSample != &Samples[chn.nNewIns])
+			{
+				// ProTracker compatibility: Instrument changes without a note do not happen instantly, but rather when the sample loop has finished playing.
+				// Test case: PTInstrSwap.mod
+				const ModSample &smp = Samples[chn.nNewIns];
+				chn.pModSample = &smp;
+				chn.pCurrentSample = smp.samplev();
+				chn.dwFlags = (chn.dwFlags & CHN_CHANNELFLAGS) | smp.uFlags;
+				chn.nLength = smp.uFlags[CHN_LOOP] ? smp.nLoopEnd : smp.nLength;
+				chn.nLoopStart = smp.nLoopStart;
+				chn.nLoopEnd = smp.nLoopEnd;
+				chn.position.SetInt(chn.nLoopStart);
+				mixLoopState.UpdateLookaheadPointers(chn);
+				if(!chn.pCurrentSample)
+				{
+					break;
+				}
+				// The new sample may be 16-bit or stereo when the old one was not
+				functionNdx = GetMixFunctionIndex(chn);
+			} else if(m_playBehaviour[kMODOneShotLoops] && chn.nLoopStart == 0)
+			{
+				// ProTracker "oneshot" loops (if loop start is 0, play the whole sample once and then repeat until loop end)
+				chn.position.SetInt(0);
+				chn.nLoopEnd = chn.nLength = chn.pModSample->nLoopEnd;
+			}
+		}
+	} while(nsamples > 0);
+
+	// Restore sample pointer in case it got changed through loop wrap-around
+	chn.pCurrentSample = mixLoopState.samplePointer;
+	return mixed;
+}
+
+
 // Render count * number of channels samples
 void CSoundFile::CreateStereoMix(int count)
 {
-	mixsample_t *pOfsL, *pOfsR;
-
 	if (!count) return;
 
 	// Resetting sound buffer
@@ -284,22 +492,30 @@ void CSoundFile::CreateStereoMix(int count)
 
 	CHANNELINDEX nchmixed = 0;
 
-	const bool ITPingPongMode = m_playBehaviour[kITPingPongMode];
+	const MixFuncInterface *mixFunctions = MixFuncTable::GetFunctionTable();
+
+	// Voices that go straight into the dry mix buffer can be mixed in parallel, all others are mixed right away.
+	// Skipping voices due to the voice limit depends on the mixing order, so this only works if the limit cannot be hit.
+	const bool mixParallel = m_MixThreadPool != nullptr && m_MixerSettings.m_nMaxMixChannels >= m_nMixChannels
+#ifdef MODPLUG_TRACKER
+		&& m_SamplePlayLengths == nullptr
+#endif
+		;
+	std::vector<CHANNELINDEX> &parallelVoices = m_MixParallelVoices;
+	parallelVoices.clear();
+#ifndef NO_PLUGINS
+	const bool hasPlugins = !GetActivePlugins().empty();
+#endif // NO_PLUGINS
 
 	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
 	{
 		ModChannel &chn = m_PlayState.Chn[m_PlayState.ChnMix[nChn]];
 
 		if(!chn.pCurrentSample) continue;
-		pOfsR = &gnDryROfsVol;
-		pOfsL = &gnDryLOfsVol;
+		mixsample_t *pOfsR = &gnDryROfsVol;
+		mixsample_t *pOfsL = &gnDryLOfsVol;
 
-		uint32 functionNdx = MixFuncTable::ResamplingModeToMixFlags(static_cast<ResamplingMode>(chn.resamplingMode));
-		if(chn.dwFlags[CHN_16BIT]) functionNdx |= MixFuncTable::ndx16Bit;
-		if(chn.dwFlags[CHN_STEREO]) functionNdx |= MixFuncTable::ndxStereo;
-#ifndef NO_FILTER
-		if(chn.dwFlags[CHN_FILTER]) functionNdx |= MixFuncTable::ndxFilter;
-#endif
+		uint32 functionNdx = GetMixFunctionIndex(chn);
 
 		mixsample_t *pbuffer = MixSoundBuffer;
 #ifndef NO_REVERB
@@ -315,7 +531,7 @@ void CSoundFile::CreateStereoMix(int count)
 
 		//Look for plugins associated with this implicit tracker channel.
 #ifndef NO_PLUGINS
-		PLUGINDEX nMixPlugin = GetBestPlugin(m_PlayState.ChnMix[nChn], PrioritiseInstrument, RespectMutes);
+		const PLUGINDEX nMixPlugin = hasPlugins ? GetBestPlugin(m_PlayState.ChnMix[nChn], PrioritiseInstrument, RespectMutes) : 0;
 
 		if ((nMixPlugin > 0) && (nMixPlugin <= MAX_MIXPLUGINS) && m_MixPlugins[nMixPlugin - 1].pMixPlugin != nullptr)
 		{
@@ -335,145 +551,273 @@ void CSoundFile::CreateStereoMix(int count)
 		}
 #endif // NO_PLUGINS
 
-		MixLoopState mixLoopState(chn);
+		if(mixParallel && pbuffer == MixSoundBuffer)
+		{
+			parallelVoices.push_back(m_PlayState.ChnMix[nChn]);
+			continue;
+		}
 
-		////////////////////////////////////////////////////
-		CHANNELINDEX naddmix = 0;
-		int nsamples = count;
-		// Keep mixing this sample until the buffer is filled.
-		do
+		const bool mixed = MixChannel(chn, mixFunctions, functionNdx, pbuffer, *pOfsR, *pOfsL, count, nchmixed >= m_MixerSettings.m_nMaxMixChannels);
+		if(mixed) nchmixed++;
+
+#ifndef NO_PLUGINS
+		if(mixed && nMixPlugin > 0 && nMixPlugin <= MAX_MIXPLUGINS && m_MixPlugins[nMixPlugin - 1].pMixPlugin)
 		{
-			uint32 nrampsamples = nsamples;
-			int32 nSmpCount;
-			if(chn.nRampLength > 0)
-			{
-				if (nrampsamples > chn.nRampLength) nrampsamples = chn.nRampLength;
-			}
+			m_MixPlugins[nMixPlugin - 1].pMixPlugin->ResetSilence();
+		}
+#endif // NO_PLUGINS
+	}
 
-			if((nSmpCount = mixLoopState.GetSampleCount(chn, nrampsamples, ITPingPongMode)) <= 0)
-			{
-				// Stopping the channel
-				chn.pCurrentSample = nullptr;
-				chn.nLength = 0;
-				chn.position.Set(0);
-				chn.nRampLength = 0;
-				EndChannelOfs(chn, pbuffer, nsamples);
-				*pOfsR += chn.nROfs;
-				*pOfsL += chn.nLOfs;
-				chn.nROfs = chn.nLOfs = 0;
-				chn.dwFlags.reset(CHN_PINGPONGFLAG);
-				break;
-			}
+	if(!parallelVoices.empty())
+	{
+		nchmixed += MixVoicesParallel(parallelVoices, mixFunctions, count);
+	}
 
-			// Should we mix this channel ?
-			if((nchmixed >= m_MixerSettings.m_nMaxMixChannels)				// Too many channels
-				|| (!chn.nRampLength && !(chn.leftVol | chn.rightVol)))		// Channel is completely silent
-			{
-				chn.position += chn.increment * nSmpCount;
-				chn.nROfs = chn.nLOfs = 0;
-				pbuffer += nSmpCount * 2;
-				naddmix = 0;
-			}
-#ifdef MODPLUG_TRACKER
-			else if(m_SamplePlayLengths != nullptr)
+	m_nMixStat = std::max<CHANNELINDEX>(m_nMixStat, nchmixed);
+}
+
+
+// Mix the given voices into the dry mix buffer, spread across the mix thread pool.
+// The voices are split into contiguous slices. The first slice is mixed directly into MixSoundBuffer, all other slices
+// are mixed into their own scratch buffer and then added to MixSoundBuffer in slice order. Since the integer mixer's
+// additions are exact, the result is bit-identical to mixing all voices serially.
+CHANNELINDEX CSoundFile::MixVoicesParallel(const std::vector<CHANNELINDEX> &voices, const MixFuncInterface *mixFunctions, int count)
+{
+	// Waking up the workers is not free, so don't bother for very few voices.
+	const std::size_t minVoicesPerSlice = 4;
+	const std::size_t numSlices = std::min(m_MixThreadPool->size(), (voices.size() + minVoicesPerSlice - 1) / minVoicesPerSlice);
+	MPT_ASSERT(MixWorkerBuffer.size() >= (m_MixThreadPool->size() - 1) * m_MixerSettings.MixChunkSize * 2);
+
+	struct SliceResult
+	{
+		mixsample_t ofsR = 0, ofsL = 0;
+		CHANNELINDEX mixed = 0;
+	};
+	std::array<SliceResult, MixerSettings::MaxMixThreads> results;
+
+	auto mixSlice = [&](std::size_t slice)
+	{
+		const std::size_t first = voices.size() * slice / numSlices, last = voices.size() * (slice + 1) / numSlices;
+		mixsample_t *pbuffer = MixSoundBuffer;
+		if(slice > 0)
+		{
+			pbuffer = MixWorkerBuffer + (slice - 1) * m_MixerSettings.MixChunkSize * 2;
+			InitMixBuffer(pbuffer, count * 2);
+		}
+		SliceResult &result = results[slice];
+		for(std::size_t i = first; i < last; i++)
+		{
+			ModChannel &chn = m_PlayState.Chn[voices[i]];
+			uint32 functionNdx = GetMixFunctionIndex(chn);
+			if(MixChannel(chn, mixFunctions, functionNdx, pbuffer, result.ofsR, result.ofsL, count, false))
+				result.mixed++;
+		}
+	};
+
+	if(numSlices <= 1)
+		mixSlice(0);
+	else
+		m_MixThreadPool->parallel_for(numSlices, mixSlice);
+
+	// Fixed-order reduction
+	CHANNELINDEX nchmixed = 0;
+	for(std::size_t slice = 0; slice < numSlices; slice++)
+	{
+		if(slice > 0)
+		{
+			const mixsample_t *src = MixWorkerBuffer + (slice - 1) * m_MixerSettings.MixChunkSize * 2;
+			mixsample_t *dst = MixSoundBuffer;
+			for(int i = 0; i < count * 2; i++)
 			{
-				// Detecting the longest play time for each sample for optimization
-				chn.position += chn.increment * nSmpCount;
-				size_t smp = std::distance<const ModSample *>(Samples, chn.pModSample);
-				if(smp < m_SamplePlayLengths->size())
-				{
-					m_SamplePlayLengths->at(smp) = std::max(m_SamplePlayLengths->at(smp), chn.position.GetUInt());
-				}
+				dst[i] += src[i];
 			}
-#endif
-			else
-			{
-				// Do mixing
-				mixsample_t *pbufmax = pbuffer + (nSmpCount * 2);
-				chn.nROfs = -*(pbufmax - 2);
-				chn.nLOfs = -*(pbufmax - 1);
+		}
+		gnDryROfsVol += results[slice].ofsR;
+		gnDryLOfsVol += results[slice].ofsL;
+		nchmixed += results[slice].mixed;
+	}
+	return nchmixed;
+}
 
-#ifdef MPT_BUILD_DEBUG
-				SamplePosition targetpos = chn.position + chn.increment * nSmpCount;
-#endif
-				MixFuncTable::Functions[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
-#ifdef MPT_BUILD_DEBUG
-				MPT_ASSERT(chn.position.GetUInt() == targetpos.GetUInt());
-#endif
 
-				chn.nROfs += *(pbufmax - 2);
-				chn.nLOfs += *(pbufmax - 1);
-				pbuffer = pbufmax;
-				naddmix = 1;
-			}
+#ifndef NO_PLUGINS
+
+void CSoundFile::InvalidateActivePlugins()
+{
+	m_ActivePluginsDirty = true;
+	AllocatePluginWorkerBuffer();
+}
+
+
+// Size the scratch buffers for parallel plugin processing, so that the audio thread never has to allocate them.
+// Must be called whenever the number of plugin instances, the mix chunk size or the plugin thread pool changes.
+void CSoundFile::AllocatePluginWorkerBuffer()
+{
+	std::size_t numPlugins = 0;
+	if(m_PluginThreadPool)
+	{
+		for(const auto &plugin : m_MixPlugins)
+		{
+			if(plugin.pMixPlugin != nullptr)
+				numPlugins++;
+		}
+	}
+	// Only plugins in the same level are processed at the same time, so this may be more than needed, but it is never too little.
+	const std::size_t scratchSize = (numPlugins > 1) ? numPlugins * GetMixChunkSize(true) * 2 : 0;
+	if(PluginWorkerBuffer.size() != scratchSize)
+		PluginWorkerBuffer.Resize(scratchSize);
+}
+
+
+const std::vector<PLUGINDEX> &CSoundFile::GetActivePlugins() const
+{
+	if(m_ActivePluginsDirty)
+	{
+		m_ActivePlugins.clear();
+		for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+		{
+			if(m_MixPlugins[plug].pMixPlugin != nullptr)
+				m_ActivePlugins.push_back(plug);
+		}
+		m_ActivePluginsDirty = false;
+	}
+	return m_ActivePlugins;
+}
+
 
-			nsamples -= nSmpCount;
-			if (chn.nRampLength)
+// Determine the buffers that each plugin reads from and writes to in the current mix chunk, and group the plugins into levels.
+// A plugin is put into a later level than all plugins in earlier slots that it depends on, i.e. if it reads a buffer they write to, if
+// it modifies a buffer they read or if they send MIDI or parameter changes to each other. Plugins in earlier slots that merely mix into
+// the same buffers can share its level, as plugin output is always mixed into the output buffers in slot order.
+// Without a plugin thread pool, every plugin gets its own level, which is the same as processing all plugins one after another.
+// pMixL / pMixR are updated to the buffers that hold the master mix after all plugins have been processed.
+// Returns the number of levels. m_PluginJobs is sorted by level and slot.
+uint32 CSoundFile::PlanPluginJobs(const std::vector<PLUGINDEX> &activePlugins, float *&pMixL, float *&pMixR)
+{
+	m_PluginJobs.clear();
+	for(PLUGINDEX plug : activePlugins)
+	{
+		const SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
+		if(plugin.pMixPlugin == nullptr
+			|| plugin.pMixPlugin->m_MixState.pMixBuffer == nullptr
+			|| !plugin.pMixPlugin->m_mixBuffer.Ok())
+		{
+			continue;
+		}
+
+		PluginJob job;
+		job.inL = plugin.pMixPlugin->m_mixBuffer.GetInputBuffer(0);
+		job.inR = plugin.pMixPlugin->m_mixBuffer.GetInputBuffer(1);
+		job.masterL = job.masterR = nullptr;
+		job.scratchL = job.scratchR = nullptr;
+		job.level = 0;
+		job.plug = plug;
+		job.outPlug = PLUGINDEX_INVALID;
+		// Middle subtract mode depends on the contents of the output buffer (see IMixPlugin::ProcessMixOps)
+		job.readsOutput = !plugin.pMixPlugin->IsInstrument() && plugin.GetMixMode() == 4;
+		job.skip = false;
+		job.process = false;
+
+		// Plugins without input are skipped in ProcessPlugins. As such plugins cannot be master effects and are not fed by the master chain,
+		// they would not change the master mix buffers anyway, so they can be planned like all other plugins.
+		bool isMasterMix = false;
+		if (pMixL == job.inL)
+		{
+			isMasterMix = true;
+			pMixL = MixFloatBuffer[0];
+			pMixR = MixFloatBuffer[1];
+		}
+		job.outL = pMixL;
+		job.outR = pMixR;
+
+		if (!plugin.IsOutputToMaster())
+		{
+			PLUGINDEX nOutput = plugin.GetOutputPlugin();
+			if(nOutput > plug && nOutput != PLUGINDEX_INVALID
+				&& m_MixPlugins[nOutput].pMixPlugin != nullptr)
 			{
-				if (chn.nRampLength <= static_cast<uint32>(nSmpCount))
+				IMixPlugin *outPlugin = m_MixPlugins[nOutput].pMixPlugin;
+				job.outPlug = nOutput;
+				if(outPlugin->m_mixBuffer.Ok())
 				{
-					// Ramping is done
-					chn.nRampLength = 0;
-					chn.leftVol = chn.newLeftVol;
-					chn.rightVol = chn.newRightVol;
-					chn.rightRamp = chn.leftRamp = 0;
-					if(chn.dwFlags[CHN_NOTEFADE] && !chn.nFadeOutVol)
-					{
-						chn.nLength = 0;
-						chn.pCurrentSample = nullptr;
-					}
-				} else
-				{
-					chn.nRampLength -= nSmpCount;
+					job.outL = outPlugin->m_mixBuffer.GetInputBuffer(0);
+					job.outR = outPlugin->m_mixBuffer.GetInputBuffer(1);
 				}
 			}
+		}
 
-			if(chn.position.GetUInt() >= chn.nLoopEnd && chn.dwFlags[CHN_LOOP])
+		if (plugin.IsMasterEffect())
+		{
+			if (!isMasterMix)
 			{
-				if(m_playBehaviour[kMODSampleSwap] && chn.nNewIns && chn.nNewIns <= GetNumSamples() && chn.pModSample != &Samples[chn.nNewIns])
-				{
-					// ProTracker compatibility: Instrument changes without a note do not happen instantly, but rather when the sample loop has finished playing.
-					// Test case: PTInstrSwap.mod
-					const ModSample &smp = Samples[chn.nNewIns];
-					chn.pModSample = &smp;
-					chn.pCurrentSample = smp.samplev();
-					chn.dwFlags = (chn.dwFlags & CHN_CHANNELFLAGS) | smp.uFlags;
-					chn.nLength = smp.uFlags[CHN_LOOP] ? smp.nLoopEnd : smp.nLength;
-					chn.nLoopStart = smp.nLoopStart;
-					chn.nLoopEnd = smp.nLoopEnd;
-					chn.position.SetInt(chn.nLoopStart);
-					mixLoopState.UpdateLookaheadPointers(chn);
-					if(!chn.pCurrentSample)
-					{
-						break;
-					}
-				} else if(m_playBehaviour[kMODOneShotLoops] && chn.nLoopStart == 0)
-				{
-					// ProTracker "oneshot" loops (if loop start is 0, play the whole sample once and then repeat until loop end)
-					chn.position.SetInt(0);
-					chn.nLoopEnd = chn.nLength = chn.pModSample->nLoopEnd;
-				}
+				job.masterL = pMixL;
+				job.masterR = pMixR;
 			}
-		} while(nsamples > 0);
+			pMixL = job.outL;
+			pMixR = job.outR;
+		}
+		m_PluginJobs.push_back(job);
+	}
 
-		// Restore sample pointer in case it got changed through loop wrap-around
-		chn.pCurrentSample = mixLoopState.samplePointer;
-		nchmixed += naddmix;
-	
-#ifndef NO_PLUGINS
-		if(naddmix && nMixPlugin > 0 && nMixPlugin <= MAX_MIXPLUGINS && m_MixPlugins[nMixPlugin - 1].pMixPlugin)
+	if(!m_PluginThreadPool)
+	{
+		for(std::size_t j = 0; j < m_PluginJobs.size(); j++)
 		{
-			m_MixPlugins[nMixPlugin - 1].pMixPlugin->ResetSilence();
+			m_PluginJobs[j].level = static_cast<uint32>(j);
 		}
-#endif // NO_PLUGINS
+		return static_cast<uint32>(m_PluginJobs.size());
 	}
-	m_nMixStat = std::max<CHANNELINDEX>(m_nMixStat, nchmixed);
+
+	// Buffers are identified by their left channel.
+	// Buffers read while processing: Plugin input and, for master effects, the master mix that is moved into the input.
+	const auto reads = [](const PluginJob &job, const float *buffer)
+	{
+		return buffer == job.inL || (job.masterL != nullptr && buffer == job.masterL);
+	};
+	// Buffers modified before processing: Input and master mix of master effects.
+	const auto prepares = [](const PluginJob &job, const float *buffer)
+	{
+		return job.masterL != nullptr && (buffer == job.inL || buffer == job.masterL);
+	};
+
+	uint32 numLevels = 0;
+	for(std::size_t j = 0; j < m_PluginJobs.size(); j++)
+	{
+		PluginJob &job = m_PluginJobs[j];
+		const PLUGINDEX jobOutput = m_MixPlugins[job.plug].GetOutputPlugin();
+		for(std::size_t i = 0; i < j; i++)
+		{
+			const PluginJob &prev = m_PluginJobs[i];
+			const PLUGINDEX prevOutput = m_MixPlugins[prev.plug].GetOutputPlugin();
+			if(prevOutput == job.plug || jobOutput == prev.plug
+				|| (prevOutput != PLUGINDEX_INVALID && prevOutput == jobOutput)
+				|| reads(job, prev.outL)
+				|| (prev.masterL != nullptr && (reads(job, prev.inL) || reads(job, prev.masterL)))
+				|| (job.masterL != nullptr && (reads(prev, job.inL) || reads(prev, job.masterL) || prepares(job, prev.outL))))
+			{
+				job.level = std::max(job.level, prev.level + 1);
+			} else if(prev.outL == job.outL || prepares(prev, job.outL) || reads(prev, job.outL))
+			{
+				job.level = std::max(job.level, prev.level);
+			}
+		}
+		numLevels = std::max(numLevels, job.level + 1);
+	}
+	std::sort(m_PluginJobs.begin(), m_PluginJobs.end(), [](const PluginJob &a, const PluginJob &b)
+	{
+		return a.level < b.level || (a.level == b.level && a.plug < b.plug);
+	});
+	return numLevels;
 }
 
+#endif // NO_PLUGINS
+
 
-void CSoundFile::ProcessPlugins(uint32 nCount)
+void CSoundFile::ProcessPlugins(uint32 nCount, float *floatOutput)
 {
 #ifndef NO_PLUGINS
+	const std::vector<PLUGINDEX> &activePlugins = GetActivePlugins();
+
 	// If any sample channels are active or any plugin has some input, possibly suspended master plugins need to be woken up.
 	bool masterHasInput = (m_nMixStat > 0);
 
@@ -483,7 +827,7 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 #endif // MPT_INTMIXER
 
 	// Setup float inputs from samples
-	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	for(PLUGINDEX plug : activePlugins)
 	{
 		SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
 		if(plugin.pMixPlugin != nullptr
@@ -546,22 +890,32 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 	const bool positionChanged = HasPositionChanged();
 
 	// Process Plugins
-	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	// The plugins are grouped into levels (see PlanPluginJobs). Levels are processed one after another. Within a level,
+	// everything that has side effects on other plugins or shared buffers happens serially in slot order, only the actual
+	// plugin processing is done concurrently if there is a plugin thread pool.
+	const uint32 numLevels = PlanPluginJobs(activePlugins, pMixL, pMixR);
+	auto levelStart = m_PluginJobs.begin();
+	for(uint32 level = 0; level < numLevels; level++)
 	{
-		SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
-		if (plugin.pMixPlugin != nullptr
-			&& plugin.pMixPlugin->m_MixState.pMixBuffer != nullptr
-			&& plugin.pMixPlugin->m_mixBuffer.Ok())
+		const auto levelEnd = std::find_if(levelStart, m_PluginJobs.end(), [level](const PluginJob &job) { return job.level != level; });
+
+		// Wake up plugins that receive input and set up the input of master effects
+		m_PluginParallelJobs.clear();
+		for(auto job = levelStart; job != levelEnd; job++)
 		{
+			SNDMIXPLUGIN &plugin = m_MixPlugins[job->plug];
 			IMixPlugin *pObject = plugin.pMixPlugin;
-			if(!plugin.IsMasterEffect() && !plugin.pMixPlugin->ShouldProcessSilence() && !(plugin.pMixPlugin->m_MixState.dwFlags & SNDMIXPLUGINSTATE::psfHasInput))
+			SNDMIXPLUGINSTATE &state = pObject->m_MixState;
+			job->scratchL = job->scratchR = nullptr;
+			job->skip = false;
+			if(!plugin.IsMasterEffect() && !pObject->ShouldProcessSilence() && !(state.dwFlags & SNDMIXPLUGINSTATE::psfHasInput))
 			{
 				// If plugin has no inputs and isn't a master plugin, we shouldn't let it process silence if possible.
 				// I have yet to encounter a VST plugin which actually sets this flag.
 				bool hasInput = false;
-				for(PLUGINDEX inPlug = 0; inPlug < plug; inPlug++)
+				for(PLUGINDEX inPlug = 0; inPlug < job->plug; inPlug++)
 				{
-					if(m_MixPlugins[inPlug].GetOutputPlugin() == plug)
+					if(m_MixPlugins[inPlug].GetOutputPlugin() == job->plug)
 					{
 						hasInput = true;
 						break;
@@ -569,76 +923,39 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 				}
 				if(!hasInput)
 				{
+					job->skip = true;
 					continue;
 				}
 			}
 
-			bool isMasterMix = false;
-			float *plugInputL = pObject->m_mixBuffer.GetInputBuffer(0);
-			float *plugInputR = pObject->m_mixBuffer.GetInputBuffer(1);
-
-			if (pMixL == plugInputL)
+			if(job->outPlug != PLUGINDEX_INVALID && !(state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass))
 			{
-				isMasterMix = true;
-				pMixL = MixFloatBuffer[0];
-				pMixR = MixFloatBuffer[1];
+				m_MixPlugins[job->outPlug].pMixPlugin->ResetSilence();
 			}
-			SNDMIXPLUGINSTATE &state = plugin.pMixPlugin->m_MixState;
-			float *pOutL = pMixL;
-			float *pOutR = pMixR;
-
-			if (!plugin.IsOutputToMaster())
-			{
-				PLUGINDEX nOutput = plugin.GetOutputPlugin();
-				if(nOutput > plug && nOutput != PLUGINDEX_INVALID
-					&& m_MixPlugins[nOutput].pMixPlugin != nullptr)
-				{
-					IMixPlugin *outPlugin = m_MixPlugins[nOutput].pMixPlugin;
-					if(!(state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass)) outPlugin->ResetSilence();
-
-					if(outPlugin->m_mixBuffer.Ok())
-					{
-						pOutL = outPlugin->m_mixBuffer.GetInputBuffer(0);
-						pOutR = outPlugin->m_mixBuffer.GetInputBuffer(1);
-					}
-				}
-			}
-
-			/*
-			if (plugin.multiRouting) {
-				int nOutput=0;
-				for (int nOutput=0; nOutput < plugin.nOutputs / 2; nOutput++) {
-					destinationPlug = plugin.multiRoutingDestinations[nOutput];
-					pOutState = m_MixPlugins[destinationPlug].pMixState;
-					pOutputs[2 * nOutput] = plugInputL;
-					pOutputs[2 * (nOutput + 1)] = plugInputR;
-				}
-
-			}*/
 
 			if (plugin.IsMasterEffect())
 			{
-				if (!isMasterMix)
+				if (job->masterL != nullptr)
 				{
-					float *pInL = plugInputL;
-					float *pInR = plugInputR;
+					float *pInL = job->inL;
+					float *pInR = job->inR;
+					float *pMasterL = job->masterL;
+					float *pMasterR = job->masterR;
 					for (uint32 i=0; i<nCount; i++)
 					{
-						pInL[i] += pMixL[i];
-						pInR[i] += pMixR[i];
-						pMixL[i] = 0;
-						pMixR[i] = 0;
+						pInL[i] += pMasterL[i];
+						pInR[i] += pMasterR[i];
+						pMasterL[i] = 0;
+						pMasterR[i] = 0;
 					}
 				}
-				pMixL = pOutL;
-				pMixR = pOutR;
 
 				if(masterHasInput)
 				{
 					// Samples or plugins are being rendered, so turn off auto-bypass for this master effect.
-					if(plugin.pMixPlugin != nullptr) plugin.pMixPlugin->ResetSilence();
+					pObject->ResetSilence();
 					SNDMIXPLUGIN *chain = &plugin;
-					PLUGINDEX out = chain->GetOutputPlugin(), prevOut = plug;
+					PLUGINDEX out = chain->GetOutputPlugin(), prevOut = job->plug;
 					while(out > prevOut && out < MAX_MIXPLUGINS)
 					{
 						chain = &m_MixPlugins[out];
@@ -652,10 +969,54 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 				}
 			}
 
-			if(plugin.IsBypassed() || (plugin.IsAutoSuspendable() && (state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass)))
+			job->process = !(plugin.IsBypassed() || (plugin.IsAutoSuspendable() && (state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass)));
+			if(job->process)
 			{
-				const float * const pInL = plugInputL;
-				const float * const pInR = plugInputR;
+				if(positionChanged)
+					pObject->PositionChanged();
+				if(!job->readsOutput)
+					m_PluginParallelJobs.push_back(&*job);
+			}
+		}
+
+		// Render all plugins of this level into scratch buffers at once.
+		// The scratch buffers are initialized to negative zero, so that mixing them into the output buffers afterwards gives the same result as rendering into the output buffers directly.
+		if(m_PluginThreadPool && m_PluginParallelJobs.size() > 1)
+		{
+			const std::size_t scratchFrames = GetMixChunkSize(true);
+			MPT_ASSERT(nCount <= scratchFrames);
+			MPT_ASSERT(PluginWorkerBuffer.size() >= m_PluginParallelJobs.size() * scratchFrames * 2);
+			for(std::size_t i = 0; i < m_PluginParallelJobs.size(); i++)
+			{
+				m_PluginParallelJobs[i]->scratchL = PluginWorkerBuffer.data() + i * scratchFrames * 2;
+				m_PluginParallelJobs[i]->scratchR = m_PluginParallelJobs[i]->scratchL + scratchFrames;
+			}
+			m_PluginThreadPool->parallel_for(m_PluginParallelJobs.size(), [this, nCount](std::size_t i)
+			{
+				PluginJob &job = *m_PluginParallelJobs[i];
+				std::fill(job.scratchL, job.scratchL + nCount, -0.0f);
+				std::fill(job.scratchR, job.scratchR + nCount, -0.0f);
+				m_MixPlugins[job.plug].pMixPlugin->Process(job.scratchL, job.scratchR, nCount);
+			});
+		}
+
+		// Mix the plugin output into the output buffers
+		for(auto job = levelStart; job != levelEnd; job++)
+		{
+			if(job->skip)
+			{
+				continue;
+			}
+			SNDMIXPLUGIN &plugin = m_MixPlugins[job->plug];
+			IMixPlugin *pObject = plugin.pMixPlugin;
+			SNDMIXPLUGINSTATE &state = pObject->m_MixState;
+			float *pOutL = job->outL;
+			float *pOutR = job->outR;
+
+			if(!job->process)
+			{
+				const float * const pInL = job->inL;
+				const float * const pInR = job->inR;
 				for (uint32 i=0; i<nCount; i++)
 				{
 					pOutL[i] += pInL[i];
@@ -663,9 +1024,19 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 				}
 			} else
 			{
-				if(positionChanged)
-					pObject->PositionChanged();
-				pObject->Process(pOutL, pOutR, nCount);
+				if(job->scratchL != nullptr)
+				{
+					const float * const pScratchL = job->scratchL;
+					const float * const pScratchR = job->scratchR;
+					for(uint32 i = 0; i < nCount; i++)
+					{
+						pOutL[i] += pScratchL[i];
+						pOutR[i] += pScratchR[i];
+					}
+				} else
+				{
+					pObject->Process(pOutL, pOutR, nCount);
+				}
 
 				state.inputSilenceCount += nCount;
 				if(plugin.IsAutoSuspendable() && pObject->GetNumOutputChannels() > 0 && state.inputSilenceCount >= m_MixerSettings.gdwMixingFreq * 4)
@@ -691,15 +1062,28 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 			}
 			state.dwFlags &= ~SNDMIXPLUGINSTATE::psfHasInput;
 		}
+		levelStart = levelEnd;
 	}
+	if(floatOutput != nullptr)
+	{
+		// Floating point master mix: Only bring the plugin output to full scale = 1.0, but stay in floating point
 #ifdef MPT_INTMIXER
-	FloatToStereoMix(pMixL, pMixR, MixSoundBuffer, nCount, FloatToInt);
+		FloatToStereoMix(pMixL, pMixR, floatOutput, nCount, FloatToInt / MIXING_SCALEF);
 #else
-	InterleaveStereo(pMixL, pMixR, MixSoundBuffer, nCount);
+		FloatToStereoMix(pMixL, pMixR, floatOutput, nCount, 1.0f);
 #endif // MPT_INTMIXER
+	} else
+	{
+#ifdef MPT_INTMIXER
+		FloatToStereoMix(pMixL, pMixR, MixSoundBuffer, nCount, FloatToInt);
+#else
+		InterleaveStereo(pMixL, pMixR, MixSoundBuffer, nCount);
+#endif // MPT_INTMIXER
+	}
 
 #else
 	MPT_UNREFERENCED_PARAMETER(nCount);
+	MPT_UNREFERENCED_PARAMETER(floatOutput);
 #endif // NO_PLUGINS
 }
 
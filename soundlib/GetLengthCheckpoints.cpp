@@ -0,0 +1,221 @@
+/*
+ * GetLengthCheckpoints.cpp
+ * ------------------------
+ * Purpose: Snapshots of the GetLength() state, so that seeking can resume from a point close to the seek target.
+ * Notes  : While GetLength() scans a subsong from its start, it takes a snapshot of its complete state at regular intervals.
+ *          As GetLength() is deterministic, a later call with the same start position can resume from any snapshot that
+ *          was taken before its target was reached, and it will arrive at the same result as a scan from the start.
+ *          Only the part of the module before GetLength() moves on to the next subsong is recorded, because the
+ *          following subsongs depend on which rows have been visited by the previous ones.
+ *          Sample position adjustment (eAdjustSamplePositions) does not use checkpoints, as its channel state depends on the seek target.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "GetLengthCheckpoints.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+size_t GetLengthCheckpoint::GetMemoryUsage() const
+{
+	size_t size = sizeof(*this)
+		+ channels.capacity() * sizeof(ModChannel)
+		+ chnSettings.capacity() * sizeof(GetLengthChnSettings)
+		+ visitedRows.GetMemoryUsage() - sizeof(RowVisitor);
+#ifndef NO_PLUGINS
+	// Rough estimate of a tree node
+	size += plugParams.size() * (sizeof(GetLengthPlugParamMap::value_type) + 4 * sizeof(void *));
+#endif // NO_PLUGINS
+	return size;
+}
+
+
+GetLengthSongCheckpoints::GetLengthSongCheckpoints(SEQUENCEINDEX sequence, ORDERINDEX startOrder, ROWINDEX startRow, bool adjust, double interval)
+	: sequence(sequence)
+	, startOrder(startOrder)
+	, startRow(startRow)
+	, adjust(adjust)
+	, m_interval(interval)
+	, m_memoryUsage(0)
+{
+}
+
+
+const GetLengthCheckpoint *GetLengthSongCheckpoints::FindTime(double time) const
+{
+	auto cp = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), time, [](double t, const GetLengthCheckpoint &checkpoint) { return t < checkpoint.elapsedTime; });
+	if(cp == m_checkpoints.begin())
+	{
+		return nullptr;
+	}
+	return &*(cp - 1);
+}
+
+
+const GetLengthCheckpoint *GetLengthSongCheckpoints::FindPosition(ORDERINDEX order, ROWINDEX row) const
+{
+	if(order < m_firstVisit.size() && row < m_firstVisit[order].size() && m_firstVisit[order][row] >= 0.0)
+	{
+		return FindTime(m_firstVisit[order][row]);
+	}
+	// The row has not been reached by any scan so far, so it can only be reached after the last checkpoint.
+	return m_checkpoints.empty() ? nullptr : &m_checkpoints.back();
+}
+
+
+void GetLengthSongCheckpoints::AddCheckpoint(GetLengthCheckpoint &&checkpoint, size_t maxMemory)
+{
+	const size_t size = checkpoint.GetMemoryUsage();
+	if(m_memoryUsage + size > maxMemory)
+	{
+		// Thin out the existing checkpoints so that their density stays uniform across the song.
+		std::vector<GetLengthCheckpoint> kept;
+		kept.reserve(m_checkpoints.size() / 2 + 1);
+		for(size_t i = 1; i < m_checkpoints.size(); i += 2)
+		{
+			m_memoryUsage -= m_checkpoints[i - 1].GetMemoryUsage();
+			kept.push_back(std::move(m_checkpoints[i]));
+		}
+		if(m_checkpoints.size() % 2u)
+		{
+			m_memoryUsage -= m_checkpoints.back().GetMemoryUsage();
+		}
+		m_checkpoints = std::move(kept);
+		m_interval *= 2.0;
+		if(m_memoryUsage + size > maxMemory || !IsCheckpointDue(checkpoint.elapsedTime))
+		{
+			return;
+		}
+	}
+	m_memoryUsage += size;
+	m_checkpoints.push_back(std::move(checkpoint));
+}
+
+
+void GetLengthSongCheckpoints::VisitRow(ORDERINDEX order, ROWINDEX row, double time)
+{
+	if(order >= m_firstVisit.size())
+	{
+		m_memoryUsage += (order + 1 - m_firstVisit.size()) * sizeof(m_firstVisit[0]);
+		m_firstVisit.resize(order + 1);
+	}
+	auto &rows = m_firstVisit[order];
+	if(row >= rows.size())
+	{
+		m_memoryUsage += (row + 1 - rows.size()) * sizeof(double);
+		rows.resize(row + 1, -1.0);
+	}
+	if(rows[row] < 0.0)
+	{
+		rows[row] = time;
+	}
+}
+
+
+void GetLengthCheckpoints::SetConfig(double interval, size_t maxMemory)
+{
+	MPT_LOCK_GUARD<mpt::mutex> lock(m_mutex);
+	if(interval != m_interval || maxMemory != m_maxMemory)
+	{
+		m_songs.clear();
+	}
+	m_interval = interval;
+	m_maxMemory = maxMemory;
+}
+
+
+void GetLengthCheckpoints::Clear()
+{
+	MPT_LOCK_GUARD<mpt::mutex> lock(m_mutex);
+	m_songs.clear();
+	m_rowVisitors.clear();
+}
+
+
+GetLengthSongCheckpoints &GetLengthCheckpoints::GetSong(SEQUENCEINDEX sequence, ORDERINDEX startOrder, ROWINDEX startRow, bool adjust, uint32 sampleRate, uint32 tempoFactor)
+{
+	MPT_LOCK_GUARD<mpt::mutex> lock(m_mutex);
+	if(sampleRate != m_sampleRate || tempoFactor != m_tempoFactor)
+	{
+		m_songs.clear();
+		m_sampleRate = sampleRate;
+		m_tempoFactor = tempoFactor;
+	}
+	for(auto &song : m_songs)
+	{
+		if(song.sequence == sequence && song.startOrder == startOrder && song.startRow == startRow && song.adjust == adjust)
+		{
+			return song;
+		}
+	}
+	m_songs.emplace_back(sequence, startOrder, startRow, adjust, m_interval);
+	return m_songs.back();
+}
+
+
+void GetLengthCheckpoints::AddCheckpoint(GetLengthSongCheckpoints &song, GetLengthCheckpoint &&checkpoint)
+{
+	MPT_LOCK_GUARD<mpt::mutex> lock(m_mutex);
+	size_t otherSongs = 0;
+	for(const auto &other : m_songs)
+	{
+		if(&other != &song)
+		{
+			otherSongs += other.GetMemoryUsage();
+		}
+	}
+	song.AddCheckpoint(std::move(checkpoint), (otherSongs < m_maxMemory) ? (m_maxMemory - otherSongs) : 0);
+}
+
+
+std::unique_ptr<RowVisitor> GetLengthCheckpoints::AcquireRowVisitor(const CSoundFile &sndFile, SEQUENCEINDEX sequence)
+{
+	std::unique_ptr<RowVisitor> visitor;
+	{
+		MPT_LOCK_GUARD<mpt::mutex> lock(m_mutex);
+		auto it = std::find_if(m_rowVisitors.begin(), m_rowVisitors.end(), [sequence](const std::unique_ptr<RowVisitor> &v) { return v->GetSequence() == sequence; });
+		if(it != m_rowVisitors.end())
+		{
+			visitor = std::move(*it);
+			m_rowVisitors.erase(it);
+		}
+	}
+	if(visitor)
+	{
+		// The module may have been edited since the visitor was last used, so it may still have to be resized.
+		visitor->Initialize(true);
+	} else
+	{
+		visitor = mpt::make_unique<RowVisitor>(sndFile, sequence);
+	}
+	return visitor;
+}
+
+
+void GetLengthCheckpoints::ReleaseRowVisitor(std::unique_ptr<RowVisitor> visitor)
+{
+	MPT_LOCK_GUARD<mpt::mutex> lock(m_mutex);
+	const SEQUENCEINDEX sequence = visitor->GetSequence();
+	if(std::none_of(m_rowVisitors.begin(), m_rowVisitors.end(), [sequence](const std::unique_ptr<RowVisitor> &v) { return v->GetSequence() == sequence; }))
+	{
+		m_rowVisitors.push_back(std::move(visitor));
+	}
+}
+
+
+size_t GetLengthCheckpoints::GetMemoryUsage() const
+{
+	MPT_LOCK_GUARD<mpt::mutex> lock(m_mutex);
+	size_t size = 0;
+	for(const auto &song : m_songs)
+	{
+		size += song.GetMemoryUsage();
+	}
+	return size;
+}
+
+
+OPENMPT_NAMESPACE_END
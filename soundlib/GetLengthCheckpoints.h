@@ -0,0 +1,149 @@
+/*
+ * GetLengthCheckpoints.h
+ * ----------------------
+ * Purpose: Snapshots of the GetLength() state, so that seeking can resume from a point close to the seek target.
+ * Notes  : See implementation file.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+#include "Sndfile.h"
+#include "RowVisitor.h"
+#include "../common/mptMutex.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+// Per-channel state of GetLength() that is not stored in the channel itself
+struct GetLengthChnSettings
+{
+	double patLoop = 0.0;
+	CSoundFile::samplecount_t patLoopSmp = 0;
+	ROWINDEX patLoopStart = 0;
+	uint32 ticksToRender = 0;	// When using sample sync, we still need to render this many ticks
+	bool incChanged = false;	// When using sample sync, note frequency has changed
+	uint8 vol = 0xFF;
+};
+
+#ifndef NO_PLUGINS
+typedef std::map<std::pair<ModCommand::INSTR, uint16>, uint16> GetLengthPlugParamMap;
+#endif // NO_PLUGINS
+
+
+// Complete state of GetLength() at the start of a row
+struct GetLengthCheckpoint
+{
+	// Global play state variables that are updated by GetLength(). All other global variables are taken from the current play state.
+	CSoundFile::samplecount_t totalSampleCount;
+	double bufferDiff;
+	uint32 musicSpeed;
+	TEMPO musicTempo;
+	int32 globalVolume;
+	ROWINDEX rowsPerBeat;
+	ROWINDEX row, nextRow, nextPatStartRow;
+	PATTERNINDEX pattern;
+	ORDERINDEX currentOrder, nextOrder;
+
+	std::vector<ModChannel> channels;	// Only the pattern channels; NNA channels are not touched by GetLength()
+	std::vector<GetLengthChnSettings> chnSettings;
+#ifndef NO_PLUGINS
+	GetLengthPlugParamMap plugParams;
+#endif // NO_PLUGINS
+	RowVisitor visitedRows;
+	GetLengthType retval;
+	double elapsedTime;
+	uint32 oldTickDuration;
+
+	GetLengthCheckpoint(const RowVisitor &visitedRows) : visitedRows(visitedRows) { }
+
+	size_t GetMemoryUsage() const;
+};
+
+
+// Checkpoints of one subsong, taken while GetLength() scans it from its start position
+class GetLengthSongCheckpoints
+{
+public:
+	const SEQUENCEINDEX sequence;
+	const ORDERINDEX startOrder;
+	const ROWINDEX startRow;
+	const bool adjust;	// Checkpoints taken with eAdjust contain more channel state than those taken with eNoAdjust
+
+protected:
+	std::vector<GetLengthCheckpoint> m_checkpoints;
+	std::vector<std::vector<double>> m_firstVisit;	// Time at which each row was reached for the first time, or a negative value if it has not been reached yet
+	double m_interval;
+	std::atomic<size_t> m_memoryUsage;
+
+public:
+	GetLengthSongCheckpoints(SEQUENCEINDEX sequence, ORDERINDEX startOrder, ROWINDEX startRow, bool adjust, double interval);
+
+	// Find the latest checkpoint before the given time or song position is reached, or nullptr if there is none.
+	const GetLengthCheckpoint *FindTime(double time) const;
+	const GetLengthCheckpoint *FindPosition(ORDERINDEX order, ROWINDEX row) const;
+
+	// Returns true if a new checkpoint should be added at the given time.
+	bool IsCheckpointDue(double time) const
+	{
+		return m_checkpoints.empty() ? (time >= m_interval) : (time >= m_checkpoints.back().elapsedTime + m_interval);
+	}
+	// Add a new checkpoint. If the memory limit would be exceeded, every other existing checkpoint is removed and the interval is doubled.
+	void AddCheckpoint(GetLengthCheckpoint &&checkpoint, size_t maxMemory);
+
+	// Remember the time at which a row was reached.
+	void VisitRow(ORDERINDEX order, ROWINDEX row, double time);
+
+	size_t GetMemoryUsage() const { return m_memoryUsage; }
+	size_t GetNumCheckpoints() const { return m_checkpoints.size(); }
+};
+
+
+// All checkpoints recorded for a module, and the row visitors of previous GetLength() calls.
+// Checkpoints are only valid for the module data and timing settings they were recorded with; they are discarded automatically when the sample rate or tempo factor changes.
+// Several threads may scan different subsongs at the same time, but only one thread may use the checkpoints of a specific subsong.
+class GetLengthCheckpoints
+{
+protected:
+	mutable mpt::mutex m_mutex;
+	std::deque<GetLengthSongCheckpoints> m_songs;	// deque, so that references to songs stay valid when new songs are added
+	std::vector<std::unique_ptr<RowVisitor>> m_rowVisitors;	// Unused row visitors, at most one per sequence
+	double m_interval = 0.0;
+	size_t m_maxMemory = 0;
+	uint32 m_sampleRate = 0;
+	uint32 m_tempoFactor = 0;
+
+public:
+	// interval: Time between two checkpoints in seconds, or 0 to disable checkpoints.
+	// maxMemory: Memory that may be used by all checkpoints of a module, in bytes.
+	void SetConfig(double interval, size_t maxMemory);
+	double GetInterval() const { return m_interval; }
+	size_t GetMaxMemory() const { return m_maxMemory; }
+	bool IsEnabled() const { return m_interval > 0.0 && m_maxMemory > 0; }
+
+	void Clear();
+
+	// Get the checkpoints of the subsong starting at the given position, or create them if they do not exist yet.
+	GetLengthSongCheckpoints &GetSong(SEQUENCEINDEX sequence, ORDERINDEX startOrder, ROWINDEX startRow, bool adjust, uint32 sampleRate, uint32 tempoFactor);
+
+	// Add a checkpoint to the given subsong, respecting the memory limit of all subsongs.
+	void AddCheckpoint(GetLengthSongCheckpoints &song, GetLengthCheckpoint &&checkpoint);
+
+	// Get a row visitor for the given sequence in which all rows are unvisited.
+	// The visitor of a previous GetLength() call is reused if there is one, so that its memory does not have to be allocated again.
+	std::unique_ptr<RowVisitor> AcquireRowVisitor(const CSoundFile &sndFile, SEQUENCEINDEX sequence);
+	// Give back a row visitor obtained from AcquireRowVisitor() once it is no longer needed.
+	void ReleaseRowVisitor(std::unique_ptr<RowVisitor> visitor);
+
+	size_t GetMemoryUsage() const;
+};
+
+
+OPENMPT_NAMESPACE_END
@@ -324,9 +324,6 @@ ITDecompression::ITDecompression(FileReader &file, ModSample &sample, bool it215
 				continue;	// Malformed sample?
 			bitFile = file.ReadChunk(compressedSize);
 
-			// Initialise bit reader
-			mem1 = mem2 = 0;
-
 			try
 			{
 				if(mptSample.GetElementarySampleSize() > 1)
@@ -346,44 +343,75 @@ ITDecompression::ITDecompression(FileReader &file, ModSample &sample, bool it215
 template<typename Properties>
 void ITDecompression::Uncompress(typename Properties::sample_t *target)
 {
-	curLength = std::min(mptSample.nLength - writtenSamples, SmpLength(ITCompression::blockSize / sizeof(typename Properties::sample_t)));
-
+	typedef typename Properties::sample_t sample_t;
 	const int defWidth = Properties::defWidth; // gcc static const member reference workaround
 
+	// For every bit width, the range of values that announce a width change instead of a sample,
+	// and the shift amount for sign-extending sample values.
+	// Mode A (1 to 6 bits): Only the top bit value, the new width follows.
+	// Mode B (7 to 8 / 16 bits): A small range around the top bit value, which encodes the new width.
+	// Mode C (9 / 17 bits): All values with the top bit set, the remaining bits are the new width.
+	// Sample values in mode C are not sign-extended by the original algorithm, but since only the lower 8 / 16 bits of the integrator end up in the sample, it makes no difference.
+	struct WidthInfo
+	{
+		uint32 first, count;
+		int signShift;
+	} widthInfo[defWidth + 1];
+	for(int w = 1; w <= defWidth; w++)
+	{
+		const uint32 topBit = 1u << (w - 1);
+		if(w <= 6)
+			widthInfo[w] = { topBit, 1, 32 - w };
+		else if(w < defWidth)
+			widthInfo[w] = { topBit + Properties::lowerB, Properties::upperB - Properties::lowerB + 1, 32 - w };
+		else
+			widthInfo[w] = { topBit, topBit, 32 - (w - 1) };
+	}
+
+	// Work on local copies of the decoder state so that the compiler can keep it in registers
+	const SmpLength numChannels = mptSample.GetNumChannels();
+	SmpLength length = std::min(mptSample.nLength - writtenSamples, SmpLength(ITCompression::blockSize / sizeof(sample_t)));
+	SmpLength written = writtenSamples, pos = writePos;
+	unsigned int mem1 = 0, mem2 = 0;	// Integrator memory
 	int width = defWidth;
-	while(curLength > 0)
+	try
 	{
-		if(width > defWidth)
+		while(length > 0)
 		{
-			// Error!
-			return;
-		}
+			if(width > defWidth)
+			{
+				// Error!
+				break;
+			}
 
-		int v = bitFile.ReadBits(width);
-		const int topBit = (1 << (width - 1));
-		if(width <= 6)
-		{
-			// Mode A: 1 to 6 bits
-			if(v == topBit)
-				ChangeWidth(width, bitFile.ReadBits(Properties::fetchA));
-			else
-				Write<Properties>(v, topBit, target);
-		} else if(width < defWidth)
-		{
-			// Mode B: 7 to 8 / 16 bits
-			if(v >= topBit + Properties::lowerB && v <= topBit + Properties::upperB)
-				ChangeWidth(width, v - (topBit + Properties::lowerB));
-			else
-				Write<Properties>(v, topBit, target);
-		} else
-		{
-			// Mode C: 9 / 17 bits
-			if(v & topBit)
-				width = (v & ~topBit) + 1;
-			else
-				Write<Properties>((v & ~topBit), 0, target);
+			const uint32 v = bitFile.ReadBits(width);
+			const WidthInfo &info = widthInfo[width];
+			if(v - info.first < info.count)
+			{
+				if(width <= 6)
+					ChangeWidth(width, bitFile.ReadBits(Properties::fetchA));
+				else if(width < defWidth)
+					ChangeWidth(width, v - info.first);
+				else
+					width = (v - info.first) + 1;
+			} else
+			{
+				mem1 += static_cast<int32>(v << info.signShift) >> info.signShift;
+				mem2 += mem1;
+				target[pos] = static_cast<sample_t>(static_cast<int>(is215 ? mem2 : mem1));
+				pos += numChannels;
+				written++;
+				length--;
+			}
 		}
+	} catch(const BitReader::eof &)
+	{
+		writtenSamples = written;
+		writePos = pos;
+		throw;
 	}
+	writtenSamples = written;
+	writePos = pos;
 }
 
 
@@ -396,18 +424,4 @@ void ITDecompression::ChangeWidth(int &curWidth, int width)
 }
 
 
-template<typename Properties>
-void ITDecompression::Write(int v, int topBit, typename Properties::sample_t *target)
-{
-	if(v & topBit)
-		v -= (topBit << 1);
-	mem1 += v;
-	mem2 += mem1;
-	target[writePos] = static_cast<typename Properties::sample_t>(static_cast<int>(is215 ? mem2 : mem1));
-	writtenSamples++;
-	writePos += mptSample.GetNumChannels();
-	curLength--;
-}
-
-
 OPENMPT_NAMESPACE_END
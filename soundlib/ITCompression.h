@@ -78,16 +78,11 @@ protected:
 
 	SmpLength writtenSamples;	// Number of samples so far written on this channel
 	SmpLength writePos;			// Absolut write position in sample (for stereo samples)
-	SmpLength curLength;		// Length of currently processed block
-	unsigned int mem1, mem2;	// Integrator memory
 	bool is215;					// Use IT2.15 compression (double deltas)
 
 	template<typename Properties>
 	void Uncompress(typename Properties::sample_t *target);
 	static void ChangeWidth(int &curWidth, int width);
-
-	template<typename Properties>
-	void Write(int v, int topbit, typename Properties::sample_t *target);
 };
 
 
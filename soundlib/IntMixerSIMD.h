@@ -0,0 +1,448 @@
+/*
+ * IntMixerSIMD.h
+ * --------------
+ * Purpose: SSE4.1 / AVX2 versions of the fixed point mixer interpolation classes and sample loops.
+ * Notes  : All functions in here produce bit-exact results compared to their scalar counterparts in IntMixer.h.
+ *          Only the interpolation (which dominates the cost of the HQ resamplers) is vectorized,
+ *          filtering and mixing into the output buffer still happens one sampling point at a time.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "IntMixer.h"
+
+#if defined(ENABLE_INTRINSICS_SSE4_1) || defined(ENABLE_INTRINSICS_AVX2)
+#include <immintrin.h>
+#endif
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#if defined(ENABLE_INTRINSICS_SSE4_1)
+
+namespace MixerSIMD
+{
+
+//////////////////////////////////////////////////////////////////////////
+// Helpers for reading sampling points as 16-bit integers (identical to IntToIntTraits<..., 16>::Convert)
+
+// Load 4 consecutive 8-bit or 16-bit samples
+static MPT_TARGET_SSE4_1 MPT_FORCEINLINE __m128i Load4(const int16 *p)
+{
+	return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+}
+static MPT_TARGET_SSE4_1 MPT_FORCEINLINE __m128i Load4(const int8 *p)
+{
+	int32 v;
+	std::memcpy(&v, p, sizeof(v));
+	return _mm_slli_epi16(_mm_cvtepi8_epi16(_mm_cvtsi32_si128(v)), 8);
+}
+
+// Load 8 consecutive 8-bit or 16-bit samples
+static MPT_TARGET_SSE4_1 MPT_FORCEINLINE __m128i Load8(const int16 *p)
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+static MPT_TARGET_SSE4_1 MPT_FORCEINLINE __m128i Load8(const int8 *p)
+{
+	return _mm_slli_epi16(_mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))), 8);
+}
+
+// Load 16 consecutive 8-bit or 16-bit samples into two registers
+static MPT_TARGET_SSE4_1 MPT_FORCEINLINE void Load16(const int16 *p, __m128i &lo, __m128i &hi)
+{
+	lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+	hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8));
+}
+static MPT_TARGET_SSE4_1 MPT_FORCEINLINE void Load16(const int8 *p, __m128i &lo, __m128i &hi)
+{
+	const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+	lo = _mm_slli_epi16(_mm_cvtepi8_epi16(v), 8);
+	hi = _mm_slli_epi16(_mm_cvtepi8_epi16(_mm_srli_si128(v, 8)), 8);
+}
+
+// Turn LRLRLRLR into LLLLRRRR
+static MPT_TARGET_SSE4_1 MPT_FORCEINLINE __m128i Deinterleave4(__m128i v)
+{
+	return _mm_shuffle_epi8(v, _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15));
+}
+
+// Horizontally add the four 32-bit sums of a and b, returning a in element 0 and b in element 1.
+static MPT_TARGET_SSE4_1 MPT_FORCEINLINE __m128i HorizontalSum2(__m128i a, __m128i b)
+{
+	const __m128i sum = _mm_hadd_epi32(a, b);
+	return _mm_hadd_epi32(sum, sum);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// SSE4.1 interpolation templates
+// One output sampling point is computed per call, the 4 or 8 filter taps are evaluated using pmaddwd.
+
+template<class Traits>
+struct FastSincInterpolationSSE4_1
+{
+	static_assert(std::is_same<typename Traits::output_t, int32>::value, "Integer mixer required");
+
+	MPT_FORCEINLINE void Start(const ModChannel &, const CResampler &) { }
+	MPT_FORCEINLINE void End(const ModChannel &) { }
+
+	MPT_TARGET_SSE4_1 MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		const __m128i lut = Load4(CResampler::FastSincTable + ((posLo >> 22) & 0x3FC));
+		if(Traits::numChannelsIn == 1)
+		{
+			const __m128i sum = _mm_madd_epi16(Load4(inBuffer - 1), lut);
+			outSample[0] = _mm_cvtsi128_si32(_mm_hadd_epi32(sum, sum)) / 16384;
+		} else
+		{
+			const __m128i sum = _mm_madd_epi16(Deinterleave4(Load8(inBuffer - 2)), _mm_unpacklo_epi64(lut, lut));
+			const __m128i lr = _mm_hadd_epi32(sum, sum);
+			outSample[0] = _mm_cvtsi128_si32(lr) / 16384;
+			outSample[1] = _mm_extract_epi32(lr, 1) / 16384;
+		}
+	}
+};
+
+
+// Shared implementation of the 8-tap interpolators.
+// Returns the four partial sums (taps 0-1, 2-3, 4-5, 6-7) for each input channel.
+template<class Traits>
+struct EightTapSSE4_1
+{
+	static MPT_TARGET_SSE4_1 MPT_FORCEINLINE void Process(const typename Traits::input_t * const MPT_RESTRICT inBuffer, const int16 * const lutPtr, __m128i &sumL, __m128i &sumR)
+	{
+		const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lutPtr));
+		if(Traits::numChannelsIn == 1)
+		{
+			sumL = _mm_madd_epi16(Load8(inBuffer - 3), lut);
+			sumR = sumL;
+		} else
+		{
+			__m128i lo, hi;
+			Load16(inBuffer - 6, lo, hi);
+			lo = Deinterleave4(lo);
+			hi = Deinterleave4(hi);
+			sumL = _mm_madd_epi16(_mm_unpacklo_epi64(lo, hi), lut);
+			sumR = _mm_madd_epi16(_mm_unpackhi_epi64(lo, hi), lut);
+		}
+	}
+};
+
+
+template<class Traits>
+struct PolyphaseInterpolationSSE4_1 : public PolyphaseInterpolation<Traits>
+{
+	static_assert(std::is_same<typename Traits::output_t, int32>::value, "Integer mixer required");
+
+	MPT_TARGET_SSE4_1 MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		__m128i sumL, sumR;
+		EightTapSSE4_1<Traits>::Process(inBuffer, this->sinc + ((posLo >> (32 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH, sumL, sumR);
+		const __m128i lr = HorizontalSum2(sumL, sumR);
+		outSample[0] = _mm_cvtsi128_si32(lr) / (1 << SINC_QUANTSHIFT);
+		if(Traits::numChannelsIn == 2)
+			outSample[1] = _mm_extract_epi32(lr, 1) / (1 << SINC_QUANTSHIFT);
+	}
+};
+
+
+template<class Traits>
+struct FIRFilterInterpolationSSE4_1 : public FIRFilterInterpolation<Traits>
+{
+	static_assert(std::is_same<typename Traits::output_t, int32>::value, "Integer mixer required");
+
+	MPT_TARGET_SSE4_1 MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		__m128i sumL, sumR;
+		EightTapSSE4_1<Traits>::Process(inBuffer, this->WFIRlut + ((((posLo >> 16) + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK), sumL, sumR);
+		// Elements: L taps 0-3, L taps 4-7, R taps 0-3, R taps 4-7
+		const __m128i vol = _mm_hadd_epi32(sumL, sumR);
+		outSample[0] = ((_mm_cvtsi128_si32(vol) / 2) + (_mm_extract_epi32(vol, 1) / 2)) / (1 << (WFIR_16BITSHIFT - 1));
+		if(Traits::numChannelsIn == 2)
+			outSample[1] = ((_mm_extract_epi32(vol, 2) / 2) + (_mm_extract_epi32(vol, 3) / 2)) / (1 << (WFIR_16BITSHIFT - 1));
+	}
+};
+
+} // namespace MixerSIMD
+
+
+// SSE4.1 version of SampleLoop (see MixerInterface.h).
+// This needs to be duplicated because the interpolation functors can only be inlined into functions compiled for the same instruction set.
+template<class Traits, class InterpolationFunc, class FilterFunc, class MixFunc>
+static MPT_TARGET_SSE4_1 void SampleLoopSSE4_1(ModChannel &chn, const CResampler &resampler, typename Traits::output_t * MPT_RESTRICT outBuffer, unsigned int numSamples)
+{
+	ModChannel &c = chn;
+	const typename Traits::input_t * MPT_RESTRICT inSample = static_cast<const typename Traits::input_t *>(c.pCurrentSample);
+
+	InterpolationFunc interpolate;
+	FilterFunc filter;
+	MixFunc mix;
+
+	// Do initialisation if necessary
+	interpolate.Start(c, resampler);
+	filter.Start(c);
+	mix.Start(c);
+
+	unsigned int samples = numSamples;
+	SamplePosition smpPos = c.position;	// Fixed-point sample position
+	const SamplePosition increment = c.increment;	// Fixed-point sample increment
+
+	while(samples--)
+	{
+		typename Traits::outbuf_t outSample;
+		interpolate(outSample, inSample + smpPos.GetInt() * Traits::numChannelsIn, smpPos.GetFract());
+		filter(outSample, c);
+		mix(outSample, c, outBuffer);
+		outBuffer += Traits::numChannelsOut;
+
+		smpPos += increment;
+	}
+
+	mix.End(c);
+	filter.End(c);
+	interpolate.End(c);
+
+	c.position = smpPos;
+}
+
+#endif // ENABLE_INTRINSICS_SSE4_1
+
+
+#if defined(ENABLE_INTRINSICS_AVX2)
+
+namespace MixerSIMD
+{
+
+static MPT_TARGET_AVX2 MPT_FORCEINLINE __m256i Combine(__m128i lo, __m128i hi)
+{
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// AVX2 interpolation templates
+// These compute two consecutive output sampling points at once, which fills a whole 256-bit register for 8-tap mono
+// and 4-tap stereo interpolation. For 8-tap stereo interpolation, each sampling point fills a register on its own.
+
+template<class Traits>
+struct FastSincInterpolationAVX2 : public FastSincInterpolationSSE4_1<Traits>
+{
+	MPT_TARGET_AVX2 MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		FastSincInterpolationSSE4_1<Traits>::operator() (outSample, inBuffer, posLo);
+	}
+
+	MPT_TARGET_AVX2 MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample0, typename Traits::outbuf_t &outSample1, const typename Traits::input_t * const MPT_RESTRICT inBuffer0, const uint32 posLo0, const typename Traits::input_t * const MPT_RESTRICT inBuffer1, const uint32 posLo1)
+	{
+		const __m128i lut0 = Load4(CResampler::FastSincTable + ((posLo0 >> 22) & 0x3FC));
+		const __m128i lut1 = Load4(CResampler::FastSincTable + ((posLo1 >> 22) & 0x3FC));
+		if(Traits::numChannelsIn == 1)
+		{
+			// Elements: Point 0 taps 0-1, 2-3, point 1 taps 0-1, 2-3
+			const __m128i sum = _mm_madd_epi16(_mm_unpacklo_epi64(Load4(inBuffer0 - 1), Load4(inBuffer1 - 1)), _mm_unpacklo_epi64(lut0, lut1));
+			const __m128i vol = _mm_hadd_epi32(sum, sum);
+			outSample0[0] = _mm_cvtsi128_si32(vol) / 16384;
+			outSample1[0] = _mm_extract_epi32(vol, 1) / 16384;
+		} else
+		{
+			const __m256i in = Combine(Deinterleave4(Load8(inBuffer0 - 2)), Deinterleave4(Load8(inBuffer1 - 2)));
+			const __m256i sum = _mm256_madd_epi16(in, Combine(_mm_unpacklo_epi64(lut0, lut0), _mm_unpacklo_epi64(lut1, lut1)));
+			// Elements: point 0 left, right, left, right, point 1 left, right, left, right
+			const __m256i lr = _mm256_hadd_epi32(sum, sum);
+			const __m128i lr0 = _mm256_castsi256_si128(lr), lr1 = _mm256_extracti128_si256(lr, 1);
+			outSample0[0] = _mm_cvtsi128_si32(lr0) / 16384;
+			outSample0[1] = _mm_extract_epi32(lr0, 1) / 16384;
+			outSample1[0] = _mm_cvtsi128_si32(lr1) / 16384;
+			outSample1[1] = _mm_extract_epi32(lr1, 1) / 16384;
+		}
+	}
+};
+
+
+// Shared implementation of the 8-tap interpolators.
+// For mono, returns the four partial sums (taps 0-1, 2-3, 4-5, 6-7) of the first and second sampling point in the lower and upper half.
+// For stereo, returns left taps 0-1, 2-3, right taps 0-1, 2-3, left taps 4-5, 6-7, right taps 4-5, 6-7 of one sampling point.
+template<class Traits>
+struct EightTapAVX2
+{
+	static MPT_TARGET_AVX2 MPT_FORCEINLINE __m256i ProcessMono(const typename Traits::input_t * const MPT_RESTRICT inBuffer0, const int16 * const lut0, const typename Traits::input_t * const MPT_RESTRICT inBuffer1, const int16 * const lut1)
+	{
+		const __m256i lut = Combine(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lut0)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(lut1)));
+		return _mm256_madd_epi16(Combine(Load8(inBuffer0 - 3), Load8(inBuffer1 - 3)), lut);
+	}
+
+	static MPT_TARGET_AVX2 MPT_FORCEINLINE __m256i ProcessStereo(const typename Traits::input_t * const MPT_RESTRICT inBuffer, const int16 * const lutPtr)
+	{
+		// Taps 0-3 in the lower half, taps 4-7 in the upper half, for both left and right channel
+		const __m256i lut = _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lutPtr))), _mm256_setr_epi32(0, 1, 0, 1, 2, 3, 2, 3));
+		__m128i lo, hi;
+		Load16(inBuffer - 6, lo, hi);
+		return _mm256_madd_epi16(Combine(Deinterleave4(lo), Deinterleave4(hi)), lut);
+	}
+};
+
+
+template<class Traits>
+struct PolyphaseInterpolationAVX2 : public PolyphaseInterpolation<Traits>
+{
+	static_assert(std::is_same<typename Traits::output_t, int32>::value, "Integer mixer required");
+
+	MPT_FORCEINLINE const int16 *GetLUT(const uint32 posLo) const
+	{
+		return this->sinc + ((posLo >> (32 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH;
+	}
+
+	MPT_TARGET_AVX2 MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		if(Traits::numChannelsIn == 1)
+		{
+			__m128i sumL, sumR;
+			EightTapSSE4_1<Traits>::Process(inBuffer, GetLUT(posLo), sumL, sumR);
+			outSample[0] = _mm_cvtsi128_si32(HorizontalSum2(sumL, sumR)) / (1 << SINC_QUANTSHIFT);
+		} else
+		{
+			const __m256i sum = EightTapAVX2<Traits>::ProcessStereo(inBuffer, GetLUT(posLo));
+			const __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+			const __m128i lr = _mm_hadd_epi32(half, half);
+			outSample[0] = _mm_cvtsi128_si32(lr) / (1 << SINC_QUANTSHIFT);
+			outSample[1] = _mm_extract_epi32(lr, 1) / (1 << SINC_QUANTSHIFT);
+		}
+	}
+
+	MPT_TARGET_AVX2 MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample0, typename Traits::outbuf_t &outSample1, const typename Traits::input_t * const MPT_RESTRICT inBuffer0, const uint32 posLo0, const typename Traits::input_t * const MPT_RESTRICT inBuffer1, const uint32 posLo1)
+	{
+		if(Traits::numChannelsIn == 1)
+		{
+			__m256i sum = EightTapAVX2<Traits>::ProcessMono(inBuffer0, GetLUT(posLo0), inBuffer1, GetLUT(posLo1));
+			sum = _mm256_hadd_epi32(sum, sum);
+			sum = _mm256_hadd_epi32(sum, sum);
+			outSample0[0] = _mm_cvtsi128_si32(_mm256_castsi256_si128(sum)) / (1 << SINC_QUANTSHIFT);
+			outSample1[0] = _mm_cvtsi128_si32(_mm256_extracti128_si256(sum, 1)) / (1 << SINC_QUANTSHIFT);
+		} else
+		{
+			(*this)(outSample0, inBuffer0, posLo0);
+			(*this)(outSample1, inBuffer1, posLo1);
+		}
+	}
+};
+
+
+template<class Traits>
+struct FIRFilterInterpolationAVX2 : public FIRFilterInterpolation<Traits>
+{
+	static_assert(std::is_same<typename Traits::output_t, int32>::value, "Integer mixer required");
+
+	MPT_FORCEINLINE const int16 *GetLUT(const uint32 posLo) const
+	{
+		return this->WFIRlut + ((((posLo >> 16) + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK);
+	}
+
+	static MPT_FORCEINLINE int32 Finish(int32 vol1, int32 vol2)
+	{
+		return ((vol1 / 2) + (vol2 / 2)) / (1 << (WFIR_16BITSHIFT - 1));
+	}
+
+	MPT_TARGET_AVX2 MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		if(Traits::numChannelsIn == 1)
+		{
+			__m128i sumL, sumR;
+			EightTapSSE4_1<Traits>::Process(inBuffer, GetLUT(posLo), sumL, sumR);
+			const __m128i vol = _mm_hadd_epi32(sumL, sumL);
+			outSample[0] = Finish(_mm_cvtsi128_si32(vol), _mm_extract_epi32(vol, 1));
+		} else
+		{
+			// Elements: left taps 0-3, right taps 0-3 (twice), left taps 4-7, right taps 4-7 (twice)
+			__m256i sum = EightTapAVX2<Traits>::ProcessStereo(inBuffer, GetLUT(posLo));
+			sum = _mm256_hadd_epi32(sum, sum);
+			const __m128i vol1 = _mm256_castsi256_si128(sum), vol2 = _mm256_extracti128_si256(sum, 1);
+			outSample[0] = Finish(_mm_cvtsi128_si32(vol1), _mm_cvtsi128_si32(vol2));
+			outSample[1] = Finish(_mm_extract_epi32(vol1, 1), _mm_extract_epi32(vol2, 1));
+		}
+	}
+
+	MPT_TARGET_AVX2 MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample0, typename Traits::outbuf_t &outSample1, const typename Traits::input_t * const MPT_RESTRICT inBuffer0, const uint32 posLo0, const typename Traits::input_t * const MPT_RESTRICT inBuffer1, const uint32 posLo1)
+	{
+		if(Traits::numChannelsIn == 1)
+		{
+			// Elements: point 0 taps 0-3, 4-7 (twice), point 1 taps 0-3, 4-7 (twice)
+			__m256i sum = EightTapAVX2<Traits>::ProcessMono(inBuffer0, GetLUT(posLo0), inBuffer1, GetLUT(posLo1));
+			sum = _mm256_hadd_epi32(sum, sum);
+			const __m128i vol0 = _mm256_castsi256_si128(sum), vol1 = _mm256_extracti128_si256(sum, 1);
+			outSample0[0] = Finish(_mm_cvtsi128_si32(vol0), _mm_extract_epi32(vol0, 1));
+			outSample1[0] = Finish(_mm_cvtsi128_si32(vol1), _mm_extract_epi32(vol1, 1));
+		} else
+		{
+			(*this)(outSample0, inBuffer0, posLo0);
+			(*this)(outSample1, inBuffer1, posLo1);
+		}
+	}
+};
+
+} // namespace MixerSIMD
+
+
+// AVX2 version of SampleLoop (see MixerInterface.h).
+// The interpolation functor is asked for two sampling points at once. As interpolation does not depend on the filter or mix state,
+// the result is identical to computing them one by one.
+template<class Traits, class InterpolationFunc, class FilterFunc, class MixFunc>
+static MPT_TARGET_AVX2 void SampleLoopAVX2(ModChannel &chn, const CResampler &resampler, typename Traits::output_t * MPT_RESTRICT outBuffer, unsigned int numSamples)
+{
+	ModChannel &c = chn;
+	const typename Traits::input_t * MPT_RESTRICT inSample = static_cast<const typename Traits::input_t *>(c.pCurrentSample);
+
+	InterpolationFunc interpolate;
+	FilterFunc filter;
+	MixFunc mix;
+
+	// Do initialisation if necessary
+	interpolate.Start(c, resampler);
+	filter.Start(c);
+	mix.Start(c);
+
+	unsigned int samples = numSamples;
+	SamplePosition smpPos = c.position;	// Fixed-point sample position
+	const SamplePosition increment = c.increment;	// Fixed-point sample increment
+
+	while(samples >= 2)
+	{
+		const SamplePosition smpPos1 = smpPos + increment;
+		typename Traits::outbuf_t outSample0, outSample1;
+		interpolate(outSample0, outSample1,
+			inSample + smpPos.GetInt() * Traits::numChannelsIn, smpPos.GetFract(),
+			inSample + smpPos1.GetInt() * Traits::numChannelsIn, smpPos1.GetFract());
+		filter(outSample0, c);
+		mix(outSample0, c, outBuffer);
+		outBuffer += Traits::numChannelsOut;
+		filter(outSample1, c);
+		mix(outSample1, c, outBuffer);
+		outBuffer += Traits::numChannelsOut;
+
+		smpPos = smpPos1 + increment;
+		samples -= 2;
+	}
+	if(samples)
+	{
+		typename Traits::outbuf_t outSample;
+		interpolate(outSample, inSample + smpPos.GetInt() * Traits::numChannelsIn, smpPos.GetFract());
+		filter(outSample, c);
+		mix(outSample, c, outBuffer);
+
+		smpPos += increment;
+	}
+
+	mix.End(c);
+	filter.End(c);
+	interpolate.End(c);
+
+	c.position = smpPos;
+}
+
+#endif // ENABLE_INTRINSICS_AVX2
+
+
+OPENMPT_NAMESPACE_END
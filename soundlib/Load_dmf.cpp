@@ -942,12 +942,15 @@ bool CSoundFile::ReadDMF(FileReader &file, ModLoadingFlags loadFlags)
 
 	// Read patterns
 	chunk = chunks.GetChunk(DMFChunk::idPATT);
-	if(chunk.IsValid() && (loadFlags & loadPatternData))
+	DMFPatterns patHeader;
+	if(chunk.IsValid() && (loadFlags & (loadPatternData | loadMetadata)))
 	{
-		DMFPatterns patHeader;
+		// The channel count is part of the module metadata, so it is also read if the pattern data itself is not loaded.
 		chunk.ReadStruct(patHeader);
 		m_nChannels = Clamp<uint8, uint8>(patHeader.numTracks, 1, 32) + 1;	// + 1 for global track (used for tempo stuff)
-
+	}
+	if(chunk.IsValid() && (loadFlags & loadPatternData))
+	{
 		// First, find out where all of our patterns are...
 		std::vector<FileReader> patternChunks(patHeader.numPatterns);
 		for(auto &patternChunk : patternChunks)
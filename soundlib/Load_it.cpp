@@ -797,11 +797,13 @@ bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
 			if(!sample.uFlags[SMP_KEEPONDISK])
 			{
 				SampleIO sampleIO = sampleHeader.GetSampleFormat(fileHeader.cwtv);
-				if(loadFlags & loadSampleData)
+				if((loadFlags & loadSampleData) && !(loadFlags & deferSampleData))
 				{
 					sampleIO.ReadSample(sample, file);
 				} else
 				{
+					if(loadFlags & loadSampleData)
+						DeferSampleData(i + 1, sampleIO, file);
 					if(sampleIO.IsVariableLengthEncoded())
 						lastSampleCompressed = true;
 					else
@@ -871,13 +873,15 @@ bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
 		AddToLog(mpt::format(str_PatternSetTruncationNote)(patPos.size(), numPats));
 	}
 
+	// Checking for number of used channels, which is not explicitely specified in the file.
+	// The channel count is part of the module metadata, so this is also done if the pattern data itself is not loaded.
+	const PATTERNINDEX numScannedPats = (loadFlags & (loadPatternData | loadMetadata)) ? numPats : 0;
 	if(!(loadFlags & loadPatternData))
 	{
 		numPats = 0;
 	}
 
-	// Checking for number of used channels, which is not explicitely specified in the file.
-	for(PATTERNINDEX pat = 0; pat < numPats; pat++)
+	for(PATTERNINDEX pat = 0; pat < numScannedPats; pat++)
 	{
 		if(patPos[pat] == 0 || !file.Seek(patPos[pat]))
 			continue;
@@ -682,7 +682,8 @@ bool CSoundFile::ReadMDL(FileReader &file, ModLoadingFlags loadFlags)
 	}
 
 	// Read actual patterns
-	if((loadFlags & loadPatternData) && (chunk = chunks.GetChunk(MDLChunk::idPats)).IsValid())
+	// The channel count is part of the module metadata, so the patterns are also scanned if the pattern data itself is not loaded.
+	if((loadFlags & (loadPatternData | loadMetadata)) && (chunk = chunks.GetChunk(MDLChunk::idPats)).IsValid())
 	{
 		PATTERNINDEX numPats = chunk.ReadUint8();
 
@@ -706,6 +707,10 @@ bool CSoundFile::ReadMDL(FileReader &file, ModLoadingFlags loadFlags)
 		}
 		chunk.Seek(1);
 
+		if(!(loadFlags & loadPatternData))
+		{
+			numPats = 0;
+		}
 		Patterns.ResizeArray(numPats);
 		for(PATTERNINDEX pat = 0; pat < numPats; pat++)
 		{
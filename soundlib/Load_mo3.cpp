@@ -21,6 +21,7 @@
 
 #include "MPEGFrame.h"
 #include "OggStream.h"
+#include "../common/mptThreadPool.h"
 #if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
 #include "../common/mptBufferIO.h"
 #endif
@@ -326,125 +327,188 @@ struct MO3SampleChunk
 };
 
 
-// Unpack macros
+struct MO3DeltaSample
+{
+	FileReader chunk;
+	SAMPLEINDEX smp;
+	bool prediction;
+	MO3DeltaSample(SAMPLEINDEX smp_, bool prediction_, const FileReader &chunk_)
+		: chunk(chunk_), smp(smp_), prediction(prediction_) { }
+};
+
+
+// Buffered input for the MO3 LZ decoder.
+// The compressed stream is read through pinned views of the file, so that fetching a byte does not have to go through the FileReader.
+// Reading past the end of the file returns 0, just like FileReader::ReadUint8().
+class MO3InputBuffer
+{
+	FileReader &m_file;
+	FileReader::PinnedRawDataView m_view;
+	const uint8 *m_pos = nullptr, *m_end = nullptr;
+
+	MPT_NOINLINE uint8 Refill()
+	{
+		m_file.Skip(m_view.size());
+		m_view = m_file.GetPinnedRawDataView(mpt::IO::BUFFERSIZE_NORMAL);
+		m_pos = reinterpret_cast<const uint8 *>(m_view.data());
+		m_end = m_pos + m_view.size();
+		if(m_pos == m_end)
+			return 0;
+		return *m_pos++;
+	}
+
+public:
+	MO3InputBuffer(FileReader &file) : m_file(file) { }
 
-// shift control bits until it is empty:
+	uint8 ReadUint8()
+	{
+		if(m_pos != m_end)
+			return *m_pos++;
+		return Refill();
+	}
+
+	// Advance the file cursor to the first byte that has not been consumed yet.
+	void Finish()
+	{
+		m_file.Skip(m_view.size() - (m_end - m_pos));
+		m_view.invalidate();
+		m_pos = m_end = nullptr;
+	}
+};
+
+
+// Copy an LZ match. Source and destination overlap if the match is longer than its distance, in which case the already copied bytes are repeated.
+static void CopyMO3Match(uint8 *dst, const uint8 *src, uint32 length)
+{
+	const std::ptrdiff_t distance = dst - src;
+	if(distance >= static_cast<std::ptrdiff_t>(length))
+	{
+		std::memcpy(dst, src, length);
+		return;
+	} else if(distance == 1)
+	{
+		std::memset(dst, *src, length);
+		return;
+	} else if(distance >= 8)
+	{
+		// Each 8-byte block only reads bytes that have already been written
+		while(length >= 8)
+		{
+			std::memcpy(dst, src, 8);
+			dst += 8;
+			src += 8;
+			length -= 8;
+		}
+	}
+	while(length--)
+	{
+		*dst++ = *src++;
+	}
+}
+
+
+// The control stream is read bit by bit, starting from the most significant bit of each control byte.
+// Control bytes are interleaved with the literal and offset bytes of the data stream.
 // a 0 bit means literal : the next data byte is copied
 // a 1 means compressed data
 // then the next 2 bits determines what is the LZ ptr
 // ('00' same as previous, else stored in stream)
-
-#define READ_CTRL_BIT \
-	data <<= 1; \
-	carry = (data > 0xFF); \
-	data &= 0xFF; \
-	if(data == 0) \
-	{ \
-		data = file.ReadUint8(); \
-		data = (data << 1) + 1; \
-		carry = (data > 0xFF); \
-		data &= 0xFF; \
-	}
-
-// length coded within control stream:
+//
+// Lengths are coded within control stream:
 // most significant bit is 1
 // then the first bit of each bits pair (noted n1),
 // until second bit is 0 (noted n0)
+//
+// All length and offset arithmetic is done on unsigned integers to get well-defined wrap-around on corrupted input.
 
-#define DECODE_CTRL_BITS \
-{ \
-	strLen++; \
-	do { \
-		READ_CTRL_BIT; \
-		strLen = (strLen << 1) + carry; \
-		READ_CTRL_BIT; \
-	} while(carry); \
-}
-
-static bool UnpackMO3Data(FileReader &file, uint8 *dst, uint32 size)
+bool UnpackMO3Data(FileReader &file, uint8 *dst, uint32 size)
 {
 	if(!size)
 	{
 		return false;
 	}
 
-	uint16 data = 0;
-	int8 carry = 0;			// x86 carry (used to propagate the most significant bit from one byte to another)
-	int32 strLen = 0;		// length of previous string
-	int32 strOffset;		// string offset
-	uint8 *initDst = dst;
-	uint32 ebp, previousPtr = 0;
-	uint32 initSize = size;
+	MO3InputBuffer input(file);
+	uint32 ctrl = 0;  // Current control byte, shifted left by the number of consumed bits. Bit 8 is the current control bit, and a sentinel bit marks the end of the byte.
+	const auto ReadCtrlBit = [&]()
+	{
+		ctrl <<= 1;
+		if(!(ctrl & 0xFF))
+		{
+			ctrl = (input.ReadUint8() << 1) | 1;
+		}
+		return (ctrl >> 8) & 1;
+	};
+	const auto DecodeCtrlBits = [&]()
+	{
+		uint32 value = 1;
+		do
+		{
+			value = (value << 1) + ReadCtrlBit();
+		} while(ReadCtrlBit());
+		return value;
+	};
+
+	int32 previousOffset = 0;
+	uint8 * const initDst = dst;
+	const uint32 initSize = size;
 
 	// Read first uncompressed byte
-	*dst++ = file.ReadUint8();
+	*dst++ = input.ReadUint8();
 	size--;
 
 	while(size > 0)
 	{
-		READ_CTRL_BIT;
-		if(!carry)
+		if(!ReadCtrlBit())
 		{
 			// a 0 ctrl bit means 'copy', not compressed byte
-			*dst++ = file.ReadUint8();
+			*dst++ = input.ReadUint8();
 			size--;
+			continue;
+		}
+
+		// a 1 ctrl bit means compressed bytes are following
+		// read length, and if strLen > 3 (coded using more than 1 bits pair) also part of the offset value
+		uint32 strLen = DecodeCtrlBits() - 3u;
+		int32 strOffset;
+		if(static_cast<int32>(strLen) < 0)
+		{
+			// means LZ ptr with same previous relative LZ ptr (saved one)
+			strOffset = previousOffset;
+			strLen = 0;
 		} else
 		{
-			// a 1 ctrl bit means compressed bytes are following
-			ebp = 0; // length adjustment
-			DECODE_CTRL_BITS; // read length, and if strLen > 3 (coded using more than 1 bits pair) also part of the offset value
-			strLen -=3;
-			if(strLen < 0)
-			{
-				// means LZ ptr with same previous relative LZ ptr (saved one)
-				strOffset = previousPtr;	// restore previous Ptr
+			// LZ ptr in ctrl stream, less significant offset byte is read from data stream
+			strOffset = static_cast<int32>(~((strLen << 8) | input.ReadUint8()));
+			// length is always at least 1, and longer for far offsets
+			strLen = 1;
+			if(strOffset < -1280)
 				strLen++;
-			} else
-			{
-				// LZ ptr in ctrl stream
-				strOffset = (strLen << 8) | file.ReadUint8(); // read less significant offset byte from stream
-				strLen = 0;
-				strOffset = ~strOffset;
-				if(strOffset < -1280)
-					ebp++;
-				ebp++;	// length is always at least 1
-				if(strOffset < -32000)
-					ebp++;
-				previousPtr = strOffset; // save current Ptr
-			}
+			if(strOffset < -32000)
+				strLen++;
+			previousOffset = strOffset;
+		}
 
-			// read the next 2 bits as part of strLen
-			READ_CTRL_BIT;
-			strLen = (strLen << 1) + carry;
-			READ_CTRL_BIT;
-			strLen = (strLen << 1) + carry;
-			if(strLen == 0)
-			{
-				// length does not fit in 2 bits
-				DECODE_CTRL_BITS;	// decode length: 1 is the most significant bit,
-				strLen += 2;		// then first bit of each bits pairs (noted n1), until n0.
-			}
-			strLen += ebp; // length adjustment
-			if(size >= static_cast<uint32>(strLen) && strLen > 0)
-			{
-				// Copy previous string
-				if(strOffset >= 0 || static_cast<std::ptrdiff_t>(dst - initDst) + strOffset < 0)
-				{
-					break;
-				}
-				size -= strLen;
-				const uint8 *string = dst + strOffset;
-				while(strLen > 0)
-				{
-					*dst++ = *string++;
-					strLen--;
-				}
-			} else
-			{
-				break;
-			}
+		// read the next 2 bits as part of strLen
+		uint32 lenBits = ReadCtrlBit() << 1;
+		lenBits |= ReadCtrlBit();
+		if(lenBits == 0)
+		{
+			// length does not fit in 2 bits
+			lenBits = DecodeCtrlBits() + 2u;
+		}
+		strLen += lenBits;
+
+		if(static_cast<int32>(strLen) <= 0 || size < strLen
+			|| strOffset >= 0 || (dst - initDst) + strOffset < 0)
+		{
+			break;
 		}
+		CopyMO3Match(dst, dst + strOffset, strLen);
+		dst += strLen;
+		size -= strLen;
 	}
+	input.Finish();
 #ifdef MPT_BUILD_FUZZER
 	// When using a fuzzer, we should not care if the decompressed buffer has the correct size.
 	// This makes finding new interesting test cases much easier.
@@ -457,6 +521,23 @@ static bool UnpackMO3Data(FileReader &file, uint8 *dst, uint32 size)
 }
 
 
+// Unpack macro for delta-compressed samples
+
+// shift control bits until it is empty, see UnpackMO3Data for the meaning of the bits
+
+#define READ_CTRL_BIT \
+	data <<= 1; \
+	carry = (data > 0xFF); \
+	data &= 0xFF; \
+	if(data == 0) \
+	{ \
+		data = file.ReadUint8(); \
+		data = (data << 1) + 1; \
+		carry = (data > 0xFF); \
+		data &= 0xFF; \
+	}
+
+
 struct MO3Delta8BitParams
 {
 	typedef int8 sample_t;
@@ -608,7 +689,6 @@ static void UnpackMO3DeltaPredictionSample(FileReader &file, typename Properties
 
 
 #undef READ_CTRL_BIT
-#undef DECODE_CTRL_BITS
 
 
 #if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
@@ -1259,6 +1339,10 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 		m_nInstruments = 0;
 
 	std::vector<MO3SampleChunk> sampleChunks(m_nSamples);
+	// Delta-compressed samples are unpacked and duplicate samples are copied once all sample headers have been read,
+	// so that the unpacking can be done on several threads.
+	std::vector<MO3DeltaSample> deltaSamples;
+	std::vector<std::pair<SAMPLEINDEX, SAMPLEINDEX>> duplicateSamples;	// Sample, sample to copy from
 
 	const bool frequencyIsHertz = (version >= 5 || !(fileHeader.flags & MO3FileHeader::linearSlides));
 	bool unsupportedSamples = false;
@@ -1301,14 +1385,7 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 		} else if(smpHeader.compressedSize < 0 && (smp + smpHeader.compressedSize) > 0)
 		{
 			// Duplicate sample
-			const ModSample &smpFrom = Samples[smp + smpHeader.compressedSize];
-			LimitMax(sample.nLength, smpFrom.nLength);
-			sample.uFlags.set(CHN_16BIT, smpFrom.uFlags[CHN_16BIT]);
-			sample.uFlags.set(CHN_STEREO, smpFrom.uFlags[CHN_STEREO]);
-			if(smpFrom.HasSampleData() && sample.AllocateSample())
-			{
-				memcpy(sample.sampleb(), smpFrom.sampleb(), sample.GetSampleSizeInBytes());
-			}
+			duplicateSamples.push_back(std::make_pair(smp, static_cast<SAMPLEINDEX>(smp + smpHeader.compressedSize)));
 		} else if(smpHeader.compressedSize > 0)
 		{
 			if(smpHeader.flags & MO3Sample::smp16Bit) sample.uFlags.set(CHN_16BIT);
@@ -1330,23 +1407,11 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 				LimitMax(sample.nLength, mpt::saturate_cast<SmpLength>(maxLength));
 			}
 
-			if(compression == MO3Sample::smpDeltaCompression)
-			{
-				if(sample.AllocateSample())
-				{
-					if(smpHeader.flags & MO3Sample::smp16Bit)
-						UnpackMO3DeltaSample<MO3Delta16BitParams>(sampleData, sample.sample16(), sample.nLength, numChannels);
-					else
-						UnpackMO3DeltaSample<MO3Delta8BitParams>(sampleData, sample.sample8(), sample.nLength, numChannels);
-				}
-			} else if(compression == MO3Sample::smpDeltaPrediction)
+			if(compression == MO3Sample::smpDeltaCompression || compression == MO3Sample::smpDeltaPrediction)
 			{
 				if(sample.AllocateSample())
 				{
-					if(smpHeader.flags & MO3Sample::smp16Bit)
-						UnpackMO3DeltaPredictionSample<MO3Delta16BitParams>(sampleData, sample.sample16(), sample.nLength, numChannels);
-					else
-						UnpackMO3DeltaPredictionSample<MO3Delta8BitParams>(sampleData, sample.sample8(), sample.nLength, numChannels);
+					deltaSamples.push_back(MO3DeltaSample(smp, compression == MO3Sample::smpDeltaPrediction, sampleData));
 				}
 			} else if(compression == MO3Sample::smpCompressionOgg || compression == MO3Sample::smpSharedOgg)
 			{
@@ -1391,15 +1456,56 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 		}
 	}
 
-	// Now we can load Ogg samples with shared headers.
 	if(loadFlags & loadSampleData)
 	{
-		for(SAMPLEINDEX smp = 1; smp <= m_nSamples; smp++)
+		const std::size_t numThreads = GetLoadThreads() ? GetLoadThreads() : mpt::thread_pool::hardware_concurrency();
+		// A pool size of 0 would mean hardware_concurrency(), so there must be at least one thread even without samples.
+		mpt::thread_pool pool(std::max<std::size_t>(std::min<std::size_t>(numThreads, m_nSamples), 1));
+
+		pool.parallel_for(deltaSamples.size(), [&](std::size_t i)
+		{
+			ModSample &sample = Samples[deltaSamples[i].smp];
+			FileReader &sampleData = deltaSamples[i].chunk;
+			const uint8 numChannels = sample.GetNumChannels();
+			if(!deltaSamples[i].prediction)
+			{
+				if(sample.uFlags[CHN_16BIT])
+					UnpackMO3DeltaSample<MO3Delta16BitParams>(sampleData, sample.sample16(), sample.nLength, numChannels);
+				else
+					UnpackMO3DeltaSample<MO3Delta8BitParams>(sampleData, sample.sample8(), sample.nLength, numChannels);
+			} else
+			{
+				if(sample.uFlags[CHN_16BIT])
+					UnpackMO3DeltaPredictionSample<MO3Delta16BitParams>(sampleData, sample.sample16(), sample.nLength, numChannels);
+				else
+					UnpackMO3DeltaPredictionSample<MO3Delta8BitParams>(sampleData, sample.sample8(), sample.nLength, numChannels);
+			}
+		});
+
+		for(const auto &duplicate : duplicateSamples)
+		{
+			ModSample &sample = Samples[duplicate.first];
+			const ModSample &smpFrom = Samples[duplicate.second];
+			LimitMax(sample.nLength, smpFrom.nLength);
+			sample.uFlags.set(CHN_16BIT, smpFrom.uFlags[CHN_16BIT]);
+			sample.uFlags.set(CHN_STEREO, smpFrom.uFlags[CHN_STEREO]);
+			if(smpFrom.HasSampleData() && sample.AllocateSample())
+			{
+				memcpy(sample.sampleb(), smpFrom.sampleb(), sample.GetSampleSizeInBytes());
+			}
+		}
+
+		// Now we can load Ogg samples with shared headers.
+		// Every sample only writes to its own ModSample and log message list, so they can be decoded in parallel.
+		std::vector<std::vector<std::pair<LogLevel, mpt::ustring>>> oggMessages(m_nSamples);
+		std::vector<uint8> oggUnsupported(m_nSamples, 0);
+		pool.parallel_for(m_nSamples, [&](std::size_t i)
 		{
+			const SAMPLEINDEX smp = static_cast<SAMPLEINDEX>(i + 1);
 			MO3SampleChunk &sampleChunk = sampleChunks[smp - 1];
 			// Is this an Ogg sample?
 			if(!sampleChunk.chunk.IsValid())
-				continue;
+				return;
 
 			SAMPLEINDEX sharedOggHeader = smp + sampleChunk.sharedHeader;
 			// Which chunk are we going to read the header from?
@@ -1482,8 +1588,8 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 				mpt::ostringstream mergedStream(std::ios::binary);
 				mergedStream.imbue(std::locale::classic());
 
-				sampleChunks[sharedOggHeader - 1].chunk.Rewind();
-				FileReader sharedChunk = sampleChunks[sharedOggHeader - 1].chunk.ReadChunk(sampleChunk.headerSize);
+				// Do not modify the shared header's chunk, as its own sample may be decoded on another thread at the same time.
+				FileReader sharedChunk = sampleChunks[sharedOggHeader - 1].chunk.GetChunkAt(0, sampleChunk.headerSize);
 				sharedChunk.Rewind();
 
 				std::vector<uint32> dataStreamSerials;
@@ -1541,13 +1647,13 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 
 				if(headStreamSerials.size() > 1)
 				{
-					AddToLog(LogWarning, mpt::format(MPT_USTRING("Sample %1: Ogg Vorbis data with shared header and multiple logical bitstreams in header chunk found. This may be handled incorrectly."))(smp));
+					oggMessages[smp - 1].push_back(std::make_pair(LogWarning, mpt::format(MPT_USTRING("Sample %1: Ogg Vorbis data with shared header and multiple logical bitstreams in header chunk found. This may be handled incorrectly."))(smp)));
 				} else if(dataStreamSerials.size() > 1)
 				{
-					AddToLog(LogWarning, mpt::format(MPT_USTRING("Sample %1: Ogg Vorbis sample with shared header and multiple logical bitstreams found. This may be handled incorrectly."))(smp));
+					oggMessages[smp - 1].push_back(std::make_pair(LogWarning, mpt::format(MPT_USTRING("Sample %1: Ogg Vorbis sample with shared header and multiple logical bitstreams found. This may be handled incorrectly."))(smp)));
 				} else if((dataStreamSerials.size() == 1) && (headStreamSerials.size() == 1) && (dataStreamSerials[0] != headStreamSerials[0]))
 				{
-					AddToLog(LogInformation, mpt::format(MPT_USTRING("Sample %1: Ogg Vorbis data with shared header and different logical bitstream serials found."))(smp));
+					oggMessages[smp - 1].push_back(std::make_pair(LogInformation, mpt::format(MPT_USTRING("Sample %1: Ogg Vorbis data with shared header and different logical bitstream serials found."))(smp)));
 				}
 
 				std::string mergedStreamData = mergedStream.str();
@@ -1568,7 +1674,9 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 #else // !(MPT_WITH_VORBIS && MPT_WITH_VORBISFILE)
 
 			FileReader &sampleData = sampleChunk.chunk;
-			FileReader &headerChunk = sharedHeader ? sampleChunks[sharedOggHeader - 1].chunk : sampleData;
+			// Do not modify the shared header's chunk, as its own sample may be decoded on another thread at the same time.
+			FileReader sharedHeaderChunk = sharedHeader ? sampleChunks[sharedOggHeader - 1].chunk.GetChunkAt(0, sampleChunks[sharedOggHeader - 1].chunk.GetLength()) : FileReader();
+			FileReader &headerChunk = sharedHeader ? sharedHeaderChunk : sampleData;
 #if defined(MPT_WITH_STBVORBIS)
 			std::size_t initialRead = sharedHeader ? sampleChunk.headerSize : headerChunk.GetLength();
 #endif // MPT_WITH_STBVORBIS
@@ -1577,7 +1685,7 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 
 			headerChunk.Rewind();
 			if(sharedHeader && !headerChunk.CanRead(sampleChunk.headerSize))
-				continue;
+				return;
 
 #if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
 
@@ -1635,17 +1743,17 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 						}
 					} else
 					{
-						unsupportedSamples = true;
+						oggUnsupported[smp - 1] = true;
 					}
 				} else
 				{
-					AddToLog(LogWarning, mpt::format(MPT_USTRING("Sample %1: Unsupported Ogg Vorbis chained stream found."))(smp));
-					unsupportedSamples = true;
+					oggMessages[smp - 1].push_back(std::make_pair(LogWarning, mpt::format(MPT_USTRING("Sample %1: Unsupported Ogg Vorbis chained stream found."))(smp)));
+					oggUnsupported[smp - 1] = true;
 				}
 				ov_clear(&vf);
 			} else
 			{
-				unsupportedSamples = true;
+				oggUnsupported[smp - 1] = true;
 			}
 
 #elif defined(MPT_WITH_STBVORBIS)
@@ -1708,14 +1816,26 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 				stb_vorbis_close(vorb);
 			} else
 			{
-				unsupportedSamples = true;
+				oggUnsupported[smp - 1] = true;
 			}
 
 #else // !VORBIS
 
-			unsupportedSamples = true;
+			oggUnsupported[smp - 1] = true;
 
 #endif // VORBIS
+		});
+
+		for(SAMPLEINDEX smp = 1; smp <= m_nSamples; smp++)
+		{
+			for(const auto &message : oggMessages[smp - 1])
+			{
+				AddToLog(message.first, message.second);
+			}
+			if(oggUnsupported[smp - 1])
+			{
+				unsupportedSamples = true;
+			}
 		}
 	}
 
@@ -85,4 +85,9 @@ bool ReadOrderFromFile(ModSequence &order, FileReader &file, size_t howMany, uin
 	return true;
 }
 
+
+// Decompress the LZ-compressed music data of an MO3 file into dst, which must be able to hold size bytes.
+// Returns true if exactly size bytes were decompressed.
+bool UnpackMO3Data(FileReader &file, uint8 *dst, uint32 size);
+
 OPENMPT_NAMESPACE_END
@@ -0,0 +1,67 @@
+/*
+ * MixBuffer.h
+ * -----------
+ * Purpose: Heap-allocated, aligned mix buffers with a size that is chosen at runtime.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+// Mix buffers are aligned to 32 bytes so that they can be accessed with full-width AVX loads and stores.
+// The allocated size is rounded up to a multiple of 8 elements, as some SIMD loops may process a few elements beyond the wanted length.
+template<typename buffer_t>
+class AlignedMixBuffer
+{
+protected:
+
+	std::vector<buffer_t> buffer;
+	buffer_t *alignedBuffer = nullptr;
+	std::size_t bufferSize = 0;
+
+	static_assert(sizeof(buffer_t) <= 32, "Check buffer alignment code");
+	static const uintptr_t bufferAlignmentInBytes = (32 - 1);
+	static const std::size_t additionalBuffer = bufferAlignmentInBytes / sizeof(buffer_t);
+
+public:
+
+	AlignedMixBuffer() = default;
+	explicit AlignedMixBuffer(std::size_t size) { Resize(size); }
+
+	// The aligned pointer refers into our own storage, so copying would need to re-align it.
+	AlignedMixBuffer(const AlignedMixBuffer &) = delete;
+	AlignedMixBuffer & operator = (const AlignedMixBuffer &) = delete;
+
+	// (Re-)allocate the buffer and silence it. Existing contents are not preserved.
+	void Resize(std::size_t size)
+	{
+		const std::size_t paddedSize = (size + 7u) & ~std::size_t(7);
+		buffer.assign(paddedSize + additionalBuffer, buffer_t(0));
+		alignedBuffer = reinterpret_cast<buffer_t *>((reinterpret_cast<uintptr_t>(buffer.data()) + bufferAlignmentInBytes) & ~bufferAlignmentInBytes);
+		bufferSize = size;
+	}
+
+	// Silence the whole buffer
+	void Clear()
+	{
+		std::fill(alignedBuffer, alignedBuffer + bufferSize, buffer_t(0));
+	}
+
+	std::size_t size() const { return bufferSize; }
+	buffer_t *data() { return alignedBuffer; }
+	const buffer_t *data() const { return alignedBuffer; }
+
+	operator buffer_t * () { return alignedBuffer; }
+	operator const buffer_t * () const { return alignedBuffer; }
+};
+
+
+OPENMPT_NAMESPACE_END
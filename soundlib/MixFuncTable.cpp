@@ -20,6 +20,7 @@
 
 #ifdef MPT_INTMIXER
 #include "IntMixer.h"
+#include "IntMixerSIMD.h"
 #else
 #include "FloatMixer.h"
 #endif // MPT_INTMIXER
@@ -40,22 +41,26 @@ namespace MixFuncTable
 	typedef Int16SToFloatS I16S;
 #endif // MPT_INTMIXER
 
-// Build mix function table for given resampling, filter and ramping settings: One function each for 8-Bit / 16-Bit Mono / Stereo
-#define BuildMixFuncTableRamp(resampling, filter, ramp) \
-	SampleLoop<I8M, resampling<I8M>, filter<I8M>, MixMono ## ramp<I8M> >, \
-	SampleLoop<I16M, resampling<I16M>, filter<I16M>, MixMono ## ramp<I16M> >, \
-	SampleLoop<I8S, resampling<I8S>, filter<I8S>, MixStereo ## ramp<I8S> >, \
-	SampleLoop<I16S, resampling<I16S>, filter<I16S>, MixStereo ## ramp<I16S> >
+// Build mix function table for given sample loop, resampling, filter and ramping settings: One function each for 8-Bit / 16-Bit Mono / Stereo
+#define BuildMixFuncTableRamp(loop, resampling, filter, ramp) \
+	loop<I8M, resampling<I8M>, filter<I8M>, MixMono ## ramp<I8M> >, \
+	loop<I16M, resampling<I16M>, filter<I16M>, MixMono ## ramp<I16M> >, \
+	loop<I8S, resampling<I8S>, filter<I8S>, MixStereo ## ramp<I8S> >, \
+	loop<I16S, resampling<I16S>, filter<I16S>, MixStereo ## ramp<I16S> >
 
-// Build mix function table for given resampling, filter settings: With and without ramping
-#define BuildMixFuncTableFilter(resampling, filter) \
-	BuildMixFuncTableRamp(resampling, filter, NoRamp), \
-	BuildMixFuncTableRamp(resampling, filter, Ramp)
+// Build mix function table for given sample loop, resampling, filter settings: With and without ramping
+#define BuildMixFuncTableFilter(loop, resampling, filter) \
+	BuildMixFuncTableRamp(loop, resampling, filter, NoRamp), \
+	BuildMixFuncTableRamp(loop, resampling, filter, Ramp)
 
-// Build mix function table for given resampling settings: With and without filter
+// Build mix function table for given sample loop and resampling settings: With and without filter
+#define BuildMixFuncTableLoop(loop, resampling) \
+	BuildMixFuncTableFilter(loop, resampling, NoFilter), \
+	BuildMixFuncTableFilter(loop, resampling, ResonantFilter)
+
+// Build mix function table for given resampling settings, using the generic sample loop
 #define BuildMixFuncTable(resampling) \
-	BuildMixFuncTableFilter(resampling, NoFilter), \
-	BuildMixFuncTableFilter(resampling, ResonantFilter)
+	BuildMixFuncTableLoop(SampleLoop, resampling)
 
 const MixFuncInterface Functions[6 * 16] =
 {
@@ -67,12 +72,56 @@ const MixFuncInterface Functions[6 * 16] =
 	BuildMixFuncTable(AmigaBlepInterpolation),	// Amiga emulation
 };
 
+// Only the multi-tap interpolation algorithms benefit from vectorization; all other entries are identical to the generic table.
+#if defined(MPT_INTMIXER) && defined(ENABLE_INTRINSICS_SSE4_1)
+const MixFuncInterface FunctionsSSE4_1[6 * 16] =
+{
+	BuildMixFuncTable(NoInterpolation),
+	BuildMixFuncTable(LinearInterpolation),
+	BuildMixFuncTableLoop(SampleLoopSSE4_1, MixerSIMD::FastSincInterpolationSSE4_1),
+	BuildMixFuncTableLoop(SampleLoopSSE4_1, MixerSIMD::PolyphaseInterpolationSSE4_1),
+	BuildMixFuncTableLoop(SampleLoopSSE4_1, MixerSIMD::FIRFilterInterpolationSSE4_1),
+	BuildMixFuncTable(AmigaBlepInterpolation),
+};
+#endif // MPT_INTMIXER && ENABLE_INTRINSICS_SSE4_1
+
+#if defined(MPT_INTMIXER) && defined(ENABLE_INTRINSICS_AVX2)
+const MixFuncInterface FunctionsAVX2[6 * 16] =
+{
+	BuildMixFuncTable(NoInterpolation),
+	BuildMixFuncTable(LinearInterpolation),
+	BuildMixFuncTableLoop(SampleLoopAVX2, MixerSIMD::FastSincInterpolationAVX2),
+	BuildMixFuncTableLoop(SampleLoopAVX2, MixerSIMD::PolyphaseInterpolationAVX2),
+	BuildMixFuncTableLoop(SampleLoopAVX2, MixerSIMD::FIRFilterInterpolationAVX2),
+	BuildMixFuncTable(AmigaBlepInterpolation),
+};
+#endif // MPT_INTMIXER && ENABLE_INTRINSICS_AVX2
+
 
 #undef BuildMixFuncTableRamp
 #undef BuildMixFuncTableFilter
+#undef BuildMixFuncTableLoop
 #undef BuildMixFuncTable
 
 
+const MixFuncInterface *GetFunctionTable()
+{
+#if defined(MPT_INTMIXER) && defined(ENABLE_INTRINSICS_AVX2)
+	if(GetProcSupport() & PROCSUPPORT_AVX2)
+	{
+		return FunctionsAVX2;
+	}
+#endif
+#if defined(MPT_INTMIXER) && defined(ENABLE_INTRINSICS_SSE4_1)
+	if(GetProcSupport() & PROCSUPPORT_SSE4_1)
+	{
+		return FunctionsSSE4_1;
+	}
+#endif
+	return Functions;
+}
+
+
 ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode)
 {
 	switch(resamplingMode)
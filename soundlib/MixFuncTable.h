@@ -42,7 +42,19 @@ namespace MixFuncTable
 		ndxAmigaBlep		= 0x50,
 	};
 
+	// Generic mix functions
 	extern const MixFuncInterface Functions[6 * 16];
+#if defined(MPT_INTMIXER) && defined(ENABLE_INTRINSICS_SSE4_1)
+	// Mix functions with SSE4.1-optimized interpolation
+	extern const MixFuncInterface FunctionsSSE4_1[6 * 16];
+#endif
+#if defined(MPT_INTMIXER) && defined(ENABLE_INTRINSICS_AVX2)
+	// Mix functions with AVX2-optimized interpolation
+	extern const MixFuncInterface FunctionsAVX2[6 * 16];
+#endif
+
+	// Returns the mix function table that is best suited for the processor features enabled at runtime.
+	const MixFuncInterface *GetFunctionTable();
 
 	ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode);
 }
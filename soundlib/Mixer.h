@@ -21,6 +21,7 @@ enum { MIXING_FILTER_PRECISION = 24 };	// Fixed point resonant filter bits
 typedef float mixsample_t;
 #endif
 
+// Default mix chunk size. Plugins and the EQ are never fed more than this many frames at once.
 #define MIXBUFFERSIZE 512
 #define NUMMIXINPUTBUFFERS 4
 
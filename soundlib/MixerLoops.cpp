@@ -21,6 +21,11 @@
 #include "MixerLoops.h"
 
 #include "Sndfile.h"
+#include "../soundbase/SampleFormatConverters.h"
+
+#if defined(ENABLE_INTRINSICS_SSE2) || defined(ENABLE_INTRINSICS_AVX2)
+#include <immintrin.h>
+#endif
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -479,6 +484,17 @@ void FloatToStereoMix(const float *pIn1, const float *pIn2, int32 *pOut, uint32
 }
 
 
+// Same as above, but for the floating point master mix: Interleave and scale without converting to fixed point.
+void FloatToStereoMix(const float *pIn1, const float *pIn2, float *pOut, uint32 nCount, const float _f2fc)
+{
+	for(uint32 i=0; i<nCount; ++i)
+	{
+		*pOut++ = *pIn1++ * _f2fc;
+		*pOut++ = *pIn2++ * _f2fc;
+	}
+}
+
+
 void MonoMixToFloat(const int32 *pSrc, float *pOut, uint32 nCount, const float _i2fc)
 {
 
@@ -569,7 +585,8 @@ interleaveloop:
 }
 #endif
 
-static void C_InterleaveFrontRear(mixsample_t *pFrontBuf, mixsample_t *pRearBuf, uint32 nFrames)
+template<typename Tsample>
+static void C_InterleaveFrontRear(Tsample *pFrontBuf, Tsample *pRearBuf, uint32 nFrames)
 {
 	// copy backwards as we are writing back into FrontBuf
 	for(int i=nFrames-1; i>=0; i--)
@@ -590,6 +607,13 @@ void InterleaveFrontRear(mixsample_t *pFrontBuf, mixsample_t *pRearBuf, uint32 n
 	#endif
 }
 
+#ifdef MPT_INTMIXER
+void InterleaveFrontRear(float *pFrontBuf, float *pRearBuf, uint32 nFrames)
+{
+	C_InterleaveFrontRear(pFrontBuf, pRearBuf, nFrames);
+}
+#endif // MPT_INTMIXER
+
 
 #ifdef ENABLE_X86
 static void X86_MonoFromStereo(int32 *pMixBuf, uint32 nSamples)
@@ -612,7 +636,8 @@ stloop:
 }
 #endif
 
-static void C_MonoFromStereo(mixsample_t *pMixBuf, uint32 nSamples)
+template<typename Tsample>
+static void C_MonoFromStereo(Tsample *pMixBuf, uint32 nSamples)
 {
 	for(uint32 i=0; i<nSamples; ++i)
 	{
@@ -629,6 +654,13 @@ void MonoFromStereo(mixsample_t *pMixBuf, uint32 nSamples)
 	#endif
 }
 
+#ifdef MPT_INTMIXER
+void MonoFromStereo(float *pMixBuf, uint32 nSamples)
+{
+	C_MonoFromStereo(pMixBuf, nSamples);
+}
+#endif // MPT_INTMIXER
+
 
 #define OFSDECAYSHIFT	8
 #define OFSDECAYMASK	0xFF
@@ -863,6 +895,376 @@ void DeinterleaveStereo(const mixsample_t * MPT_RESTRICT input, mixsample_t * MP
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////
+// Conversion of the fixed point master mix to the output format (SSE2 / AVX2 intrinsics)
+
+#if defined(ENABLE_INTRINSICS_SSE2)
+
+static const int MixToInt16Shift = SC::ConvertFixedPoint<int16, int32, MIXING_FRACTIONAL_BITS, false>::shiftBits;
+
+// Scalar conversion with arbitrary input and output strides for the remainders of the vectorized loops
+template<typename Tsample, bool clipOutput>
+static void ConvertMixScalar(Tsample *out, std::size_t outStride, const int32 *mix, std::size_t mixStride, std::size_t count)
+{
+	SC::ConvertFixedPoint<Tsample, int32, MIXING_FRACTIONAL_BITS, clipOutput> conv;
+	for(std::size_t i = 0; i < count; i++)
+	{
+		out[i * outStride] = conv(mix[i * mixStride]);
+	}
+}
+
+// Round and saturate 8 fixed point values to 16 bits
+static MPT_TARGET_SSE2 MPT_FORCEINLINE __m128i MixToInt16SSE2(__m128i a, __m128i b)
+{
+	const __m128i round = _mm_set1_epi32(1 << (MixToInt16Shift - 1));
+	a = _mm_srai_epi32(_mm_add_epi32(a, round), MixToInt16Shift);
+	b = _mm_srai_epi32(_mm_add_epi32(b, round), MixToInt16Shift);
+	return _mm_packs_epi32(a, b);
+}
+
+template<bool clipOutput>
+static MPT_TARGET_SSE2 MPT_FORCEINLINE __m128 MixToFloatSSE2(__m128i v)
+{
+	__m128 f = _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(1.0f / static_cast<float>(1 << MIXING_FRACTIONAL_BITS)));
+	MPT_CONSTANT_IF(clipOutput)
+	{
+		f = _mm_min_ps(_mm_max_ps(f, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+	}
+	return f;
+}
+
+// LRLR + LRLR => LLLL, RRRR
+static MPT_TARGET_SSE2 MPT_FORCEINLINE void Deinterleave2SSE2(__m128i a, __m128i b, __m128i &l, __m128i &r)
+{
+	l = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+	r = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+// Four frames of four channels => four channels of four frames
+static MPT_TARGET_SSE2 MPT_FORCEINLINE void Deinterleave4SSE2(__m128i &a, __m128i &b, __m128i &c, __m128i &d)
+{
+	__m128 r0 = _mm_castsi128_ps(a), r1 = _mm_castsi128_ps(b), r2 = _mm_castsi128_ps(c), r3 = _mm_castsi128_ps(d);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	a = _mm_castps_si128(r0);
+	b = _mm_castps_si128(r1);
+	c = _mm_castps_si128(r2);
+	d = _mm_castps_si128(r3);
+}
+
+static MPT_TARGET_SSE2 void ConvertMixToInt16SSE2(int16 *out, const int32 *mix, std::size_t count)
+{
+	const std::size_t numVectors = count / 8;
+	for(std::size_t i = 0; i < numVectors; i++, mix += 8, out += 8)
+	{
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mix));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mix + 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out), MixToInt16SSE2(a, b));
+	}
+	ConvertMixScalar<int16, false>(out, 1, mix, 1, count % 8);
+}
+
+static MPT_TARGET_SSE2 void ConvertMixToInt16StereoSSE2(int16 *outL, int16 *outR, const int32 *mix, std::size_t frames)
+{
+	const std::size_t numVectors = frames / 8;
+	for(std::size_t i = 0; i < numVectors; i++, mix += 16, outL += 8, outR += 8)
+	{
+		__m128i l0, r0, l1, r1;
+		Deinterleave2SSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(mix)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(mix + 4)), l0, r0);
+		Deinterleave2SSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(mix + 8)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(mix + 12)), l1, r1);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(outL), MixToInt16SSE2(l0, l1));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(outR), MixToInt16SSE2(r0, r1));
+	}
+	ConvertMixScalar<int16, false>(outL, 1, mix, 2, frames % 8);
+	ConvertMixScalar<int16, false>(outR, 1, mix + 1, 2, frames % 8);
+}
+
+static MPT_TARGET_SSE2 void ConvertMixToInt16QuadSSE2(int16 * const *outputBuffers, std::size_t offset, const int32 *mix, std::size_t frames)
+{
+	int16 *out[4] = { outputBuffers[0] + offset, outputBuffers[1] + offset, outputBuffers[2] + offset, outputBuffers[3] + offset };
+	const std::size_t numVectors = frames / 4;
+	for(std::size_t i = 0; i < numVectors; i++, mix += 16)
+	{
+		__m128i v[4];
+		for(int j = 0; j < 4; j++)
+		{
+			v[j] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mix + j * 4));
+		}
+		Deinterleave4SSE2(v[0], v[1], v[2], v[3]);
+		for(int channel = 0; channel < 4; channel++)
+		{
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(out[channel]), MixToInt16SSE2(v[channel], v[channel]));
+			out[channel] += 4;
+		}
+	}
+	for(int channel = 0; channel < 4; channel++)
+	{
+		ConvertMixScalar<int16, false>(out[channel], 1, mix + channel, 4, frames % 4);
+	}
+}
+
+template<bool clipOutput>
+static MPT_TARGET_SSE2 void ConvertMixToFloatSSE2(float *out, const int32 *mix, std::size_t count)
+{
+	const std::size_t numVectors = count / 4;
+	for(std::size_t i = 0; i < numVectors; i++, mix += 4, out += 4)
+	{
+		_mm_storeu_ps(out, MixToFloatSSE2<clipOutput>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(mix))));
+	}
+	ConvertMixScalar<float, clipOutput>(out, 1, mix, 1, count % 4);
+}
+
+template<bool clipOutput>
+static MPT_TARGET_SSE2 void ConvertMixToFloatStereoSSE2(float *outL, float *outR, const int32 *mix, std::size_t frames)
+{
+	const std::size_t numVectors = frames / 4;
+	for(std::size_t i = 0; i < numVectors; i++, mix += 8, outL += 4, outR += 4)
+	{
+		__m128i l, r;
+		Deinterleave2SSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(mix)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(mix + 4)), l, r);
+		_mm_storeu_ps(outL, MixToFloatSSE2<clipOutput>(l));
+		_mm_storeu_ps(outR, MixToFloatSSE2<clipOutput>(r));
+	}
+	ConvertMixScalar<float, clipOutput>(outL, 1, mix, 2, frames % 4);
+	ConvertMixScalar<float, clipOutput>(outR, 1, mix + 1, 2, frames % 4);
+}
+
+template<bool clipOutput>
+static MPT_TARGET_SSE2 void ConvertMixToFloatQuadSSE2(float * const *outputBuffers, std::size_t offset, const int32 *mix, std::size_t frames)
+{
+	float *out[4] = { outputBuffers[0] + offset, outputBuffers[1] + offset, outputBuffers[2] + offset, outputBuffers[3] + offset };
+	const std::size_t numVectors = frames / 4;
+	for(std::size_t i = 0; i < numVectors; i++, mix += 16)
+	{
+		__m128i v[4];
+		for(int j = 0; j < 4; j++)
+		{
+			v[j] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mix + j * 4));
+		}
+		Deinterleave4SSE2(v[0], v[1], v[2], v[3]);
+		for(int channel = 0; channel < 4; channel++)
+		{
+			_mm_storeu_ps(out[channel], MixToFloatSSE2<clipOutput>(v[channel]));
+			out[channel] += 4;
+		}
+	}
+	for(int channel = 0; channel < 4; channel++)
+	{
+		ConvertMixScalar<float, clipOutput>(out[channel], 1, mix + channel, 4, frames % 4);
+	}
+}
+
+#endif // ENABLE_INTRINSICS_SSE2
+
+#if defined(ENABLE_INTRINSICS_AVX2)
+
+// Round and saturate 16 fixed point values to 16 bits
+static MPT_TARGET_AVX2 MPT_FORCEINLINE __m256i MixToInt16AVX2(__m256i a, __m256i b)
+{
+	const __m256i round = _mm256_set1_epi32(1 << (MixToInt16Shift - 1));
+	a = _mm256_srai_epi32(_mm256_add_epi32(a, round), MixToInt16Shift);
+	b = _mm256_srai_epi32(_mm256_add_epi32(b, round), MixToInt16Shift);
+	// packs works within 128-bit lanes
+	return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+template<bool clipOutput>
+static MPT_TARGET_AVX2 MPT_FORCEINLINE __m256 MixToFloatAVX2(__m256i v)
+{
+	__m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(1.0f / static_cast<float>(1 << MIXING_FRACTIONAL_BITS)));
+	MPT_CONSTANT_IF(clipOutput)
+	{
+		f = _mm256_min_ps(_mm256_max_ps(f, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f));
+	}
+	return f;
+}
+
+// LRLR LRLR + LRLR LRLR => LLLL LLLL, RRRR RRRR
+static MPT_TARGET_AVX2 MPT_FORCEINLINE void Deinterleave2AVX2(__m256i a, __m256i b, __m256i &l, __m256i &r)
+{
+	const __m256 fa = _mm256_castsi256_ps(a), fb = _mm256_castsi256_ps(b);
+	l = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+	r = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(fa, fb, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+static MPT_TARGET_AVX2 void ConvertMixToInt16AVX2(int16 *out, const int32 *mix, std::size_t count)
+{
+	const std::size_t numVectors = count / 16;
+	for(std::size_t i = 0; i < numVectors; i++, mix += 16, out += 16)
+	{
+		const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mix));
+		const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mix + 8));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(out), MixToInt16AVX2(a, b));
+	}
+	ConvertMixScalar<int16, false>(out, 1, mix, 1, count % 16);
+}
+
+static MPT_TARGET_AVX2 void ConvertMixToInt16StereoAVX2(int16 *outL, int16 *outR, const int32 *mix, std::size_t frames)
+{
+	const std::size_t numVectors = frames / 16;
+	for(std::size_t i = 0; i < numVectors; i++, mix += 32, outL += 16, outR += 16)
+	{
+		__m256i l0, r0, l1, r1;
+		Deinterleave2AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(mix)), _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mix + 8)), l0, r0);
+		Deinterleave2AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(mix + 16)), _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mix + 24)), l1, r1);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(outL), MixToInt16AVX2(l0, l1));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(outR), MixToInt16AVX2(r0, r1));
+	}
+	ConvertMixToInt16StereoSSE2(outL, outR, mix, frames % 16);
+}
+
+template<bool clipOutput>
+static MPT_TARGET_AVX2 void ConvertMixToFloatAVX2(float *out, const int32 *mix, std::size_t count)
+{
+	const std::size_t numVectors = count / 8;
+	for(std::size_t i = 0; i < numVectors; i++, mix += 8, out += 8)
+	{
+		_mm256_storeu_ps(out, MixToFloatAVX2<clipOutput>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(mix))));
+	}
+	ConvertMixScalar<float, clipOutput>(out, 1, mix, 1, count % 8);
+}
+
+template<bool clipOutput>
+static MPT_TARGET_AVX2 void ConvertMixToFloatStereoAVX2(float *outL, float *outR, const int32 *mix, std::size_t frames)
+{
+	const std::size_t numVectors = frames / 8;
+	for(std::size_t i = 0; i < numVectors; i++, mix += 16, outL += 8, outR += 8)
+	{
+		__m256i l, r;
+		Deinterleave2AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(mix)), _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mix + 8)), l, r);
+		_mm256_storeu_ps(outL, MixToFloatAVX2<clipOutput>(l));
+		_mm256_storeu_ps(outR, MixToFloatAVX2<clipOutput>(r));
+	}
+	ConvertMixToFloatStereoSSE2<clipOutput>(outL, outR, mix, frames % 8);
+}
+
+#endif // ENABLE_INTRINSICS_AVX2
+
+
+bool ConvertMixToInt16SIMD(int16 *outputBuffer, int16 * const *outputBuffers, std::size_t offset, const int32 *mixBuffer, std::size_t channels, std::size_t countChunk)
+{
+#if defined(ENABLE_INTRINSICS_SSE2)
+	if(!(GetProcSupport() & PROCSUPPORT_SSE2) || (outputBuffers && channels != 1 && channels != 2 && channels != 4))
+	{
+		return false;
+	}
+#if defined(ENABLE_INTRINSICS_AVX2)
+	const bool avx2 = (GetProcSupport() & PROCSUPPORT_AVX2) != 0;
+#else
+	const bool avx2 = false;
+#endif
+	if(outputBuffer)
+	{
+#if defined(ENABLE_INTRINSICS_AVX2)
+		if(avx2)
+			ConvertMixToInt16AVX2(outputBuffer + channels * offset, mixBuffer, channels * countChunk);
+		else
+#endif
+			ConvertMixToInt16SSE2(outputBuffer + channels * offset, mixBuffer, channels * countChunk);
+	}
+	if(outputBuffers)
+	{
+		if(channels == 1)
+		{
+#if defined(ENABLE_INTRINSICS_AVX2)
+			if(avx2)
+				ConvertMixToInt16AVX2(outputBuffers[0] + offset, mixBuffer, countChunk);
+			else
+#endif
+				ConvertMixToInt16SSE2(outputBuffers[0] + offset, mixBuffer, countChunk);
+		} else if(channels == 2)
+		{
+#if defined(ENABLE_INTRINSICS_AVX2)
+			if(avx2)
+				ConvertMixToInt16StereoAVX2(outputBuffers[0] + offset, outputBuffers[1] + offset, mixBuffer, countChunk);
+			else
+#endif
+				ConvertMixToInt16StereoSSE2(outputBuffers[0] + offset, outputBuffers[1] + offset, mixBuffer, countChunk);
+		} else
+		{
+			ConvertMixToInt16QuadSSE2(outputBuffers, offset, mixBuffer, countChunk);
+		}
+	}
+	MPT_UNREFERENCED_PARAMETER(avx2);
+	return true;
+#else
+	MPT_UNREFERENCED_PARAMETER(outputBuffer);
+	MPT_UNREFERENCED_PARAMETER(outputBuffers);
+	MPT_UNREFERENCED_PARAMETER(offset);
+	MPT_UNREFERENCED_PARAMETER(mixBuffer);
+	MPT_UNREFERENCED_PARAMETER(channels);
+	MPT_UNREFERENCED_PARAMETER(countChunk);
+	return false;
+#endif // ENABLE_INTRINSICS_SSE2
+}
+
+
+template<bool clipOutput>
+static bool ConvertMixToFloatSIMDImpl(float *outputBuffer, float * const *outputBuffers, std::size_t offset, const int32 *mixBuffer, std::size_t channels, std::size_t countChunk)
+{
+#if defined(ENABLE_INTRINSICS_SSE2)
+	if(!(GetProcSupport() & PROCSUPPORT_SSE2) || (outputBuffers && channels != 1 && channels != 2 && channels != 4))
+	{
+		return false;
+	}
+#if defined(ENABLE_INTRINSICS_AVX2)
+	const bool avx2 = (GetProcSupport() & PROCSUPPORT_AVX2) != 0;
+#else
+	const bool avx2 = false;
+#endif
+	if(outputBuffer)
+	{
+#if defined(ENABLE_INTRINSICS_AVX2)
+		if(avx2)
+			ConvertMixToFloatAVX2<clipOutput>(outputBuffer + channels * offset, mixBuffer, channels * countChunk);
+		else
+#endif
+			ConvertMixToFloatSSE2<clipOutput>(outputBuffer + channels * offset, mixBuffer, channels * countChunk);
+	}
+	if(outputBuffers)
+	{
+		if(channels == 1)
+		{
+#if defined(ENABLE_INTRINSICS_AVX2)
+			if(avx2)
+				ConvertMixToFloatAVX2<clipOutput>(outputBuffers[0] + offset, mixBuffer, countChunk);
+			else
+#endif
+				ConvertMixToFloatSSE2<clipOutput>(outputBuffers[0] + offset, mixBuffer, countChunk);
+		} else if(channels == 2)
+		{
+#if defined(ENABLE_INTRINSICS_AVX2)
+			if(avx2)
+				ConvertMixToFloatStereoAVX2<clipOutput>(outputBuffers[0] + offset, outputBuffers[1] + offset, mixBuffer, countChunk);
+			else
+#endif
+				ConvertMixToFloatStereoSSE2<clipOutput>(outputBuffers[0] + offset, outputBuffers[1] + offset, mixBuffer, countChunk);
+		} else
+		{
+			ConvertMixToFloatQuadSSE2<clipOutput>(outputBuffers, offset, mixBuffer, countChunk);
+		}
+	}
+	MPT_UNREFERENCED_PARAMETER(avx2);
+	return true;
+#else
+	MPT_UNREFERENCED_PARAMETER(outputBuffer);
+	MPT_UNREFERENCED_PARAMETER(outputBuffers);
+	MPT_UNREFERENCED_PARAMETER(offset);
+	MPT_UNREFERENCED_PARAMETER(mixBuffer);
+	MPT_UNREFERENCED_PARAMETER(channels);
+	MPT_UNREFERENCED_PARAMETER(countChunk);
+	return false;
+#endif // ENABLE_INTRINSICS_SSE2
+}
+
+bool ConvertMixToFloatSIMD(float *outputBuffer, float * const *outputBuffers, std::size_t offset, const int32 *mixBuffer, std::size_t channels, std::size_t countChunk, bool clipOutput)
+{
+	if(clipOutput)
+		return ConvertMixToFloatSIMDImpl<true>(outputBuffer, outputBuffers, offset, mixBuffer, channels, countChunk);
+	else
+		return ConvertMixToFloatSIMDImpl<false>(outputBuffer, outputBuffers, offset, mixBuffer, channels, countChunk);
+}
+
+
 #ifndef MODPLUG_TRACKER
 
 void ApplyGain(int32 *soundBuffer, std::size_t channels, std::size_t countChunk, int32 gainFactor16_16)
@@ -22,9 +22,17 @@ struct ModChannel;
 
 void StereoMixToFloat(const int32 *pSrc, float *pOut1, float *pOut2, uint32 nCount, const float _i2fc);
 void FloatToStereoMix(const float *pIn1, const float *pIn2, int32 *pOut, uint32 uint32, const float _f2ic);
+void FloatToStereoMix(const float *pIn1, const float *pIn2, float *pOut, uint32 nCount, const float _f2fc);
 void MonoMixToFloat(const int32 *pSrc, float *pOut, uint32 uint32, const float _i2fc);
 void FloatToMonoMix(const float *pIn, int32 *pOut, uint32 uint32, const float _f2ic);
 
+// Convert the fixed point master mix to 16-bit or floating point output buffers using SSE2 or AVX2 instructions.
+// Works like CopyFloatMix in AudioReadTarget.h: outputBuffer is interleaved, outputBuffers has one buffer per channel, and writing starts at frame offset.
+// The output is identical to ConvertInterleavedFixedPointToInterleaved / ConvertInterleavedFixedPointToNonInterleaved with MIXING_FRACTIONAL_BITS.
+// Returns false without writing anything if the processor or channel layout is not supported.
+bool ConvertMixToInt16SIMD(int16 *outputBuffer, int16 * const *outputBuffers, std::size_t offset, const int32 *mixBuffer, std::size_t channels, std::size_t countChunk);
+bool ConvertMixToFloatSIMD(float *outputBuffer, float * const *outputBuffers, std::size_t offset, const int32 *mixBuffer, std::size_t channels, std::size_t countChunk, bool clipOutput);
+
 #ifndef MODPLUG_TRACKER
 void ApplyGain(int32 *soundBuffer, std::size_t channels, std::size_t countChunk, int32 gainFactor16_16);
 void ApplyGain(float *outputBuffer, float * const *outputBuffers, std::size_t offset, std::size_t channels, std::size_t countChunk, float gainFactor);
@@ -33,6 +41,11 @@ void ApplyGain(float *outputBuffer, float * const *outputBuffers, std::size_t of
 void InitMixBuffer(mixsample_t *pBuffer, uint32 nSamples);
 void InterleaveFrontRear(mixsample_t *pFrontBuf, mixsample_t *pRearBuf, uint32 nFrames);
 void MonoFromStereo(mixsample_t *pMixBuf, uint32 nSamples);
+#ifdef MPT_INTMIXER
+// Versions for the floating point master mix (see MixerSettings::FloatMasterMix)
+void InterleaveFrontRear(float *pFrontBuf, float *pRearBuf, uint32 nFrames);
+void MonoFromStereo(float *pMixBuf, uint32 nSamples);
+#endif // MPT_INTMIXER
 
 void InterleaveStereo(const mixsample_t *inputL, const mixsample_t *inputR, mixsample_t *output, size_t numSamples);
 void DeinterleaveStereo(const mixsample_t *input, mixsample_t *outputL, mixsample_t *outputR, size_t numSamples);
@@ -10,6 +10,7 @@
 #include "stdafx.h"
 #include "MixerSettings.h"
 #include "Snd_defs.h"
+#include "Mixer.h"
 #include "../common/misc_util.h"
 
 OPENMPT_NAMESPACE_BEGIN
@@ -35,6 +36,12 @@ MixerSettings::MixerSettings()
 
 	NumInputChannels = 0;
 
+	MixChunkSize = MIXBUFFERSIZE;
+	NumMixThreads = 1;
+	NumPluginThreads = 1;
+	FloatMasterMix = false;
+	SkipSilentChunks = true;
+
 }
 
 int32 MixerSettings::GetVolumeRampUpSamples() const
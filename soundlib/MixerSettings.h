@@ -27,6 +27,27 @@ struct MixerSettings
 	uint32 m_nPreAmp;
 	std::size_t NumInputChannels;
 
+	// Maximum number of frames that are rendered in one go.
+	// Smaller chunks are needed if plugins or the EQ are active (see CSoundFile::GetMixChunkSize).
+	uint32 MixChunkSize;
+	static const uint32 MaxMixChunkSize = 65536;
+
+	// Number of threads that mix voices in parallel (1 = no parallel mixing, 0 = one per CPU core).
+	uint32 NumMixThreads;
+	static const uint32 MaxMixThreads = 32;
+
+	// Number of threads that process independent plugin chains in parallel (1 = no parallel processing, 0 = one per CPU core, at most MaxMixThreads).
+	// The output is identical to processing all plugins one after another in slot order.
+	uint32 NumPluginThreads;
+
+	// Process the master mix (plugins, global volume, stereo separation) in floating point instead of fixed point.
+	// Voices are always mixed in fixed point. Only takes effect if the audio read target accepts float data and no DSP effects are active.
+	bool FloatMasterMix;
+
+	// Skip all mixing and master processing of chunks that are known to be silent (see CSoundFile::IsMixSilent).
+	// The output is identical either way, disabling it is only useful for verifying that.
+	bool SkipSilentChunks;
+
 	int32 VolumeRampUpMicroseconds;
 	int32 VolumeRampDownMicroseconds;
 	int32 GetVolumeRampUpMicroseconds() const { return VolumeRampUpMicroseconds; }
@@ -42,7 +63,7 @@ struct MixerSettings
 	
 	bool IsValid() const
 	{
-		return (gdwMixingFreq > 0) && (gnChannels == 1 || gnChannels == 2 || gnChannels == 4) && (NumInputChannels == 0 || NumInputChannels == 1 || NumInputChannels == 2 || NumInputChannels == 4);
+		return (gdwMixingFreq > 0) && (gnChannels == 1 || gnChannels == 2 || gnChannels == 4) && (NumInputChannels == 0 || NumInputChannels == 1 || NumInputChannels == 2 || NumInputChannels == 4) && (MixChunkSize > 0 && MixChunkSize <= MaxMixChunkSize);
 	}
 	
 	MixerSettings();
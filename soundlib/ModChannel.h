@@ -56,6 +56,7 @@ struct ModChannel
 	FlagSet<ChannelFlags> dwFlags;
 	mixsample_t nROfs, nLOfs;
 	uint32 nRampLength;
+	uint8 resamplingMode;
 
 	const ModSample *pModSample;			// Currently assigned sample slot (may already be stopped)
 	Paula::State paulaState;
@@ -85,7 +86,6 @@ struct ModChannel
 	CHANNELINDEX nMasterChn;
 	ModCommand rowCommand;
 	// 8-bit members
-	uint8 resamplingMode;
 	uint8 nRestoreResonanceOnNewNote;	// See nRestorePanOnNewNote
 	uint8 nRestoreCutoffOnNewNote;		// ditto
 	uint8 nNote, nNNA;
@@ -12,6 +12,7 @@
 #include "Sndfile.h"
 #include "ModSample.h"
 #include "modsmp_ctrl.h"
+#include "SamplePool.h"
 
 #include <cmath>
 
@@ -184,11 +185,12 @@ void *ModSample::AllocateSample(SmpLength numSamples, size_t bytesPerSample)
 
 	if(allocSize != 0)
 	{
-		char *p = new (std::nothrow) char[allocSize];
+		// The buffer starts with a header for the sample pool (see SamplePool.cpp)
+		char *p = new (std::nothrow) char[SamplePool::BufferHeaderSize + allocSize];
 		if(p != nullptr)
 		{
-			memset(p, 0, allocSize);
-			return p + (InterpolationMaxLookahead * MaxSamplingPointSize);
+			memset(p, 0, SamplePool::BufferHeaderSize + allocSize);
+			return p + SamplePool::BufferHeaderSize + (InterpolationMaxLookahead * MaxSamplingPointSize);
 		}
 	}
 	return nullptr;
@@ -225,20 +227,83 @@ size_t ModSample::GetRealSampleBufferSize(SmpLength numSamples, size_t bytesPerS
 
 void ModSample::FreeSample()
 {
-	FreeSample(pData.pSample);
+	if(IsPinned())
+	{
+		// Pinned sample data is owned by someone else
+		delete[] pLookahead;
+		pLookahead = nullptr;
+	} else
+	{
+		FreeSample(pData.pSample);
+	}
 	pData.pSample = nullptr;
 }
 
 
 void ModSample::FreeSample(void *samplePtr)
 {
-	if(samplePtr)
+	if(SamplePool::IsShared(samplePtr))
 	{
-		delete[] (((char *)samplePtr) - (InterpolationMaxLookahead * MaxSamplingPointSize));
+		SamplePool::Instance().Release(samplePtr);
+	} else if(samplePtr)
+	{
+		delete[] (((char *)samplePtr) - (InterpolationMaxLookahead * MaxSamplingPointSize) - SamplePool::BufferHeaderSize);
 	}
 }
 
 
+// Offsets of the parts of the lookahead buffer of pinned sample data, in sampling points
+static const SmpLength PinnedLookaheadOffsets[] =
+{
+	0,								// lookaheadSampleStart
+	3 * InterpolationMaxLookahead,	// lookaheadSampleEnd
+	6 * InterpolationMaxLookahead,	// lookaheadLoop
+	10 * InterpolationMaxLookahead,	// lookaheadSustainLoop
+};
+static const SmpLength PinnedLookaheadSize = 14 * InterpolationMaxLookahead;
+
+
+SmpLength ModSample::GetMinPinnedLength()
+{
+	// The lookahead around the sample start and end must not overlap
+	return 2 * InterpolationMaxLookahead;
+}
+
+
+bool ModSample::PinSampleData(const void *data)
+{
+	if(data == nullptr || nLength < GetMinPinnedLength() || nLength > MAX_SAMPLE_LENGTH)
+	{
+		return false;
+	}
+	const size_t lookaheadSize = PinnedLookaheadSize * GetBytesPerSample();
+	mpt::byte *lookahead = new (std::nothrow) mpt::byte[lookaheadSize];
+	if(lookahead == nullptr)
+	{
+		return false;
+	}
+	memset(lookahead, 0, lookaheadSize);
+	FreeSample();
+	pData.pSample = const_cast<void *>(data);
+	pLookahead = lookahead;
+	return true;
+}
+
+
+const mpt::byte *ModSample::GetPinnedLookahead(PinnedLookaheadArea area) const noexcept
+{
+	MPT_ASSERT(IsPinned());
+	return pLookahead + PinnedLookaheadOffsets[area] * GetBytesPerSample();
+}
+
+
+mpt::byte *ModSample::GetPinnedLookahead(PinnedLookaheadArea area) noexcept
+{
+	MPT_ASSERT(IsPinned());
+	return pLookahead + PinnedLookaheadOffsets[area] * GetBytesPerSample();
+}
+
+
 // Set loop points and update loop wrap-around buffer
 void ModSample::SetLoop(SmpLength start, SmpLength end, bool enable, bool pingpong, CSoundFile &sndFile)
 {
@@ -17,6 +17,20 @@ class CSoundFile;
 // Sample Struct
 struct ModSample
 {
+	// Owning pointer to the interpolation lookahead buffer of pinned sample data.
+	// The buffer belongs to the sample data rather than to the sample header, so it is never copied along with the header:
+	// A copy-constructed sample has no lookahead buffer, and assigning a sample header keeps the lookahead buffer of the target.
+	class LookaheadPtr
+	{
+		mpt::byte *m_ptr = nullptr;
+	public:
+		LookaheadPtr() noexcept = default;
+		LookaheadPtr(const LookaheadPtr &) noexcept { }
+		LookaheadPtr & operator = (const LookaheadPtr &) noexcept { return *this; }
+		LookaheadPtr & operator = (mpt::byte *ptr) noexcept { m_ptr = ptr; return *this; }
+		operator mpt::byte * () const noexcept { return m_ptr; }
+	};
+
 	SmpLength nLength;						// In frames
 	SmpLength nLoopStart, nLoopEnd;			// Ditto
 	SmpLength nSustainStart, nSustainEnd;	// Ditto
@@ -26,6 +40,7 @@ struct ModSample
 		int8  *pSample8;					// Pointer to 8-bit sample data
 		int16 *pSample16;					// Pointer to 16-bit sample data
 	} pData;
+	LookaheadPtr pLookahead;				// Interpolation lookahead buffer if the sample data is pinned (see PinSampleData), nullptr otherwise
 	uint32 nC5Speed;						// Frequency of middle-C, in Hz (for IT/S3M/MPTM)
 	uint16 nPan;							// Default sample panning (if pan flag is set), 0...256
 	uint16 nVolume;							// Default volume, 0...256 (ignored if uFlags[SMP_NODEFAULTVOLUME] is set)
@@ -129,6 +144,26 @@ struct ModSample
 	void FreeSample();
 	static void FreeSample(void *samplePtr);
 
+	// Parts of the interpolation lookahead buffer of pinned sample data
+	enum PinnedLookaheadArea
+	{
+		lookaheadSampleStart,	// 1x InterpolationMaxLookahead sampling points before and 2x InterpolationMaxLookahead after the sample start
+		lookaheadSampleEnd,		// 2x InterpolationMaxLookahead sampling points before and 1x InterpolationMaxLookahead after the sample end
+		lookaheadLoop,			// Loop wrap-around buffer, laid out like in regular sample buffers
+		lookaheadSustainLoop,	// Sustain loop wrap-around buffer
+	};
+	// Minimum length of samples whose data can be pinned.
+	static SmpLength GetMinPinnedLength();
+	// Let the sample reference external sample data instead of owning a copy of it. The data must stay valid until the sample is freed and must not be modified.
+	// Pinned data is never written to; the lookahead that regular sample buffers store around the sample data is kept in a separate small buffer.
+	// The sample length and format must already be set. Returns false if the sample is too short or the lookahead buffer could not be allocated.
+	bool PinSampleData(const void *data);
+	// Returns true if the sample data is pinned, i.e. not owned by the sample.
+	bool IsPinned() const noexcept { return pLookahead != nullptr; }
+	// Returns the start of the given part of the lookahead buffer of pinned sample data.
+	const mpt::byte *GetPinnedLookahead(PinnedLookaheadArea area) const noexcept;
+	mpt::byte *GetPinnedLookahead(PinnedLookaheadArea area) noexcept;
+
 	// Set loop points and update loop wrap-around buffer
 	void SetLoop(SmpLength start, SmpLength end, bool enable, bool pingpong, CSoundFile &sndFile);
 	// Set sustain loop points and update loop wrap-around buffer
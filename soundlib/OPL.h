@@ -70,6 +70,8 @@ public:
 
 	void Initialize(uint32 samplerate);
 	void Mix(int *buffer, size_t count);
+	// Returns false if Mix() would not produce any output
+	bool IsActive() const { return m_isActive; }
 
 	void NoteOff(CHANNELINDEX c);
 	void NoteCut(CHANNELINDEX c);
@@ -50,38 +50,87 @@ void RowVisitor::Initialize(bool reset)
 {
 	auto &order = Order();
 	const ORDERINDEX endOrder = order.GetLengthTailTrimmed();
-	m_visitedRows.resize(endOrder);
+
+	// Check if the layout of the visited row memory still matches the order list and patterns.
+	bool layoutChanged = (GetNumOrders() != endOrder);
+	ROWINDEX maxRows = 0;
+	for(ORDERINDEX ord = 0; ord < endOrder; ord++)
+	{
+		const ROWINDEX numRows = static_cast<ROWINDEX>(GetVisitedRowsVectorSize(order[ord]));
+		maxRows = std::max(maxRows, numRows);
+		if(!layoutChanged && GetNumRows(ord) != numRows)
+		{
+			layoutChanged = true;
+		}
+	}
+
 	if(reset)
 	{
 		m_visitOrder.clear();
 		// Pre-allocate maximum amount of memory most likely needed for keeping track of visited rows in a pattern
-		if(m_visitOrder.capacity() < MAX_PATTERN_ROWS)
+		if(m_visitOrder.capacity() < maxRows)
 		{
-			ROWINDEX maxRows = 0;
-			for(const auto &pat :m_sndFile.Patterns)
-			{
-				maxRows = std::max(maxRows, pat.GetNumRows());
-			}
 			m_visitOrder.reserve(maxRows);
 		}
 	}
 
-	for(ORDERINDEX ord = 0; ord < endOrder; ord++)
+	if(!layoutChanged)
 	{
-		auto &row = m_visitedRows[ord];
-		const size_t size = GetVisitedRowsVectorSize(order[ord]);
 		if(reset)
 		{
-			// If we want to reset the vectors completely, we overwrite existing items with false.
-			row.assign(size, false);
-		} else
+			ClearBits();
+		}
+		return;
+	}
+
+	std::vector<uint32> newOffsets(endOrder + 1, 0);
+	for(ORDERINDEX ord = 0; ord < endOrder; ord++)
+	{
+		newOffsets[ord + 1] = newOffsets[ord] + static_cast<uint32>(GetVisitedRowsVectorSize(order[ord]));
+	}
+	const size_t numWords = (newOffsets.back() + 63u) / 64u;
+	if(reset)
+	{
+		m_orderOffset = std::move(newOffsets);
+		m_visitedRows.assign(numWords, 0);
+		m_wordGeneration.assign(numWords, 0);
+		m_generation = 1;
+		return;
+	}
+
+	// The module has been edited - move the rows of each order to their new place, so that no visited rows are lost.
+	RowVisitor old(*this);
+	m_orderOffset = std::move(newOffsets);
+	m_visitedRows.assign(numWords, 0);
+	m_wordGeneration.assign(numWords, 0);
+	m_generation = 1;
+	const ORDERINDEX copyOrders = std::min(old.GetNumOrders(), GetNumOrders());
+	for(ORDERINDEX ord = 0; ord < copyOrders; ord++)
+	{
+		const ROWINDEX copyRows = std::min(old.GetNumRows(ord), GetNumRows(ord));
+		for(ROWINDEX row = 0; row < copyRows; row++)
 		{
-			row.resize(size, false);
+			if(old.GetBit(old.m_orderOffset[ord] + row))
+			{
+				SetBit(m_orderOffset[ord] + row, true);
+			}
 		}
 	}
 }
 
 
+// Mark all rows as unvisited
+void RowVisitor::ClearBits()
+{
+	if(++m_generation == 0)
+	{
+		// Generation counter wrapped around, so really clear everything.
+		std::fill(m_wordGeneration.begin(), m_wordGeneration.end(), 0);
+		m_generation = 1;
+	}
+}
+
+
 // (Un)sets a given row as visited.
 // order, row - which row should be (un)set
 // If visited is true, the row will be set as visited.
@@ -94,17 +143,17 @@ void RowVisitor::SetVisited(ORDERINDEX ord, ROWINDEX row, bool visited)
 	}
 
 	// The module might have been edited in the meantime - so we have to extend this a bit.
-	if(ord >= m_visitedRows.size() || row >= m_visitedRows[ord].size())
+	if(ord >= GetNumOrders() || row >= GetNumRows(ord))
 	{
 		Initialize(false);
 		// If it's still past the end of the vector, this means that ord >= order.GetLengthTailTrimmed(), i.e. we are trying to play an empty order.
-		if(ord >= m_visitedRows.size())
+		if(ord >= GetNumOrders())
 		{
 			return;
 		}
 	}
 
-	m_visitedRows[ord][row] = visited;
+	SetBit(m_orderOffset[ord] + row, visited);
 	if(visited)
 	{
 		AddVisitedRow(ord, row);
@@ -123,7 +172,7 @@ bool RowVisitor::IsVisited(ORDERINDEX ord, ROWINDEX row, bool autoSet)
 	}
 
 	// The row slot for this row has not been assigned yet - Just return false, as this means that the program has not played the row yet.
-	if(ord >= m_visitedRows.size() || row >= m_visitedRows[ord].size())
+	if(ord >= GetNumOrders() || row >= GetNumRows(ord))
 	{
 		if(autoSet)
 		{
@@ -132,13 +181,14 @@ bool RowVisitor::IsVisited(ORDERINDEX ord, ROWINDEX row, bool autoSet)
 		return false;
 	}
 
-	if(m_visitedRows[ord][row])
+	const size_t index = m_orderOffset[ord] + row;
+	if(GetBit(index))
 	{
 		// We visited this row already - this module must be looping.
 		return true;
 	} else if(autoSet)
 	{
-		m_visitedRows[ord][row] = true;
+		SetBit(index, true);
 		AddVisitedRow(ord, row);
 	}
 
@@ -176,16 +226,20 @@ bool RowVisitor::GetFirstUnvisitedRow(ORDERINDEX &ord, ROWINDEX &row, bool onlyU
 			continue;
 		}
 
-		if(ord >= m_visitedRows.size())
+		if(ord >= GetNumOrders())
 		{
 			// Not yet initialized => unvisited
 			row = 0;
 			return true;
 		}
 
-		const auto &visitedRows = m_visitedRows[ord];
-		auto foundRow = std::find(visitedRows.begin(), visitedRows.end(), onlyUnplayedPatterns);
-		if(onlyUnplayedPatterns && foundRow == visitedRows.end())
+		const size_t first = m_orderOffset[ord], numRows = GetNumRows(ord);
+		size_t foundRow = 0;
+		while(foundRow < numRows && GetBit(first + foundRow) != onlyUnplayedPatterns)
+		{
+			foundRow++;
+		}
+		if(onlyUnplayedPatterns && foundRow == numRows)
 		{
 			// No row of this pattern has been played yet.
 			row = 0;
@@ -193,15 +247,15 @@ bool RowVisitor::GetFirstUnvisitedRow(ORDERINDEX &ord, ROWINDEX &row, bool onlyU
 		} else if(!onlyUnplayedPatterns)
 		{
 			// Return the first unplayed row in this pattern
-			if(foundRow != visitedRows.end())
+			if(foundRow != numRows)
 			{
-				row = static_cast<ROWINDEX>(std::distance(visitedRows.begin(), foundRow));
+				row = static_cast<ROWINDEX>(foundRow);
 				return true;
 			}
-			if(visitedRows.size() < m_sndFile.Patterns[pattern].GetNumRows())
+			if(numRows < m_sndFile.Patterns[pattern].GetNumRows())
 			{
 				// History is not fully initialized
-				row = static_cast<ROWINDEX>(visitedRows.size());
+				row = static_cast<ROWINDEX>(numRows);
 				return true;
 			}
 		}
@@ -214,6 +268,17 @@ bool RowVisitor::GetFirstUnvisitedRow(ORDERINDEX &ord, ROWINDEX &row, bool onlyU
 }
 
 
+// Approximate amount of memory used by this object, in bytes.
+size_t RowVisitor::GetMemoryUsage() const
+{
+	return sizeof(*this)
+		+ m_visitedRows.capacity() * sizeof(uint64)
+		+ m_wordGeneration.capacity() * sizeof(uint32)
+		+ m_orderOffset.capacity() * sizeof(uint32)
+		+ m_visitOrder.capacity() * sizeof(ROWINDEX);
+}
+
+
 // Set all rows of a previous pattern loop as unvisited.
 void RowVisitor::ResetPatternLoop(ORDERINDEX ord, ROWINDEX startRow)
 {
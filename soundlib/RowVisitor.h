@@ -21,8 +21,14 @@ class ModSequence;
 class RowVisitor
 {
 protected:
-	// Memory for every row in the module if it has been visited or not.
-	std::vector<std::vector<bool>> m_visitedRows;
+	// Memory for every row in the module if it has been visited or not, one bit per row.
+	// The rows of all orders are stored back to back; the first row of order n is found at bit index m_orderOffset[n].
+	std::vector<uint64> m_visitedRows;
+	// A word of m_visitedRows is only valid if its generation matches m_generation, otherwise all of its rows are unvisited.
+	// This way, all rows can be marked as unvisited by just incrementing m_generation.
+	std::vector<uint32> m_wordGeneration;
+	std::vector<uint32> m_orderOffset;
+	uint32 m_generation = 1;
 	// Memory of visited rows (including their order) to reset pattern loops.
 	std::vector<ROWINDEX> m_visitOrder;
 
@@ -35,8 +41,11 @@ public:
 
 	// Resize / Clear the row vector.
 	// If reset is true, the vector is not only resized to the required dimensions, but also completely cleared (i.e. all visited rows are unset).
+	// If the order list and pattern sizes have not changed since the last call, clearing only takes constant time.
 	void Initialize(bool reset);
 
+	SEQUENCEINDEX GetSequence() const { return m_sequence; }
+
 	// Mark a row as visited.
 	void Visit(ORDERINDEX ord, ROWINDEX row)
 	{
@@ -67,8 +76,22 @@ public:
 	void Set(const RowVisitor &other)
 	{
 		m_visitedRows = other.m_visitedRows;
+		m_wordGeneration = other.m_wordGeneration;
+		m_orderOffset = other.m_orderOffset;
+		m_generation = other.m_generation;
+	}
+
+	// Retrieve the complete state (visited rows and the order in which they were visited) from another RowVisitor object of the same sequence.
+	void Restore(const RowVisitor &other)
+	{
+		Set(other);
+		m_visitOrder = other.m_visitOrder;
+		m_currentOrder = other.m_currentOrder;
 	}
 
+	// Approximate amount of memory used by this object, in bytes.
+	size_t GetMemoryUsage() const;
+
 	// Set all rows of a previous pattern loop as unvisited.
 	void ResetPatternLoop(ORDERINDEX ord, ROWINDEX startRow);
 
@@ -82,6 +105,31 @@ protected:
 	// Add a row to the visited row memory for this pattern.
 	void AddVisitedRow(ORDERINDEX ord, ROWINDEX row);
 
+	// Number of orders and rows per order that the visited row memory has been initialized for.
+	ORDERINDEX GetNumOrders() const { return m_orderOffset.empty() ? 0 : static_cast<ORDERINDEX>(m_orderOffset.size() - 1); }
+	ROWINDEX GetNumRows(ORDERINDEX ord) const { return m_orderOffset[ord + 1] - m_orderOffset[ord]; }
+
+	bool GetBit(size_t index) const
+	{
+		const size_t word = index / 64u;
+		return m_wordGeneration[word] == m_generation && ((m_visitedRows[word] >> (index % 64u)) & 1u);
+	}
+	void SetBit(size_t index, bool value)
+	{
+		const size_t word = index / 64u;
+		if(m_wordGeneration[word] != m_generation)
+		{
+			m_visitedRows[word] = 0;
+			m_wordGeneration[word] = m_generation;
+		}
+		if(value)
+			m_visitedRows[word] |= (uint64(1) << (index % 64u));
+		else
+			m_visitedRows[word] &= ~(uint64(1) << (index % 64u));
+	}
+	// Mark all rows as unvisited
+	void ClearBits();
+
 	const ModSequence &Order() const;
 };
 
@@ -31,35 +31,9 @@ void AMSUnpack(const int8 * const source, size_t sourceSize, void * const dest,
 uintptr_t DMFUnpack(FileReader &file, uint8 *psample, uint32 maxlen);
 
 
-// Read a sample from memory
-size_t SampleIO::ReadSample(ModSample &sample, FileReader &file) const
+// Limit the sample length to what can possibly be decoded from fileSize bytes and set the sample format flags.
+bool SampleIO::LimitSampleLength(ModSample &sample, std::size_t fileSize) const
 {
-	if(!file.IsValid())
-	{
-		return 0;
-	}
-
-	LimitMax(sample.nLength, MAX_SAMPLE_LENGTH);
-
-	FileReader::off_t bytesRead = 0;	// Amount of memory that has been read from file
-
-	FileReader::off_t filePosition = file.GetPosition();
-	const mpt::byte * sourceBuf = nullptr;
-	FileReader::PinnedRawDataView restrictedSampleDataView;
-	FileReader::off_t fileSize = 0;
-	if(UsesFileReaderForDecoding())
-	{
-		sourceBuf = nullptr;
-		fileSize = file.BytesLeft();
-	} else if(!IsVariableLengthEncoded())
-	{
-		restrictedSampleDataView = file.GetPinnedRawDataView(CalculateEncodedSize(sample.nLength));
-		sourceBuf = restrictedSampleDataView.data();
-		fileSize = restrictedSampleDataView.size();
-	} else
-	{
-		MPT_ASSERT_NOTREACHED();
-	}
 	if(!IsVariableLengthEncoded() && sample.nLength > 0x40000)
 	{
 		// Limit sample length to available bytes in file to avoid excessive memory allocation.
@@ -103,11 +77,86 @@ size_t SampleIO::ReadSample(ModSample &sample, FileReader &file) const
 
 	if(sample.nLength < 1)
 	{
-		return 0;
+		return false;
 	}
 
 	sample.uFlags.set(CHN_16BIT, GetBitDepth() >= 16);
 	sample.uFlags.set(CHN_STEREO, GetChannelFormat() != mono);
+	return true;
+}
+
+
+// Apply the sample length limits and format flags of ReadSample without decoding or allocating any sample data
+bool SampleIO::PrepareSample(ModSample &sample, const FileReader &file) const
+{
+	if(!file.IsValid())
+	{
+		return false;
+	}
+
+	LimitMax(sample.nLength, MAX_SAMPLE_LENGTH);
+
+	// Same amount of data that ReadSample looks at
+	FileReader::off_t fileSize = 0;
+	if(UsesFileReaderForDecoding())
+	{
+		fileSize = file.BytesLeft();
+	} else if(!IsVariableLengthEncoded())
+	{
+		fileSize = std::min(file.BytesLeft(), static_cast<FileReader::off_t>(CalculateEncodedSize(sample.nLength)));
+	}
+	return LimitSampleLength(sample, fileSize);
+}
+
+
+bool SampleIO::IsNativePCM() const
+{
+	if(GetEncoding() != signedPCM || (GetChannelFormat() != mono && GetChannelFormat() != stereoInterleaved))
+	{
+		return false;
+	}
+	if(GetBitDepth() == 8)
+	{
+		return true;
+	}
+	return GetBitDepth() == 16 && ((GetEndianness() == littleEndian) ? mpt::endian::little : mpt::endian::big) == mpt::endian::native;
+}
+
+
+// Read a sample from memory
+size_t SampleIO::ReadSample(ModSample &sample, FileReader &file) const
+{
+	if(!file.IsValid())
+	{
+		return 0;
+	}
+
+	LimitMax(sample.nLength, MAX_SAMPLE_LENGTH);
+
+	FileReader::off_t bytesRead = 0;	// Amount of memory that has been read from file
+
+	FileReader::off_t filePosition = file.GetPosition();
+	const mpt::byte * sourceBuf = nullptr;
+	FileReader::PinnedRawDataView restrictedSampleDataView;
+	FileReader::off_t fileSize = 0;
+	if(UsesFileReaderForDecoding())
+	{
+		sourceBuf = nullptr;
+		fileSize = file.BytesLeft();
+	} else if(!IsVariableLengthEncoded())
+	{
+		restrictedSampleDataView = file.GetPinnedRawDataView(CalculateEncodedSize(sample.nLength));
+		sourceBuf = restrictedSampleDataView.data();
+		fileSize = restrictedSampleDataView.size();
+	} else
+	{
+		MPT_ASSERT_NOTREACHED();
+	}
+	if(!LimitSampleLength(sample, fileSize))
+	{
+		return 0;
+	}
+
 	size_t sampleSize = sample.AllocateSample();	// Target sample size in bytes
 
 	if(sampleSize == 0)
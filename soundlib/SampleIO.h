@@ -238,6 +238,9 @@ public:
 		return false;
 	}
 
+	// Returns true if the decoded sample data is identical to the encoded data on this platform, i.e. the sample can reference the file data directly.
+	bool IsNativePCM() const;
+
 	// Get bits per sample
 	uint8 GetBitDepth() const
 	{
@@ -279,6 +282,10 @@ public:
 		return GetEncodedHeaderSize() + (length * (GetEncodedBitsPerSample()/8) * GetNumChannels());
 	}
 
+	// Apply the same sample length limits and format flags as ReadSample, but do not decode or allocate any sample data.
+	// Returns false if the sample would be empty.
+	bool PrepareSample(ModSample &sample, const FileReader &file) const;
+
 	// Read a sample from memory
 	size_t ReadSample(ModSample &sample, FileReader &file) const;
 
@@ -286,6 +293,11 @@ public:
 	// Write a sample to file
 	size_t WriteSample(std::ostream &f, const ModSample &sample, SmpLength maxSamples = 0) const;
 #endif // MODPLUG_NO_FILESAVE
+
+protected:
+	// Limit the sample length to what can possibly be decoded from fileSize bytes and set the sample format flags.
+	// Returns false if the sample is empty.
+	bool LimitSampleLength(ModSample &sample, std::size_t fileSize) const;
 };
 
 
@@ -0,0 +1,135 @@
+/*
+ * SamplePool.cpp
+ * --------------
+ * Purpose: Sharing sample data between modules that have been loaded from the same file.
+ * Notes  : Applications that open the same file several times (e.g. for playing it on several decks or for seeking
+ *          ahead in a second instance) would otherwise keep several identical copies of the decoded sample data.
+ *          Sample buffers are identified by a CRC-64 of the whole file and the sample index. Every buffer allocated
+ *          by ModSample::AllocateSample carries a small header in front of the lookahead area, which tells whether the
+ *          buffer is owned by the pool. Pooled buffers are reference-counted and must be treated as read-only;
+ *          code that modifies sample data in place has to call ctrlSmp::UnshareSample first (copy-on-write).
+ *          Only the buffer pointer and the reference count are shared, each module keeps its own sample header.
+ *          A pool entry is only reused if the sample header properties that determine the buffer contents
+ *          (length, format and loop points, because of the precomputed loop wrap-around) and the decoded sample data
+ *          itself are identical, so a hash collision can never make a module play the samples of another file.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "SamplePool.h"
+#include "ModSample.h"
+#include "Mixer.h"
+#include "../common/mptCRC.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+static_assert(sizeof(SamplePool::BufferHeader) <= SamplePool::BufferHeaderSize, "Sample buffer header does not fit");
+
+
+SamplePool &SamplePool::Instance()
+{
+	static SamplePool pool;
+	return pool;
+}
+
+
+SamplePool::Key SamplePool::GetFileKey(const FileReader &file)
+{
+	FileReader f = file;
+	f.Rewind();
+	FileReader::PinnedRawDataView view = f.GetPinnedRawDataView();
+	mpt::checksum::crc64_jones crc;
+	crc(view.begin(), view.end());
+	Key key;
+	key.fileHash = crc.result();
+	key.fileSize = view.size();
+	key.sample = 0;
+	return key;
+}
+
+
+SamplePool::BufferHeader &SamplePool::GetHeader(void *samplePtr)
+{
+	return *reinterpret_cast<BufferHeader *>(static_cast<char *>(samplePtr) - (InterpolationMaxLookahead * MaxSamplingPointSize) - BufferHeaderSize);
+}
+
+
+bool SamplePool::IsShared(const void *samplePtr)
+{
+	return samplePtr != nullptr && GetHeader(const_cast<void *>(samplePtr)).pooled;
+}
+
+
+SamplePool::Entry::Entry(const ModSample &sample)
+	: data(const_cast<void *>(sample.samplev()))
+	, length(sample.nLength)
+	, loopStart(sample.nLoopStart), loopEnd(sample.nLoopEnd)
+	, sustainStart(sample.nSustainStart), sustainEnd(sample.nSustainEnd)
+	, flags(sample.uFlags & (CHN_16BIT | CHN_STEREO | CHN_LOOP | CHN_PINGPONGLOOP | CHN_SUSTAINLOOP | CHN_PINGPONGSUSTAIN))
+{
+}
+
+
+bool SamplePool::Entry::Matches(const ModSample &sample) const
+{
+	const Entry other(sample);
+	return length == other.length
+		&& loopStart == other.loopStart && loopEnd == other.loopEnd
+		&& sustainStart == other.sustainStart && sustainEnd == other.sustainEnd
+		&& flags == other.flags;
+}
+
+
+void SamplePool::Share(const Key &key, ModSample &sample)
+{
+	void *ownData = sample.samplev();
+	if(ownData == nullptr || sample.IsPinned() || IsShared(ownData) || sample.uFlags[CHN_ADLIB])
+	{
+		return;
+	}
+	{
+		MPT_LOCK_GUARD<mpt::mutex> lock(m_mutex);
+		auto it = m_entries.find(key);
+		if(it == m_entries.end())
+		{
+			BufferHeader &header = GetHeader(ownData);
+			header.key = key;
+			header.refCount = 1;
+			header.pooled = true;
+			m_entries.insert(std::make_pair(key, Entry(sample)));
+			return;
+		}
+		if(!it->second.Matches(sample)
+			|| memcmp(it->second.data, ownData, sample.GetSampleSizeInBytes()))
+		{
+			// Same file, but the sample was modified or loaded differently. Keep the private copy.
+			return;
+		}
+		GetHeader(it->second.data).refCount++;
+		sample.pData.pSample = it->second.data;
+	}
+	ModSample::FreeSample(ownData);
+}
+
+
+void SamplePool::Release(void *samplePtr)
+{
+	BufferHeader &header = GetHeader(samplePtr);
+	MPT_ASSERT(header.pooled);
+	{
+		MPT_LOCK_GUARD<mpt::mutex> lock(m_mutex);
+		MPT_ASSERT(header.refCount > 0);
+		if(--header.refCount > 0)
+		{
+			return;
+		}
+		m_entries.erase(header.key);
+	}
+	delete[] reinterpret_cast<char *>(&header);
+}
+
+
+OPENMPT_NAMESPACE_END
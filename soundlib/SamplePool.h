@@ -0,0 +1,85 @@
+/*
+ * SamplePool.h
+ * ------------
+ * Purpose: Sharing sample data between modules that have been loaded from the same file.
+ * Notes  : See implementation file.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include <map>
+#include "Snd_defs.h"
+#include "../common/mptMutex.h"
+#include "../common/FileReader.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+struct ModSample;
+
+
+class SamplePool
+{
+public:
+	// Identifies a sample by the contents of the file it has been loaded from and its index in the module
+	struct Key
+	{
+		uint64 fileHash;
+		uint64 fileSize;
+		SAMPLEINDEX sample;
+
+		bool operator< (const Key &other) const
+		{
+			if(fileHash != other.fileHash) return fileHash < other.fileHash;
+			if(fileSize != other.fileSize) return fileSize < other.fileSize;
+			return sample < other.sample;
+		}
+	};
+
+	// Every buffer allocated by ModSample::AllocateSample starts with this header, followed by the interpolation lookahead area and the actual sample data.
+	struct BufferHeader
+	{
+		Key key;			// Only valid if pooled is set
+		uint32 refCount;	// Number of samples using the buffer, only valid if pooled is set. Protected by the pool mutex.
+		bool pooled;		// The buffer is owned by the pool and may be used by several modules. Never changes once it has been set.
+	};
+	// Size reserved for the header, keeping the alignment of the sample data
+	static const size_t BufferHeaderSize = 32;
+
+	// The pool that is shared by all modules of the process.
+	static SamplePool &Instance();
+
+	// Returns the key of sample 0 of a file. The whole file is read for computing it.
+	static Key GetFileKey(const FileReader &file);
+
+	// Returns true if the sample buffer is owned by the pool. Shared sample data must not be modified (see ctrlSmp::UnshareSample).
+	static bool IsShared(const void *samplePtr);
+	static BufferHeader &GetHeader(void *samplePtr);
+
+	// Shares the data of the sample with other modules. If the pool already contains the same sample data,
+	// the sample's own data is freed and the sample uses the shared data instead.
+	void Share(const Key &key, ModSample &sample);
+	// Removes a reference to a shared sample buffer, freeing it if it is not used anymore. Called by ModSample::FreeSample.
+	void Release(void *samplePtr);
+
+protected:
+	// Properties of the sample that determine the contents of the sample buffer, including the precomputed loops
+	struct Entry
+	{
+		void *data;
+		SmpLength length, loopStart, loopEnd, sustainStart, sustainEnd;
+		SampleFlags flags;
+
+		explicit Entry(const ModSample &sample);
+		bool Matches(const ModSample &sample) const;
+	};
+
+	mpt::mutex m_mutex;
+	std::map<Key, Entry> m_entries;
+};
+
+
+OPENMPT_NAMESPACE_END
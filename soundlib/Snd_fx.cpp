@@ -23,8 +23,10 @@
 #include "tuning.h"
 #include "Tables.h"
 #include "modsmp_ctrl.h"	// For updating the loop wraparound data with the invert loop effect
+#include "SamplePool.h"
 #include "plugins/PlugInterface.h"
 #include "OPL.h"
+#include "GetLengthCheckpoints.h"
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -56,18 +58,10 @@ protected:
 
 public:
 	std::unique_ptr<CSoundFile::PlayState> state;
-	struct ChnSettings
-	{
-		double patLoop = 0.0;
-		CSoundFile::samplecount_t patLoopSmp = 0;
-		ROWINDEX patLoopStart = 0;
-		uint32 ticksToRender = 0;	// When using sample sync, we still need to render this many ticks
-		bool incChanged = false;	// When using sample sync, note frequency has changed
-		uint8 vol = 0xFF;
-	};
+	typedef GetLengthChnSettings ChnSettings;
 
 #ifndef NO_PLUGINS
-	typedef std::map<std::pair<ModCommand::INSTR, uint16>, uint16> PlugParamMap;
+	typedef GetLengthPlugParamMap PlugParamMap;
 	PlugParamMap plugParams;
 #endif
 	std::vector<ChnSettings> chnSettings;
@@ -99,6 +93,59 @@ public:
 		}
 	}
 
+	// Take a snapshot of the complete state at the start of a row
+	GetLengthCheckpoint CreateCheckpoint(const RowVisitor &visitedRows, const GetLengthType &retval, uint32 oldTickDuration) const
+	{
+		GetLengthCheckpoint checkpoint(visitedRows);
+		checkpoint.totalSampleCount = state->m_lTotalSampleCount;
+		checkpoint.bufferDiff = state->m_dBufferDiff;
+		checkpoint.musicSpeed = state->m_nMusicSpeed;
+		checkpoint.musicTempo = state->m_nMusicTempo;
+		checkpoint.globalVolume = state->m_nGlobalVolume;
+		checkpoint.rowsPerBeat = state->m_nCurrentRowsPerBeat;
+		checkpoint.row = state->m_nRow;
+		checkpoint.nextRow = state->m_nNextRow;
+		checkpoint.nextPatStartRow = state->m_nNextPatStartRow;
+		checkpoint.pattern = state->m_nPattern;
+		checkpoint.currentOrder = state->m_nCurrentOrder;
+		checkpoint.nextOrder = state->m_nNextOrder;
+		checkpoint.channels.assign(state->Chn, state->Chn + sndFile.GetNumChannels());
+		checkpoint.chnSettings = chnSettings;
+#ifndef NO_PLUGINS
+		checkpoint.plugParams = plugParams;
+#endif // NO_PLUGINS
+		checkpoint.retval = retval;
+		checkpoint.elapsedTime = elapsedTime;
+		checkpoint.oldTickDuration = oldTickDuration;
+		return checkpoint;
+	}
+
+	// Continue from a snapshot taken by CreateCheckpoint
+	void RestoreCheckpoint(const GetLengthCheckpoint &checkpoint, RowVisitor &visitedRows, GetLengthType &retval, uint32 &oldTickDuration)
+	{
+		state->m_lTotalSampleCount = checkpoint.totalSampleCount;
+		state->m_dBufferDiff = checkpoint.bufferDiff;
+		state->m_nMusicSpeed = checkpoint.musicSpeed;
+		state->m_nMusicTempo = checkpoint.musicTempo;
+		state->m_nGlobalVolume = checkpoint.globalVolume;
+		state->m_nCurrentRowsPerBeat = checkpoint.rowsPerBeat;
+		state->m_nRow = checkpoint.row;
+		state->m_nNextRow = checkpoint.nextRow;
+		state->m_nNextPatStartRow = checkpoint.nextPatStartRow;
+		state->m_nPattern = checkpoint.pattern;
+		state->m_nCurrentOrder = checkpoint.currentOrder;
+		state->m_nNextOrder = checkpoint.nextOrder;
+		std::copy(checkpoint.channels.begin(), checkpoint.channels.end(), state->Chn);
+		chnSettings = checkpoint.chnSettings;
+#ifndef NO_PLUGINS
+		plugParams = checkpoint.plugParams;
+#endif // NO_PLUGINS
+		visitedRows.Restore(checkpoint.visitedRows);
+		retval = checkpoint.retval;
+		elapsedTime = checkpoint.elapsedTime;
+		oldTickDuration = checkpoint.oldTickDuration;
+	}
+
 	// Increment playback position of sample and envelopes on a channel
 	void RenderChannel(CHANNELINDEX channel, uint32 tickDuration, uint32 portaStart = uint32_max)
 	{
@@ -246,7 +293,8 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 	GetLengthMemory memory(*this);
 	CSoundFile::PlayState &playState = *memory.state;
 	// Temporary visited rows vector (so that GetLength() won't interfere with the player code if the module is playing at the same time)
-	RowVisitor visitedRows(*this, sequence);
+	std::unique_ptr<RowVisitor> visitedRowsPtr = m_lengthCheckpoints->AcquireRowVisitor(*this, sequence);
+	RowVisitor &visitedRows = *visitedRowsPtr;
 
 	playState.m_nNextRow = playState.m_nRow = target.startRow;
 	playState.m_nNextOrder = playState.m_nCurrentOrder = target.startOrder;
@@ -290,8 +338,34 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 	// If samples are being synced, force them to resync if tick duration changes
 	uint32 oldTickDuration = 0;
 
+	// Resume from the latest checkpoint that was taken before the target is reached.
+	GetLengthSongCheckpoints *checkpoints = nullptr;
+	if(!adjustSamplePos && m_lengthCheckpoints->IsEnabled())
+	{
+		checkpoints = &m_lengthCheckpoints->GetSong(sequence, target.startOrder, target.startRow, (adjustMode & eAdjust) != 0, m_MixerSettings.gdwMixingFreq, m_nTempoFactor);
+		const GetLengthCheckpoint *checkpoint = nullptr;
+		if(target.mode == GetLengthTarget::SeekSeconds)
+		{
+			checkpoint = checkpoints->FindTime(target.time);
+		} else if(target.mode == GetLengthTarget::SeekPosition && target.pos.order < orderList.size()
+			&& Patterns.IsValidPat(orderList[target.pos.order]) && Patterns[orderList[target.pos.order]].IsValidRow(target.pos.row))
+		{
+			checkpoint = checkpoints->FindPosition(target.pos.order, target.pos.row);
+		}
+		if(checkpoint != nullptr)
+		{
+			memory.RestoreCheckpoint(*checkpoint, visitedRows, retval, oldTickDuration);
+		}
+	}
+
 	for (;;)
 	{
+		// Only record the first subsong, as the following ones depend on the rows visited by the previous ones.
+		if(checkpoints != nullptr && results.empty() && checkpoints->IsCheckpointDue(memory.elapsedTime))
+		{
+			m_lengthCheckpoints->AddCheckpoint(*checkpoints, memory.CreateCheckpoint(visitedRows, retval, oldTickDuration));
+		}
+
 		// Time target reached.
 		if(target.mode == GetLengthTarget::SeekSeconds && memory.elapsedTime >= target.time)
 		{
@@ -399,6 +473,11 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 		if(playState.m_nRow >= Patterns[playState.m_nPattern].GetNumRows())
 			playState.m_nRow = 0;
 
+		if(checkpoints != nullptr && results.empty())
+		{
+			checkpoints->VisitRow(playState.m_nCurrentOrder, playState.m_nRow, memory.elapsedTime);
+		}
+
 		// Check whether target was reached.
 		if(target.mode == GetLengthTarget::SeekPosition && playState.m_nCurrentOrder == target.pos.order && playState.m_nRow == target.pos.row)
 		{
@@ -1312,11 +1391,30 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 		visitedSongRows.Set(visitedRows);
 	}
 
+	m_lengthCheckpoints->ReleaseRowVisitor(std::move(visitedRowsPtr));
 	return results;
 
 }
 
 
+void CSoundFile::SetLengthCheckpoints(double interval, size_t maxMemory)
+{
+	m_lengthCheckpoints->SetConfig(interval, maxMemory);
+}
+
+
+double CSoundFile::GetLengthCheckpointInterval() const
+{
+	return m_lengthCheckpoints->GetInterval();
+}
+
+
+size_t CSoundFile::GetLengthCheckpointMaxMemory() const
+{
+	return m_lengthCheckpoints->GetMaxMemory();
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Effects
 
@@ -1359,6 +1457,9 @@ void CSoundFile::InstrumentChange(ModChannel *pChn, uint32 instr, bool bPorta, b
 		pSmp = nullptr;
 	}
 
+	// Deferred sample data is decoded on a background thread. The sample header is complete already, but notes stay silent until the data is there.
+	RequestDeferredSample(pSmp);
+
 	bool returnAfterVolumeAdjust = false;
 
 	// instrumentChanged is used for IT carry-on env option
@@ -1685,6 +1786,7 @@ void CSoundFile::NoteChange(ModChannel *pChn, int note, bool bPorta, bool bReset
 		}
 		note = pIns->NoteMap[note - NOTE_MIN];
 	}
+	RequestDeferredSample(pSmp);
 	// Key Off
 	if(note > NOTE_MAX)
 	{
@@ -4708,6 +4810,10 @@ void CSoundFile::InvertLoop(ModChannel *pChn)
 	if (++pChn->nEFxOffset >= pModSample->nLoopEnd - pModSample->nLoopStart)
 		pChn->nEFxOffset = 0;
 
+	// Shared or pinned sample data must not be modified, and making a private copy of it would allocate memory on the playback thread.
+	// Samples that may be used by this effect are therefore never shared when loading the module (see CSoundFile::Create).
+	if(SamplePool::IsShared(pModSample->samplev()) || pModSample->IsPinned()) return;
+
 	// TRASH IT!!! (Yes, the sample!)
 	uint8 &sample = mpt::byte_cast<uint8 *>(pModSample->sampleb())[pModSample->nLoopStart + pChn->nEFxOffset];
 	sample = ~sample;
@@ -34,6 +34,10 @@
 #include "../common/FileReader.h"
 #include "Container.h"
 #include "OPL.h"
+#include "GetLengthCheckpoints.h"
+#include "DeferredSamples.h"
+#include "SamplePool.h"
+#include "../common/mptThreadPool.h"
 
 #ifndef NO_ARCHIVE_SUPPORT
 #include "../unarchiver/unarchiver.h"
@@ -78,11 +82,14 @@ CSoundFile::CSoundFile() :
 	m_MIDIMapper(*this),
 #endif
 	m_PRNG(mpt::make_prng<mpt::fast_prng>(mpt::global_prng())),
-	visitedSongRows(*this)
+	visitedSongRows(*this),
+	m_lengthCheckpoints(mpt::make_unique<GetLengthCheckpoints>()),
+	m_deferredSamples(mpt::make_unique<DeferredSamples>()),
+	m_loadThreads(1),
+	m_shareSamples(false),
+	m_pinSamples(false)
 {
-	MemsetZero(MixSoundBuffer);
-	MemsetZero(MixRearBuffer);
-	MemsetZero(MixFloatBuffer);
+	AllocateMixBuffers();
 
 #ifdef MODPLUG_TRACKER
 	m_bChannelMuteTogglePending.reset();
@@ -369,10 +376,16 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 	std::fill(std::begin(m_MixPlugins), std::end(m_MixPlugins), SNDMIXPLUGIN());
 #endif // NO_PLUGINS
 
+	// Sample data is shared with other modules loaded from the same file if this is set
+	bool shareSamples = false;
+	SamplePool::Key poolKey = SamplePool::Key();
+
 	if(file.IsValid())
 	{
 		try
 		{
+			// Set if file references data that is freed when returning from this function
+			bool fileIsTemporary = false;
 
 #ifndef NO_ARCHIVE_SUPPORT
 			CUnarchiver unarchiver(file);
@@ -381,6 +394,7 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 				if (unarchiver.ExtractBestFile(GetSupportedExtensions(true)))
 				{
 					file = unarchiver.GetOutputFile();
+					fileIsTemporary = true;
 				}
 			}
 #endif
@@ -403,6 +417,7 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 					if(!containerItems.empty())
 					{
 						file = containerItems[0].file;
+						fileIsTemporary = fileIsTemporary || (containerItems[0].data_cache != nullptr);
 					}
 				}
 			}
@@ -412,15 +427,58 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 				return false;
 			}
 
-			// Try all module format loaders
+			if(fileIsTemporary)
+			{
+				// Deferred sample data could not be decoded anymore after returning.
+				loadFlags = static_cast<ModLoadingFlags>(loadFlags & ~deferSampleData);
+			}
+
+			// Loaders that support it only read the sample headers first, and the sample data is then decoded on several threads
+			// or referenced in the file data.
+			const bool pinSamples = (loadFlags & loadSampleData) && m_pinSamples && !fileIsTemporary;
+			shareSamples = (loadFlags & loadSampleData) && !(loadFlags & deferSampleData) && m_shareSamples;
+			const bool decodeSamplesInParallel = (loadFlags & loadSampleData) && !(loadFlags & deferSampleData) && (m_loadThreads != 1 || pinSamples);
+			if(decodeSamplesInParallel)
+			{
+				loadFlags = static_cast<ModLoadingFlags>(loadFlags | deferSampleData);
+			}
+			if(decodeSamplesInParallel || pinSamples)
+			{
+				// Stream-backed files can only be read from several threads or referenced by samples once they are cached completely.
+				file.GetRawData();
+			}
+			if(shareSamples)
+			{
+				poolKey = SamplePool::GetFileKey(file);
+			}
+
+			// Try all module format loaders whose header probe does not reject the file.
+			// Candidates are still tried in the order of ModuleFormatLoaders, as that order resolves ambiguities between formats.
+			file.Rewind();
+			const FileReader::PinnedRawDataView header = file.GetPinnedRawDataView(ProbeRecommendedSize);
+			const uint64 fileSize = file.GetLength();
 			bool loaderSuccess = false;
 			for(const auto &format : ModuleFormatLoaders)
 			{
+				if(format.prober != nullptr && format.prober(MemoryFileReader(header.span()), &fileSize) == ProbeFailure)
+					continue;
 				loaderSuccess = (this->*(format.loader))(file, loadFlags);
 				if(loaderSuccess)
 					break;
 			}
 
+			if(loaderSuccess && pinSamples)
+			{
+				for(SAMPLEINDEX smp = 1; smp <= m_nSamples; smp++)
+				{
+					m_deferredSamples->Pin(smp, *this);
+				}
+			}
+			if(loaderSuccess && decodeSamplesInParallel)
+			{
+				m_deferredSamples->DecodeAll(*this, m_loadThreads);
+			}
+
 			if(!loaderSuccess)
 			{
 				m_nType = MOD_TYPE_NONE;
@@ -491,7 +549,10 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 			{
 				filename = filename.RelativePathToAbsolute(GetpModDoc()->GetPathNameMpt().GetPath());
 			}
-			if(!LoadExternalSample(nSmp, filename))
+			if(!(loadFlags & loadSampleData))
+			{
+				// Only reading the sample headers
+			} else if(!LoadExternalSample(nSmp, filename))
 			{
 #ifndef MODPLUG_TRACKER
 				// OpenMPT has its own way of reporting this error in CModDoc.
@@ -504,9 +565,17 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 		}
 #endif // MPT_EXTERNAL_SAMPLES
 
-		if(sample.HasSampleData())
+		if(!sample.IsPinned() && SamplePool::IsShared(sample.samplev()))
+		{
+			// Loops have already been precomputed by the module that shared the data
+			sample.SanitizeLoops();
+		} else if(sample.HasSampleData())
 		{
 			sample.PrecomputeLoops(*this, false);
+		} else if(IsSampleDataDeferred(nSmp))
+		{
+			// Loops are precomputed once the data has been decoded
+			sample.SanitizeLoops();
 		} else if(!sample.uFlags[SMP_KEEPONDISK])
 		{
 			sample.nLength = 0;
@@ -519,6 +588,27 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 		if(sample.nGlobalVol > 64) sample.nGlobalVol = 64;
 		if(sample.uFlags[CHN_ADLIB] && m_opl == nullptr) InitOPL();
 	}
+	if(shareSamples)
+	{
+		// The MOD Invert Loop effect (EFx) modifies looped 8-bit samples while playing.
+		// Such samples are never shared, so that the playback thread does not have to make a private copy of them.
+		bool usesInvertLoop = false;
+		if(GetType() == MOD_TYPE_MOD)
+		{
+			Patterns.ForEachModCommand([&usesInvertLoop](const ModCommand &m)
+			{
+				if(m.command == CMD_MODCMDEX && (m.param & 0xF0) == 0xF0 && (m.param & 0x0F) != 0)
+					usesInvertLoop = true;
+			});
+		}
+		for(SAMPLEINDEX smp = 1; smp <= m_nSamples; smp++)
+		{
+			if(usesInvertLoop && Samples[smp].uFlags[CHN_LOOP] && !Samples[smp].uFlags[CHN_16BIT])
+				continue;
+			poolKey.sample = smp;
+			SamplePool::Instance().Share(poolKey, Samples[smp]);
+		}
+	}
 	// Check invalid instruments
 	INSTRUMENTINDEX maxInstr = 0;
 	for(INSTRUMENTINDEX i = 0; i <= m_nInstruments; i++)
@@ -560,6 +650,7 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 
 	RecalculateSamplesPerTick();
 	visitedSongRows.Initialize(true);
+	m_lengthCheckpoints->Clear();
 
 	for(auto &order : Order)
 	{
@@ -677,6 +768,8 @@ bool CSoundFile::Destroy()
 	}
 
 	Patterns.DestroyPatterns();
+	m_lengthCheckpoints->Clear();
+	m_deferredSamples->Clear();
 
 	m_songName.clear();
 	m_songArtist.clear();
@@ -1418,6 +1511,89 @@ bool CSoundFile::DestroySampleThreadsafe(SAMPLEINDEX nSample)
 }
 
 
+void CSoundFile::DeferSampleData(SAMPLEINDEX smp, const SampleIO &sampleIO, const FileReader &file)
+{
+	if(sampleIO.PrepareSample(Samples[smp], file))
+	{
+		m_deferredSamples->Add(smp, sampleIO, file);
+	}
+}
+
+
+bool CSoundFile::IsSampleDataDeferred(SAMPLEINDEX smp) const
+{
+	return m_deferredSamples->IsPending(smp);
+}
+
+
+void CSoundFile::ResolveDeferredSample(const ModSample *sample) const
+{
+	if(sample == nullptr || sample->HasSampleData())
+	{
+		return;
+	}
+	const SAMPLEINDEX smp = static_cast<SAMPLEINDEX>(sample - Samples);
+	if(m_deferredSamples->IsPending(smp))
+	{
+		// Playback routines are const, but decoding the sample data is not observable from the outside.
+		m_deferredSamples->Resolve(smp, const_cast<CSoundFile &>(*this));
+	}
+}
+
+
+bool CSoundFile::RequestDeferredSample(const ModSample *sample) const
+{
+	if(sample == nullptr || sample->HasSampleData())
+	{
+		return true;
+	}
+	// Playback routines are const, but attaching the decoded sample data is not observable from the outside.
+	return m_deferredSamples->Request(static_cast<SAMPLEINDEX>(sample - Samples), const_cast<CSoundFile &>(*this));
+}
+
+
+void CSoundFile::StartDeferredSampleDecoding(bool decodeAll)
+{
+	m_deferredSamples->StartBackgroundDecoding(*this, decodeAll);
+}
+
+
+void CSoundFile::SetLoadThreads(std::size_t numThreads)
+{
+	m_loadThreads = numThreads;
+}
+
+
+std::size_t CSoundFile::GetLoadThreads() const
+{
+	return m_loadThreads;
+}
+
+
+void CSoundFile::SetSampleSharing(bool share)
+{
+	m_shareSamples = share;
+}
+
+
+bool CSoundFile::GetSampleSharing() const
+{
+	return m_shareSamples;
+}
+
+
+void CSoundFile::SetSamplePinning(bool pin)
+{
+	m_pinSamples = pin;
+}
+
+
+bool CSoundFile::GetSamplePinning() const
+{
+	return m_pinSamples;
+}
+
+
 CTuning* CSoundFile::CreateTuning12TET(const std::string &name)
 {
 	CTuning* pT = CTuning::CreateGeometric(name, 12, 2, 15);
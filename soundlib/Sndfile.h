@@ -27,6 +27,8 @@
 #endif // MODPLUG_TRACKER
 
 #include "Mixer.h"
+#include "MixBuffer.h"
+#include "MixerInterface.h"
 #include "Resampler.h"
 #ifndef NO_REVERB
 #include "../sounddsp/Reverb.h"
@@ -211,6 +213,10 @@ class CTuningCollection;
 typedef Tuning::CTuningCollection CTuningCollection;
 struct CModSpecifications;
 class OPL;
+class GetLengthCheckpoints;
+class DeferredSamples;
+class SampleIO;
+namespace mpt { class thread_pool; }
 #ifdef MODPLUG_TRACKER
 class CModDoc;
 #endif // MODPLUG_TRACKER
@@ -249,6 +255,10 @@ protected:
 	virtual ~IAudioReadTarget() = default;
 public:
 	virtual void DataCallback(int *MixSoundBuffer, std::size_t channels, std::size_t countChunk) = 0;
+	// Targets that can consume a floating point mix (full scale = 1.0) directly return true here.
+	// If they do and MixerSettings::FloatMasterMix is enabled, FloatDataCallback is called instead of DataCallback.
+	virtual bool AcceptsFloatMix() const { return false; }
+	virtual void FloatDataCallback(float * /*MixFloatBuffer*/, std::size_t /*channels*/, std::size_t /*countChunk*/) { }
 };
 
 
@@ -338,14 +348,22 @@ private: //Misc data
 	const CModSpecifications *m_pModSpecs;
 
 private:
+	// All mix buffers hold m_MixerSettings.MixChunkSize frames.
 	// Interleaved Front Mix Buffer (Also room for interleaved rear mix)
-	mixsample_t MixSoundBuffer[MIXBUFFERSIZE * 4];
-	mixsample_t MixRearBuffer[MIXBUFFERSIZE * 2];
+	AlignedMixBuffer<mixsample_t> MixSoundBuffer;
+	AlignedMixBuffer<mixsample_t> MixRearBuffer;
 	// Non-interleaved plugin processing buffer
-	float MixFloatBuffer[2][MIXBUFFERSIZE];
+	AlignedMixBuffer<float> MixFloatBuffer[2];
+	// Interleaved floating point master mix, only allocated if MixerSettings::FloatMasterMix is enabled.
+	AlignedMixBuffer<float> MixFloatSoundBuffer;
+	AlignedMixBuffer<float> MixFloatRearBuffer;
 	mixsample_t gnDryLOfsVol = 0;
 	mixsample_t gnDryROfsVol = 0;
-	mixsample_t MixInputBuffer[NUMMIXINPUTBUFFERS][MIXBUFFERSIZE];
+	AlignedMixBuffer<mixsample_t> MixInputBuffer[NUMMIXINPUTBUFFERS];
+	// Parallel voice mixing: Scratch buffers for all but the first mix thread, and list of voices to mix in parallel.
+	AlignedMixBuffer<mixsample_t> MixWorkerBuffer;
+	std::vector<CHANNELINDEX> m_MixParallelVoices;
+	std::unique_ptr<mpt::thread_pool> m_MixThreadPool;
 
 public:
 	MixerSettings m_MixerSettings;
@@ -383,6 +401,7 @@ public:
 	CHANNELINDEX m_nMixChannels = 0;
 private:
 	CHANNELINDEX m_nMixStat;
+	uint64 m_nSilentFramesSkipped = 0;	// Number of frames for which mixing was skipped because the whole mix was known to be silent
 public:
 	ROWINDEX m_nDefaultRowsPerBeat, m_nDefaultRowsPerMeasure;	// default rows per beat and measure for this module
 	TempoMode m_nTempoMode = tempoModeClassic;
@@ -422,6 +441,29 @@ public:
 	MIDIMacroConfig m_MidiCfg;							// MIDI Macro config table
 #ifndef NO_PLUGINS
 	SNDMIXPLUGIN m_MixPlugins[MAX_MIXPLUGINS];			// Mix plugins
+private:
+	// Slots that hold a plugin instance, in processing order (plugins can only be routed to plugins in later slots, so this is ascending slot order)
+	mutable std::vector<PLUGINDEX> m_ActivePlugins;
+	mutable bool m_ActivePluginsDirty = true;
+	// A plugin to be processed in the current mix chunk, and the buffers it touches (see ProcessPlugins)
+	struct PluginJob
+	{
+		float *inL, *inR;			// Plugin input
+		float *outL, *outR;			// Buffers the plugin output is mixed into
+		float *masterL, *masterR;	// Master mix that is moved into the plugin input before processing (master effects only), or nullptr
+		float *scratchL, *scratchR;	// Scratch buffers the plugin output is rendered to if the plugin is processed in parallel, or nullptr
+		uint32 level;				// Plugins of the same level do not depend on each other and can be processed concurrently
+		PLUGINDEX plug;
+		PLUGINDEX outPlug;			// Plugin the output is routed to, or PLUGINDEX_INVALID
+		bool readsOutput;			// Plugin output depends on the previous contents of the output buffers, so it cannot be rendered to a scratch buffer
+		bool skip;					// Plugin has no input and is not processed at all
+		bool process;				// Plugin is not bypassed
+	};
+	std::vector<PluginJob> m_PluginJobs;
+	std::vector<PluginJob *> m_PluginParallelJobs;
+	AlignedMixBuffer<float> PluginWorkerBuffer;	// One pair of scratch buffers per plugin instance (see AllocatePluginWorkerBuffer)
+	std::unique_ptr<mpt::thread_pool> m_PluginThreadPool;
+public:
 #endif
 	char m_szNames[MAX_SAMPLES][MAX_SAMPLENAME];		// Sample names
 
@@ -445,6 +487,7 @@ public:
 	struct PlayState
 	{
 		friend class CSoundFile;
+		friend class GetLengthMemory;
 	protected:
 		samplecount_t m_nBufferCount;
 		double m_dBufferDiff;
@@ -497,6 +540,16 @@ public:
 protected:
 	// For handling backwards jumps and stuff to prevent infinite loops when counting the mod length or rendering to wav.
 	RowVisitor visitedSongRows;
+	// Snapshots of the GetLength() state, for quickly seeking to positions that have been scanned before
+	std::unique_ptr<GetLengthCheckpoints> m_lengthCheckpoints;
+	// Samples whose data is decoded when they are played for the first time
+	std::unique_ptr<DeferredSamples> m_deferredSamples;
+	// Number of threads used for decoding sample data while loading (0 = one per CPU core)
+	std::size_t m_loadThreads;
+	// Share sample data with other modules loaded from the same file (see SamplePool)
+	bool m_shareSamples;
+	// Let uncompressed sample data reference the file data instead of copying it
+	bool m_pinSamples;
 
 public:
 #ifdef MODPLUG_TRACKER
@@ -571,6 +624,8 @@ public:
 		loadPluginInstance = 0x08, // If unset, plugins are not instanciated.
 		skipContainer      = 0x10,
 		skipModules        = 0x20,
+		deferSampleData    = 0x40, // If set along with loadSampleData, loaders may only remember where sample data is stored and decode it when the sample is played for the first time.
+		loadMetadata       = 0x80, // Unlike onlyVerifyHeader, it makes loaders read everything except for the data types whose flags are unset (e.g. names and song message). Loaders that derive the channel count from the pattern data still scan it.
 
 		// Shortcuts
 		loadCompleteModule = loadSampleData | loadPatternData | loadPluginData | loadPluginInstance,
@@ -660,6 +715,8 @@ public:
 	void DontLoopPattern(PATTERNINDEX nPat, ROWINDEX nRow = 0);
 	CHANNELINDEX GetMixStat() const { return m_nMixStat; }
 	void ResetMixStat() { m_nMixStat = 0; }
+	uint64 GetSilentFramesSkipped() const { return m_nSilentFramesSkipped; }
+	void ResetSilentFramesSkipped() { m_nSilentFramesSkipped = 0; }
 	void ResetPlayPos();
 	void SetCurrentOrder(ORDERINDEX nOrder);
 	std::string GetTitle() const { return m_songName; }
@@ -672,6 +729,37 @@ public:
 
 	// Get song duration in various cases: total length, length to specific order & row, etc.
 	std::vector<GetLengthType> GetLength(enmGetLengthResetMode adjustMode, GetLengthTarget target = GetLengthTarget());
+	// Let GetLength() record a checkpoint every interval seconds while scanning a song, so that later seeks can resume from the closest checkpoint.
+	// An interval of 0 disables checkpoints. maxMemory limits the memory used by all checkpoints, in bytes.
+	// Checkpoints are discarded when a new module is loaded, but not when the module is modified, so they should not be used while editing.
+	void SetLengthCheckpoints(double interval, size_t maxMemory);
+	double GetLengthCheckpointInterval() const;
+	size_t GetLengthCheckpointMaxMemory() const;
+
+	// Prepare the sample header and remember where to decode its data from when the sample is played for the first time (see deferSampleData).
+	// The file position is not advanced.
+	void DeferSampleData(SAMPLEINDEX smp, const SampleIO &sampleIO, const FileReader &file);
+	// Returns true if the sample has data that has not been decoded yet.
+	bool IsSampleDataDeferred(SAMPLEINDEX smp) const;
+	// Decode the data of a deferred sample on the calling thread if that has not happened yet. Must only be called from the thread that plays the module.
+	void ResolveDeferredSample(const ModSample *sample) const;
+	// Let the data of a deferred sample be decoded on a background thread as soon as possible, and attach it to the sample once that has happened.
+	// Returns false while the sample data is not available yet. Must only be called from the thread that plays the module.
+	bool RequestDeferredSample(const ModSample *sample) const;
+	// Start the background thread that decodes deferred samples when they are requested. If decodeAll is true, it also decodes
+	// all other deferred samples ahead of their first use.
+	void StartDeferredSampleDecoding(bool decodeAll = true);
+	// Set the number of threads used for decoding sample data in Create(). 1 = decode on the calling thread, 0 = one thread per CPU core.
+	void SetLoadThreads(std::size_t numThreads);
+	std::size_t GetLoadThreads() const;
+	// Share decoded sample data with other modules that are loaded from the same file. Only applies to modules loaded afterwards.
+	void SetSampleSharing(bool share);
+	bool GetSampleSharing() const;
+	// Let sample data that is stored as plain PCM in native byte order reference the file data instead of copying it. Only applies to modules loaded afterwards.
+	// Memory-backed file data must stay valid until the module is destroyed; stream-backed files are cached and kept alive by the module.
+	// Only formats whose loaders support deferSampleData are affected. Pinned samples take precedence over shared samples.
+	void SetSamplePinning(bool pin);
+	bool GetSamplePinning() const;
 
 public:
 	void RecalculateSamplesPerTick();
@@ -836,12 +924,29 @@ public:
 	samplecount_t Read(samplecount_t count, IAudioReadTarget &target, IAudioSource &source);
 private:
 	void CreateStereoMix(int count);
+	bool MixChannel(ModChannel &chn, const MixFuncInterface *mixFunctions, uint32 &functionNdx, mixsample_t *pbuffer, mixsample_t &ofsR, mixsample_t &ofsL, int count, bool tooManyChannels) const;
+	CHANNELINDEX MixVoicesParallel(const std::vector<CHANNELINDEX> &voices, const MixFuncInterface *mixFunctions, int count);
 public:
 	bool FadeSong(uint32 msec);
 private:
 	void ProcessDSP(uint32 countChunk);
-	void ProcessPlugins(uint32 nCount);
+	// If floatOutput is not nullptr, the processed stereo mix is written there as interleaved floating point data (full scale = 1.0) instead of MixSoundBuffer.
+	void ProcessPlugins(uint32 nCount, float *floatOutput = nullptr);
+#ifndef NO_PLUGINS
+	void AllocatePluginWorkerBuffer();
+	uint32 PlanPluginJobs(const std::vector<PLUGINDEX> &activePlugins, float *&pMixL, float *&pMixR);
+#endif // NO_PLUGINS
+public:
+#ifndef NO_PLUGINS
+	// Must be called whenever a plugin instance is attached to or removed from a slot
+	void InvalidateActivePlugins();
+	// Returns the slots that hold a plugin instance, rebuilding the list if necessary
+	const std::vector<PLUGINDEX> &GetActivePlugins() const;
+#endif // NO_PLUGINS
+private:
 	void ProcessInputChannels(IAudioSource &source, std::size_t countChunk);
+	void AllocateMixBuffers();
+	uint32 GetMixChunkSize(bool mixPlugins) const;
 public:
 	samplecount_t GetTotalSampleCount() const { return m_PlayState.m_lTotalSampleCount; }
 	bool HasPositionChanged() { bool b = m_PlayState.m_bPositionChanged; m_PlayState.m_bPositionChanged = false; return b; }
@@ -858,6 +963,7 @@ public:
 	uint32 GetSampleRate() const { return m_MixerSettings.gdwMixingFreq; }
 #ifndef NO_EQ
 	void SetEQGains(const uint32 *pGains, uint32 nBands, const uint32 *pFreqs=NULL, bool bReset=false)	{ m_EQ.SetEQGains(pGains, nBands, pFreqs, bReset, m_MixerSettings.gdwMixingFreq); } // 0=-12dB, 32=+12dB
+	void SetEQGains(const float32 *pGains, uint32 nBands, const float32 *pFreqs, bool bReset=false)	{ m_EQ.SetEQGains(pGains, nBands, pFreqs, bReset, m_MixerSettings.gdwMixingFreq); } // linear, 0.25=-12dB, 4=+12dB
 #endif // NO_EQ
 public:
 	bool ReadNote();
@@ -1082,8 +1188,15 @@ public:
 	void ProcessMidiOut(CHANNELINDEX nChn);
 #endif // NO_PLUGINS
 
-	void ProcessGlobalVolume(long countChunk);
-	void ProcessStereoSeparation(long countChunk);
+	bool IsMixSilent() const;
+	int32 UpdateGlobalVolumeRamp();
+	void SkipGlobalVolumeRamp(long countChunk);
+	template<typename Tsample>
+	void ProcessMasterMix(Tsample *soundBuffer, Tsample *rearBuffer, samplecount_t countChunk);
+	template<typename Tsample>
+	void ProcessGlobalVolume(Tsample *soundBuffer, Tsample *rearBuffer, long countChunk);
+	template<typename Tsample>
+	void ProcessStereoSeparation(Tsample *soundBuffer, Tsample *rearBuffer, long countChunk);
 
 private:
 	PLUGINDEX GetChannelPlugin(CHANNELINDEX nChn, PluginMutePriority respectMutes) const;
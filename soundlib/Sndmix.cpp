@@ -23,6 +23,7 @@
 #include "plugins/PlugInterface.h"
 #endif // NO_PLUGINS
 #include "OPL.h"
+#include "../common/mptThreadPool.h"
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -69,11 +70,78 @@ void CSoundFile::SetMixerSettings(const MixerSettings &mixersettings)
 		||
 		(mixersettings.MixerFlags != m_MixerSettings.MixerFlags))
 		reset = true;
+	const bool reallocate = (mixersettings.MixChunkSize != m_MixerSettings.MixChunkSize) || (mixersettings.NumMixThreads != m_MixerSettings.NumMixThreads) || (mixersettings.NumPluginThreads != m_MixerSettings.NumPluginThreads) || (mixersettings.FloatMasterMix != m_MixerSettings.FloatMasterMix);
 	m_MixerSettings = mixersettings;
+	if(reallocate)
+		AllocateMixBuffers();
 	InitPlayer(reset);
 }
 
 
+// Create or destroy a thread pool so that it has the requested number of threads (0 = one per CPU core).
+// The pool is only kept if it can actually process work items concurrently.
+static void UpdateThreadPool(std::unique_ptr<mpt::thread_pool> &pool, std::size_t numThreads)
+{
+	if(numThreads == 0)
+		numThreads = mpt::thread_pool::hardware_concurrency();
+	numThreads = std::min<std::size_t>(numThreads, MixerSettings::MaxMixThreads);
+	if(numThreads > 1 && (!pool || pool->size() != numThreads))
+		pool = mpt::make_unique<mpt::thread_pool>(numThreads);
+	else if(numThreads <= 1)
+		pool = nullptr;
+	if(pool && pool->size() <= 1)
+		pool = nullptr;	// No thread support
+}
+
+
+// (Re-)allocate all mix buffers and thread pools for the currently configured chunk size and number of mix and plugin threads
+void CSoundFile::AllocateMixBuffers()
+{
+	const std::size_t chunkSize = m_MixerSettings.MixChunkSize;
+	MixSoundBuffer.Resize(chunkSize * 4);
+	MixRearBuffer.Resize(chunkSize * 2);
+	for(auto &buffer : MixFloatBuffer)
+	{
+		buffer.Resize(chunkSize);
+	}
+	for(auto &buffer : MixInputBuffer)
+	{
+		buffer.Resize(chunkSize);
+	}
+	MixFloatSoundBuffer.Resize(m_MixerSettings.FloatMasterMix ? chunkSize * 4 : 0);
+	MixFloatRearBuffer.Resize(m_MixerSettings.FloatMasterMix ? chunkSize * 2 : 0);
+#ifndef NO_REVERB
+	m_Reverb.AllocateMixBuffer(chunkSize);
+#endif // NO_REVERB
+
+	UpdateThreadPool(m_MixThreadPool, m_MixerSettings.NumMixThreads);
+	const std::size_t numWorkerBuffers = m_MixThreadPool ? (m_MixThreadPool->size() - 1) : 0;
+	MixWorkerBuffer.Resize(numWorkerBuffers * chunkSize * 2);
+	m_MixParallelVoices.reserve(MAX_CHANNELS);
+
+#ifndef NO_PLUGINS
+	UpdateThreadPool(m_PluginThreadPool, m_MixerSettings.NumPluginThreads);
+	m_ActivePlugins.reserve(MAX_MIXPLUGINS);
+	m_PluginJobs.reserve(MAX_MIXPLUGINS);
+	m_PluginParallelJobs.reserve(MAX_MIXPLUGINS);
+	AllocatePluginWorkerBuffer();
+#endif // NO_PLUGINS
+}
+
+
+// Number of frames that may be rendered in one go.
+// Plugins have fixed-size internal buffers, so the chunk size is limited to MIXBUFFERSIZE if any of them are active.
+uint32 CSoundFile::GetMixChunkSize(bool mixPlugins) const
+{
+	uint32 chunkSize = m_MixerSettings.MixChunkSize;
+	if(mixPlugins)
+	{
+		chunkSize = std::min(chunkSize, uint32(MIXBUFFERSIZE));
+	}
+	return chunkSize;
+}
+
+
 void CSoundFile::SetResamplerSettings(const CResamplerSettings &resamplersettings)
 {
 	m_Resampler.m_Settings = resamplersettings;
@@ -140,34 +208,45 @@ bool CSoundFile::FadeSong(uint32 msec)
 // Apply stereo separation factor on an interleaved stereo/quad stream.
 // count = Number of stereo sample pairs to process
 // separation = -256...256 (negative values = swap L/R, 0 = mono, 128 = normal)
-static void ApplyStereoSeparation(mixsample_t *mixBuf, std::size_t count, int32 separation)
+static void ApplyStereoSeparation(int32 *mixBuf, std::size_t count, int32 separation)
+{
+	const int32 factor_num = separation; // 128 =^= 1.0f
+	const int32 factor_den = MixerSettings::StereoSeparationScale; // 128
+	const int32 normalize_den = 2; // mid/side pre/post normalization
+	const int32 mid_den = normalize_den;
+	const int32 side_num = factor_num;
+	const int32 side_den = factor_den * normalize_den;
+	for(std::size_t i = 0; i < count; i++)
+	{
+		int32 l = mixBuf[0];
+		int32 r = mixBuf[1];
+		int32 m = l + r;
+		int32 s = l - r;
+		m /= mid_den;
+		s = Util::muldiv(s, side_num, side_den);
+		l = m + s;
+		r = m - s;
+		mixBuf[0] = l;
+		mixBuf[1] = r;
+		mixBuf += 2;
+	}
+}
+
+
+static void ApplyStereoSeparation(float *mixBuf, std::size_t count, int32 separation)
 {
-#ifdef MPT_INTMIXER
-	const mixsample_t factor_num = separation; // 128 =^= 1.0f
-	const mixsample_t factor_den = MixerSettings::StereoSeparationScale; // 128
-	const mixsample_t normalize_den = 2; // mid/side pre/post normalization
-	const mixsample_t mid_den = normalize_den;
-	const mixsample_t side_num = factor_num;
-	const mixsample_t side_den = factor_den * normalize_den;
-#else
 	const float normalize_factor = 0.5f; // cumulative mid/side normalization factor (1/sqrt(2))*(1/sqrt(2))
 	const float factor = static_cast<float>(separation) / static_cast<float>(MixerSettings::StereoSeparationScale); // sep / 128
 	const float mid_factor = normalize_factor;
 	const float side_factor = factor * normalize_factor;
-#endif
 	for(std::size_t i = 0; i < count; i++)
 	{
-		mixsample_t l = mixBuf[0];
-		mixsample_t r = mixBuf[1];
-		mixsample_t m = l + r;
-		mixsample_t s = l - r;
-#ifdef MPT_INTMIXER
-		m /= mid_den;
-		s = Util::muldiv(s, side_num, side_den);
-#else
+		float l = mixBuf[0];
+		float r = mixBuf[1];
+		float m = l + r;
+		float s = l - r;
 		m *= mid_factor;
 		s *= side_factor;
-#endif
 		l = m + s;
 		r = m - s;
 		mixBuf[0] = l;
@@ -177,7 +256,8 @@ static void ApplyStereoSeparation(mixsample_t *mixBuf, std::size_t count, int32
 }
 
 
-static void ApplyStereoSeparation(mixsample_t *SoundFrontBuffer, mixsample_t *SoundRearBuffer, std::size_t channels, std::size_t countChunk, int32 separation)
+template<typename Tsample>
+static void ApplyStereoSeparation(Tsample *SoundFrontBuffer, Tsample *SoundRearBuffer, std::size_t channels, std::size_t countChunk, int32 separation)
 {
 	if(separation == MixerSettings::StereoSeparationScale)
 	{ // identity
@@ -188,6 +268,92 @@ static void ApplyStereoSeparation(mixsample_t *SoundFrontBuffer, mixsample_t *So
 }
 
 
+// Returns true if the next chunk is known to be completely silent:
+// No voices are playing, no click removal offsets are left and neither OPL, reverb nor any plugin can produce a tail.
+bool CSoundFile::IsMixSilent() const
+{
+	if(m_MixerSettings.NumInputChannels > 0 || m_MixerSettings.DSPMask)
+	{
+		return false;
+	}
+	if(gnDryROfsVol || gnDryLOfsVol)
+	{
+		return false;
+	}
+	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
+	{
+		if(m_PlayState.Chn[m_PlayState.ChnMix[nChn]].pCurrentSample)
+		{
+			return false;
+		}
+	}
+	if(m_opl && m_opl->IsActive())
+	{
+		return false;
+	}
+#ifndef NO_REVERB
+	if(m_Reverb.IsActive())
+	{
+		return false;
+	}
+#endif // NO_REVERB
+#ifndef NO_PLUGINS
+	for(PLUGINDEX plug : GetActivePlugins())
+	{
+		const SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
+		if(plugin.pMixPlugin == nullptr)
+		{
+			continue;
+		}
+		// Auto-suspended plugins are only woken up again by new input or MIDI events.
+		const SNDMIXPLUGINSTATE &state = plugin.pMixPlugin->m_MixState;
+		if(!plugin.IsBypassed() && !(plugin.IsAutoSuspendable() && (state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass)))
+		{
+			return false;
+		}
+		if(state.nVolDecayR || state.nVolDecayL || (state.dwFlags & SNDMIXPLUGINSTATE::psfMixReady))
+		{
+			return false;
+		}
+	}
+#endif // NO_PLUGINS
+	return true;
+}
+
+
+// Mono downmix, global volume, stereo separation, DSP effects and quad interleaving, applied to either the fixed point or the floating point master mix.
+template<typename Tsample>
+void CSoundFile::ProcessMasterMix(Tsample *soundBuffer, Tsample *rearBuffer, samplecount_t countChunk)
+{
+	if(m_MixerSettings.gnChannels == 1)
+	{
+		MonoFromStereo(soundBuffer, countChunk);
+	}
+
+	if(m_PlayConfig.getGlobalVolumeAppliesToMaster())
+	{
+		ProcessGlobalVolume(soundBuffer, rearBuffer, countChunk);
+	}
+
+	if(m_MixerSettings.m_nStereoSeparation != MixerSettings::StereoSeparationScale)
+	{
+		ProcessStereoSeparation(soundBuffer, rearBuffer, countChunk);
+	}
+
+	if(m_MixerSettings.DSPMask)
+	{
+		// The floating point master mix is never used with DSP effects (see Read)
+		MPT_ASSERT(static_cast<void *>(soundBuffer) == static_cast<void *>(MixSoundBuffer.data()));
+		ProcessDSP(countChunk);
+	}
+
+	if(m_MixerSettings.gnChannels == 4)
+	{
+		InterleaveFrontRear(soundBuffer, rearBuffer, countChunk);
+	}
+}
+
+
 void CSoundFile::ProcessInputChannels(IAudioSource &source, std::size_t countChunk)
 {
 	for(std::size_t channel = 0; channel < NUMMIXINPUTBUFFERS; ++channel)
@@ -209,16 +375,13 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 
 	bool mixPlugins = false;
 #ifndef NO_PLUGINS
-	for(const auto &plug : m_MixPlugins)
-	{
-		if(plug.pMixPlugin)
-		{
-			mixPlugins = true;
-			break;
-		}
-	}
+	mixPlugins = !GetActivePlugins().empty();
 #endif // NO_PLUGINS
 
+	const samplecount_t mixChunkSize = GetMixChunkSize(mixPlugins);
+	// DSP effects can only process the fixed point mix.
+	const bool floatMix = m_MixerSettings.FloatMasterMix && !m_MixerSettings.DSPMask && target.AcceptsFloatMix();
+
 	samplecount_t countRendered = 0;
 	samplecount_t countToRender = count;
 
@@ -290,55 +453,74 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 
 		MPT_ASSERT(m_PlayState.m_nBufferCount > 0); // assert that we have actually something to do
 
-		const samplecount_t countChunk = std::min<samplecount_t>({ MIXBUFFERSIZE, m_PlayState.m_nBufferCount, countToRender });
+		const samplecount_t countChunk = std::min<samplecount_t>({ mixChunkSize, m_PlayState.m_nBufferCount, countToRender });
 
-		if(m_MixerSettings.NumInputChannels > 0)
+		if(m_MixerSettings.SkipSilentChunks && IsMixSilent())
 		{
-			ProcessInputChannels(source, countChunk);
-		}
-
-		CreateStereoMix(countChunk);
-
-		if(m_opl)
+			// Nothing is playing and no effect has a tail left, so the whole chunk is silent and only the global volume ramp needs to advance.
+			// The target is still fed with silence, as it may e.g. apply dithering.
+			if(m_PlayConfig.getGlobalVolumeAppliesToMaster())
+			{
+				SkipGlobalVolumeRamp(countChunk);
+			}
+			if(floatMix)
+			{
+				std::fill(MixFloatSoundBuffer.data(), MixFloatSoundBuffer.data() + countChunk * m_MixerSettings.gnChannels, 0.0f);
+				target.FloatDataCallback(MixFloatSoundBuffer, m_MixerSettings.gnChannels, countChunk);
+			} else
+			{
+				std::fill(MixSoundBuffer.data(), MixSoundBuffer.data() + countChunk * m_MixerSettings.gnChannels, 0);
+				target.DataCallback(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk);
+			}
+			m_nSilentFramesSkipped += countChunk;
+		} else
 		{
-			m_opl->Mix(MixSoundBuffer, countChunk);
-		}
+			if(m_MixerSettings.NumInputChannels > 0)
+			{
+				ProcessInputChannels(source, countChunk);
+			}
 
-		#ifndef NO_REVERB
-			m_Reverb.Process(MixSoundBuffer, countChunk);
-		#endif // NO_REVERB
+			CreateStereoMix(countChunk);
 
-		if(mixPlugins)
-		{
-			ProcessPlugins(countChunk);
-		}
+			if(m_opl)
+			{
+				m_opl->Mix(MixSoundBuffer, countChunk);
+			}
 
-		if(m_MixerSettings.gnChannels == 1)
-		{
-			MonoFromStereo(MixSoundBuffer, countChunk);
-		}
+			#ifndef NO_REVERB
+				m_Reverb.Process(MixSoundBuffer, countChunk);
+			#endif // NO_REVERB
 
-		if(m_PlayConfig.getGlobalVolumeAppliesToMaster())
-		{
-			ProcessGlobalVolume(countChunk);
-		}
+			if(floatMix)
+			{
+				// Convert the fixed point voice mix only once, and keep the rest of the master mix in floating point
+				if(mixPlugins)
+				{
+					ProcessPlugins(countChunk, MixFloatSoundBuffer);
+				} else
+				{
+					MonoMixToFloat(MixSoundBuffer, MixFloatSoundBuffer, countChunk * 2, 1.0f / MIXING_SCALEF);
+				}
+				if(m_MixerSettings.gnChannels == 4)
+				{
+					MonoMixToFloat(MixRearBuffer, MixFloatRearBuffer, countChunk * 2, 1.0f / MIXING_SCALEF);
+				}
 
-		if(m_MixerSettings.m_nStereoSeparation != MixerSettings::StereoSeparationScale)
-		{
-			ProcessStereoSeparation(countChunk);
-		}
+				ProcessMasterMix(MixFloatSoundBuffer.data(), MixFloatRearBuffer.data(), countChunk);
 
-		if(m_MixerSettings.DSPMask)
-		{
-			ProcessDSP(countChunk);
-		}
+				target.FloatDataCallback(MixFloatSoundBuffer, m_MixerSettings.gnChannels, countChunk);
+			} else
+			{
+				if(mixPlugins)
+				{
+					ProcessPlugins(countChunk);
+				}
 
-		if(m_MixerSettings.gnChannels == 4)
-		{
-			InterleaveFrontRear(MixSoundBuffer, MixRearBuffer, countChunk);
-		}
+				ProcessMasterMix(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk);
 
-		target.DataCallback(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk);
+				target.DataCallback(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk);
+			}
+		}
 
 		// Buffer ready
 		countRendered += countChunk;
@@ -2287,6 +2469,11 @@ bool CSoundFile::ReadNote()
 		if (pChn->nRightVU > VUMETER_DECAY) pChn->nRightVU -= VUMETER_DECAY; else pChn->nRightVU = 0;
 
 		pChn->newLeftVol = pChn->newRightVol = 0;
+		if(pChn->pModSample && !pChn->pModSample->HasSampleData() && pChn->nLength)
+		{
+			// Notes that were triggered before the deferred sample data was decoded start playing once it is available.
+			RequestDeferredSample(pChn->pModSample);
+		}
 		pChn->pCurrentSample = (pChn->pModSample && pChn->pModSample->HasSampleData() && pChn->nLength && pChn->IsSamplePlaying()) ? pChn->pModSample->samplev() : nullptr;
 		if (pChn->pCurrentSample || (pChn->HasMIDIOutput() && !pChn->dwFlags[CHN_KEYOFF | CHN_NOTEFADE]))
 		{
@@ -2560,8 +2747,19 @@ void CSoundFile::ProcessMidiOut(CHANNELINDEX nChn)
 #endif // NO_PLUGINS
 
 
-template<int channels>
-MPT_FORCEINLINE void ApplyGlobalVolumeWithRamping(int *SoundBuffer, int *RearBuffer, int32 lCount, int32 m_nGlobalVolume, int32 step, int32 &m_nSamplesToGlobalVolRampDest, int32 &m_lHighResRampingGlobalVolume)
+static MPT_FORCEINLINE int32 ApplyGlobalVolume(int32 sample, int32 volume, int32 volumeScale)
+{
+	return Util::muldiv(sample, volume, volumeScale);
+}
+
+static MPT_FORCEINLINE float ApplyGlobalVolume(float sample, int32 volume, int32 volumeScale)
+{
+	return sample * static_cast<float>(volume) / static_cast<float>(volumeScale);
+}
+
+
+template<int channels, typename Tsample>
+MPT_FORCEINLINE void ApplyGlobalVolumeWithRamping(Tsample *SoundBuffer, Tsample *RearBuffer, int32 lCount, int32 m_nGlobalVolume, int32 step, int32 &m_nSamplesToGlobalVolRampDest, int32 &m_lHighResRampingGlobalVolume)
 {
 	const bool isStereo = (channels >= 2);
 	const bool hasRear = (channels >= 4);
@@ -2571,17 +2769,17 @@ MPT_FORCEINLINE void ApplyGlobalVolumeWithRamping(int *SoundBuffer, int *RearBuf
 		{
 			// Ramping required
 			m_lHighResRampingGlobalVolume += step;
-			                          SoundBuffer[0] = Util::muldiv(SoundBuffer[0], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
-			MPT_CONSTANT_IF(isStereo) SoundBuffer[1] = Util::muldiv(SoundBuffer[1], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
-			MPT_CONSTANT_IF(hasRear)  RearBuffer[0]  = Util::muldiv(RearBuffer[0] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION); else MPT_UNUSED_VARIABLE(RearBuffer);
-			MPT_CONSTANT_IF(hasRear)  RearBuffer[1]  = Util::muldiv(RearBuffer[1] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION); else MPT_UNUSED_VARIABLE(RearBuffer);
+			                          SoundBuffer[0] = ApplyGlobalVolume(SoundBuffer[0], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
+			MPT_CONSTANT_IF(isStereo) SoundBuffer[1] = ApplyGlobalVolume(SoundBuffer[1], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
+			MPT_CONSTANT_IF(hasRear)  RearBuffer[0]  = ApplyGlobalVolume(RearBuffer[0] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION); else MPT_UNUSED_VARIABLE(RearBuffer);
+			MPT_CONSTANT_IF(hasRear)  RearBuffer[1]  = ApplyGlobalVolume(RearBuffer[1] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION); else MPT_UNUSED_VARIABLE(RearBuffer);
 			m_nSamplesToGlobalVolRampDest--;
 		} else
 		{
-			                          SoundBuffer[0] = Util::muldiv(SoundBuffer[0], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
-			MPT_CONSTANT_IF(isStereo) SoundBuffer[1] = Util::muldiv(SoundBuffer[1], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
-			MPT_CONSTANT_IF(hasRear)  RearBuffer[0]  = Util::muldiv(RearBuffer[0] , m_nGlobalVolume, MAX_GLOBAL_VOLUME); else MPT_UNUSED_VARIABLE(RearBuffer);
-			MPT_CONSTANT_IF(hasRear)  RearBuffer[1]  = Util::muldiv(RearBuffer[1] , m_nGlobalVolume, MAX_GLOBAL_VOLUME); else MPT_UNUSED_VARIABLE(RearBuffer);
+			                          SoundBuffer[0] = ApplyGlobalVolume(SoundBuffer[0], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
+			MPT_CONSTANT_IF(isStereo) SoundBuffer[1] = ApplyGlobalVolume(SoundBuffer[1], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
+			MPT_CONSTANT_IF(hasRear)  RearBuffer[0]  = ApplyGlobalVolume(RearBuffer[0] , m_nGlobalVolume, MAX_GLOBAL_VOLUME); else MPT_UNUSED_VARIABLE(RearBuffer);
+			MPT_CONSTANT_IF(hasRear)  RearBuffer[1]  = ApplyGlobalVolume(RearBuffer[1] , m_nGlobalVolume, MAX_GLOBAL_VOLUME); else MPT_UNUSED_VARIABLE(RearBuffer);
 			m_lHighResRampingGlobalVolume = m_nGlobalVolume << VOLUMERAMPPRECISION;
 		}
 		SoundBuffer += isStereo ? 2 : 1;
@@ -2590,7 +2788,8 @@ MPT_FORCEINLINE void ApplyGlobalVolumeWithRamping(int *SoundBuffer, int *RearBuf
 }
 
 
-void CSoundFile::ProcessGlobalVolume(long lCount)
+// Start a new global volume ramp if necessary and return the per-sample ramping step
+int32 CSoundFile::UpdateGlobalVolumeRamp()
 {
 
 	// should we ramp?
@@ -2638,24 +2837,51 @@ void CSoundFile::ProcessGlobalVolume(long lCount)
 		}
 	}
 
+	return step;
+}
+
+
+// Advance the global volume ramp for a chunk that is known to be silent
+void CSoundFile::SkipGlobalVolumeRamp(long lCount)
+{
+	const int32 step = UpdateGlobalVolumeRamp();
+	const int32 rampSamples = std::min<int32>(m_PlayState.m_nSamplesToGlobalVolRampDest, lCount);
+	if(rampSamples > 0)
+	{
+		m_PlayState.m_lHighResRampingGlobalVolume += step * rampSamples;
+		m_PlayState.m_nSamplesToGlobalVolRampDest -= rampSamples;
+	}
+	if(rampSamples < lCount)
+	{
+		m_PlayState.m_lHighResRampingGlobalVolume = m_PlayState.m_nGlobalVolume << VOLUMERAMPPRECISION;
+	}
+}
+
+
+template<typename Tsample>
+void CSoundFile::ProcessGlobalVolume(Tsample *soundBuffer, Tsample *rearBuffer, long lCount)
+{
+	const int32 step = UpdateGlobalVolumeRamp();
+
 	// apply volume and ramping
 	if(m_MixerSettings.gnChannels == 1)
 	{
-		ApplyGlobalVolumeWithRamping<1>(MixSoundBuffer, MixRearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
+		ApplyGlobalVolumeWithRamping<1>(soundBuffer, rearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
 	} else if(m_MixerSettings.gnChannels == 2)
 	{
-		ApplyGlobalVolumeWithRamping<2>(MixSoundBuffer, MixRearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
+		ApplyGlobalVolumeWithRamping<2>(soundBuffer, rearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
 	} else if(m_MixerSettings.gnChannels == 4)
 	{
-		ApplyGlobalVolumeWithRamping<4>(MixSoundBuffer, MixRearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
+		ApplyGlobalVolumeWithRamping<4>(soundBuffer, rearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
 	}
 
 }
 
 
-void CSoundFile::ProcessStereoSeparation(long countChunk)
+template<typename Tsample>
+void CSoundFile::ProcessStereoSeparation(Tsample *soundBuffer, Tsample *rearBuffer, long countChunk)
 {
-	ApplyStereoSeparation(MixSoundBuffer, MixRearBuffer, m_MixerSettings.gnChannels, countChunk, m_MixerSettings.m_nStereoSeparation);
+	ApplyStereoSeparation(soundBuffer, rearBuffer, m_MixerSettings.gnChannels, countChunk, m_MixerSettings.m_nStereoSeparation);
 }
 
 
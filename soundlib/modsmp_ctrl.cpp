@@ -12,6 +12,7 @@
 #include "modsmp_ctrl.h"
 #include "AudioCriticalSection.h"
 #include "Sndfile.h"
+#include "SamplePool.h"
 #include "../soundbase/SampleFormatConverters.h"
 #include "../soundbase/SampleFormatCopy.h"
 
@@ -23,6 +24,7 @@ namespace ctrlSmp
 void ReplaceSample(ModSample &smp, void *pNewSample, const SmpLength newLength, CSoundFile &sndFile)
 {
 	void * const pOldSmp = smp.samplev();
+	mpt::byte * const pOldLookahead = smp.pLookahead;
 	FlagSet<ChannelFlags> setFlags, resetFlags;
 
 	setFlags.set(CHN_16BIT, smp.uFlags[CHN_16BIT]);
@@ -35,8 +37,47 @@ void ReplaceSample(ModSample &smp, void *pNewSample, const SmpLength newLength,
 
 	ctrlChn::ReplaceSample(sndFile, smp, pNewSample, newLength, setFlags, resetFlags);
 	smp.pData.pSample = pNewSample;
+	smp.pLookahead = nullptr;
 	smp.nLength = newLength;
-	ModSample::FreeSample(pOldSmp);
+	if(pOldLookahead != nullptr)
+	{
+		// Pinned sample data is owned by someone else
+		delete[] pOldLookahead;
+	} else
+	{
+		ModSample::FreeSample(pOldSmp);
+	}
+}
+
+
+bool UnshareSample(ModSample &smp, CSoundFile &sndFile)
+{
+	if(smp.IsPinned())
+	{
+		// Pinned sample data must not be modified either
+		const uint8 bps = smp.GetBytesPerSample();
+		char *pNewSmp = static_cast<char *>(ModSample::AllocateSample(smp.nLength, bps));
+		if(pNewSmp == nullptr)
+			return false;
+		// Also copy the lookahead, so that the precomputed loops stay valid.
+		memcpy(pNewSmp - InterpolationMaxLookahead * bps, smp.GetPinnedLookahead(ModSample::lookaheadSampleStart), InterpolationMaxLookahead * bps);
+		memcpy(pNewSmp, smp.samplev(), smp.GetSampleSizeInBytes());
+		memcpy(pNewSmp + smp.GetSampleSizeInBytes(), smp.GetPinnedLookahead(ModSample::lookaheadSampleEnd) + 2 * InterpolationMaxLookahead * bps, InterpolationMaxLookahead * bps);
+		memcpy(pNewSmp + smp.GetSampleSizeInBytes() + InterpolationMaxLookahead * bps, smp.GetPinnedLookahead(ModSample::lookaheadLoop), 8 * InterpolationMaxLookahead * bps);
+		ReplaceSample(smp, pNewSmp, smp.nLength, sndFile);
+		return true;
+	}
+	if(!SamplePool::IsShared(smp.samplev()))
+		return true;
+
+	const size_t lookaheadSize = InterpolationMaxLookahead * MaxSamplingPointSize;
+	void *pNewSmp = ModSample::AllocateSample(smp.nLength, smp.GetBytesPerSample());
+	if(pNewSmp == nullptr)
+		return false;
+	// Also copy the lookahead area, so that the precomputed loops stay valid.
+	memcpy(static_cast<char *>(pNewSmp) - lookaheadSize, smp.sampleb() - lookaheadSize, ModSample::GetRealSampleBufferSize(smp.nLength, smp.GetBytesPerSample()));
+	ReplaceSample(smp, pNewSmp, smp.nLength, sndFile);
+	return true;
 }
 
 
@@ -114,6 +155,10 @@ SmpLength RemoveRange(ModSample &smp, SmpLength selStart, SmpLength selEnd, CSou
 	{
 		return smp.nLength;
 	}
+	if(!UnshareSample(smp, sndFile))
+	{
+		return smp.nLength;
+	}
 	const uint8 bps = smp.GetBytesPerSample();
 	memmove(smp.sampleb() + selStart * bps, smp.sampleb() + selEnd * bps, (smp.nLength - selEnd) * bps);
 	smp.nLength -= (selEnd - selStart);
@@ -259,10 +304,24 @@ void PrecomputeLoopsImpl(ModSample &smp, const CSoundFile &sndFile)
 	const int numChannels = smp.GetNumChannels();
 	const int copySamples = numChannels * InterpolationMaxLookahead;
 	
-	T *sampleData = reinterpret_cast<T *>(smp.samplev());
-	T *afterSampleStart = sampleData + smp.nLength * numChannels;
-	T *loopLookAheadStart = afterSampleStart + copySamples;
-	T *sustainLookAheadStart = loopLookAheadStart + 4 * copySamples;
+	const T *sampleData = static_cast<const T *>(smp.samplev());
+	T *sampleStart, *afterSampleStart, *loopLookAheadStart, *sustainLookAheadStart;
+	if(smp.IsPinned())
+	{
+		// Pinned sample data must not be written to, so the sampling points around the sample start and end are copied to a separate buffer.
+		sampleStart = reinterpret_cast<T *>(smp.GetPinnedLookahead(ModSample::lookaheadSampleStart)) + copySamples;
+		afterSampleStart = reinterpret_cast<T *>(smp.GetPinnedLookahead(ModSample::lookaheadSampleEnd)) + 2 * copySamples;
+		std::copy(sampleData, sampleData + 2 * copySamples, sampleStart);
+		std::copy(sampleData + smp.nLength * numChannels - 2 * copySamples, sampleData + smp.nLength * numChannels, afterSampleStart - 2 * copySamples);
+		loopLookAheadStart = reinterpret_cast<T *>(smp.GetPinnedLookahead(ModSample::lookaheadLoop));
+		sustainLookAheadStart = reinterpret_cast<T *>(smp.GetPinnedLookahead(ModSample::lookaheadSustainLoop));
+	} else
+	{
+		sampleStart = static_cast<T *>(smp.samplev());
+		afterSampleStart = sampleStart + smp.nLength * numChannels;
+		loopLookAheadStart = afterSampleStart + copySamples;
+		sustainLookAheadStart = loopLookAheadStart + 4 * copySamples;
+	}
 
 	// Hold sample on the same level as the last sampling point at the end to prevent extra pops with interpolation.
 	// Do the same at the sample start, too.
@@ -271,7 +330,7 @@ void PrecomputeLoopsImpl(ModSample &smp, const CSoundFile &sndFile)
 		for(int c = 0; c < numChannels; c++)
 		{
 			afterSampleStart[i * numChannels + c] = afterSampleStart[-numChannels + c];
-			sampleData[-(i + 1) * numChannels + c] = sampleData[c];
+			sampleStart[-(i + 1) * numChannels + c] = sampleStart[c];
 		}
 	}
 
@@ -300,7 +359,8 @@ void PrecomputeLoopsImpl(ModSample &smp, const CSoundFile &sndFile)
 
 bool PrecomputeLoops(ModSample &smp, CSoundFile &sndFile, bool updateChannels)
 {
-	if(!smp.HasSampleData())
+	// The precomputed loops of pinned sample data are stored in a separate buffer
+	if(!smp.HasSampleData() || (!smp.IsPinned() && !UnshareSample(smp, sndFile)))
 		return false;
 
 	smp.SanitizeLoops();
@@ -479,7 +539,7 @@ namespace
 // Remove DC offset
 double RemoveDCOffset(ModSample &smp, SmpLength start, SmpLength end, CSoundFile &sndFile)
 {
-	if(!smp.HasSampleData())
+	if(!smp.HasSampleData() || !UnshareSample(smp, sndFile))
 		return 0;
 
 	if(end > smp.nLength) end = smp.nLength;
@@ -556,7 +616,7 @@ static void ReverseSampleImpl(T *pStart, const SmpLength nLength)
 // Reverse sample data
 bool ReverseSample(ModSample &smp, SmpLength start, SmpLength end, CSoundFile &sndFile)
 {
-	if(!smp.HasSampleData()) return false;
+	if(!smp.HasSampleData() || !UnshareSample(smp, sndFile)) return false;
 	if(end == 0 || start > smp.nLength || end > smp.nLength)
 	{
 		start = 0;
@@ -593,7 +653,7 @@ static void UnsignSampleImpl(T *pStart, const SmpLength length)
 // Virtually unsign sample data
 bool UnsignSample(ModSample &smp, SmpLength start, SmpLength end, CSoundFile &sndFile)
 {
-	if(!smp.HasSampleData()) return false;
+	if(!smp.HasSampleData() || !UnshareSample(smp, sndFile)) return false;
 	if(end == 0 || start > smp.nLength || end > smp.nLength)
 	{
 		start = 0;
@@ -625,7 +685,7 @@ static void InvertSampleImpl(T *pStart, const SmpLength length)
 // Invert sample data (flip by 180 degrees)
 bool InvertSample(ModSample &smp, SmpLength start, SmpLength end, CSoundFile &sndFile)
 {
-	if(!smp.HasSampleData()) return false;
+	if(!smp.HasSampleData() || !UnshareSample(smp, sndFile)) return false;
 	if(end == 0 || start > smp.nLength || end > smp.nLength)
 	{
 		start = 0;
@@ -663,7 +723,7 @@ static void XFadeSampleImpl(const T *srcIn, const T *srcOut, T *output, const Sm
 // X-Fade sample data to create smooth loop transitions
 bool XFadeSample(ModSample &smp, SmpLength fadeLength, int fadeLaw, bool afterloopFade, bool useSustainLoop, CSoundFile &sndFile)
 {
-	if(!smp.HasSampleData()) return false;
+	if(!smp.HasSampleData() || !UnshareSample(smp, sndFile)) return false;
 	const SmpLength loopStart = useSustainLoop ? smp.nSustainStart : smp.nLoopStart;
 	const SmpLength loopEnd = useSustainLoop ? smp.nSustainEnd : smp.nLoopEnd;
 	
@@ -715,7 +775,7 @@ static void SilenceSampleImpl(T *p, SmpLength length, SmpLength inc, bool fromSt
 bool SilenceSample(ModSample &smp, SmpLength start, SmpLength end, CSoundFile &sndFile)
 {
 	LimitMax(end, smp.nLength);
-	if(!smp.HasSampleData() || start >= end) return false;
+	if(!smp.HasSampleData() || start >= end || !UnshareSample(smp, sndFile)) return false;
 
 	const SmpLength length = end - start;
 	const bool fromStart = start == 0;
@@ -754,7 +814,7 @@ static void StereoSepSampleImpl(T *p, SmpLength length, int32 separation)
 bool StereoSepSample(ModSample &smp, SmpLength start, SmpLength end, double separation, CSoundFile &sndFile)
 {
 	LimitMax(end, smp.nLength);
-	if(!smp.HasSampleData() || start >= end || smp.GetNumChannels() != 2) return false;
+	if(!smp.HasSampleData() || start >= end || smp.GetNumChannels() != 2 || !UnshareSample(smp, sndFile)) return false;
 
 	const SmpLength length = end - start;
 	const uint8 numChn = smp.GetNumChannels();
@@ -797,7 +857,7 @@ static void ConvertStereoToMonoOneChannelImpl(T *pDest, const SmpLength length)
 // Convert a multichannel sample to mono (currently only implemented for stereo)
 bool ConvertToMono(ModSample &smp, CSoundFile &sndFile, StereoToMonoMode conversionMode)
 {
-	if(!smp.HasSampleData() || smp.GetNumChannels() != 2) return false;
+	if(!smp.HasSampleData() || smp.GetNumChannels() != 2 || !UnshareSample(smp, sndFile)) return false;
 
 	// Note: Sample is overwritten in-place! Unused data is not deallocated!
 	if(conversionMode == mixChannels)
@@ -880,7 +940,7 @@ bool ConvertToStereo(ModSample &smp, CSoundFile &sndFile)
 // Convert 16-bit sample to 8-bit
 bool ConvertTo8Bit(ModSample &smp, CSoundFile &sndFile)
 {
-	if(!smp.HasSampleData() || smp.GetElementarySampleSize() != 2)
+	if(!smp.HasSampleData() || smp.GetElementarySampleSize() != 2 || !UnshareSample(smp, sndFile))
 		return false;
 
 	CopySample<SC::ConversionChain<SC::Convert<int8, int16>, SC::DecodeIdentity<int16> > >(reinterpret_cast<int8*>(smp.samplev()), smp.nLength * smp.GetNumChannels(), 1, smp.sample16(), smp.GetSampleSizeInBytes(), 1);
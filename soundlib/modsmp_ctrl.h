@@ -48,6 +48,10 @@ SmpLength ResizeSample(ModSample &smp, const SmpLength newLength, CSoundFile &sn
 // Replaces sample in 'smp' with given sample and frees the old sample.
 void ReplaceSample(ModSample &smp, void *pNewSample,  const SmpLength newLength, CSoundFile &sndFile);
 
+// Give the sample its own copy of its data if the data is shared with other modules (see SamplePool).
+// Must be called before modifying sample data in place. Return: false if out of memory.
+bool UnshareSample(ModSample &smp, CSoundFile &sndFile);
+
 // Update loop wrap-around buffers
 bool PrecomputeLoops(ModSample &smp, CSoundFile &sndFile, bool updateChannels = true);
 
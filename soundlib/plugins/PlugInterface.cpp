@@ -82,6 +82,7 @@ IMixPlugin::~IMixPlugin()
 	{
 		m_pMixStruct->pMixPlugin = nullptr;
 		m_pMixStruct = nullptr;
+		m_SndFile.InvalidateActivePlugins();
 	}
 
 	if (m_pNext) m_pNext->m_pPrev = m_pPrev;
@@ -94,6 +95,7 @@ IMixPlugin::~IMixPlugin()
 void IMixPlugin::InsertIntoFactoryList()
 {
 	m_pMixStruct->pMixPlugin = this;
+	m_SndFile.InvalidateActivePlugins();
 
 	m_pNext = m_Factory.pPluginsList;
 	if(m_Factory.pPluginsList)
@@ -110,6 +112,7 @@ void IMixPlugin::SetSlot(PLUGINDEX slot)
 {
 	m_nSlot = slot;
 	m_pMixStruct = &m_SndFile.m_MixPlugins[slot];
+	m_SndFile.InvalidateActivePlugins();
 }
 
 
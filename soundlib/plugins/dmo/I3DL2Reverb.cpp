@@ -49,22 +49,23 @@ void I3DL2Reverb::DelayLine::Advance()
 
 MPT_FORCEINLINE void I3DL2Reverb::DelayLine::Set(float value)
 {
-	at(m_position) = value;
+	(*this)[m_position] = value;
 }
 
 
-float I3DL2Reverb::DelayLine::Get(int32 offset) const
+MPT_FORCEINLINE float I3DL2Reverb::DelayLine::Get(int32 offset) const
 {
-	offset = (offset + m_position) % m_length;
-	if(offset < 0)
-		offset += m_length;
-	return at(offset);
+	MPT_ASSERT(offset >= 0 && offset < m_length);
+	offset += m_position;
+	if(offset >= m_length)
+		offset -= m_length;
+	return (*this)[offset];
 }
 
 
 MPT_FORCEINLINE float I3DL2Reverb::DelayLine::Get() const
 {
-	return at(m_delayPosition);
+	return (*this)[m_delayPosition];
 }
 
 
@@ -125,9 +126,26 @@ void I3DL2Reverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		in[1]++;
 		m_remain = false;
 	}
-	
+
+	// The low-pass filters of the two additional delay lines per channel are updated along with all other delay lines below,
+	// so their state has to be preserved if they are not used.
+	const bool moreDelayLines = (m_quality & kMoreDelayLines) != 0;
+	const float unusedHist[4] = { m_filterHist[2], m_filterHist[3], m_filterHist[8], m_filterHist[9] };
+
 	while(frames > 0)
 	{
+		// Low-pass filter the output of all late reverb delay lines at once.
+		// None of the delay lines is written to before it is read in the same frame, so this does not depend on the all-pass chains below.
+		float delayed[12];
+		for(int32 d = 0; d < 12; d++)
+		{
+			delayed[d] = m_delayLines[d].Get();
+		}
+		for(int32 d = 0; d < 12; d++)
+		{
+			m_filterHist[d] = (m_filterHist[d] - delayed[d]) * m_delayCoeffs[1][d] + delayed[d];
+		}
+
 		// Apply room filter and insert into early reflection delay lines
 		const float inL = *(in[0]++);
 		const float inRoomL = (m_filterHist[12] - inL) * m_roomFilter + inL;
@@ -162,44 +180,38 @@ void I3DL2Reverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		reverbL2 = m_filterHist[16] * 0.707f + reverbL1;
 		reverbR2 = reverbL1 - m_filterHist[16] * 0.707f;
 
-		m_filterHist[5] = (m_filterHist[5] - m_delayLines[5].Get()) * m_delayCoeffs[5][1] + m_delayLines[5].Get();
-		reverbL1 = m_filterHist[5] * m_delayCoeffs[5][0] + reverbL2 * m_diffusion;
+		reverbL1 = m_filterHist[5] * m_delayCoeffs[0][5] + reverbL2 * m_diffusion;
 		m_delayLines[5].Set(reverbL2 - reverbL1 * m_diffusion);
 		reverbL2 = reverbL1;
 		reverbL3 = -0.15f * reverbL1;
 
-		m_filterHist[4] = (m_filterHist[4] - m_delayLines[4].Get()) * m_delayCoeffs[4][1] + m_delayLines[4].Get();
-		reverbL1 = m_filterHist[4] * m_delayCoeffs[4][0] + reverbL2 * m_diffusion;
+		reverbL1 = m_filterHist[4] * m_delayCoeffs[0][4] + reverbL2 * m_diffusion;
 		m_delayLines[4].Set(reverbL2 - reverbL1 * m_diffusion);
 		reverbL2 = reverbL1;
 		reverbL3 -= reverbL1 * 0.2f;
 
 		if(m_quality & kMoreDelayLines)
 		{
-			m_filterHist[3] = (m_filterHist[3] - m_delayLines[3].Get()) * m_delayCoeffs[3][1] + m_delayLines[3].Get();
-			reverbL1 = m_filterHist[3] * m_delayCoeffs[3][0] + reverbL2 * m_diffusion;
+			reverbL1 = m_filterHist[3] * m_delayCoeffs[0][3] + reverbL2 * m_diffusion;
 			m_delayLines[3].Set(reverbL2 - reverbL1 * m_diffusion);
 			reverbL2 = reverbL1;
 			reverbL3 += 0.35f * reverbL1;
 
-			m_filterHist[2] = (m_filterHist[2] - m_delayLines[2].Get()) * m_delayCoeffs[2][1] + m_delayLines[2].Get();
-			reverbL1 = m_filterHist[2] * m_delayCoeffs[2][0] + reverbL2 * m_diffusion;
+			reverbL1 = m_filterHist[2] * m_delayCoeffs[0][2] + reverbL2 * m_diffusion;
 			m_delayLines[2].Set(reverbL2 - reverbL1 * m_diffusion);
 			reverbL2 = reverbL1;
 			reverbL3 -= reverbL1 * 0.38f;
 		}
 		m_delayLines[17].Set(reverbL2);
 
-		reverbL1 = m_delayLines[17].Get() * m_delayCoeffs[12][0];
-		m_filterHist[17] = (m_filterHist[17] - reverbL1) * m_delayCoeffs[12][1] + reverbL1;
+		reverbL1 = m_delayLines[17].Get() * m_delayCoeffs[0][12];
+		m_filterHist[17] = (m_filterHist[17] - reverbL1) * m_delayCoeffs[1][12] + reverbL1;
 
-		m_filterHist[1] = (m_filterHist[1] - m_delayLines[1].Get()) * m_delayCoeffs[1][1] + m_delayLines[1].Get();
-		reverbL1 = m_filterHist[17] * m_diffusion + m_filterHist[1] * m_delayCoeffs[1][0];
+		reverbL1 = m_filterHist[17] * m_diffusion + m_filterHist[1] * m_delayCoeffs[0][1];
 		m_delayLines[1].Set(m_filterHist[17] - reverbL1 * m_diffusion);
 		reverbL2 = reverbL1;
 		float reverbL4 = reverbL1 * 0.38f;
 
-		m_filterHist[0] = (m_filterHist[0] - m_delayLines[0].Get()) * m_delayCoeffs[0][1] + m_delayLines[0].Get();
 		reverbL1 = m_filterHist[0] * m_delayCoeffs[0][0] + reverbL2 * m_diffusion;
 		m_delayLines[0].Set(reverbL2 - reverbL1 * m_diffusion);
 		reverbL3 -= reverbL1 * 0.38f;
@@ -219,45 +231,39 @@ void I3DL2Reverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		}
 		const float earlyRefOutR = earlyR * m_ERLevel;
 
-		m_filterHist[11] = (m_filterHist[11] - m_delayLines[11].Get()) * m_delayCoeffs[11][1] + m_delayLines[11].Get();
-		reverbR1 = m_filterHist[11] * m_delayCoeffs[11][0] + reverbR2 * m_diffusion;
+		reverbR1 = m_filterHist[11] * m_delayCoeffs[0][11] + reverbR2 * m_diffusion;
 		m_delayLines[11].Set(reverbR2 - reverbR1 * m_diffusion);
 		reverbR2 = reverbR1;
 
-		m_filterHist[10] = (m_filterHist[10] - m_delayLines[10].Get()) * m_delayCoeffs[10][1] + m_delayLines[10].Get();
-		reverbR1 = m_filterHist[10] * m_delayCoeffs[10][0] + reverbR2 * m_diffusion;
+		reverbR1 = m_filterHist[10] * m_delayCoeffs[0][10] + reverbR2 * m_diffusion;
 		m_delayLines[10].Set(reverbR2 - reverbR1 * m_diffusion);
 		reverbR3 = reverbL4 - reverbR2 * 0.15f - reverbR1 * 0.2f;
 		reverbR2 = reverbR1;
 
 		if(m_quality & kMoreDelayLines)
 		{
-			m_filterHist[9] = (m_filterHist[9] - m_delayLines[9].Get()) * m_delayCoeffs[9][1] + m_delayLines[9].Get();
-			reverbR1 = m_filterHist[9] * m_delayCoeffs[9][0] + reverbR2 * m_diffusion;
+			reverbR1 = m_filterHist[9] * m_delayCoeffs[0][9] + reverbR2 * m_diffusion;
 			m_delayLines[9].Set(reverbR2 - reverbR1 * m_diffusion);
 			reverbR2 = reverbR1;
 			reverbR3 += reverbR1 * 0.35f;
 
-			m_filterHist[8] = (m_filterHist[8] - m_delayLines[8].Get()) * m_delayCoeffs[8][1] + m_delayLines[8].Get();
-			reverbR1 = m_filterHist[8] * m_delayCoeffs[8][0] + reverbR2 * m_diffusion;
+			reverbR1 = m_filterHist[8] * m_delayCoeffs[0][8] + reverbR2 * m_diffusion;
 			m_delayLines[8].Set(reverbR2 - reverbR1 * m_diffusion);
 			reverbR2 = reverbR1;
 			reverbR3 -= reverbR1 * 0.38f;
 		}
 		m_delayLines[18].Set(reverbR2);
 
-		reverbR1 = m_delayLines[18].Get() * m_delayCoeffs[12][0];
-		m_filterHist[18] = (m_filterHist[18] - reverbR1) * m_delayCoeffs[12][1] + reverbR1;
+		reverbR1 = m_delayLines[18].Get() * m_delayCoeffs[0][12];
+		m_filterHist[18] = (m_filterHist[18] - reverbR1) * m_delayCoeffs[1][12] + reverbR1;
 			
-		m_filterHist[7] = (m_filterHist[7] - m_delayLines[7].Get()) * m_delayCoeffs[7][1] + m_delayLines[7].Get();
-		reverbR1 = m_filterHist[18] * m_diffusion + m_filterHist[7] * m_delayCoeffs[7][0];
+		reverbR1 = m_filterHist[18] * m_diffusion + m_filterHist[7] * m_delayCoeffs[0][7];
 		m_delayLines[7].Set(m_filterHist[18] - reverbR1 * m_diffusion);
 		reverbR2 = reverbR1;
 
 		float lateRevOutL = (reverbL3 + reverbR1 * 0.38f) * m_ReverbLevelL;
 
-		m_filterHist[6] = (m_filterHist[6] - m_delayLines[6].Get()) * m_delayCoeffs[6][1] + m_delayLines[6].Get();
-		reverbR1 = m_filterHist[6] * m_delayCoeffs[6][0] + reverbR2 * m_diffusion;
+		reverbR1 = m_filterHist[6] * m_delayCoeffs[0][6] + reverbR2 * m_diffusion;
 		m_delayLines[6].Set(reverbR2 - reverbR1 * m_diffusion);
 		m_filterHist[16] = reverbR1;
 
@@ -288,6 +294,14 @@ void I3DL2Reverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		frames--;
 	}
 
+	if(!moreDelayLines)
+	{
+		m_filterHist[2] = unusedHist[0];
+		m_filterHist[3] = unusedHist[1];
+		m_filterHist[8] = unusedHist[2];
+		m_filterHist[9] = unusedHist[3];
+	}
+
 	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
 }
 
@@ -530,10 +544,17 @@ void I3DL2Reverb::SetDecayCoeffs()
 		levelRtmp *= CalcDecayCoeffs(8);
 		levelL += levelLtmp * 0.1444f;
 		levelR += levelRtmp * 0.1444f;
+	} else
+	{
+		// Unused, but processed along with the other delay lines
+		CalcDecayCoeffs(3);
+		CalcDecayCoeffs(9);
+		CalcDecayCoeffs(2);
+		CalcDecayCoeffs(8);
 	}
 	CalcDecayCoeffs(12);
-	levelLtmp *= m_delayCoeffs[12][0] * m_delayCoeffs[12][0];
-	levelRtmp *= m_delayCoeffs[12][0] * m_delayCoeffs[12][0];
+	levelLtmp *= m_delayCoeffs[0][12] * m_delayCoeffs[0][12];
+	levelRtmp *= m_delayCoeffs[0][12] * m_delayCoeffs[0][12];
 
 	levelLtmp *= CalcDecayCoeffs(1);
 	levelRtmp *= CalcDecayCoeffs(7);
@@ -572,8 +593,8 @@ float I3DL2Reverb::CalcDecayCoeffs(int32 index)
 		if(mpt::abs(c2) > 1.0f)
 			c2 = (-c22 - c23) / (c21 + c21);
 	}
-	m_delayCoeffs[index][0] = c1;
-	m_delayCoeffs[index][1] = c2;
+	m_delayCoeffs[0][index] = c1;
+	m_delayCoeffs[1][index] = c2;
 
 	c1 *= c1;
 	float diff2 = m_diffusion * m_diffusion;
@@ -57,7 +57,9 @@ protected:
 		void SetDelayTap(int32 delayTap);
 		void Advance();
 		void Set(float value);
+		// Get the sample that was written offset samples ago (0 <= offset < length)
 		float Get(int32 offset) const;
+		// Get the sample at the delay tap
 		float Get() const;
 	};
 
@@ -74,11 +76,13 @@ protected:
 
 	int32 m_delayTaps[15];	// 6*L + 6*R + LR + Early L + Early R
 	int32 m_earlyTaps[2][6];
-	float m_delayCoeffs[13][2];
+	// Gain and low-pass coefficients of the late reverb delay lines (0-11) and the reverb delay (12).
+	// Each coefficient type is stored contiguously, so that the low-pass filters of all late reverb delay lines can be processed with SIMD instructions.
+	float m_delayCoeffs[2][13];
 
 	// State
 	DelayLine m_delayLines[19];
-	float m_filterHist[19];
+	float m_filterHist[19];	// 0-11: Low-pass filter state of the late reverb delay lines
 
 	// Remaining frame for downsampled reverb
 	float m_prevL;
@@ -50,62 +50,58 @@ void WavesReverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
 
 	uint32 combPos = m_state.combPos, allpassPos = m_state.allpassPos;
-	uint32 delay0 = (m_delay[0] + combPos + 1) & 0xFFF;
-	uint32 delay1 = (m_delay[1] + combPos + 1) & 0xFFF;
-	uint32 delay2 = (m_delay[2] + combPos + 1) & 0xFFF;
-	uint32 delay3 = (m_delay[3] + combPos + 1) & 0xFFF;
+	uint32 combDelay[4];
+	float combOld[4];
+	for(uint32 c = 0; c < 4; c++)
+	{
+		combDelay[c] = (m_delay[c] + combPos + 1) & 0xFFF;
+		combOld[c] = m_state.comb[combDelay[c]][c];
+	}
 	uint32 delay4 = (m_delay[4] + allpassPos) & 0x3FF;
 	uint32 delay5 = (m_delay[5] + allpassPos) & 0x3FF;
-	float delay0old = m_state.comb[delay0][0];
-	float delay1old = m_state.comb[delay1][1];
-	float delay2old = m_state.comb[delay2][2];
-	float delay3old = m_state.comb[delay3][3];
 
 	for(uint32 i = numFrames; i != 0; i--)
 	{
 		const float leftIn  = *(in[0])++ + 1e-30f;	// Prevent denormals
 		const float rightIn = *(in[1])++ + 1e-30f;	// Prevent denormals
 
-		// Advance buffer index for the four comb filters
-		delay0 = (delay0 - 1) & 0xFFF;
-		delay1 = (delay1 - 1) & 0xFFF;
-		delay2 = (delay2 - 1) & 0xFFF;
-		delay3 = (delay3 - 1) & 0xFFF;
-		float &delay0new = m_state.comb[delay0][0];
-		float &delay1new = m_state.comb[delay1][1];
-		float &delay2new = m_state.comb[delay2][2];
-		float &delay3new = m_state.comb[delay3][3];
+		// Advance buffer index for the four comb filters and read their outputs
+		float combNew[4];
+		for(uint32 c = 0; c < 4; c++)
+		{
+			combDelay[c] = (combDelay[c] - 1) & 0xFFF;
+			combNew[c] = m_state.comb[combDelay[c]][c];
+		}
 
 		float r1, r2;
-		
-		r1 = delay1new * 0.61803401f + m_state.allpass1[delay4][0] * m_coeffs[0];
-		r2 = m_state.allpass1[delay4][1] * m_coeffs[0] - delay0new * 0.61803401f;
-		m_state.allpass1[allpassPos][0] = r2 * 0.61803401f + delay0new;
-		m_state.allpass1[allpassPos][1] = delay1new - r1 * 0.61803401f;
-		delay0new = r1;
-		delay1new = r2;
-
-		r1 = delay3new * 0.61803401f + m_state.allpass2[delay5][0] * m_coeffs[1];
-		r2 = m_state.allpass2[delay5][1] * m_coeffs[1] - delay2new * 0.61803401f;
-		m_state.allpass2[allpassPos][0] = r2 * 0.61803401f + delay2new;
-		m_state.allpass2[allpassPos][1] = delay3new - r1 * 0.61803401f;
-		delay2new = r1;
-		delay3new = r2;
-
-		*(out[0])++ = (leftIn  * m_dryFactor) + delay0new + delay2new;
-		*(out[1])++ = (rightIn * m_dryFactor) + delay1new + delay3new;
 
+		r1 = combNew[1] * 0.61803401f + m_state.allpass1[delay4][0] * m_allpassCoeffs[0];
+		r2 = m_state.allpass1[delay4][1] * m_allpassCoeffs[0] - combNew[0] * 0.61803401f;
+		m_state.allpass1[allpassPos][0] = r2 * 0.61803401f + combNew[0];
+		m_state.allpass1[allpassPos][1] = combNew[1] - r1 * 0.61803401f;
+		combNew[0] = r1;
+		combNew[1] = r2;
+
+		r1 = combNew[3] * 0.61803401f + m_state.allpass2[delay5][0] * m_allpassCoeffs[1];
+		r2 = m_state.allpass2[delay5][1] * m_allpassCoeffs[1] - combNew[2] * 0.61803401f;
+		m_state.allpass2[allpassPos][0] = r2 * 0.61803401f + combNew[2];
+		m_state.allpass2[allpassPos][1] = combNew[3] - r1 * 0.61803401f;
+		combNew[2] = r1;
+		combNew[3] = r2;
+
+		*(out[0])++ = (leftIn  * m_dryFactor) + combNew[0] + combNew[2];
+		*(out[1])++ = (rightIn * m_dryFactor) + combNew[1] + combNew[3];
+
+		// Store the all-pass outputs in the comb filters and feed them
 		const float leftWet  = leftIn  * m_wetFactor;
 		const float rightWet = rightIn * m_wetFactor;
-		m_state.comb[combPos][0] = (delay0new * m_coeffs[2]) + (delay0old * m_coeffs[3]) + leftWet;
-		m_state.comb[combPos][1] = (delay1new * m_coeffs[4]) + (delay1old * m_coeffs[5]) + rightWet;
-		m_state.comb[combPos][2] = (delay2new * m_coeffs[6]) + (delay2old * m_coeffs[7]) - rightWet;
-		m_state.comb[combPos][3] = (delay3new * m_coeffs[8]) + (delay3old * m_coeffs[9]) + leftWet;
-
-		delay0old = delay0new;
-		delay1old = delay1new;
-		delay2old = delay2new;
-		delay3old = delay3new;
+		const float combIn[4] = { leftWet, rightWet, -rightWet, leftWet };
+		for(uint32 c = 0; c < 4; c++)
+		{
+			m_state.comb[combDelay[c]][c] = combNew[c];
+			m_state.comb[combPos][c] = (combNew[c] * m_combCoeffs[0][c]) + (combOld[c] * m_combCoeffs[1][c]) + combIn[c];
+			combOld[c] = combNew[c];
+		}
 
 		// Advance buffer index
 		combPos = (combPos - 1) & 0xFFF;
@@ -230,18 +226,18 @@ void WavesReverb::RecalculateWavesReverbParams()
 	const double ReverbTimeSmp = -3000.0 / (m_SndFile.GetSampleRate() * ReverbTime());
 	const double ReverbTimeSmpHF = ReverbTimeSmp * (1.0 / HighFreqRTRatio() - 1.0);
 
-	m_coeffs[0] = static_cast<float>(std::pow(10.0, m_delay[4] * ReverbTimeSmp));
-	m_coeffs[1] = static_cast<float>(std::pow(10.0, m_delay[5] * ReverbTimeSmp));
+	m_allpassCoeffs[0] = static_cast<float>(std::pow(10.0, m_delay[4] * ReverbTimeSmp));
+	m_allpassCoeffs[1] = static_cast<float>(std::pow(10.0, m_delay[5] * ReverbTimeSmp));
 
 	double sum = 0.0;
 	for(uint32 pair = 0; pair < 4; pair++)
 	{
 		double gain1 = std::pow(10.0, m_delay[pair] * ReverbTimeSmp);
 		double gain2 = (1.0 - std::pow(10.0, (m_delay[pair] + m_delay[4 + pair / 2]) * ReverbTimeSmpHF)) * 0.5;
-		double gain3 = gain1 * m_coeffs[pair / 2];
+		double gain3 = gain1 * m_allpassCoeffs[pair / 2];
 		double gain4 = gain3 * (((gain3 + 1.0) * gain3 + 1.0) * gain3 + 1.0) + 1.0;
-		m_coeffs[2 + pair * 2] = static_cast<float>(gain1 * (1.0 - gain2));
-		m_coeffs[3 + pair * 2] = static_cast<float>(gain1 * gain2);
+		m_combCoeffs[0][pair] = static_cast<float>(gain1 * (1.0 - gain2));
+		m_combCoeffs[1][pair] = static_cast<float>(gain1 * gain2);
 		sum += gain4 * gain4;
 	}
 
@@ -34,7 +34,8 @@ protected:
 	// Parameters and coefficients
 	float m_dryFactor;
 	float m_wetFactor;
-	float m_coeffs[10];
+	float m_allpassCoeffs[2];
+	float m_combCoeffs[2][4];	// Feedback and damping coefficients, stored contiguously for the four comb filters so that they can be processed in parallel
 	uint32 m_delay[6];
 
 	// State
@@ -30,8 +30,15 @@
 #include "../soundbase/SampleFormatCopy.h"
 #include "../soundlib/ModSampleCopy.h"
 #include "../soundlib/ITCompression.h"
+#include "../soundlib/Loaders.h"
+#include "../soundlib/MixFuncTable.h"
+#include "../soundlib/MixerLoops.h"
+#include "../soundlib/Dither.h"
 #include "../soundlib/tuningcollection.h"
 #include "../soundlib/tuning.h"
+#include "../soundlib/modsmp_ctrl.h"
+#include "../soundlib/SamplePool.h"
+#include "../common/mptThreadPool.h"
 #ifdef MODPLUG_TRACKER
 #include "../mptrack/Mptrack.h"
 #include "../mptrack/Moddoc.h"
@@ -43,18 +50,27 @@
 #include "../common/mptFileIO.h"
 #ifdef LIBOPENMPT_BUILD
 #include "../libopenmpt/libopenmpt_version.h"
+#include "../libopenmpt/libopenmpt.h"
+#include "../libopenmpt/libopenmpt.hpp"
+#include "../libopenmpt/libopenmpt_stream_callbacks_buffer.h"
 #endif // LIBOPENMPT_BUILD
 #ifndef NO_PLUGINS
 #include "../soundlib/plugins/PlugInterface.h"
+#include "../soundlib/plugins/PluginManager.h"
 #endif
 #include "../common/mptBufferIO.h"
 #include <limits>
 #ifdef LIBOPENMPT_BUILD
 #include <iostream>
+#include <sstream>
 #endif // LIBOPENMPT_BUILD
 #include <istream>
 #include <ostream>
 #include <stdexcept>
+#if defined(MPT_ENABLE_THREAD)
+#include <chrono>
+#include <thread>
+#endif // MPT_ENABLE_THREAD
 #if MPT_COMPILER_MSVC
 #include <tchar.h>
 #endif
@@ -106,6 +122,16 @@ static MPT_NOINLINE void TestStringIO();
 static MPT_NOINLINE void TestMIDIEvents();
 static MPT_NOINLINE void TestSampleConversion();
 static MPT_NOINLINE void TestITCompression();
+static MPT_NOINLINE void TestMO3Decompression();
+static MPT_NOINLINE void TestMixFuncTables();
+static MPT_NOINLINE void TestOutputConversion();
+static MPT_NOINLINE void TestDSPEffects();
+static MPT_NOINLINE void TestRenderSettings();
+static MPT_NOINLINE void TestPinnedSamples();
+static MPT_NOINLINE void TestSharedSamples();
+static MPT_NOINLINE void TestModuleInfo();
+static MPT_NOINLINE void TestRenderBatch();
+static MPT_NOINLINE void TestLoadFromFile();
 static MPT_NOINLINE void TestTunings();
 static MPT_NOINLINE void TestPCnoteSerialization();
 static MPT_NOINLINE void TestLoadSaveFile();
@@ -128,6 +154,779 @@ mpt::PathString GetPathPrefix()
 }
 
 
+// Create a simple 32-channel MOD file in which all channels play a looped noise sample at different pitches and panning positions
+static std::vector<mpt::byte> CreateRenderTestModule()
+{
+	const CHANNELINDEX numChannels = 32;
+	const uint16 sampleWords = 2000;
+	std::vector<mpt::byte> data(1084 + 64 * numChannels * 4 + sampleWords * 2, mpt::byte(0));
+	// Sample 1: Full volume, looped
+	data[20 + 22] = mpt::byte(sampleWords >> 8);
+	data[20 + 23] = mpt::byte(sampleWords & 0xFF);
+	data[20 + 25] = mpt::byte(64);
+	data[20 + 28] = mpt::byte(sampleWords >> 8);
+	data[20 + 29] = mpt::byte(sampleWords & 0xFF);
+	// One order, one pattern
+	data[950] = mpt::byte(1);
+	data[951] = mpt::byte(127);
+	std::memcpy(data.data() + 1080, "32CH", 4);
+	for(ROWINDEX row = 0; row < 64; row += 16)
+	{
+		for(CHANNELINDEX chn = 0; chn < numChannels; chn++)
+		{
+			mpt::byte *cell = data.data() + 1084 + (row * numChannels + chn) * 4;
+			const uint16 period = static_cast<uint16>(120 + ((chn * 37 + row * 5) % 700));
+			cell[0] = mpt::byte(period >> 8);
+			cell[1] = mpt::byte(period & 0xFF);
+			cell[2] = mpt::byte(0x10 | 0x08);	// Instrument 1, set panning
+			cell[3] = mpt::byte((chn * 8 + row) & 0xFF);
+		}
+	}
+	for(std::size_t i = 1084 + 64 * numChannels * 4; i < data.size(); i++)
+	{
+		data[i] = mpt::byte(mpt::random<uint8>(*s_PRNG));
+	}
+	return data;
+}
+
+
+// Collects the raw mixer output
+class AudioReadTargetCollect : public IAudioReadTarget
+{
+public:
+	std::vector<int> samples;
+	void DataCallback(int *MixSoundBuffer, std::size_t channels, std::size_t countChunk) override
+	{
+		samples.insert(samples.end(), MixSoundBuffer, MixSoundBuffer + channels * countChunk);
+	}
+};
+
+
+// Collects the floating point master mix, converted back to fixed point for comparison.
+// The fixed point mix is ignored, so that nothing is collected if the floating point master mix is not used.
+class AudioReadTargetCollectFloat : public AudioReadTargetCollect
+{
+public:
+	void DataCallback(int * /*MixSoundBuffer*/, std::size_t /*channels*/, std::size_t /*countChunk*/) override { }
+	bool AcceptsFloatMix() const override { return true; }
+	void FloatDataCallback(float *MixFloatBuffer, std::size_t channels, std::size_t countChunk) override
+	{
+		for(std::size_t i = 0; i < channels * countChunk; i++)
+		{
+			samples.push_back(Util::Round<int>(MixFloatBuffer[i] * MIXING_SCALEF));
+		}
+	}
+};
+
+
+static std::vector<int> RenderTestModule(const std::vector<mpt::byte> &moduleData, uint32 chunkSize, uint32 numMixThreads, bool floatMasterMix = false, uint32 channels = 2, int32 stereoSeparation = MixerSettings::StereoSeparationScale)
+{
+	std::unique_ptr<CSoundFile> sndFile = mpt::make_unique<CSoundFile>();
+	sndFile->Create(FileReader(mpt::as_span(moduleData)), CSoundFile::loadCompleteModule);
+	MixerSettings mixerSettings = sndFile->m_MixerSettings;
+	mixerSettings.MixChunkSize = chunkSize;
+	mixerSettings.NumMixThreads = numMixThreads;
+	mixerSettings.FloatMasterMix = floatMasterMix;
+	mixerSettings.gnChannels = channels;
+	mixerSettings.m_nStereoSeparation = stereoSeparation;
+	sndFile->SetMixerSettings(mixerSettings);
+	sndFile->InitPlayer(true);
+	if(floatMasterMix)
+	{
+		AudioReadTargetCollectFloat target;
+		sndFile->Read(sndFile->m_MixerSettings.gdwMixingFreq * 2, target);
+		return target.samples;
+	}
+	AudioReadTargetCollect target;
+	sndFile->Read(sndFile->m_MixerSettings.gdwMixingFreq * 2, target);
+	return target.samples;
+}
+
+
+// Render the test module with the default chunk size, requesting the output in blocks of the given size
+static std::vector<int> RenderTestModuleInBlocks(const std::vector<mpt::byte> &moduleData, uint32 blockSize)
+{
+	std::unique_ptr<CSoundFile> sndFile = mpt::make_unique<CSoundFile>();
+	sndFile->Create(FileReader(mpt::as_span(moduleData)), CSoundFile::loadCompleteModule);
+	sndFile->InitPlayer(true);
+	AudioReadTargetCollect target;
+	for(uint32 frames = 0; frames < sndFile->m_MixerSettings.gdwMixingFreq * 2; frames += blockSize)
+	{
+		sndFile->Read(std::min(blockSize, sndFile->m_MixerSettings.gdwMixingFreq * 2 - frames), target);
+	}
+	return target.samples;
+}
+
+
+#ifdef LIBOPENMPT_BUILD
+// Render the test module through libopenmpt with the given render.chunk_frames ctl, reading the output in blocks of the given size
+static std::vector<float> RenderTestModuleChunkFrames(const std::vector<mpt::byte> &moduleData, const std::string &chunkFrames, std::size_t blockSize)
+{
+	std::map<std::string, std::string> ctls;
+	if(!chunkFrames.empty())
+		ctls["render.chunk_frames"] = chunkFrames;
+	std::ostringstream log;
+	openmpt::module mod(moduleData.data(), moduleData.size(), log, ctls);
+	std::vector<float> buffer(blockSize * 2), samples;
+	while(samples.size() < 44100u * 2u * 2u)
+	{
+		std::size_t count = mod.read_interleaved_stereo(44100, blockSize, buffer.data());
+		if(count == 0)
+			break;
+		samples.insert(samples.end(), buffer.begin(), buffer.begin() + count * 2);
+	}
+	samples.resize(std::min(samples.size(), std::size_t(44100 * 2 * 2)));
+	return samples;
+}
+#endif // LIBOPENMPT_BUILD
+
+
+static int MaxRenderDifference(const std::vector<int> &a, const std::vector<int> &b)
+{
+	int maxDiff = 0;
+	for(std::size_t i = 0; i < std::min(a.size(), b.size()); i++)
+	{
+		maxDiff = std::max(maxDiff, std::abs(a[i] - b[i]));
+	}
+	return maxDiff;
+}
+
+
+#ifndef NO_PLUGINS
+// Render the test module through several independent plugin chains, a plugin that depends on the output buffer contents, a bypassed plugin and a master effect
+static std::vector<int> RenderPluginTestModule(const std::vector<mpt::byte> &moduleData, uint32 chunkSize, uint32 numPluginThreads)
+{
+	static const struct
+	{
+		uint32 id;
+		PLUGINDEX output;	// PLUGINDEX_INVALID = master
+		uint8 mixMode;
+		bool masterEffect, bypass;
+	} plugins[] =
+	{
+		{ 0xEFE6629C, 1, 0, false, false },	// Chorus -> Echo
+		{ 0xEF3E932C, PLUGINDEX_INVALID, 0, false, false },	// Echo
+		{ 0xEF985E71, PLUGINDEX_INVALID, 0, false, false },	// I3DL2Reverb
+		{ 0xEF114C90, PLUGINDEX_INVALID, 4, false, false },	// Distortion, middle subtract
+		{ 0x87FC0268, 6, 3, false, false },	// WavesReverb, mix subtract -> ParamEq
+		{ 0xDAFD8210, PLUGINDEX_INVALID, 0, false, true },	// Gargle, bypassed
+		{ 0x120CED89, PLUGINDEX_INVALID, 0, false, false },	// ParamEq
+		{ 0xEF011F79, PLUGINDEX_INVALID, 0, true, false },	// Compressor
+	};
+
+	std::unique_ptr<CSoundFile> sndFile = mpt::make_unique<CSoundFile>();
+	sndFile->Create(FileReader(mpt::as_span(moduleData)), CSoundFile::loadCompleteModule);
+	for(PLUGINDEX plug = 0; plug < CountOf(plugins); plug++)
+	{
+		SNDMIXPLUGIN &plugin = sndFile->m_MixPlugins[plug];
+		plugin.Info.dwPluginId1 = kDmoMagic;
+		plugin.Info.dwPluginId2 = plugins[plug].id;
+		if(plugins[plug].output != PLUGINDEX_INVALID)
+			plugin.SetOutputPlugin(plugins[plug].output);
+		plugin.SetMixMode(plugins[plug].mixMode);
+		plugin.SetMasterEffect(plugins[plug].masterEffect);
+		plugin.SetBypass(plugins[plug].bypass);
+		CreateMixPluginProc(plugin, *sndFile);
+		VERIFY_EQUAL_NONCONT(plugin.pMixPlugin != nullptr, true);
+	}
+	const PLUGINDEX channelPlugins[] = { 1, 3, 4, 5, 6, 0 };	// 1-based, 0 = no plugin
+	for(CHANNELINDEX chn = 0; chn < sndFile->GetNumChannels(); chn++)
+	{
+		sndFile->ChnSettings[chn].nMixPlugin = channelPlugins[chn % CountOf(channelPlugins)];
+	}
+
+	MixerSettings mixerSettings = sndFile->m_MixerSettings;
+	mixerSettings.MixChunkSize = chunkSize;
+	mixerSettings.NumPluginThreads = numPluginThreads;
+	mixerSettings.FloatMasterMix = true;
+	sndFile->SetMixerSettings(mixerSettings);
+	sndFile->InitPlayer(true);
+	AudioReadTargetCollectFloat target;
+	sndFile->Read(sndFile->m_MixerSettings.gdwMixingFreq * 2, target);
+	return target.samples;
+}
+#endif // NO_PLUGINS
+
+
+static MPT_NOINLINE void TestRenderSettings()
+{
+	const std::vector<mpt::byte> moduleData = CreateRenderTestModule();
+	const std::vector<int> reference = RenderTestModule(moduleData, MIXBUFFERSIZE, 1);
+	VERIFY_EQUAL_NONCONT(reference.size(), 44100u * 2u * 2u);
+	VERIFY_EQUAL_NONCONT(std::count(reference.begin(), reference.end(), 0) < static_cast<std::ptrdiff_t>(reference.size() / 2), true);
+
+	// Stopped voices are merged into the global click removal offset at the end of a chunk, so the chunk boundaries affect the rounding of its decay.
+	// This already happened with a fixed chunk size when the output is requested in smaller blocks.
+	// A smaller chunk size must give exactly the same output as that, and all chunk sizes of at least one tick (882 frames) must give the same output.
+	const std::vector<int> bigChunks = RenderTestModule(moduleData, 4096, 1);
+	const std::vector<int> smallChunks = RenderTestModule(moduleData, 98, 1);
+	VERIFY_EQUAL(bigChunks.size(), reference.size());
+	VERIFY_EQUAL(smallChunks.size(), reference.size());
+	VERIFY_EQUAL(RenderTestModule(moduleData, 1024, 1) == bigChunks, true);
+	VERIFY_EQUAL(RenderTestModuleInBlocks(moduleData, 98) == smallChunks, true);
+	VERIFY_EQUAL(RenderTestModuleInBlocks(moduleData, 441) == RenderTestModule(moduleData, 441, 1), true);
+	VERIFY_EQUAL(RenderTestModuleInBlocks(moduleData, 4096) == reference, true);
+
+	// Parallel mixing must produce exactly the same output as serial mixing
+	VERIFY_EQUAL(RenderTestModule(moduleData, MIXBUFFERSIZE, 3) == reference, true);
+	VERIFY_EQUAL(RenderTestModule(moduleData, 4096, 4) == bigChunks, true);
+	VERIFY_EQUAL(RenderTestModule(moduleData, 98, 2) == smallChunks, true);
+	VERIFY_EQUAL(RenderTestModule(moduleData, 100, 2) == RenderTestModule(moduleData, 100, 1), true);
+
+#ifndef NO_PLUGINS
+	// Processing independent plugin chains in parallel must produce exactly the same output as processing them in slot order
+	{
+		const std::vector<int> serialPlugins = RenderPluginTestModule(moduleData, MIXBUFFERSIZE, 1);
+		VERIFY_EQUAL(serialPlugins.size(), reference.size());
+		VERIFY_EQUAL(MaxRenderDifference(serialPlugins, reference) > 0, true);
+		VERIFY_EQUAL(RenderPluginTestModule(moduleData, MIXBUFFERSIZE, 4) == serialPlugins, true);
+		VERIFY_EQUAL(RenderPluginTestModule(moduleData, 100, 1) == RenderPluginTestModule(moduleData, 100, 3), true);
+	}
+#endif // NO_PLUGINS
+
+	// The floating point master mix only differs from the fixed point master mix by rounding (and float precision of the full-scale signal)
+	for(uint32 channels : { 1u, 2u, 4u })
+	{
+		const std::vector<int> fixedMaster = RenderTestModule(moduleData, MIXBUFFERSIZE, 1, false, channels, 64);
+		const std::vector<int> floatMaster = RenderTestModule(moduleData, MIXBUFFERSIZE, 1, true, channels, 64);
+		VERIFY_EQUAL(fixedMaster.size(), 44100u * 2u * channels);
+		VERIFY_EQUAL(floatMaster.size(), fixedMaster.size());
+		VERIFY_EQUAL(MaxRenderDifference(floatMaster, fixedMaster) <= 64, true);
+	}
+
+	// Without a sample loop, voices stop long before the next row is triggered, so the silence in between does not need to be mixed
+	std::vector<mpt::byte> oneShotData = moduleData;
+	oneShotData[20 + 28] = mpt::byte(0);
+	oneShotData[20 + 29] = mpt::byte(1);
+	for(uint32 channels : { 1u, 2u, 4u })
+	{
+		for(bool floatMasterMix : { false, true })
+		{
+			std::vector<int> output[2];
+			for(bool skipSilence : { false, true })
+			{
+				std::unique_ptr<CSoundFile> sndFile = mpt::make_unique<CSoundFile>();
+				sndFile->Create(FileReader(mpt::as_span(oneShotData)), CSoundFile::loadCompleteModule);
+				MixerSettings mixerSettings = sndFile->m_MixerSettings;
+				mixerSettings.gnChannels = channels;
+				mixerSettings.FloatMasterMix = floatMasterMix;
+				mixerSettings.SkipSilentChunks = skipSilence;
+				sndFile->SetMixerSettings(mixerSettings);
+				sndFile->InitPlayer(true);
+				// Fade the global volume in and out, so that the silent chunks have to keep the volume ramp going
+				sndFile->m_PlayState.m_nGlobalVolume = 0;
+				std::unique_ptr<AudioReadTargetCollect> target = floatMasterMix ? mpt::make_unique<AudioReadTargetCollectFloat>() : mpt::make_unique<AudioReadTargetCollect>();
+				sndFile->Read(44100, *target);
+				sndFile->m_PlayState.m_nGlobalVolume = MAX_GLOBAL_VOLUME / 2;
+				sndFile->Read(44100, *target);
+				VERIFY_EQUAL(target->samples.size(), 44100u * 2u * channels);
+				if(skipSilence)
+				{
+					VERIFY_EQUAL(sndFile->GetSilentFramesSkipped() > 0, true);
+					VERIFY_EQUAL(sndFile->GetSilentFramesSkipped() < 44100u * 2u, true);
+				} else
+				{
+					VERIFY_EQUAL(sndFile->GetSilentFramesSkipped(), 0u);
+				}
+				output[skipSilence ? 1 : 0] = std::move(target->samples);
+			}
+			// Skipping silent chunks must not change the output at all
+			VERIFY_EQUAL(std::count(output[0].begin(), output[0].end(), 0) < static_cast<std::ptrdiff_t>(output[0].size()), true);
+			VERIFY_EQUAL(output[1] == output[0], true);
+		}
+	}
+
+	// ProTracker instrument swaps happen while mixing, so the mix function must follow the format of the new sample.
+	// A 16-bit copy of an 8-bit sample must sound exactly like the original.
+	{
+		const uint16 sampleWords = 500;
+		std::vector<mpt::byte> swapData = moduleData;
+		// Sample 2: Full volume, looped
+		swapData[50 + 22] = mpt::byte(sampleWords >> 8);
+		swapData[50 + 23] = mpt::byte(sampleWords & 0xFF);
+		swapData[50 + 25] = mpt::byte(64);
+		swapData[50 + 28] = mpt::byte(sampleWords >> 8);
+		swapData[50 + 29] = mpt::byte(sampleWords & 0xFF);
+		for(int i = 0; i < sampleWords * 2; i++)
+		{
+			swapData.push_back(mpt::byte(mpt::random<uint8>(*s_PRNG)));
+		}
+		// Instrument 2 without a note between the notes of instrument 1
+		for(ROWINDEX row = 8; row < 64; row += 16)
+		{
+			for(CHANNELINDEX chn = 0; chn < 32; chn++)
+			{
+				mpt::byte *cell = swapData.data() + 1084 + (row * 32 + chn) * 4;
+				cell[2] = mpt::byte(0x20);
+			}
+		}
+		std::vector<int> output[2];
+		for(int sixteenBit = 0; sixteenBit < 2; sixteenBit++)
+		{
+			std::unique_ptr<CSoundFile> sndFile = mpt::make_unique<CSoundFile>();
+			sndFile->Create(FileReader(mpt::as_span(swapData)), CSoundFile::loadCompleteModule);
+			VERIFY_EQUAL_NONCONT(sndFile->GetSample(2).nLength, sampleWords * 2u);
+			if(sixteenBit)
+			{
+				ctrlSmp::ConvertTo16Bit(sndFile->GetSample(2), *sndFile);
+			}
+			sndFile->m_playBehaviour.set(kMODSampleSwap);
+			CResamplerSettings resamplerSettings = sndFile->m_Resampler.m_Settings;
+			resamplerSettings.SrcMode = SRCMODE_NEAREST;
+			sndFile->SetResamplerSettings(resamplerSettings);
+			sndFile->InitPlayer(true);
+			AudioReadTargetCollect target;
+			sndFile->Read(44100 * 2, target);
+			output[sixteenBit] = std::move(target.samples);
+		}
+		VERIFY_EQUAL(output[0].size(), 44100u * 2u * 2u);
+		VERIFY_EQUAL(output[1] == output[0], true);
+	}
+
+#ifdef LIBOPENMPT_BUILD
+	// Setting the chunk size through libopenmpt.
+	// The mixer never mixes past the end of a tick (882 frames at 125 BPM), so all chunk sizes above that are equivalent.
+	// Smaller chunk sizes must be equivalent to requesting the output in blocks of that size, if the tick length is a multiple of it.
+	{
+		const std::vector<float> bigChunks = RenderTestModuleChunkFrames(moduleData, "4096", 4096);
+		VERIFY_EQUAL_NONCONT(bigChunks.size(), 44100u * 2u * 2u);
+		VERIFY_EQUAL_NONCONT(std::count(bigChunks.begin(), bigChunks.end(), 0.0f) < static_cast<std::ptrdiff_t>(bigChunks.size() / 2), true);
+		VERIFY_EQUAL(RenderTestModuleChunkFrames(moduleData, "1024", 4096) == bigChunks, true);
+		VERIFY_EQUAL(RenderTestModuleChunkFrames(moduleData, "98", 4096) == RenderTestModuleChunkFrames(moduleData, "", 98), true);
+		VERIFY_EQUAL(RenderTestModuleChunkFrames(moduleData, "512", 4096) == RenderTestModuleChunkFrames(moduleData, "", 4096), true);
+	}
+#endif // LIBOPENMPT_BUILD
+}
+
+
+// Create an IT file with uncompressed mono samples of various lengths and loop types, which are played at many different pitches
+static std::vector<mpt::byte> CreatePinnedSamplesTestModule()
+{
+	struct TestSample
+	{
+		uint8 flags;	// IT sample flags
+		uint32 length, loopStart, loopEnd, sustainStart, sustainEnd;
+	};
+	static const TestSample testSamples[] =
+	{
+		{ 0x01 | 0x10,               1000, 200, 1000,  0,   0 },	// 8-bit, forward loop up to the sample end
+		{ 0x01 | 0x02 | 0x10 | 0x40,  777, 100,  500,  0,   0 },	// 16-bit, ping-pong loop ending before the sample end
+		{ 0x01 | 0x02 | 0x10 | 0x20 | 0x80, 600, 0, 600, 50, 300 },	// 16-bit, forward loop over the whole sample and ping-pong sustain loop
+		{ 0x01,                        40,   0,    0,  0,   0 },	// 8-bit, barely long enough for pinning
+		{ 0x01 | 0x10,                 20,   0,   20,  0,   0 },	// 8-bit, too short for pinning
+	};
+	const uint16 numSamples = static_cast<uint16>(mpt::size(testSamples));
+	const CHANNELINDEX numChannels = 2 * numSamples;
+	const ROWINDEX numRows = 64;
+
+	std::vector<mpt::byte> pattern;
+	for(ROWINDEX row = 0; row < numRows; row++)
+	{
+		for(CHANNELINDEX chn = 0; chn < numChannels && (row % 4) == 0; chn++)
+		{
+			pattern.push_back(mpt::byte(0x80 | (chn + 1)));
+			if(row % 8 == 0)
+			{
+				pattern.push_back(mpt::byte(0x03));
+				pattern.push_back(mpt::byte(12 + ((row * 5 + chn * 11) % 96)));
+				pattern.push_back(mpt::byte(1 + chn % numSamples));
+			} else
+			{
+				// Note-off, leaving the sustain loop
+				pattern.push_back(mpt::byte(0x01));
+				pattern.push_back(mpt::byte(0xFF));
+			}
+		}
+		pattern.push_back(mpt::byte(0));
+	}
+
+	const std::size_t sampleHeaderOffset = 0xC0 + 2 + numSamples * 4 + 4;
+	const std::size_t patternOffset = sampleHeaderOffset + numSamples * 0x50;
+	std::size_t sampleDataOffset = (patternOffset + 8 + pattern.size() + 1) & ~std::size_t(1);
+	std::size_t fileSize = sampleDataOffset;
+	for(const auto &smp : testSamples)
+	{
+		fileSize += smp.length * ((smp.flags & 0x02) ? 2 : 1);
+	}
+
+	std::vector<mpt::byte> data(fileSize, mpt::byte(0));
+	auto write16 = [&data](std::size_t offset, uint32 value) { data[offset] = mpt::byte(value & 0xFF); data[offset + 1] = mpt::byte(value >> 8); };
+	auto write32 = [&](std::size_t offset, uint32 value) { write16(offset, value & 0xFFFF); write16(offset + 2, value >> 16); };
+
+	std::memcpy(data.data(), "IMPM", 4);
+	write16(32, 2);	// Orders
+	write16(36, numSamples);
+	write16(38, 1);	// Patterns
+	write16(40, 0x0214);
+	write16(42, 0x0214);
+	write16(44, 0x01 | 0x08);	// Stereo, linear slides
+	data[48] = mpt::byte(128);	// Global volume
+	data[49] = mpt::byte(48);	// Mix volume
+	data[50] = mpt::byte(3);	// Speed
+	data[51] = mpt::byte(125);	// Tempo
+	data[52] = mpt::byte(128);	// Separation
+	for(CHANNELINDEX chn = 0; chn < 64; chn++)
+	{
+		data[64 + chn] = mpt::byte((chn * 13) % 65);
+		data[128 + chn] = mpt::byte(64);
+	}
+	data[0xC0] = mpt::byte(0);
+	data[0xC1] = mpt::byte(0xFF);
+	for(uint16 smp = 0; smp < numSamples; smp++)
+	{
+		write32(0xC2 + smp * 4, static_cast<uint32>(sampleHeaderOffset + smp * 0x50));
+	}
+	write32(0xC2 + numSamples * 4, static_cast<uint32>(patternOffset));
+
+	for(uint16 smp = 0; smp < numSamples; smp++)
+	{
+		const TestSample &sample = testSamples[smp];
+		const std::size_t offset = sampleHeaderOffset + smp * 0x50;
+		std::memcpy(data.data() + offset, "IMPS", 4);
+		data[offset + 17] = mpt::byte(64);	// Global volume
+		data[offset + 18] = mpt::byte(sample.flags);
+		data[offset + 19] = mpt::byte(64);	// Volume
+		data[offset + 46] = mpt::byte(1);	// Signed samples
+		write32(offset + 48, sample.length);
+		write32(offset + 52, sample.loopStart);
+		write32(offset + 56, sample.loopEnd);
+		write32(offset + 60, 8363 + smp * 1000);
+		write32(offset + 64, sample.sustainStart);
+		write32(offset + 68, sample.sustainEnd);
+		write32(offset + 72, static_cast<uint32>(sampleDataOffset));
+		for(std::size_t i = 0; i < sample.length * ((sample.flags & 0x02) ? 2 : 1); i++)
+		{
+			data[sampleDataOffset++] = mpt::byte(mpt::random<uint8>(*s_PRNG));
+		}
+	}
+
+	write16(patternOffset, static_cast<uint16>(pattern.size()));
+	write16(patternOffset + 2, numRows);
+	std::copy(pattern.begin(), pattern.end(), data.begin() + patternOffset + 8);
+	return data;
+}
+
+
+static MPT_NOINLINE void TestPinnedSamples()
+{
+	const std::vector<mpt::byte> moduleData = CreatePinnedSamplesTestModule();
+	std::unique_ptr<CSoundFile> pinnedSndFile = mpt::make_unique<CSoundFile>(), unpinnedSndFile = mpt::make_unique<CSoundFile>();
+	pinnedSndFile->SetSamplePinning(true);
+	VERIFY_EQUAL(pinnedSndFile->Create(FileReader(mpt::as_span(moduleData)), CSoundFile::loadCompleteModule), true);
+	VERIFY_EQUAL(unpinnedSndFile->Create(FileReader(mpt::as_span(moduleData)), CSoundFile::loadCompleteModule), true);
+	VERIFY_EQUAL(pinnedSndFile->GetNumSamples(), 5);
+
+	for(SAMPLEINDEX smp = 1; smp <= pinnedSndFile->GetNumSamples(); smp++)
+	{
+		const ModSample &sample = pinnedSndFile->GetSample(smp);
+		const ModSample &expected = unpinnedSndFile->GetSample(smp);
+		VERIFY_EQUAL_NONCONT(sample.IsPinned(), smp != 5);
+		VERIFY_EQUAL_NONCONT(expected.IsPinned(), false);
+		VERIFY_EQUAL_NONCONT(sample.nLength, expected.nLength);
+		VERIFY_EQUAL_NONCONT(sample.uFlags, expected.uFlags);
+		if(sample.IsPinned())
+		{
+			VERIFY_EQUAL_NONCONT(sample.sampleb() > moduleData.data() && sample.sampleb() + sample.GetSampleSizeInBytes() <= moduleData.data() + moduleData.size(), true);
+		}
+		VERIFY_EQUAL_NONCONT(std::memcmp(sample.samplev(), expected.samplev(), expected.GetSampleSizeInBytes()), 0);
+	}
+
+	// Pinned sample data must sound exactly like decoded sample data, including the interpolation around the sample and loop boundaries
+	for(int resamplingMode = SRCMODE_NEAREST; resamplingMode < SRCMODE_DEFAULT; resamplingMode++)
+	{
+		std::vector<int> output[2];
+		for(int pinned = 0; pinned < 2; pinned++)
+		{
+			CSoundFile &sndFile = pinned ? *pinnedSndFile : *unpinnedSndFile;
+			CResamplerSettings resamplerSettings = sndFile.m_Resampler.m_Settings;
+			resamplerSettings.SrcMode = static_cast<ResamplingMode>(resamplingMode);
+			sndFile.SetResamplerSettings(resamplerSettings);
+			sndFile.SetCurrentOrder(0);
+			sndFile.InitPlayer(true);
+			AudioReadTargetCollect target;
+			sndFile.Read(sndFile.m_MixerSettings.gdwMixingFreq * 3, target);
+			output[pinned] = std::move(target.samples);
+		}
+		VERIFY_EQUAL_NONCONT(output[0].size(), unpinnedSndFile->m_MixerSettings.gdwMixingFreq * 3u * 2u);
+		VERIFY_EQUAL_NONCONT(output[0] == output[1], true);
+	}
+
+	// Copying a pinned sample to another module must give it its own sample data and no lookahead buffer of its own
+	{
+		const ModSample &sourceSample = pinnedSndFile->GetSample(1);
+		VERIFY_EQUAL(unpinnedSndFile->ReadSampleFromSong(1, *pinnedSndFile, 1), true);
+		const ModSample &copiedSample = unpinnedSndFile->GetSample(1);
+		VERIFY_EQUAL(sourceSample.IsPinned(), true);
+		VERIFY_EQUAL(copiedSample.IsPinned(), false);
+		VERIFY_EQUAL(copiedSample.samplev() != sourceSample.samplev(), true);
+		VERIFY_EQUAL(copiedSample.nLength, sourceSample.nLength);
+		VERIFY_EQUAL(std::memcmp(copiedSample.samplev(), sourceSample.samplev(), sourceSample.GetSampleSizeInBytes()), 0);
+	}
+
+	// Copies of a sample header never take over the lookahead buffer, while assigning a header keeps the buffer of the target
+	{
+		ModSample &pinnedSample = pinnedSndFile->GetSample(3);
+		const ModSample headerCopy = pinnedSample;
+		VERIFY_EQUAL(headerCopy.IsPinned(), false);
+		const ModSample origSample = pinnedSample;
+		pinnedSample = unpinnedSndFile->GetSample(3);
+		pinnedSample.pData.pSample = const_cast<void *>(headerCopy.samplev());
+		VERIFY_EQUAL(pinnedSample.IsPinned(), true);
+		pinnedSample = origSample;
+		VERIFY_EQUAL(pinnedSample.IsPinned(), true);
+		VERIFY_EQUAL(pinnedSample.samplev(), headerCopy.samplev());
+	}
+
+	// Modifying pinned sample data must leave the file data alone
+	ModSample &modifiedSample = pinnedSndFile->GetSample(2);
+	const std::vector<mpt::byte> originalData(modifiedSample.sampleb(), modifiedSample.sampleb() + modifiedSample.GetSampleSizeInBytes());
+	const mpt::byte *pinnedData = modifiedSample.sampleb();
+	VERIFY_EQUAL(ctrlSmp::InvertSample(modifiedSample, 0, modifiedSample.nLength, *pinnedSndFile), true);
+	VERIFY_EQUAL(modifiedSample.IsPinned(), false);
+	VERIFY_EQUAL(std::memcmp(pinnedData, originalData.data(), originalData.size()), 0);
+	VERIFY_EQUAL(std::memcmp(modifiedSample.samplev(), originalData.data(), originalData.size()) != 0, true);
+
+	pinnedSndFile->Destroy();
+	unpinnedSndFile->Destroy();
+}
+
+
+static MPT_NOINLINE void TestSharedSamples()
+{
+	const std::vector<mpt::byte> moduleData = CreateRenderTestModule();
+	// Same module, but the first channel uses the Invert Loop effect (EF8) on the first row
+	std::vector<mpt::byte> invertLoopData = moduleData;
+	invertLoopData[1084 + 2] = mpt::byte(0x10 | 0x0E);
+	invertLoopData[1084 + 3] = mpt::byte(0xF8);
+
+	for(int invertLoop = 0; invertLoop < 2; invertLoop++)
+	{
+		const std::vector<mpt::byte> &data = invertLoop ? invertLoopData : moduleData;
+		std::unique_ptr<CSoundFile> sndFile1 = mpt::make_unique<CSoundFile>(), sndFile2 = mpt::make_unique<CSoundFile>();
+		sndFile1->SetSampleSharing(true);
+		sndFile2->SetSampleSharing(true);
+		VERIFY_EQUAL(sndFile1->Create(FileReader(mpt::as_span(data)), CSoundFile::loadCompleteModule), true);
+		VERIFY_EQUAL(sndFile2->Create(FileReader(mpt::as_span(data)), CSoundFile::loadCompleteModule), true);
+		const ModSample &sample1 = sndFile1->GetSample(1), &sample2 = sndFile2->GetSample(1);
+		VERIFY_EQUAL(sample1.HasSampleData(), true);
+		VERIFY_EQUAL(sample1.uFlags[CHN_LOOP], true);
+
+		// Samples that are modified by the Invert Loop effect while playing are not shared
+		VERIFY_EQUAL(SamplePool::IsShared(sample2.samplev()), !invertLoop);
+		VERIFY_EQUAL(sample1.samplev() == sample2.samplev(), !invertLoop);
+
+		// Playing a module must never modify the sample data of another module
+		const std::vector<mpt::byte> originalData(sample2.sampleb(), sample2.sampleb() + sample2.GetSampleSizeInBytes());
+		sndFile1->SetCurrentOrder(0);
+		sndFile1->InitPlayer(true);
+		AudioReadTargetCollect target;
+		sndFile1->Read(sndFile1->m_MixerSettings.gdwMixingFreq * 2, target);
+		VERIFY_EQUAL(std::memcmp(sample2.samplev(), originalData.data(), originalData.size()), 0);
+		VERIFY_EQUAL(std::memcmp(sample1.samplev(), originalData.data(), originalData.size()) != 0, invertLoop != 0);
+
+		sndFile1->Destroy();
+		sndFile2->Destroy();
+	}
+
+	// The pool does not share sample data with a module that has the same key but different sample data
+	{
+		VERIFY_EQUAL_NONCONT(moduleData.empty(), false);
+		std::vector<mpt::byte> otherData = moduleData;
+		const std::size_t lastByte = otherData.size() - 1;
+		otherData[lastByte] = ~otherData[lastByte];
+		std::unique_ptr<CSoundFile> sndFile1 = mpt::make_unique<CSoundFile>(), sndFile2 = mpt::make_unique<CSoundFile>();
+		sndFile1->SetSampleSharing(true);
+		VERIFY_EQUAL(sndFile1->Create(FileReader(mpt::as_span(moduleData)), CSoundFile::loadCompleteModule), true);
+		VERIFY_EQUAL(sndFile2->Create(FileReader(mpt::as_span(otherData)), CSoundFile::loadCompleteModule), true);
+		VERIFY_EQUAL(SamplePool::IsShared(sndFile1->GetSample(1).samplev()), true);
+		SamplePool::Key key = SamplePool::GetFileKey(FileReader(mpt::as_span(moduleData)));
+		key.sample = 1;
+		SamplePool::Instance().Share(key, sndFile2->GetSample(1));
+		VERIFY_EQUAL(SamplePool::IsShared(sndFile2->GetSample(1).samplev()), false);
+		VERIFY_EQUAL(sndFile2->GetSample(1).sampleb()[sndFile2->GetSample(1).nLength - 1], otherData[lastByte]);
+		sndFile1->Destroy();
+		sndFile2->Destroy();
+	}
+}
+
+
+static MPT_NOINLINE void TestModuleInfo()
+{
+	// IT files without channel names do not store the number of channels, it has to be derived from the pattern data
+	const std::vector<mpt::byte> moduleData = CreatePinnedSamplesTestModule();
+	std::unique_ptr<CSoundFile> sndFile = mpt::make_unique<CSoundFile>(), metadataSndFile = mpt::make_unique<CSoundFile>();
+	VERIFY_EQUAL(sndFile->Create(FileReader(mpt::as_span(moduleData)), CSoundFile::loadCompleteModule), true);
+	VERIFY_EQUAL(metadataSndFile->Create(FileReader(mpt::as_span(moduleData)), CSoundFile::loadMetadata), true);
+	VERIFY_EQUAL(sndFile->GetNumChannels(), 10);
+	VERIFY_EQUAL(metadataSndFile->GetNumChannels(), sndFile->GetNumChannels());
+	VERIFY_EQUAL(metadataSndFile->GetNumSamples(), sndFile->GetNumSamples());
+	VERIFY_EQUAL(metadataSndFile->Patterns.IsValidPat(0), false);
+	VERIFY_EQUAL(metadataSndFile->GetSample(1).HasSampleData(), false);
+
+#ifdef LIBOPENMPT_BUILD
+	std::istringstream stream(std::string(mpt::byte_cast<const char *>(moduleData.data()), moduleData.size()));
+	std::ostringstream log;
+	const openmpt::module_info info = openmpt::read_module_info(stream, log);
+	VERIFY_EQUAL(info.type, "it");
+	VERIFY_EQUAL(info.num_channels, 10);
+	VERIFY_EQUAL(info.num_samples, 5);
+	VERIFY_EQUAL(info.sample_names.size(), 5u);
+#endif // LIBOPENMPT_BUILD
+
+	sndFile->Destroy();
+	metadataSndFile->Destroy();
+}
+
+
+#ifdef LIBOPENMPT_BUILD
+
+// Collects the output of a batch job
+class BatchSinkCollect : public openmpt::batch_sink
+{
+public:
+	std::vector<float> samples;
+	int32 interpolationFilter;
+	bool throwInWrite;
+
+	BatchSinkCollect(int32 interpolationFilter = 0, bool throwInWrite = false) : interpolationFilter(interpolationFilter), throwInWrite(throwInWrite) { }
+
+	void begin(openmpt::module &mod) override
+	{
+		if(interpolationFilter)
+			mod.set_render_param(openmpt::module::RENDER_INTERPOLATIONFILTER_LENGTH, interpolationFilter);
+	}
+	bool write(const float *interleaved, std::size_t frames) override
+	{
+		if(throwInWrite)
+			throw std::runtime_error("sink error");
+		samples.insert(samples.end(), interleaved, interleaved + frames * 2);
+		return true;
+	}
+
+	static void BeginC(void *user, openmpt_module *mod)
+	{
+		BatchSinkCollect &that = *static_cast<BatchSinkCollect *>(user);
+		if(that.interpolationFilter)
+			openmpt_module_set_render_param(mod, OPENMPT_MODULE_RENDER_INTERPOLATIONFILTER_LENGTH, that.interpolationFilter);
+	}
+	static int WriteC(void *user, const float *interleaved, size_t frames)
+	{
+		BatchSinkCollect &that = *static_cast<BatchSinkCollect *>(user);
+		that.samples.insert(that.samples.end(), interleaved, interleaved + frames * 2);
+		return 1;
+	}
+};
+
+
+// Renders a module on the calling thread, in the same block size as the batch renderer
+static std::vector<float> RenderTestModuleSerial(const std::vector<mpt::byte> &moduleData, int32 interpolationFilter)
+{
+	std::ostringstream log;
+	openmpt::module mod(moduleData.data(), moduleData.size(), log);
+	if(interpolationFilter)
+		mod.set_render_param(openmpt::module::RENDER_INTERPOLATIONFILTER_LENGTH, interpolationFilter);
+	std::vector<float> buffer(4096 * 2), samples;
+	while(std::size_t count = mod.read_interleaved_stereo(44100, 4096, buffer.data()))
+	{
+		samples.insert(samples.end(), buffer.begin(), buffer.begin() + count * 2);
+	}
+	return samples;
+}
+
+#endif // LIBOPENMPT_BUILD
+
+
+static MPT_NOINLINE void TestRenderBatch()
+{
+#ifdef LIBOPENMPT_BUILD
+	const std::vector<mpt::byte> moduleData = CreateRenderTestModule();
+	const std::vector<mpt::byte> invalidData;
+	const std::string moduleString(mpt::byte_cast<const char *>(moduleData.data()), moduleData.size());
+	const std::vector<float> reference = RenderTestModuleSerial(moduleData, 0), referenceLinear = RenderTestModuleSerial(moduleData, 2);
+	VERIFY_EQUAL_NONCONT(reference.empty(), false);
+	VERIFY_EQUAL_NONCONT(reference != referenceLinear, true);
+
+	// C++ API: Jobs that fail to load or throw in the sink must not affect the other jobs
+	{
+		std::istringstream stream1(moduleString), stream2(moduleString), stream3(moduleString), streamInvalid;
+		BatchSinkCollect sink1, sink2(2), sinkThrow(0, true), sinkInvalid;
+		std::vector<openmpt::batch_job> jobs;
+		jobs.push_back(openmpt::batch_job(stream1, sink1));
+		jobs.push_back(openmpt::batch_job(streamInvalid, sinkInvalid));
+		jobs.push_back(openmpt::batch_job(stream3, sinkThrow));
+		jobs.push_back(openmpt::batch_job(stream2, sink2));
+		const std::vector<openmpt::batch_result> results = openmpt::render_batch(jobs, 44100, 2, 3);
+		VERIFY_EQUAL_NONCONT(results.size(), 4u);
+
+		VERIFY_EQUAL(results[0].success, true);
+		VERIFY_EQUAL(results[0].frames, static_cast<int64>(reference.size() / 2));
+		VERIFY_EQUAL(sink1.samples == reference, true);
+
+		VERIFY_EQUAL(results[1].success, false);
+		VERIFY_EQUAL(results[1].error.empty(), false);
+		VERIFY_EQUAL(results[1].frames, 0);
+		VERIFY_EQUAL(sinkInvalid.samples.empty(), true);
+
+		VERIFY_EQUAL(results[2].success, false);
+		VERIFY_EQUAL(results[2].error, "sink error");
+
+		VERIFY_EQUAL(results[3].success, true);
+		VERIFY_EQUAL(sink2.samples == referenceLinear, true);
+	}
+
+	// Invalid parameters are reported for the whole batch
+	{
+		std::istringstream stream(moduleString);
+		BatchSinkCollect sink;
+		std::vector<openmpt::batch_job> jobs(1, openmpt::batch_job(stream, sink));
+		bool caught = false;
+		try
+		{
+			openmpt::render_batch(jobs, 44100, 3, 1);
+		} catch(const openmpt::exception &)
+		{
+			caught = true;
+		}
+		VERIFY_EQUAL(caught, true);
+		VERIFY_EQUAL(sink.samples.empty(), true);
+	}
+
+	// C API
+	{
+		openmpt_stream_buffer buffers[3];
+		openmpt_stream_buffer_init(&buffers[0], moduleData.data(), moduleData.size());
+		openmpt_stream_buffer_init(&buffers[1], invalidData.data(), invalidData.size());
+		openmpt_stream_buffer_init(&buffers[2], moduleData.data(), moduleData.size());
+		BatchSinkCollect sinks[3] = { BatchSinkCollect(0), BatchSinkCollect(0), BatchSinkCollect(2) };
+		openmpt_batch_job jobs[3];
+		MemsetZero(jobs);
+		for(std::size_t i = 0; i < 3; i++)
+		{
+			jobs[i].stream_callbacks = openmpt_stream_get_buffer_callbacks();
+			jobs[i].stream = &buffers[i];
+			jobs[i].begin_func = &BatchSinkCollect::BeginC;
+			jobs[i].write_func = &BatchSinkCollect::WriteC;
+			jobs[i].user = &sinks[i];
+		}
+		VERIFY_EQUAL(openmpt_render_batch(jobs, 3, 44100, 2, 2), 0);
+		VERIFY_EQUAL(jobs[0].error, OPENMPT_ERROR_OK);
+		VERIFY_EQUAL(sinks[0].samples == reference, true);
+		VERIFY_EQUAL(jobs[1].error != OPENMPT_ERROR_OK, true);
+		VERIFY_EQUAL(jobs[1].frames, 0);
+		VERIFY_EQUAL(jobs[2].error, OPENMPT_ERROR_OK);
+		VERIFY_EQUAL(jobs[2].frames, static_cast<int64>(referenceLinear.size() / 2));
+		VERIFY_EQUAL(sinks[2].samples == referenceLinear, true);
+
+		// Without the failing job, the whole batch succeeds
+		openmpt_stream_buffer_init(&buffers[0], moduleData.data(), moduleData.size());
+		sinks[0].samples.clear();
+		VERIFY_EQUAL(openmpt_render_batch(jobs, 1, 44100, 2, 1), 1);
+		VERIFY_EQUAL(sinks[0].samples == reference, true);
+	}
+#endif // LIBOPENMPT_BUILD
+}
+
+
 void DoTests()
 {
 
@@ -206,6 +1005,16 @@ void DoTests()
 	DO_TEST(TestMIDIEvents);
 	DO_TEST(TestSampleConversion);
 	DO_TEST(TestITCompression);
+	DO_TEST(TestMO3Decompression);
+	DO_TEST(TestMixFuncTables);
+	DO_TEST(TestOutputConversion);
+	DO_TEST(TestDSPEffects);
+	DO_TEST(TestRenderSettings);
+	DO_TEST(TestPinnedSamples);
+	DO_TEST(TestSharedSamples);
+	DO_TEST(TestModuleInfo);
+	DO_TEST(TestRenderBatch);
+	DO_TEST(TestLoadFromFile);
 	DO_TEST(TestTunings);
 
 	// slower tests, require opening a CModDoc
@@ -242,6 +1051,103 @@ static void RemoveFile(const mpt::PathString &filename)
 }
 
 
+#ifdef LIBOPENMPT_BUILD
+
+static std::vector<float> RenderLibopenmptModule(openmpt_module *mod)
+{
+	std::vector<float> samples;
+	if(mod == nullptr)
+		return samples;
+	std::vector<float> buffer(4096 * 2);
+	for(int block = 0; block < 16; block++)
+	{
+		std::size_t count = openmpt_module_read_interleaved_float_stereo(mod, 44100, 4096, buffer.data());
+		samples.insert(samples.end(), buffer.begin(), buffer.begin() + count * 2);
+	}
+	return samples;
+}
+
+#endif // LIBOPENMPT_BUILD
+
+
+// Loading a module from disk must give the same result as loading it from memory
+static MPT_NOINLINE void TestLoadFromFile()
+{
+#ifdef MPT_ENABLE_FILEIO
+	const std::vector<mpt::byte> moduleData = CreateRenderTestModule();
+	const mpt::PathString filename = GetTempFilenameBase() + MPT_PATHSTRING("fromfile.mod");
+	RemoveFile(filename);
+	{
+		mpt::ofstream f(filename, std::ios::binary);
+		f.write(mpt::byte_cast<const char *>(moduleData.data()), moduleData.size());
+		VERIFY_EQUAL_NONCONT(f.good(), true);
+	}
+
+#if defined(MPT_ENABLE_MMAP)
+	{
+		CMappedFile mappedFile;
+		VERIFY_EQUAL(mappedFile.Open(filename), true);
+		VERIFY_EQUAL(mappedFile.GetLength(), moduleData.size());
+		const mpt::byte *data = mappedFile.Lock();
+		VERIFY_EQUAL_NONCONT(data != nullptr, true);
+		VERIFY_EQUAL(std::memcmp(data, moduleData.data(), moduleData.size()), 0);
+		VERIFY_EQUAL(mappedFile.Lock(), data);
+		mappedFile.Close();
+		VERIFY_EQUAL(mappedFile.IsOpen(), false);
+		VERIFY_EQUAL(mappedFile.Open(filename + MPT_PATHSTRING(".missing")), false);
+	}
+#endif // MPT_ENABLE_MMAP
+
+	{
+		InputFile inputFile(filename);
+		VERIFY_EQUAL_NONCONT(inputFile.IsValid(), true);
+		FileReader file = GetFileReader(inputFile);
+		VERIFY_EQUAL(file.GetLength(), moduleData.size());
+		std::vector<mpt::byte> fileData(moduleData.size());
+		VERIFY_EQUAL(file.ReadRaw(fileData.data(), fileData.size()), fileData.size());
+		VERIFY_EQUAL(fileData == moduleData, true);
+		file.Rewind();
+		std::unique_ptr<CSoundFile> sndFile = mpt::make_unique<CSoundFile>();
+		VERIFY_EQUAL(sndFile->Create(file, CSoundFile::loadCompleteModule), true);
+		VERIFY_EQUAL(sndFile->GetNumChannels(), 32);
+		VERIFY_EQUAL(std::memcmp(sndFile->GetSample(1).samplev(), moduleData.data() + moduleData.size() - 4000, 4000), 0);
+		sndFile->Destroy();
+	}
+
+#ifdef LIBOPENMPT_BUILD
+	{
+		openmpt_module *memoryMod = openmpt_module_create_from_memory2(moduleData.data(), moduleData.size(), nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+		const std::vector<float> reference = RenderLibopenmptModule(memoryMod);
+		openmpt_module_destroy(memoryMod);
+		VERIFY_EQUAL_NONCONT(reference.empty(), false);
+
+		int error = OPENMPT_ERROR_OK;
+		openmpt_module *fileMod = openmpt_module_create_from_file(filename.AsNative().c_str(), nullptr, nullptr, nullptr, nullptr, &error, nullptr, nullptr);
+		VERIFY_EQUAL_NONCONT(fileMod != nullptr, true);
+		VERIFY_EQUAL(error, OPENMPT_ERROR_OK);
+		VERIFY_EQUAL(openmpt_module_get_num_channels(fileMod), 32);
+		VERIFY_EQUAL(RenderLibopenmptModule(fileMod) == reference, true);
+		openmpt_module_destroy(fileMod);
+
+		std::ostringstream log;
+		openmpt::module cxxMod(filename.AsNative(), log);
+		VERIFY_EQUAL(cxxMod.get_num_channels(), 32);
+
+		// Missing files are reported as errors
+		const char *errorMessage = nullptr;
+		openmpt_module *missingMod = openmpt_module_create_from_file((filename + MPT_PATHSTRING(".missing")).AsNative().c_str(), nullptr, nullptr, nullptr, nullptr, &error, &errorMessage, nullptr);
+		VERIFY_EQUAL(missingMod == nullptr, true);
+		VERIFY_EQUAL(error != OPENMPT_ERROR_OK, true);
+		VERIFY_EQUAL(errorMessage != nullptr, true);
+		openmpt_free_string(errorMessage);
+	}
+#endif // LIBOPENMPT_BUILD
+
+	RemoveFile(filename);
+#endif // MPT_ENABLE_FILEIO
+}
+
+
 // Test if functions related to program version data work
 static MPT_NOINLINE void TestVersion()
 {
@@ -3708,14 +4614,248 @@ static MPT_NOINLINE void TestLoadSaveFile()
 
 		TestLoadMPTMFile(GetSoundFile(sndFileContainer));
 
-		#ifndef MODPLUG_NO_FILESAVE
-			// Test file saving
-			GetSoundFile(sndFileContainer).m_dwLastSavedWithVersion = Version::Current();
-			SaveIT(sndFileContainer, filenameBase + MPT_PATHSTRING("saved.mptm"));
-		#endif
-
-		DestroySoundFileContainer(sndFileContainer);
-	}
+#ifndef NO_PLUGINS
+		// Only slots that hold a plugin instance are processed, and removing a plugin updates the list
+		{
+			TSoundFileContainer pluginContainer = CreateSoundFileContainer(filenameBaseSrc + MPT_PATHSTRING("mptm"));
+			CSoundFile &sndFile = GetSoundFile(pluginContainer);
+			std::vector<PLUGINDEX> expected;
+			for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+			{
+				if(sndFile.m_MixPlugins[plug].pMixPlugin != nullptr)
+					expected.push_back(plug);
+			}
+			VERIFY_EQUAL_NONCONT(expected.empty(), false);
+			VERIFY_EQUAL_NONCONT(sndFile.GetActivePlugins() == expected, true);
+			sndFile.m_MixPlugins[expected.front()].Destroy();
+			expected.erase(expected.begin());
+			VERIFY_EQUAL_NONCONT(sndFile.GetActivePlugins() == expected, true);
+			DestroySoundFileContainer(pluginContainer);
+		}
+#endif // NO_PLUGINS
+
+		// Sequences can be scanned concurrently, also while recording GetLength checkpoints
+		{
+			CSoundFile &sndFile = GetSoundFile(sndFileContainer);
+			const SEQUENCEINDEX numSequences = sndFile.Order.GetNumSequences();
+			std::vector<std::vector<GetLengthType>> serial(numSequences), parallel(numSequences);
+			for(SEQUENCEINDEX seq = 0; seq < numSequences; seq++)
+			{
+				serial[seq] = sndFile.GetLength(eNoAdjust, GetLengthTarget(true).StartPos(seq, 0, 0));
+			}
+			sndFile.SetLengthCheckpoints(0.1, 1024 * 1024);
+			mpt::thread_pool pool(numSequences);
+			pool.parallel_for(numSequences, [&](std::size_t seq)
+			{
+				parallel[seq] = sndFile.GetLength(eNoAdjust, GetLengthTarget(true).StartPos(static_cast<SEQUENCEINDEX>(seq), 0, 0));
+			});
+			sndFile.SetLengthCheckpoints(0.0, 0);
+			for(SEQUENCEINDEX seq = 0; seq < numSequences; seq++)
+			{
+				VERIFY_EQUAL_NONCONT(parallel[seq].size(), serial[seq].size());
+				for(size_t i = 0; i < std::min(parallel[seq].size(), serial[seq].size()); i++)
+				{
+					VERIFY_EQUAL_NONCONT(parallel[seq][i].duration, serial[seq][i].duration);
+					VERIFY_EQUAL_NONCONT(parallel[seq][i].startOrder, serial[seq][i].startOrder);
+					VERIFY_EQUAL_NONCONT(parallel[seq][i].startRow, serial[seq][i].startRow);
+				}
+			}
+		}
+
+		// Deferred sample data must be identical to sample data that is decoded while loading
+		{
+			const CSoundFile &sndFile = GetSoundFile(sndFileContainer);
+			mpt::ifstream stream(filenameBaseSrc + MPT_PATHSTRING("mptm"), std::ios::binary);
+			const std::vector<mpt::byte> fileData = make_FileReader(&stream).GetRawDataAsByteVector();
+			// 0 = decode on the calling thread, 1 = same while all samples are decoded in the background, 2 = only request the samples from the background thread
+			for(int background = 0; background < 3; background++)
+			{
+				std::unique_ptr<CSoundFile> lazySndFile = mpt::make_unique<CSoundFile>();
+				VERIFY_EQUAL(lazySndFile->Create(FileReader(mpt::as_span(fileData)), static_cast<CSoundFile::ModLoadingFlags>(CSoundFile::loadCompleteModule | CSoundFile::deferSampleData)), true);
+				VERIFY_EQUAL(lazySndFile->GetNumSamples(), sndFile.GetNumSamples());
+				if(background == 1)
+				{
+					lazySndFile->StartDeferredSampleDecoding();
+				}
+				for(SAMPLEINDEX smp = 1; smp <= std::min(lazySndFile->GetNumSamples(), sndFile.GetNumSamples()); smp++)
+				{
+					const ModSample &expected = sndFile.GetSample(smp);
+					const ModSample &sample = lazySndFile->GetSample(smp);
+					VERIFY_EQUAL_NONCONT(lazySndFile->IsSampleDataDeferred(smp), expected.HasSampleData());
+					VERIFY_EQUAL_NONCONT(sample.nLength, expected.nLength);
+					VERIFY_EQUAL_NONCONT(sample.GetElementarySampleSize(), expected.GetElementarySampleSize());
+					VERIFY_EQUAL_NONCONT(sample.GetNumChannels(), expected.GetNumChannels());
+					if(background == 2)
+					{
+						// The first request can never be fulfilled right away, as there is no background thread yet that could have decoded the sample.
+						VERIFY_EQUAL_NONCONT(lazySndFile->RequestDeferredSample(&sample), !expected.HasSampleData());
+						for(int wait = 0; wait < 1000 && !lazySndFile->RequestDeferredSample(&sample); wait++)
+						{
+#if defined(MPT_ENABLE_THREAD)
+							std::this_thread::sleep_for(std::chrono::milliseconds(10));
+#endif // MPT_ENABLE_THREAD
+						}
+					} else
+					{
+						lazySndFile->ResolveDeferredSample(&sample);
+					}
+					VERIFY_EQUAL_NONCONT(lazySndFile->IsSampleDataDeferred(smp), false);
+					VERIFY_EQUAL_NONCONT(sample.HasSampleData(), expected.HasSampleData());
+					if(sample.HasSampleData() && expected.HasSampleData())
+					{
+						VERIFY_EQUAL_NONCONT(std::memcmp(sample.samplev(), expected.samplev(), expected.GetSampleSizeInBytes()), 0);
+					}
+				}
+			}
+
+			// Same for sample data that is decoded on several threads while loading
+			std::unique_ptr<CSoundFile> parallelSndFile = mpt::make_unique<CSoundFile>();
+			parallelSndFile->SetLoadThreads(4);
+			VERIFY_EQUAL(parallelSndFile->Create(FileReader(mpt::as_span(fileData)), CSoundFile::loadCompleteModule), true);
+			VERIFY_EQUAL(parallelSndFile->GetNumSamples(), sndFile.GetNumSamples());
+			for(SAMPLEINDEX smp = 1; smp <= std::min(parallelSndFile->GetNumSamples(), sndFile.GetNumSamples()); smp++)
+			{
+				const ModSample &expected = sndFile.GetSample(smp);
+				const ModSample &sample = parallelSndFile->GetSample(smp);
+				VERIFY_EQUAL_NONCONT(parallelSndFile->IsSampleDataDeferred(smp), false);
+				VERIFY_EQUAL_NONCONT(sample.nLength, expected.nLength);
+				VERIFY_EQUAL_NONCONT(sample.HasSampleData(), expected.HasSampleData());
+				if(sample.HasSampleData() && expected.HasSampleData())
+				{
+					VERIFY_EQUAL_NONCONT(std::memcmp(sample.samplev(), expected.samplev(), expected.GetSampleSizeInBytes()), 0);
+				}
+			}
+
+			// Only reading names and messages
+			std::unique_ptr<CSoundFile> metadataSndFile = mpt::make_unique<CSoundFile>();
+			VERIFY_EQUAL(metadataSndFile->Create(FileReader(mpt::as_span(fileData)), CSoundFile::loadMetadata), true);
+			VERIFY_EQUAL(metadataSndFile->GetTitle(), sndFile.GetTitle());
+			VERIFY_EQUAL(static_cast<const std::string &>(metadataSndFile->m_songMessage), static_cast<const std::string &>(sndFile.m_songMessage));
+			VERIFY_EQUAL(metadataSndFile->GetNumChannels(), sndFile.GetNumChannels());
+			VERIFY_EQUAL(metadataSndFile->GetNumInstruments(), sndFile.GetNumInstruments());
+			VERIFY_EQUAL(metadataSndFile->GetNumSamples(), sndFile.GetNumSamples());
+			for(SAMPLEINDEX smp = 1; smp <= std::min(metadataSndFile->GetNumSamples(), sndFile.GetNumSamples()); smp++)
+			{
+				VERIFY_EQUAL_NONCONT(strcmp(metadataSndFile->GetSampleName(smp), sndFile.GetSampleName(smp)), 0);
+				VERIFY_EQUAL_NONCONT(metadataSndFile->GetSample(smp).HasSampleData(), false);
+			}
+			for(INSTRUMENTINDEX ins = 1; ins <= std::min(metadataSndFile->GetNumInstruments(), sndFile.GetNumInstruments()); ins++)
+			{
+				VERIFY_EQUAL_NONCONT(strcmp(metadataSndFile->GetInstrumentName(ins), sndFile.GetInstrumentName(ins)), 0);
+			}
+
+			// Loading from an unseekable stream, with and without reading ahead on a background thread
+			for(int readAhead = 0; readAhead < 2; readAhead++)
+			{
+				std::istringstream unseekableStream(std::string(mpt::byte_cast<const char *>(fileData.data()), fileData.size()));
+				FileReader unseekableFile(std::static_pointer_cast<IFileDataContainer>(std::make_shared<FileDataContainerStdStream>(&unseekableStream, readAhead != 0)));
+				std::unique_ptr<CSoundFile> streamSndFile = mpt::make_unique<CSoundFile>();
+				VERIFY_EQUAL(streamSndFile->Create(unseekableFile, CSoundFile::loadCompleteModule), true);
+				VERIFY_EQUAL(unseekableFile.GetLength(), fileData.size());
+				VERIFY_EQUAL(streamSndFile->GetTitle(), sndFile.GetTitle());
+				VERIFY_EQUAL(streamSndFile->GetNumSamples(), sndFile.GetNumSamples());
+				for(SAMPLEINDEX smp = 1; smp <= std::min(streamSndFile->GetNumSamples(), sndFile.GetNumSamples()); smp++)
+				{
+					const ModSample &expected = sndFile.GetSample(smp);
+					const ModSample &sample = streamSndFile->GetSample(smp);
+					VERIFY_EQUAL_NONCONT(sample.nLength, expected.nLength);
+					if(sample.HasSampleData() && expected.HasSampleData())
+					{
+						VERIFY_EQUAL_NONCONT(std::memcmp(sample.samplev(), expected.samplev(), expected.GetSampleSizeInBytes()), 0);
+					}
+				}
+				std::vector<mpt::byte> streamData;
+				unseekableFile.Rewind();
+				VERIFY_EQUAL(unseekableFile.ReadVector(streamData, fileData.size()), true);
+				VERIFY_EQUAL(streamData == fileData, true);
+			}
+
+			// Same for sample data that is shared between two modules loaded from the same file
+			std::unique_ptr<CSoundFile> sharedSndFile1 = mpt::make_unique<CSoundFile>(), sharedSndFile2 = mpt::make_unique<CSoundFile>();
+			sharedSndFile1->SetSampleSharing(true);
+			sharedSndFile2->SetSampleSharing(true);
+			VERIFY_EQUAL(sharedSndFile1->Create(FileReader(mpt::as_span(fileData)), CSoundFile::loadCompleteModule), true);
+			VERIFY_EQUAL(sharedSndFile2->Create(FileReader(mpt::as_span(fileData)), CSoundFile::loadCompleteModule), true);
+			VERIFY_EQUAL(sharedSndFile2->GetNumSamples(), sndFile.GetNumSamples());
+			for(SAMPLEINDEX smp = 1; smp <= std::min(sharedSndFile2->GetNumSamples(), sndFile.GetNumSamples()); smp++)
+			{
+				const ModSample &expected = sndFile.GetSample(smp);
+				const ModSample &sample = sharedSndFile2->GetSample(smp);
+				VERIFY_EQUAL_NONCONT(sample.nLength, expected.nLength);
+				VERIFY_EQUAL_NONCONT(sample.HasSampleData(), expected.HasSampleData());
+				if(sample.HasSampleData() && expected.HasSampleData())
+				{
+					VERIFY_EQUAL_NONCONT(SamplePool::IsShared(sample.samplev()), true);
+					VERIFY_EQUAL_NONCONT(sample.samplev(), sharedSndFile1->GetSample(smp).samplev());
+					VERIFY_EQUAL_NONCONT(std::memcmp(sample.samplev(), expected.samplev(), expected.GetSampleSizeInBytes()), 0);
+				}
+			}
+			// Modifying shared sample data must not affect the other module
+			ModSample &modifiedSample = sharedSndFile2->GetSample(1);
+			if(modifiedSample.HasSampleData())
+			{
+				const void *sharedData = modifiedSample.samplev();
+				VERIFY_EQUAL(ctrlSmp::InvertSample(modifiedSample, 0, modifiedSample.nLength, *sharedSndFile2), true);
+				VERIFY_EQUAL(SamplePool::IsShared(modifiedSample.samplev()), false);
+				VERIFY_EQUAL(sharedSndFile1->GetSample(1).samplev(), sharedData);
+				VERIFY_EQUAL(std::memcmp(sharedSndFile1->GetSample(1).samplev(), sndFile.GetSample(1).samplev(), sndFile.GetSample(1).GetSampleSizeInBytes()), 0);
+			}
+			sharedSndFile1->Destroy();
+			sharedSndFile2->Destroy();
+		}
+
+		// Deferred sample data cannot be used for files that were unpacked from a container, as their data is freed after loading
+		{
+			const CSoundFile &sndFile = GetSoundFile(sndFileContainer);
+			mpt::ifstream stream(filenameBaseSrc + MPT_PATHSTRING("mptm"), std::ios::binary);
+			const std::vector<mpt::byte> fileData = make_FileReader(&stream).GetRawDataAsByteVector();
+			// Wrap the file in an MMCMP container with a single uncompressed block
+			std::vector<mpt::byte> packedData(56);
+			const auto WriteLE = [&packedData](std::size_t offset, uint32 value, std::size_t size)
+			{
+				for(std::size_t i = 0; i < size; i++)
+				{
+					packedData[offset + i] = static_cast<mpt::byte>(value >> (i * 8));
+				}
+			};
+			std::memcpy(packedData.data(), "ziRCONia", 8);
+			WriteLE(8, 14, 2);	// Header size
+			WriteLE(12, 1, 2);	// Number of blocks
+			WriteLE(14, static_cast<uint32>(fileData.size()), 4);	// Unpacked size
+			WriteLE(18, 24, 4);	// Block table offset
+			WriteLE(24, 28, 4);	// Block offset
+			WriteLE(28, static_cast<uint32>(fileData.size()), 4);	// Block unpacked size
+			WriteLE(32, static_cast<uint32>(fileData.size()), 4);	// Block packed size
+			WriteLE(40, 1, 2);	// Number of sub-blocks
+			WriteLE(52, static_cast<uint32>(fileData.size()), 4);	// Sub-block size
+			packedData.insert(packedData.end(), fileData.begin(), fileData.end());
+
+			std::unique_ptr<CSoundFile> lazySndFile = mpt::make_unique<CSoundFile>();
+			VERIFY_EQUAL(lazySndFile->Create(FileReader(mpt::as_span(packedData)), static_cast<CSoundFile::ModLoadingFlags>(CSoundFile::loadCompleteModule | CSoundFile::deferSampleData)), true);
+			VERIFY_EQUAL(lazySndFile->GetContainerType(), MOD_CONTAINERTYPE_MMCMP);
+			VERIFY_EQUAL(lazySndFile->GetNumSamples(), sndFile.GetNumSamples());
+			for(SAMPLEINDEX smp = 1; smp <= std::min(lazySndFile->GetNumSamples(), sndFile.GetNumSamples()); smp++)
+			{
+				const ModSample &expected = sndFile.GetSample(smp);
+				const ModSample &sample = lazySndFile->GetSample(smp);
+				VERIFY_EQUAL_NONCONT(lazySndFile->IsSampleDataDeferred(smp), false);
+				VERIFY_EQUAL_NONCONT(sample.nLength, expected.nLength);
+				VERIFY_EQUAL_NONCONT(sample.HasSampleData(), expected.HasSampleData());
+				if(sample.HasSampleData() && expected.HasSampleData())
+				{
+					VERIFY_EQUAL_NONCONT(std::memcmp(sample.samplev(), expected.samplev(), expected.GetSampleSizeInBytes()), 0);
+				}
+			}
+		}
+
+		#ifndef MODPLUG_NO_FILESAVE
+			// Test file saving
+			GetSoundFile(sndFileContainer).m_dwLastSavedWithVersion = Version::Current();
+			SaveIT(sndFileContainer, filenameBase + MPT_PATHSTRING("saved.mptm"));
+		#endif
+
+		DestroySoundFileContainer(sndFileContainer);
+	}
 
 	// Reload the saved file and test if everything is still working correctly.
 	#ifndef MODPLUG_NO_FILESAVE
@@ -3788,6 +4928,60 @@ static MPT_NOINLINE void TestLoadSaveFile()
 		}
 		VERIFY_EQUAL_EPS(totalDuration, 3674.38, 1.0);
 
+		// Seeking from GetLength checkpoints must give the same results as seeking from the song start.
+		// The small memory limit forces the checkpoint interval to be increased a few times.
+		{
+			const double seekTimes[] = { 0.5, 19.0, 150.0, 3000.0, 15.0, 1000.0 };
+			std::vector<GetLengthType> expected;
+			std::vector<double> expectedAdjusted;
+			std::vector<std::pair<TEMPO, uint32>> expectedTempo;
+			for(double t : seekTimes)
+			{
+				expected.push_back(sndFile.GetLength(eNoAdjust, GetLengthTarget(t)).back());
+				expectedAdjusted.push_back(sndFile.GetLength(eAdjust, GetLengthTarget(expected.back().lastOrder, expected.back().lastRow)).back().duration);
+				expectedTempo.push_back(std::make_pair(sndFile.GetMusicTempo(), sndFile.GetMusicSpeed()));
+			}
+			sndFile.SetLengthCheckpoints(1.0, 256 * 1024);
+			VERIFY_EQUAL_NONCONT(sndFile.GetLength(eNoAdjust, GetLengthTarget(true)).size(), 3);
+			for(size_t i = 0; i < CountOf(seekTimes); i++)
+			{
+				const GetLengthType result = sndFile.GetLength(eNoAdjust, GetLengthTarget(seekTimes[i])).back();
+				VERIFY_EQUAL_NONCONT(result.duration, expected[i].duration);
+				VERIFY_EQUAL_NONCONT(result.lastOrder, expected[i].lastOrder);
+				VERIFY_EQUAL_NONCONT(result.lastRow, expected[i].lastRow);
+				VERIFY_EQUAL_NONCONT(sndFile.GetLength(eAdjust, GetLengthTarget(result.lastOrder, result.lastRow)).back().duration, expectedAdjusted[i]);
+				VERIFY_EQUAL_NONCONT(sndFile.GetMusicTempo(), expectedTempo[i].first);
+				VERIFY_EQUAL_NONCONT(sndFile.GetMusicSpeed(), expectedTempo[i].second);
+			}
+			sndFile.SetLengthCheckpoints(0.0, 0);
+		}
+
+		// GetLength() reuses its row visitors; they must pick up changes to the order list made in the meantime.
+		{
+			TSoundFileContainer reusedContainer = CreateSoundFileContainer(filenameBaseSrc + MPT_PATHSTRING("s3m"));
+			TSoundFileContainer freshContainer = CreateSoundFileContainer(filenameBaseSrc + MPT_PATHSTRING("s3m"));
+			CSoundFile &reusedFile = GetSoundFile(reusedContainer), &freshFile = GetSoundFile(freshContainer);
+			reusedFile.GetLength(eNoAdjust, GetLengthTarget(true));
+			for(CSoundFile *file : { &reusedFile, &freshFile })
+			{
+				ModSequence &order = file->Order();
+				const std::vector<PATTERNINDEX> copy(order.begin(), order.end());
+				for(PATTERNINDEX pat : copy)
+					order.push_back(pat);
+			}
+			const auto reused = reusedFile.GetLength(eNoAdjust, GetLengthTarget(true));
+			const auto fresh = freshFile.GetLength(eNoAdjust, GetLengthTarget(true));
+			VERIFY_EQUAL_NONCONT(reused.size(), fresh.size());
+			for(size_t i = 0; i < std::min(reused.size(), fresh.size()); i++)
+			{
+				VERIFY_EQUAL_NONCONT(reused[i].duration, fresh[i].duration);
+				VERIFY_EQUAL_NONCONT(reused[i].lastOrder, fresh[i].lastOrder);
+				VERIFY_EQUAL_NONCONT(reused[i].lastRow, fresh[i].lastRow);
+			}
+			DestroySoundFileContainer(freshContainer);
+			DestroySoundFileContainer(reusedContainer);
+		}
+
 		#ifndef MODPLUG_NO_FILESAVE
 			// Test file saving
 			sndFile.ChnSettings[1].dwFlags.set(CHN_MUTE);
@@ -3974,6 +5168,99 @@ static void RunITCompressionTest(const std::vector<int8> &sampleData, FlagSet<Ch
 }
 
 
+// Straightforward implementation of IT sample decompression that reads one bit at a time,
+// used for verifying that the optimized decoder produces exactly the same output, also for broken input.
+template<typename Tsample>
+static void ReferenceITDecompression(const std::string &data, std::vector<Tsample> &out, SmpLength length, SmpLength numChannels, bool it215)
+{
+	const int defWidth = (sizeof(Tsample) == 1) ? 9 : 17;
+	const int fetchA = (sizeof(Tsample) == 1) ? 3 : 4;
+	const int lowerB = (sizeof(Tsample) == 1) ? -4 : -8;
+	const int upperB = (sizeof(Tsample) == 1) ? 3 : 7;
+	std::size_t filePos = 0;
+	for(SmpLength chn = 0; chn < numChannels; chn++)
+	{
+		SmpLength written = 0, pos = chn;
+		while(written < length && filePos + 2 <= data.size())
+		{
+			const std::size_t blockSize = std::min<std::size_t>(static_cast<uint8>(data[filePos]) | (static_cast<uint8>(data[filePos + 1]) << 8), data.size() - filePos - 2);
+			const std::size_t blockStart = filePos + 2;
+			filePos = blockStart + blockSize;
+			if(!blockSize)
+				continue;
+			std::size_t bitPos = 0;
+			auto readBits = [&](int numBits, int &v)
+			{
+				if(bitPos + numBits > blockSize * 8)
+					return false;
+				v = 0;
+				for(int i = 0; i < numBits; i++, bitPos++)
+					v |= ((static_cast<uint8>(data[blockStart + bitPos / 8]) >> (bitPos % 8)) & 1) << i;
+				return true;
+			};
+			auto changeWidth = [](int curWidth, int width)
+			{
+				width++;
+				if(width >= curWidth)
+					width++;
+				return width;
+			};
+
+			SmpLength blockLength = std::min(length - written, SmpLength(ITCompression::blockSize / sizeof(Tsample)));
+			unsigned int mem1 = 0, mem2 = 0;
+			int width = defWidth, v = 0;
+			while(blockLength > 0 && width <= defWidth && readBits(width, v))
+			{
+				const int topBit = 1 << (width - 1);
+				if(width <= 6 && v == topBit)
+				{
+					int newWidth = 0;
+					if(!readBits(fetchA, newWidth))
+						break;
+					width = changeWidth(width, newWidth);
+					continue;
+				} else if(width > 6 && width < defWidth && v >= topBit + lowerB && v <= topBit + upperB)
+				{
+					width = changeWidth(width, v - (topBit + lowerB));
+					continue;
+				} else if(width == defWidth && (v & topBit))
+				{
+					width = (v & ~topBit) + 1;
+					continue;
+				}
+				if(width == defWidth)
+					v &= ~topBit;
+				else if(v & topBit)
+					v -= (topBit << 1);
+				mem1 += v;
+				mem2 += mem1;
+				out[pos] = static_cast<Tsample>(static_cast<int>(it215 ? mem2 : mem1));
+				pos += numChannels;
+				written++;
+				blockLength--;
+			}
+		}
+	}
+}
+
+
+template<typename Tsample>
+static void RunITDecompressionFuzzTest(const std::string &data, SmpLength length, bool stereo, bool it215)
+{
+	const SmpLength numChannels = stereo ? 2 : 1;
+	std::vector<Tsample> expected(length * numChannels, 0), actual(length * numChannels, 0);
+	ReferenceITDecompression(data, expected, length, numChannels, it215);
+
+	ModSample smp;
+	smp.uFlags = (sizeof(Tsample) == 2 ? CHN_16BIT : ChannelFlags(0)) | (stereo ? CHN_STEREO : ChannelFlags(0));
+	smp.pData.pSample = actual.data();
+	smp.nLength = length;
+	FileReader file(mpt::byte_cast<mpt::const_byte_span>(mpt::as_span(data)));
+	ITDecompression decompression(file, smp, it215);
+	VERIFY_EQUAL_QUIET_NONCONT(actual == expected, true);
+}
+
+
 static MPT_NOINLINE void TestITCompression()
 {
 	// Test loading / saving of IT-compressed samples
@@ -3993,6 +5280,703 @@ static MPT_NOINLINE void TestITCompression()
 		RunITCompressionTest(sampleData, CHN_STEREO, i == 0);
 		RunITCompressionTest(sampleData, CHN_16BIT | CHN_STEREO, i == 0);
 	}
+
+	// Compare the decoder with the reference implementation on random data, corrupted compressed data and truncated compressed blocks
+	for(int i = 0; i < 96; i++)
+	{
+		const bool is16Bit = (i & 1) != 0, stereo = (i & 2) != 0, it215 = (i & 4) != 0;
+		const int mode = i / 32;
+		const SmpLength length = 1 + mpt::random<uint32>(*s_PRNG) % 40000;
+		std::string data;
+		if(mode == 0)
+		{
+			for(int block = 0; block < 4; block++)
+			{
+				const uint16 blockSize = 1 + mpt::random<uint16>(*s_PRNG) % 4096;
+				data.push_back(static_cast<char>(blockSize & 0xFF));
+				data.push_back(static_cast<char>(blockSize >> 8));
+				for(uint16 j = 0; j < blockSize; j++)
+				{
+					data.push_back(mpt::random<char>(*s_PRNG));
+				}
+			}
+		} else
+		{
+			ModSample smp;
+			smp.uFlags = (is16Bit ? CHN_16BIT : ChannelFlags(0)) | (stereo ? CHN_STEREO : ChannelFlags(0));
+			smp.pData.pSample = sampleData.data();
+			smp.nLength = std::min(length, mpt::saturate_cast<SmpLength>(sampleData.size() / smp.GetBytesPerSample()));
+			mpt::ostringstream f;
+			ITCompression compression(smp, it215, &f);
+			data = f.str();
+			if(mode == 1)
+			{
+				for(int flip = 0; flip < 1 + (i & 24) / 8; flip++)
+				{
+					data[mpt::random<uint32>(*s_PRNG) % data.size()] ^= static_cast<char>(1 << (mpt::random<uint32>(*s_PRNG) % 8));
+				}
+			} else
+			{
+				// Cut off the end of every block, so that decoding runs out of bits in the middle of the block
+				std::string truncated;
+				for(std::size_t pos = 0; pos + 2 <= data.size(); )
+				{
+					const std::size_t blockSize = static_cast<uint8>(data[pos]) | (static_cast<uint8>(data[pos + 1]) << 8);
+					const std::size_t newSize = blockSize - std::min<std::size_t>(blockSize - 1, 1 + mpt::random<uint32>(*s_PRNG) % 64);
+					truncated.push_back(static_cast<char>(newSize & 0xFF));
+					truncated.push_back(static_cast<char>(newSize >> 8));
+					truncated.append(data, pos + 2, newSize);
+					pos += 2 + blockSize;
+				}
+				data = truncated;
+			}
+		}
+		if(is16Bit)
+			RunITDecompressionFuzzTest<int16>(data, length, stereo, it215);
+		else
+			RunITDecompressionFuzzTest<int8>(data, length, stereo, it215);
+	}
+}
+
+
+
+// Straightforward bit-at-a-time MO3 LZ decoder, used as a reference for the optimized UnpackMO3Data.
+static bool UnpackMO3DataReference(FileReader &file, uint8 *dst, uint32 size)
+{
+	if(!size)
+		return false;
+
+	uint32 data = 0;
+	uint32 carry = 0;
+	const auto ReadCtrlBit = [&]()
+	{
+		data <<= 1;
+		carry = (data > 0xFF) ? 1 : 0;
+		data &= 0xFF;
+		if(data == 0)
+		{
+			data = (file.ReadUint8() << 1) + 1;
+			carry = (data > 0xFF) ? 1 : 0;
+			data &= 0xFF;
+		}
+	};
+	uint32 strLen = 0;
+	const auto DecodeCtrlBits = [&]()
+	{
+		strLen++;
+		do
+		{
+			ReadCtrlBit();
+			strLen = (strLen << 1) + carry;
+			ReadCtrlBit();
+		} while(carry);
+	};
+
+	int32 strOffset = 0, previousPtr = 0;
+	uint8 *initDst = dst;
+	const uint32 initSize = size;
+
+	*dst++ = file.ReadUint8();
+	size--;
+	while(size > 0)
+	{
+		ReadCtrlBit();
+		if(!carry)
+		{
+			*dst++ = file.ReadUint8();
+			size--;
+			continue;
+		}
+		uint32 ebp = 0;
+		DecodeCtrlBits();
+		strLen -= 3;
+		if(static_cast<int32>(strLen) < 0)
+		{
+			strOffset = previousPtr;
+			strLen++;
+		} else
+		{
+			strOffset = static_cast<int32>(~((strLen << 8) | file.ReadUint8()));
+			strLen = 0;
+			if(strOffset < -1280)
+				ebp++;
+			ebp++;
+			if(strOffset < -32000)
+				ebp++;
+			previousPtr = strOffset;
+		}
+		ReadCtrlBit();
+		strLen = (strLen << 1) + carry;
+		ReadCtrlBit();
+		strLen = (strLen << 1) + carry;
+		if(strLen == 0)
+		{
+			DecodeCtrlBits();
+			strLen += 2;
+		}
+		strLen += ebp;
+		if(size < strLen || static_cast<int32>(strLen) <= 0 || strOffset >= 0 || (dst - initDst) + strOffset < 0)
+			break;
+		size -= strLen;
+		const uint8 *string = dst + strOffset;
+		while(strLen > 0)
+		{
+			*dst++ = *string++;
+			strLen--;
+		}
+	}
+	return (dst - initDst) == static_cast<std::ptrdiff_t>(initSize);
+}
+
+
+// Generates a random MO3 LZ stream and the data it decompresses to.
+class MO3StreamGenerator
+{
+	std::string m_stream;
+	std::size_t m_ctrlPos = 0;
+	int m_ctrlBitsLeft = 0;
+
+	void WriteCtrlBit(uint32 bit)
+	{
+		if(!m_ctrlBitsLeft)
+		{
+			m_ctrlPos = m_stream.size();
+			m_stream.push_back(0);
+			m_ctrlBitsLeft = 8;
+		}
+		m_ctrlBitsLeft--;
+		m_stream[m_ctrlPos] |= static_cast<char>(bit << m_ctrlBitsLeft);
+	}
+
+	// Inverse of the length coding in the control stream, value must be at least 2
+	void WriteCtrlValue(uint32 value)
+	{
+		int numBits = 0;
+		while((value >> (numBits + 1)) != 0)
+			numBits++;
+		while(numBits-- > 0)
+		{
+			WriteCtrlBit((value >> numBits) & 1);
+			WriteCtrlBit(numBits > 0 ? 1 : 0);
+		}
+	}
+
+	void WriteLength(uint32 length)
+	{
+		if(length <= 3)
+		{
+			WriteCtrlBit(length >> 1);
+			WriteCtrlBit(length & 1);
+		} else
+		{
+			WriteCtrlBit(0);
+			WriteCtrlBit(0);
+			WriteCtrlValue(length - 2);
+		}
+	}
+
+public:
+	std::vector<uint8> output;
+
+	MO3StreamGenerator(uint32 size)
+	{
+		output.push_back(mpt::random<uint8>(*s_PRNG));
+		m_stream.push_back(static_cast<char>(output.back()));
+		uint32 previousDistance = 0;
+		while(output.size() < size)
+		{
+			const uint32 remain = static_cast<uint32>(size - output.size());
+			const uint32 choice = mpt::random<uint32>(*s_PRNG) % 8;
+			if(choice < 3 || remain < 4)
+			{
+				WriteCtrlBit(0);
+				output.push_back(mpt::random<uint8>(*s_PRNG));
+				m_stream.push_back(static_cast<char>(output.back()));
+				continue;
+			}
+			// Short distances produce overlapping matches, long distances require the length adjustment
+			uint32 distance;
+			if(choice == 3 && previousDistance && previousDistance <= output.size())
+				distance = previousDistance;
+			else if(choice < 6)
+				distance = 1 + mpt::random<uint32>(*s_PRNG) % std::min<uint32>(static_cast<uint32>(output.size()), 16);
+			else
+				distance = 1 + mpt::random<uint32>(*s_PRNG) % std::min<uint32>(static_cast<uint32>(output.size()), 65536);
+			// Explicit distances imply a minimum length that is not stored in the stream
+			const uint32 lengthAdjust = (distance == previousDistance) ? 0 : (1 + (distance > 1280 ? 1 : 0) + (distance > 32000 ? 1 : 0));
+			const uint32 length = std::min(lengthAdjust + 1 + mpt::random<uint32>(*s_PRNG) % ((choice & 1) ? 300 : 12), remain);
+
+			WriteCtrlBit(1);
+			if(distance == previousDistance)
+			{
+				WriteCtrlValue(2);
+			} else
+			{
+				const uint32 code = distance - 1;
+				WriteCtrlValue((code >> 8) + 3);
+				m_stream.push_back(static_cast<char>(code & 0xFF));
+				previousDistance = distance;
+			}
+			WriteLength(length - lengthAdjust);
+			for(uint32 i = 0; i < length; i++)
+			{
+				output.push_back(output[output.size() - distance]);
+			}
+		}
+	}
+
+	const std::string &Stream() const { return m_stream; }
+};
+
+
+static void RunMO3DecompressionTest(const std::string &stream, uint32 size)
+{
+	std::vector<uint8> result(size, 0xCC), reference(size, 0xCC);
+	FileReader file(mpt::as_span(stream)), fileRef(mpt::as_span(stream));
+	const bool ok = UnpackMO3Data(file, result.data(), size);
+	const bool okRef = UnpackMO3DataReference(fileRef, reference.data(), size);
+	VERIFY_EQUAL_NONCONT(ok, okRef);
+	VERIFY_EQUAL_NONCONT(result == reference, true);
+	VERIFY_EQUAL_NONCONT(file.GetPosition(), fileRef.GetPosition());
+}
+
+
+static MPT_NOINLINE void TestMO3Decompression()
+{
+	for(int i = 0; i < 64; i++)
+	{
+		const uint32 size = 1 + mpt::random<uint32>(*s_PRNG) % ((i & 1) ? 200000 : 2000);
+		const MO3StreamGenerator generator(size);
+		std::string stream = generator.Stream();
+
+		// Valid stream followed by unrelated data, which must not be consumed
+		{
+			std::string padded = stream + std::string(16, 'x');
+			std::vector<uint8> result(size);
+			FileReader file(mpt::as_span(padded));
+			VERIFY_EQUAL_NONCONT(UnpackMO3Data(file, result.data(), size), true);
+			VERIFY_EQUAL_NONCONT(result == generator.output, true);
+			VERIFY_EQUAL_NONCONT(file.GetPosition(), stream.size());
+			RunMO3DecompressionTest(padded, size);
+		}
+
+		// Corrupted, truncated and random streams, and wrong decompressed sizes
+		std::string corrupted = stream;
+		for(int flip = 0; flip < 1 + (i & 7); flip++)
+		{
+			corrupted[mpt::random<uint32>(*s_PRNG) % corrupted.size()] ^= static_cast<char>(1 << (mpt::random<uint32>(*s_PRNG) % 8));
+		}
+		RunMO3DecompressionTest(corrupted, size);
+		RunMO3DecompressionTest(stream.substr(0, mpt::random<uint32>(*s_PRNG) % stream.size()), size);
+		RunMO3DecompressionTest(stream, size + 1 + mpt::random<uint32>(*s_PRNG) % 100);
+		RunMO3DecompressionTest(stream, 1 + mpt::random<uint32>(*s_PRNG) % size);
+		std::string random(1 + mpt::random<uint32>(*s_PRNG) % 4096, 0);
+		for(auto &c : random)
+		{
+			c = mpt::random<char>(*s_PRNG);
+		}
+		RunMO3DecompressionTest(random, size);
+	}
+	RunMO3DecompressionTest(std::string(1024, '\xFF'), 100000);
+	RunMO3DecompressionTest(std::string(), 100);
+}
+
+
+
+#if defined(MPT_INTMIXER) && defined(ENABLE_INTRINSICS_SSE4_1)
+
+// Verify that an optimized mix function table produces exactly the same output as the generic one.
+static void RunMixFuncTableTest(const MixFuncInterface *table, const std::vector<int16> &sampleData, const CResampler &resampler)
+{
+	const unsigned int numFrames = 61;	// Odd number to also exercise the remainder handling of loops processing multiple frames at once
+	const SamplePosition increments[] = { SamplePosition::Ratio(3, 7), SamplePosition::Ratio(17, 16), SamplePosition::Ratio(3, 2), SamplePosition::Ratio(19, 8), SamplePosition::Ratio(5, 4) * -1 };
+	for(uint32 ndx = 0; ndx < 6 * 16; ndx++)
+	{
+		if(table[ndx] == MixFuncTable::Functions[ndx])
+			continue;
+		for(const auto &increment : increments)
+		{
+			ModChannel chn{};
+			chn.pCurrentSample = sampleData.data() + sampleData.size() / 2;
+			chn.position = SamplePosition(0, mpt::random<uint32>(*s_PRNG));
+			chn.increment = increment;
+			chn.leftVol = 3000;
+			chn.rightVol = 1000;
+			chn.rampLeftVol = chn.leftVol << VOLUMERAMPPRECISION;
+			chn.rampRightVol = chn.rightVol << VOLUMERAMPPRECISION;
+			chn.leftRamp = 17;
+			chn.rightRamp = -13;
+			chn.nFilter_A0 = 1 << (MIXING_FILTER_PRECISION - 2);
+			chn.nFilter_B0 = 1 << (MIXING_FILTER_PRECISION - 1);
+			chn.nFilter_B1 = 1 << (MIXING_FILTER_PRECISION - 3);
+			ModChannel chnRef = chn;
+
+			std::vector<mixsample_t> buffer(numFrames * 2, 0), bufferRef(numFrames * 2, 0);
+			table[ndx](chn, resampler, buffer.data(), numFrames);
+			MixFuncTable::Functions[ndx](chnRef, resampler, bufferRef.data(), numFrames);
+
+			VERIFY_EQUAL(buffer == bufferRef, true);
+			VERIFY_EQUAL(chn.position.GetRaw(), chnRef.position.GetRaw());
+			VERIFY_EQUAL(chn.rampLeftVol, chnRef.rampLeftVol);
+			VERIFY_EQUAL(chn.rampRightVol, chnRef.rampRightVol);
+			VERIFY_EQUAL(std::equal(&chn.nFilter_Y[0][0], &chn.nFilter_Y[0][0] + 4, &chnRef.nFilter_Y[0][0]), true);
+		}
+	}
+}
+
+#endif // MPT_INTMIXER && ENABLE_INTRINSICS_SSE4_1
+
+
+static MPT_NOINLINE void TestMixFuncTables()
+{
+#if defined(MPT_INTMIXER) && defined(ENABLE_INTRINSICS_SSE4_1)
+	// Random sample data, both 8-bit and 16-bit mix functions interpret it as needed.
+	// The sample pointer is put in the middle so that interpolation can safely look around in either direction.
+	std::vector<int16> sampleData(4096);
+	for(auto &v : sampleData)
+	{
+		v = mpt::random<int16>(*s_PRNG);
+	}
+	CResampler resampler;
+
+	if(GetRealProcSupport() & PROCSUPPORT_SSE4_1)
+	{
+		RunMixFuncTableTest(MixFuncTable::FunctionsSSE4_1, sampleData, resampler);
+	}
+#if defined(ENABLE_INTRINSICS_AVX2)
+	if(GetRealProcSupport() & PROCSUPPORT_AVX2)
+	{
+		RunMixFuncTableTest(MixFuncTable::FunctionsAVX2, sampleData, resampler);
+	}
+#endif // ENABLE_INTRINSICS_AVX2
+#endif // MPT_INTMIXER && ENABLE_INTRINSICS_SSE4_1
+}
+
+
+#if defined(ENABLE_INTRINSICS_SSE2)
+
+// Compare the SIMD output conversion and dither noise generation with the generic code, using the processor features given in procSupport
+static void RunOutputConversionTest(uint32 procSupport)
+{
+	const uint32 oldProcSupport = ProcSupport;
+	for(std::size_t channels : { 1, 2, 4 })
+	{
+		for(int i = 0; i < 8; i++)
+		{
+			const std::size_t count = mpt::random<uint32>(*s_PRNG) % 80;
+			std::vector<int32> mix(channels * count);
+			for(auto &v : mix)
+			{
+				// Mostly in range, sometimes far beyond full scale to test clipping
+				v = mpt::random<int32>(*s_PRNG) >> ((i & 1) ? 0 : 4);
+			}
+
+			std::vector<int16> int16Ref(channels * count), int16Out(channels * count, 1);
+			std::vector<int16> int16Planar(4 * count, 1);
+			int16 *int16Buffers[4] = { int16Planar.data() + 0 * count, int16Planar.data() + 1 * count, int16Planar.data() + 2 * count, int16Planar.data() + 3 * count };
+			std::vector<float> floatRef(channels * count), floatOut(channels * count, 1.0f);
+			std::vector<float> floatPlanar(4 * count, 1.0f);
+			float *floatBuffers[4] = { floatPlanar.data() + 0 * count, floatPlanar.data() + 1 * count, floatPlanar.data() + 2 * count, floatPlanar.data() + 3 * count };
+			const bool clip = (i & 2) != 0;
+
+			ConvertInterleavedFixedPointToInterleaved<MIXING_FRACTIONAL_BITS, false>(int16Ref.data(), mix.data(), channels, count);
+			if(clip)
+				ConvertInterleavedFixedPointToInterleaved<MIXING_FRACTIONAL_BITS, true>(floatRef.data(), mix.data(), channels, count);
+			else
+				ConvertInterleavedFixedPointToInterleaved<MIXING_FRACTIONAL_BITS, false>(floatRef.data(), mix.data(), channels, count);
+
+			ProcSupport = procSupport;
+			const bool int16OK = ConvertMixToInt16SIMD(int16Out.data(), int16Buffers, 0, mix.data(), channels, count);
+			const bool floatOK = ConvertMixToFloatSIMD(floatOut.data(), floatBuffers, 0, mix.data(), channels, count, clip);
+			ProcSupport = oldProcSupport;
+
+			VERIFY_EQUAL_NONCONT(int16OK, true);
+			VERIFY_EQUAL_NONCONT(floatOK, true);
+			VERIFY_EQUAL_NONCONT(int16Out == int16Ref, true);
+			VERIFY_EQUAL_NONCONT(floatOut == floatRef, true);
+			for(std::size_t frame = 0; frame < count; frame++)
+			{
+				for(std::size_t channel = 0; channel < channels; channel++)
+				{
+					VERIFY_EQUAL_QUIET_NONCONT(int16Buffers[channel][frame], int16Ref[frame * channels + channel]);
+					VERIFY_EQUAL_QUIET_NONCONT(floatBuffers[channel][frame], floatRef[frame * channels + channel]);
+				}
+			}
+		}
+
+		// Noise-shaped dither generates the noise for several samples at once
+		for(int bits : { 8, 16, 24 })
+		{
+			mpt::prng prngCopy = *s_PRNG;
+			Dither dither(*s_PRNG), ditherRef(prngCopy);
+			dither.SetMode(DitherSimple);
+			ditherRef.SetMode(DitherSimple);
+			for(int i = 0; i < 8; i++)
+			{
+				const std::size_t count = mpt::random<uint32>(*s_PRNG) % 700;
+				std::vector<int> mix(channels * count);
+				for(auto &v : mix)
+				{
+					v = mpt::random<int32>(*s_PRNG) >> 4;
+				}
+				std::vector<int> mixRef = mix;
+				ProcSupport = 0;
+				ditherRef.Process(mixRef.data(), count, channels, bits);
+				ProcSupport = procSupport;
+				dither.Process(mix.data(), count, channels, bits);
+				ProcSupport = oldProcSupport;
+				VERIFY_EQUAL_NONCONT(mix == mixRef, true);
+			}
+		}
+	}
+}
+
+#endif // ENABLE_INTRINSICS_SSE2
+
+
+static MPT_NOINLINE void TestOutputConversion()
+{
+#if defined(ENABLE_INTRINSICS_SSE2)
+	if(GetRealProcSupport() & PROCSUPPORT_SSE2)
+	{
+		RunOutputConversionTest(GetRealProcSupport() & ~PROCSUPPORT_AVX2);
+	}
+#if defined(ENABLE_INTRINSICS_AVX2)
+	if(GetRealProcSupport() & PROCSUPPORT_AVX2)
+	{
+		RunOutputConversionTest(GetRealProcSupport());
+	}
+#endif // ENABLE_INTRINSICS_AVX2
+#endif // ENABLE_INTRINSICS_SSE2
+}
+
+
+#ifndef NO_EQ
+
+// Run the equalizer over a random mix in chunks of random size, optionally with the SIMD code disabled
+static std::vector<int> RunEQTest(const std::vector<int> &mix, const float32 *gains, uint32 channels, uint32 procSupport)
+{
+	const uint32 frames = static_cast<uint32>(mix.size() / 4);
+	static const float32 freqs[MAX_EQ_BANDS] = { 125, 300, 600, 1250, 4000, 8000 };
+	CQuadEQ eq;
+	eq.SetEQGains(gains, MAX_EQ_BANDS, freqs, true, 44100);
+	std::vector<int> front(mix.begin(), mix.begin() + frames * 2), rear(mix.begin() + frames * 2, mix.end());
+	mpt::prng prng(42);
+	const uint32 oldProcSupport = ProcSupport;
+	ProcSupport = procSupport;
+	for(uint32 pos = 0; pos < frames; )
+	{
+		const uint32 count = std::min(frames - pos, 1 + mpt::random<uint32>(prng) % 700);
+		eq.Process(front.data() + pos * std::min(channels, 2u), rear.data() + pos * 2, count, channels);
+		pos += count;
+	}
+	ProcSupport = oldProcSupport;
+	front.insert(front.end(), rear.begin(), rear.end());
+	return front;
+}
+
+#endif // NO_EQ
+
+
+#ifndef NO_PLUGINS
+
+// Feed a burst of deterministic noise followed by silence through a reverb DMO in blocks of an odd size, and return the interleaved wet output
+static std::vector<float> RunReverbPluginTest(CSoundFile &sndFile, uint32 pluginId, const std::vector<std::pair<PlugParamIndex, PlugParamValue>> &parameters, uint32 frames)
+{
+	SNDMIXPLUGIN &plugin = sndFile.m_MixPlugins[0];
+	plugin.Info.dwPluginId1 = kDmoMagic;
+	plugin.Info.dwPluginId2 = pluginId;
+	CreateMixPluginProc(plugin, sndFile);
+	std::vector<float> output;
+	VERIFY_EQUAL_NONCONT(plugin.pMixPlugin != nullptr, true);
+	if(plugin.pMixPlugin == nullptr)
+		return output;
+	IMixPlugin &reverb = *plugin.pMixPlugin;
+	for(const auto &param : parameters)
+	{
+		reverb.SetParameter(param.first, param.second);
+	}
+	reverb.Resume();
+
+	const uint32 blockSize = 333;
+	uint32 rng = 1;
+	float outL[blockSize], outR[blockSize];
+	for(uint32 pos = 0; pos < frames; pos += blockSize)
+	{
+		const uint32 count = std::min(frames - pos, blockSize);
+		float *inL = reverb.m_mixBuffer.GetInputBuffer(0), *inR = reverb.m_mixBuffer.GetInputBuffer(1);
+		for(uint32 i = 0; i < count; i++)
+		{
+			inL[i] = inR[i] = 0.0f;
+			if(pos + i < frames / 10)
+			{
+				rng = rng * 1664525u + 1013904223u;
+				inL[i] = static_cast<int32>(rng) / 4294967296.0f;
+				rng = rng * 1664525u + 1013904223u;
+				inR[i] = static_cast<int32>(rng) / 4294967296.0f;
+			}
+		}
+		std::fill(outL, outL + count, 0.0f);
+		std::fill(outR, outR + count, 0.0f);
+		reverb.Process(outL, outR, count);
+		const float *wetL = reverb.m_mixBuffer.GetOutputBuffer(0), *wetR = reverb.m_mixBuffer.GetOutputBuffer(1);
+		for(uint32 i = 0; i < count; i++)
+		{
+			output.push_back(wetL[i]);
+			output.push_back(wetR[i]);
+		}
+	}
+	plugin.Destroy();
+	return output;
+}
+
+#endif // NO_PLUGINS
+
+
+static MPT_NOINLINE void TestDSPEffects()
+{
+	const uint32 frames = 5000;
+	std::vector<int> mix(frames * 4);
+	for(auto &v : mix)
+	{
+		v = mpt::random<int32>(*s_PRNG) >> 6;
+	}
+
+#ifndef NO_EQ
+	{
+		const float32 flatGains[MAX_EQ_BANDS] = { 1, 1, 1, 1, 1, 1 };
+		const float32 gains[MAX_EQ_BANDS] = { 4.0f, 0.25f, 1.0f, 2.0f, 0.5f, 3.0f };
+		for(uint32 channels : { 1u, 2u, 4u })
+		{
+			// Flat bands are skipped completely
+			VERIFY_EQUAL_NONCONT(RunEQTest(mix, flatGains, channels, 0) == mix, true);
+			const std::vector<int> reference = RunEQTest(mix, gains, channels, 0);
+			VERIFY_EQUAL_NONCONT(reference != mix, true);
+#if defined(ENABLE_INTRINSICS_SSE2)
+			// The SIMD code performs the same operations as the generic code, but with -ffast-math the compiler may reorder the scalar floating point operations
+			if(GetRealProcSupport() & PROCSUPPORT_SSE2)
+			{
+				VERIFY_EQUAL_NONCONT(MaxRenderDifference(RunEQTest(mix, gains, channels, GetRealProcSupport()), reference) <= (1 << 14), true);
+			}
+#endif // ENABLE_INTRINSICS_SSE2
+		}
+	}
+#endif // NO_EQ
+
+#ifndef NO_DSP
+	{
+		// Processing in several chunks must keep the filter state of all channels
+		for(uint32 channels : { 1u, 2u, 4u })
+		{
+			std::vector<int> front(mix.begin(), mix.begin() + frames * 2), rear(mix.begin() + frames * 2, mix.end());
+			std::vector<int> frontChunked = front, rearChunked = rear;
+			CMegaBass megaBass, megaBassChunked;
+			megaBass.Initialize(true, 44100);
+			megaBassChunked.Initialize(true, 44100);
+			megaBass.Process(front.data(), rear.data(), frames, channels);
+			const uint32 stride = std::min(channels, 2u);
+			for(uint32 pos = 0; pos < frames; pos += 512)
+			{
+				megaBassChunked.Process(frontChunked.data() + pos * stride, rearChunked.data() + pos * 2, std::min(frames - pos, 512u), channels);
+			}
+			VERIFY_EQUAL_NONCONT(front == frontChunked, true);
+			VERIFY_EQUAL_NONCONT(rear == rearChunked, true);
+			VERIFY_EQUAL_NONCONT(front != std::vector<int>(mix.begin(), mix.begin() + frames * 2), true);
+			// The rear channels are only touched in quad mode
+			VERIFY_EQUAL_NONCONT(rear == std::vector<int>(mix.begin() + frames * 2, mix.end()), channels <= 2);
+		}
+	}
+#endif // NO_DSP
+
+#ifndef NO_PLUGINS
+	{
+		// The I3DL2Reverb output must not change with the layout of its delay line state.
+		// Reference values were generated with the implementation that kept the state of each delay line together.
+		const std::vector<mpt::byte> moduleData = CreateRenderTestModule();
+		std::unique_ptr<CSoundFile> sndFile = mpt::make_unique<CSoundFile>();
+		sndFile->Create(FileReader(mpt::as_span(moduleData)), CSoundFile::loadCompleteModule);
+		const uint32 reverbFrames = 22050;
+		const uint32 checkFrames[] = { 3500, 4000, 4500, 5000, 6000, 7000, 10000, 16000 };
+		// Per quality setting: Energy of the left and right channel, followed by the left and right output at each of the check frames
+		static const float reference[4][2 + CountOf(checkFrames) * 2] =
+		{
+			{ 225.74212f, 249.112874f, 0.107931413f, -0.173617795f, -0.11036171f, 0.121767446f, 0.00765860081f, 0.0344248377f, 0.0458941087f, 0.449156851f, -0.248209029f, -0.10451895f, 0.107361436f, -0.124495611f, -0.0440331064f, 0.137681037f, -0.00766764628f, -0.00933106802f },
+			{ 175.084553f, 177.161675f, 0.0754637644f, -0.149972349f, -0.227282345f, 0.225809932f, -0.182304278f, 0.0198863056f, 0.217345148f, 0.205063969f, -0.0801424384f, -0.0272472985f, 0.0307066664f, -0.102555767f, -0.0191793405f, 0.0621228516f, 0.00491906377f, -0.00304922042f },
+			{ 173.991903f, 188.986654f, -0.416286349f, -0.204043791f, 0.0076745376f, 0.299853623f, 0.356159955f, 0.11042434f, -0.0845121369f, 0.238380626f, 0.0986472368f, -0.129862666f, 0.0360325985f, -0.00675774645f, -0.00566078071f, -0.0148006231f, -0.00538595207f, -0.0210444499f },
+			{ 139.915907f, 147.706034f, -0.0947365835f, -0.293221325f, -0.369106978f, 0.127732843f, 0.428655297f, -0.0997253507f, -0.256333172f, -0.117494643f, 0.0768160373f, -0.0884330496f, -0.00628134096f, 0.0167012047f, -0.0246495232f, 0.030718023f, 0.000374814292f, 0.00308664143f },
+		};
+		for(uint32 quality = 0; quality < 4; quality++)
+		{
+			// Full room and reflection levels, so that the early reflections are as loud as the late reverb
+			const std::vector<std::pair<PlugParamIndex, PlugParamValue>> parameters =
+			{
+				{ 12, quality / 3.0f },	// kI3DL2ReverbQuality
+				{ 0, 1.0f },	// kI3DL2ReverbRoom
+				{ 5, 1.0f },	// kI3DL2ReverbReflections
+			};
+			const std::vector<float> output = RunReverbPluginTest(*sndFile, 0xEF985E71, parameters, reverbFrames);
+			VERIFY_EQUAL_NONCONT(output.size(), reverbFrames * 2u);
+			if(output.size() != reverbFrames * 2u)
+				continue;
+			double energy[2] = { 0.0, 0.0 };
+			for(std::size_t i = 0; i < output.size(); i++)
+			{
+				energy[i % 2] += output[i] * output[i];
+			}
+			VERIFY_EQUAL_EPS(energy[0], reference[quality][0], 0.00005);
+			VERIFY_EQUAL_EPS(energy[1], reference[quality][1], 0.00005);
+			for(std::size_t i = 0; i < CountOf(checkFrames); i++)
+			{
+				VERIFY_EQUAL_EPS(output[checkFrames[i] * 2], reference[quality][2 + i * 2], 0.000001f);
+				VERIFY_EQUAL_EPS(output[checkFrames[i] * 2 + 1], reference[quality][3 + i * 2], 0.000001f);
+			}
+		}
+	}
+	{
+		// Same for the WavesReverb, whose comb filters are processed side by side.
+		// Reference values were generated with the implementation that processed one comb filter after another.
+		// Both implementations round slightly differently in builds with -ffast-math, hence the tolerance.
+		const std::vector<mpt::byte> moduleData = CreateRenderTestModule();
+		std::unique_ptr<CSoundFile> sndFile = mpt::make_unique<CSoundFile>();
+		sndFile->Create(FileReader(mpt::as_span(moduleData)), CSoundFile::loadCompleteModule);
+		const uint32 reverbFrames = 22050;
+		const uint32 checkFrames[] = { 2000, 2500, 3500, 5000, 7000, 10000, 16000, 22000 };
+		const float highFreqRatios[] = { 0.0f, 0.5f, 1.0f };
+		// Per high frequency ratio: Energy of the left and right channel, followed by the left and right output at each of the check frames
+		static const float reference[CountOf(highFreqRatios)][2 + CountOf(checkFrames) * 2] =
+		{
+			{ 180.518361f, 175.770948f, -0.0214251764f, -0.00715783238f, -0.255056113f, 0.0999451205f, 0.0135255419f, -0.0815963224f, 0.191313952f, 0.040625073f, 0.0402158611f, 0.0217551216f, 0.0256617293f, 0.0802554935f, -0.0292246751f, -0.0617533475f, 0.006118658f, 0.0320697539f },
+			{ 280.830757f, 267.183581f, -0.0214251764f, -0.00715783238f, -0.255056113f, 0.0999451205f, 0.0135255419f, -0.0268600136f, 0.222636059f, 0.0483030267f, 0.0114625543f, 0.0561447218f, 0.100713655f, 0.153605953f, 0.0884108171f, 0.0436793789f, -0.0369854271f, 0.0144998617f },
+			{ 355.105239f, 334.610852f, -0.0214251764f, -0.00715783238f, -0.255056113f, 0.0999451205f, 0.0135255419f, -0.0208889246f, 0.224425256f, 0.0486693084f, 0.0119444691f, 0.0734971166f, 0.129553452f, 0.177746877f, 0.0999316871f, 0.0226974618f, -0.0562292077f, 0.0384257659f },
+		};
+		for(std::size_t setting = 0; setting < CountOf(highFreqRatios); setting++)
+		{
+			// Full reverb mix with the longest reverb time, so that the comb filter feedback dominates the output
+			const std::vector<std::pair<PlugParamIndex, PlugParamValue>> parameters =
+			{
+				{ 1, 1.0f },	// kRvbReverbMix
+				{ 2, 1.0f },	// kRvbReverbTime
+				{ 3, highFreqRatios[setting] },	// kRvbHighFreqRTRatio
+			};
+			const std::vector<float> output = RunReverbPluginTest(*sndFile, 0x87FC0268, parameters, reverbFrames);
+			VERIFY_EQUAL_NONCONT(output.size(), reverbFrames * 2u);
+			if(output.size() != reverbFrames * 2u)
+				continue;
+			double energy[2] = { 0.0, 0.0 };
+			for(std::size_t i = 0; i < output.size(); i++)
+			{
+				energy[i % 2] += output[i] * output[i];
+			}
+			VERIFY_EQUAL_EPS(energy[0], reference[setting][0], 0.00005);
+			VERIFY_EQUAL_EPS(energy[1], reference[setting][1], 0.00005);
+			for(std::size_t i = 0; i < CountOf(checkFrames); i++)
+			{
+				VERIFY_EQUAL_EPS(output[checkFrames[i] * 2], reference[setting][2 + i * 2], 0.000001f);
+				VERIFY_EQUAL_EPS(output[checkFrames[i] * 2 + 1], reference[setting][3 + i * 2], 0.000001f);
+			}
+		}
+	}
+#endif // NO_PLUGINS
 }
 
 